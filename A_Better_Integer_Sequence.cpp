@@ -7,19 +7,37 @@
 
 #include <iostream>
 #include <utility>
+#include <type_traits>
 
 /* The principle being that each recursion, we "extract" the second element, and "extend" it backward by 1, until it reaches [start]
 * For example: [1]..[4]     -> [1][3][4].. -> [1][2][3]..[4]
                 |    |          |  |  |        |  |  |
             start    mid    start mid end  start mid end
+* That recurses once per element though, so it stops at about 900 elements with g++'s default -ftemplate-depth,
+* and the compile time grows quadratically since every step copies the whole pack.
 */
 template<int start, int mid, int... end>
-auto make_sequence()
+auto make_sequence_recursive()
 {
     if constexpr (start==mid-1)
         return std::integer_sequence<int, start, mid, end...>{};
     else
-        return make_sequence<start, mid-1, mid, end...>();
+        return make_sequence_recursive<start, mid-1, mid, end...>();
+}
+
+/* So instead, let std::make_integer_sequence generate [0]..[end-start] (which is a compiler builtin with no recursion at all),
+* and shift every element by [start] in one pack expansion.
+*/
+template<int start, int... offsets>
+auto shift_sequence(std::integer_sequence<int, offsets...>)
+{
+    return std::integer_sequence<int, (start + offsets)...>{};
+}
+
+template<int start, int end>
+auto make_sequence()
+{
+    return shift_sequence<start>(std::make_integer_sequence<int, end - start + 1>{});
 }
 
 //Here is a function that verifies and prints out the integer in the sequence 1 by 1, seperated by a new line.
@@ -32,6 +50,8 @@ void print(std::integer_sequence<int, seq...>)
 
 int main()
 {
+    static_assert(std::is_same_v<decltype(make_sequence<-10, 20>()), decltype(make_sequence_recursive<-10, 20>())>);
+    static_assert(decltype(make_sequence<0, 99999>())::size() == 100000); //make_sequence_recursive<0, 99999>() won't compile
     print(make_sequence<-10, 20>());
 }
 //Output:
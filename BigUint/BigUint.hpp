@@ -0,0 +1,172 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <iostream>
+#include <cstdint>
+
+/*An arbitrary precision unsigned integer.
+ * Limbs are stored in base 10^9 (least significant first), so that printing is trivial
+ * and a limb product still fits in uint64_t
+ */
+class BigUint
+{
+	static constexpr uint32_t base = 1'000'000'000;
+	static constexpr size_t karatsuba_threshold = 48;	//below this number of limbs, schoolbook multiplication is faster
+	std::vector<uint32_t> limbs;
+
+	void trim()
+	{
+		while (!limbs.empty() && limbs.back() == 0)
+			limbs.pop_back();
+	}
+
+	BigUint low(size_t n) const
+	{
+		BigUint result;
+		result.limbs.assign(limbs.begin(), limbs.begin() + std::min(n, limbs.size()));
+		result.trim();
+		return result;
+	}
+
+	BigUint high(size_t n) const
+	{
+		BigUint result;
+		if (n < limbs.size())
+			result.limbs.assign(limbs.begin() + n, limbs.end());
+		return result;
+	}
+
+	/*this += other * base^shift */
+	void add_shifted(BigUint const& other, size_t shift)
+	{
+		if (limbs.size() < other.limbs.size() + shift)
+			limbs.resize(other.limbs.size() + shift, 0);
+		uint32_t carry = 0;
+		size_t i = 0;
+		for (; i < other.limbs.size() || carry; ++i)
+		{
+			if (i + shift == limbs.size())
+				limbs.push_back(0);
+			uint32_t sum = limbs[i + shift] + carry + (i < other.limbs.size() ? other.limbs[i] : 0);
+			carry = sum >= base;
+			limbs[i + shift] = carry ? sum - base : sum;
+		}
+	}
+
+	static BigUint schoolbook(BigUint const& x, BigUint const& y)
+	{
+		BigUint result;
+		if (x.limbs.empty() || y.limbs.empty())
+			return result;
+		/*A limb product is < 10^18, so 18 of them can be summed in uint64_t before carrying,
+		 * which saves most of the divisions */
+		constexpr size_t rows_per_carry = 16;
+		std::vector<uint64_t> sum(x.limbs.size() + y.limbs.size(), 0);
+		auto carry_all = [&sum]
+		{
+			uint64_t carry = 0;
+			for (auto& limb : sum)
+			{
+				limb += carry;
+				carry = limb / base;
+				limb %= base;
+			}
+		};
+		for (size_t i = 0; i < x.limbs.size(); ++i)
+		{
+			const uint64_t x_limb = x.limbs[i];
+			uint64_t* row = sum.data() + i;
+			for (size_t j = 0; j < y.limbs.size(); ++j)
+				row[j] += x_limb * y.limbs[j];
+			if (i % rows_per_carry == rows_per_carry - 1)
+				carry_all();
+		}
+		carry_all();
+		result.limbs.assign(sum.begin(), sum.end());
+		result.trim();
+		return result;
+	}
+
+	/*x * y = z2 * base^2m + z1 * base^m + z0, with only 3 multiplications of half the size:
+	 * z1 = (x0 + x1)(y0 + y1) - z0 - z2
+	 */
+	static BigUint karatsuba(BigUint const& x, BigUint const& y)
+	{
+		if (std::min(x.limbs.size(), y.limbs.size()) < karatsuba_threshold)
+			return schoolbook(x, y);
+		const size_t m = std::max(x.limbs.size(), y.limbs.size()) / 2;
+		const BigUint x0 = x.low(m), x1 = x.high(m);
+		const BigUint y0 = y.low(m), y1 = y.high(m);
+		const BigUint z0 = karatsuba(x0, y0);
+		const BigUint z2 = karatsuba(x1, y1);
+		const BigUint z1 = karatsuba(x0 + x1, y0 + y1) - z0 - z2;
+
+		BigUint result = z0;
+		result.add_shifted(z1, m);
+		result.add_shifted(z2, 2 * m);
+		result.trim();
+		return result;
+	}
+public:
+	BigUint(uint64_t value = 0)
+	{
+		for (; value; value /= base)
+			limbs.push_back(static_cast<uint32_t>(value % base));
+	}
+
+	BigUint& operator+=(BigUint const& rhs)
+	{
+		add_shifted(rhs, 0);
+		return *this;
+	}
+
+	friend BigUint operator+(BigUint lhs, BigUint const& rhs)
+	{
+		return lhs += rhs;
+	}
+
+	/*lhs must be >= rhs */
+	friend BigUint operator-(BigUint lhs, BigUint const& rhs)
+	{
+		int64_t borrow = 0;
+		for (size_t i = 0; i < lhs.limbs.size() && (i < rhs.limbs.size() || borrow); ++i)
+		{
+			int64_t diff = static_cast<int64_t>(lhs.limbs[i]) - borrow - (i < rhs.limbs.size() ? rhs.limbs[i] : 0);
+			borrow = diff < 0;
+			lhs.limbs[i] = static_cast<uint32_t>(borrow ? diff + base : diff);
+		}
+		lhs.trim();
+		return lhs;
+	}
+
+	friend BigUint operator*(BigUint const& lhs, BigUint const& rhs)
+	{
+		return karatsuba(lhs, rhs);
+	}
+
+	size_t digits() const
+	{
+		if (limbs.empty())
+			return 1;
+		return (limbs.size() - 1) * 9 + std::to_string(limbs.back()).size();
+	}
+
+	std::string to_string() const
+	{
+		if (limbs.empty())
+			return "0";
+		std::string result = std::to_string(limbs.back());
+		for (auto iter = limbs.rbegin() + 1; iter != limbs.rend(); ++iter)
+		{
+			const auto limb = std::to_string(*iter);
+			result.append(9 - limb.size(), '0').append(limb);
+		}
+		return result;
+	}
+
+	friend std::ostream& operator<<(std::ostream& os, BigUint const& num)
+	{
+		return os << num.to_string();
+	}
+};
@@ -10,30 +10,35 @@
 #include <array>
 #include <iostream>
 #include <algorithm>
+#include <thread>
+#include <random>
+#include <chrono>
+#include <utility>
 
 /*@ Build up a character table of pattern string for lookup
 * @ param pattern: the pattern string
 * @ return: an array of ASCII characters whose value is the highest index of occurence (last occurence) in @pattern
 */
-constexpr int alphabet = 128;
-std::array<int, alphabet> make_char_table(std::string_view pattern)
+constexpr int alphabet = 256;   //the text can be any in-memory buffer, not only ASCII
+constexpr std::array<int, alphabet> make_char_table(std::string_view pattern)
 {
     std::array<int, alphabet> char_table;
     std::fill(char_table.begin(), char_table.end(), -1);
     for (auto i = 0; i < pattern.size(); ++i)
-        char_table[pattern[i]] = std::max(i, char_table[pattern[i]]);
+        char_table[static_cast<unsigned char>(pattern[i])] = i;
     return char_table;
 }
 
 /*@ Return a shift according to the bad character rule
+* The mismatched text char is aligned with its last occurence in the pattern, or the pattern is shifted past it.
+* The shift may be <= 0 when the last occurence is on the right of the mismatch, @boyer_moore takes the max with the good suffix rule.
 */
-int bad_char_rule(std::string_view text, std::string_view pattern, const std::array<int, alphabet>& char_table)
+constexpr int bad_char_rule(std::string_view text, std::string_view pattern, const std::array<int, alphabet>& char_table)
 {
-    auto text_iter = text.cbegin() + pattern.length() - 1;
-    for (auto pattern_iter = pattern.crbegin(); pattern_iter != pattern.crend(); ++pattern_iter, --text_iter)
+    for (int j = pattern.length() - 1; j >= 0; --j)
     {
-        if (*pattern_iter != *text_iter)
-            return char_table[*text_iter] != -1 ? pattern.length() - char_table[*text_iter] : pattern.length();
+        if (pattern[j] != text[j])
+            return j - char_table[static_cast<unsigned char>(text[j])];
     }
     return 0;
 }
@@ -72,7 +77,7 @@ std::vector<int> make_max_suffix_table(std::string_view pattern)
 /*@return the maximum length of the P[pos-length..pos] == P[n-length..n]
 *
 */
-int suffixLength(std::string_view pattern, int pos)
+constexpr int suffixLength(std::string_view pattern, int pos)
 {
     int length = 0;
     for (int i = pos, j = pattern.length() - 1; i >= 0 && pattern[i] == pattern[j]; --i, --j)
@@ -80,21 +85,24 @@ int suffixLength(std::string_view pattern, int pos)
     return length;
 }
 
-std::vector<int> make_offset_table(std::string_view pattern)
+/*@return a table indexed by the length of the matched suffix,
+* whose value is how far the text position of the mismatch should jump (same as the table on wikipedia)
+*/
+constexpr std::vector<int> make_offset_table(std::string_view pattern)
 {
     std::vector<int> table(pattern.length(), 0);
     int lastPrefixPos = pattern.length();
-    for (int i = pattern.length() - 1; i > 0; --i)
+    for (int i = pattern.length(); i > 0; --i)
     {
         //if P[0..n-i] == P[i..n] ( P[i..n] is a prefix of P )
         if (std::string_view{ pattern.data(), pattern.length() - i } == std::string_view{ pattern.data() + i, pattern.length() - i })
             lastPrefixPos = i;
-        table[pattern.length() - i] = lastPrefixPos - i;
+        table[pattern.length() - i] = lastPrefixPos - i + pattern.length();
     }
-    for (int i = 0; i < pattern.length() - 1; ++i)
+    for (int i = 0; i < static_cast<int>(pattern.length()) - 1; ++i)
     {
         int slength = suffixLength(pattern, i);
-        table[slength] = pattern.length() - 1 - i;
+        table[slength] = pattern.length() - 1 - i + slength;
     }
     return table;
 }
@@ -112,29 +120,196 @@ std::vector<int> make_offset_table(std::string_view pattern)
 //}
 //
 
-int good_suffix_rule(std::string_view text, std::string_view pattern, const std::vector<int>& offset_table)
+/*@ Return a shift of the pattern according to the good suffix rule
+* When the whole pattern matches, this is the period of the pattern, so overlapping occurences are not skipped.
+*/
+template<typename OffsetTable>
+constexpr int good_suffix_rule(std::string_view text, std::string_view pattern, const OffsetTable& offset_table)
 {
-    for (int i = pattern.length() - 1; i > 0; --i)
+    const int last = pattern.length() - 1;
+    for (int j = last; j >= 0; --j)
     {
-        if (pattern[i] != text[i])
-            return offset_table[i];
+        if (pattern[j] != text[j])
+            return j + offset_table[last - j] - last;
     }
-    return -1;
+    return offset_table[last] - last;
 }
 
-std::vector<int> boyer_moore(std::string_view text, std::string_view pattern) //return occurences
+/*@ The searching loop of boyer_moore, with the tables already built for @pattern
+*/
+template<typename OffsetTable>
+std::vector<size_t> boyer_moore_with(std::string_view text, std::string_view pattern, const std::array<int, alphabet>& char_table, const OffsetTable& offset_table)
 {
-    std::vector<int> occurence;
-    auto char_table = make_char_table(text);
-    auto offset_table = make_offset_table(pattern);
-    int shift = 0;
+    std::vector<size_t> occurence;
+    size_t shift = 0;
     while (shift + pattern.length() <= text.length()) 
     {
         if (auto shifted_text = std::string_view{ text.data() + shift, pattern.length() }; shifted_text != pattern)
             shift += std::max(bad_char_rule(shifted_text, pattern, char_table), good_suffix_rule(shifted_text, pattern, offset_table));
         else
+        {
             occurence.push_back(shift);
+            shift += good_suffix_rule(shifted_text, pattern, offset_table);
+        }
+    }
+    return occurence;
+}
+
+std::vector<size_t> boyer_moore(std::string_view text, std::string_view pattern) //return occurences
+{
+    if (pattern.empty())
+        return {};
+    return boyer_moore_with(text, pattern, make_char_table(pattern), make_offset_table(pattern));
+}
+
+/*@ KMP longest proper prefix which is also a suffix, for each pattern[0..i], same as preprocess() in KMP_String_Matching.cpp
+*/
+constexpr std::vector<size_t> make_lps_table(std::string_view pattern)
+{
+    std::vector<size_t> lps(pattern.length(), 0);
+    size_t lps_pre = 0;
+    for (size_t i = 1; i < pattern.length();)
+    {
+        if (pattern[i] == pattern[lps_pre])
+            lps[i++] = ++lps_pre;
+        else if (lps_pre != 0)
+            lps_pre = lps[lps_pre - 1];
+        else
+            lps[i++] = 0;
+    }
+    return lps;
+}
+
+/*@ A string literal usable as a template argument, eg. static_searcher<"pattern">
+*/
+template<size_t N>
+struct fixed_string
+{
+    char data[N]{};
+    constexpr fixed_string(const char (&str)[N])
+    {
+        std::copy(str, str + N, data);
+    }
+    constexpr std::string_view view() const { return { data, N - 1 }; }
+};
+
+/*@ A searcher for a pattern known at compile time
+* All the tables (bad char, good suffix and KMP lps) are computed by the compiler with the same functions as the runtime searchers,
+* and needles no longer than @unroll_limit are compared with a fully unrolled expression, skipping ahead by the
+* last char of the window (Boyer-Moore-Horspool) instead of running the table driven loop.
+*/
+template<fixed_string Pattern>
+class static_searcher
+{
+    template<typename T, size_t... I>
+    static constexpr auto to_array(const std::vector<T>& table, std::index_sequence<I...>)
+    {
+        return std::array<T, sizeof...(I)>{ table[I]... };
+    }
+
+    //compare from the last char, like boyer_moore does
+    template<size_t... I>
+    static bool matches_at(const char* text, std::index_sequence<I...>)
+    {
+        return ((text[sizeof...(I) - 1 - I] == pattern[sizeof...(I) - 1 - I]) && ...);
+    }
+public:
+    static constexpr std::string_view pattern = Pattern.view();
+    static constexpr size_t unroll_limit = 8;
+    static_assert(!pattern.empty(), "Pattern cannot be empty");
+
+    static constexpr std::array<int, alphabet> char_table = make_char_table(pattern);
+    static constexpr auto offset_table = to_array(make_offset_table(pattern), std::make_index_sequence<pattern.length()>{});
+    static constexpr auto lps_table = to_array(make_lps_table(pattern), std::make_index_sequence<pattern.length()>{});
+    static constexpr std::array<size_t, alphabet> skip_table = []
+    {
+        std::array<size_t, alphabet> table{};
+        std::fill(table.begin(), table.end(), pattern.length());
+        for (size_t i = 0; i + 1 < pattern.length(); ++i)
+            table[static_cast<unsigned char>(pattern[i])] = pattern.length() - 1 - i;
+        return table;
+    }();
+
+    /*@ return occurences of the pattern in @text, same as boyer_moore(text, pattern) */
+    static std::vector<size_t> search(std::string_view text)
+    {
+        if constexpr (pattern.length() <= unroll_limit)
+        {
+            std::vector<size_t> occurence;
+            for (size_t shift = 0; shift + pattern.length() <= text.length(); shift += skip_table[static_cast<unsigned char>(text[shift + pattern.length() - 1])])
+            {
+                if (matches_at(text.data() + shift, std::make_index_sequence<pattern.length()>{}))
+                    occurence.push_back(shift);
+            }
+            return occurence;
+        }
+        else
+            return boyer_moore_with(text, pattern, char_table, offset_table);
+    }
+
+    /*@ return occurences of the pattern in @text using KMP with the compile time lps table */
+    static std::vector<size_t> kmp_search(std::string_view text)
+    {
+        std::vector<size_t> occurence;
+        size_t j = 0;
+        for (size_t i = 0; i < text.length(); ++i)
+        {
+            while (j != 0 && text[i] != pattern[j])
+                j = lps_table[j - 1];
+            if (text[i] == pattern[j] && ++j == pattern.length())
+            {
+                occurence.push_back(i + 1 - j);
+                j = lps_table[j - 1];
+            }
+        }
+        return occurence;
+    }
+};
+
+/*@ Search @pattern in @text with @searcher on multiple threads
+* The text is split into one chunk per thread, and each chunk is extended by (pattern.length() - 1) chars,
+* so that an occurence crossing a chunk boundary is still found by the thread owning its first char.
+* Occurences starting in the extension belong to the next chunk and are dropped, so every offset is reported exactly once,
+* and concatenating the per-chunk results in chunk order keeps them sorted.
+* @ param searcher: any callable (text, pattern) -> sorted std::vector<size_t> of occurences, eg. boyer_moore
+* @ return: same as searcher(text, pattern)
+*/
+template<typename Searcher>
+std::vector<size_t> parallel_search(std::string_view text, std::string_view pattern, Searcher searcher, unsigned thread_count = std::thread::hardware_concurrency())
+{
+    if (pattern.empty() || pattern.length() > text.length())
+        return {};
+    thread_count = std::max(1u, thread_count);
+    const size_t chunk_size = std::max(pattern.length(), (text.length() + thread_count - 1) / thread_count);
+    const size_t chunk_count = (text.length() + chunk_size - 1) / chunk_size;
+
+    std::vector<std::vector<size_t>> results(chunk_count);
+    std::vector<std::thread> threads;
+    threads.reserve(chunk_count);
+    for (size_t i = 0; i < chunk_count; ++i)
+    {
+        threads.emplace_back([&, i]
+        {
+            const size_t begin = i * chunk_size;
+            const size_t end = std::min(text.length(), begin + chunk_size);
+            auto& result = results[i];
+            result = searcher(text.substr(begin, end - begin + pattern.length() - 1), pattern);
+            while (!result.empty() && result.back() >= end - begin)
+                result.pop_back();
+            for (auto& offset : result)
+                offset += begin;
+        });
     }
+    for (auto& thread : threads)
+        thread.join();
+
+    std::vector<size_t> occurence;
+    size_t total = 0;
+    for (auto const& result : results)
+        total += result.size();
+    occurence.reserve(total);
+    for (auto const& result : results)
+        occurence.insert(occurence.end(), result.cbegin(), result.cend());
     return occurence;
 }
 
@@ -156,7 +331,62 @@ void test(std::string_view text, std::string_view pattern)
     std::cout << bad_char_rule(text, "lo", char_table) << '\n';
 }
 
+void benchmark_parallel_search(size_t text_length, std::string_view pattern)
+{
+    std::string text(text_length, '\0');
+    std::mt19937 gen{ std::random_device{}() };
+    std::uniform_int_distribution<int> dist{ 0, 3 };
+    for (auto& c : text)
+        c = "acgt"[dist(gen)];
+
+    auto time = [](auto&& f)
+    {
+        auto start = std::chrono::steady_clock::now();
+        auto result = f();
+        std::cout << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count() << " ms\t";
+        return result;
+    };
+    std::cout << "Searching \"" << pattern << "\" in " << (text_length >> 20) << " MB\n";
+    std::cout << "1 thread: ";
+    auto sequential = time([&] { return boyer_moore(text, pattern); });
+    for (unsigned thread_count = 2; thread_count <= std::max(2u, std::thread::hardware_concurrency()); thread_count *= 2)
+    {
+        std::cout << thread_count << " threads: ";
+        auto parallel = time([&] { return parallel_search(text, pattern, boyer_moore, thread_count); });
+        std::cout << (parallel == sequential ? "OK" : "MISMATCH") << '\n';
+    }
+    std::cout << sequential.size() << " occurences\n";
+}
+
+template<fixed_string Pattern>
+void benchmark_static_searcher(std::string_view text)
+{
+    auto time = [](char const* name, auto&& f)
+    {
+        auto start = std::chrono::steady_clock::now();
+        auto result = f();
+        std::cout << name << ": " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count() << " ms\t";
+        return result;
+    };
+    using searcher = static_searcher<Pattern>;
+    std::cout << "Searching \"" << searcher::pattern << "\" in " << (text.length() >> 20) << " MB\n";
+    auto runtime = time("boyer_moore", [&] { return boyer_moore(text, searcher::pattern); });
+    auto compile_time = time("static_searcher", [&] { return searcher::search(text); });
+    auto compile_time_kmp = time("static_searcher kmp", [&] { return searcher::kmp_search(text); });
+    std::cout << ((runtime == compile_time && runtime == compile_time_kmp) ? "OK" : "MISMATCH") << '\n';
+}
+
 int main()
 {
     test("helloworld", "lo");
+    benchmark_parallel_search(256 << 20, "gattaca");
+
+    std::string text(64 << 20, '\0');
+    std::mt19937 gen{ std::random_device{}() };
+    std::uniform_int_distribution<int> dist{ 0, 3 };
+    for (auto& c : text)
+        c = "acgt"[dist(gen)];
+    benchmark_static_searcher<"gat">(text);
+    benchmark_static_searcher<"gattaca">(text);
+    benchmark_static_searcher<"gattacagattaca">(text);
 }
\ No newline at end of file
@@ -0,0 +1,578 @@
+#include "cstring_cpp.h"
+
+#include <benchmark/benchmark.h>
+#include <string>
+#include <cstring>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <charconv>
+
+static void BM_CString_AppendChar(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        CString str = empty_CString();
+        for (auto i = 0; i < state.range(0); ++i)
+            str.public_->append_char(&str, 'a');
+        benchmark::DoNotOptimize(str.data.impl.ptr);
+        delete_CString(&str);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_StdString_PushBack(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        std::string str;
+        for (auto i = 0; i < state.range(0); ++i)
+            str.push_back('a');
+        benchmark::DoNotOptimize(str.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_CString_AppendChar)->RangeMultiplier(10)->Range(1000, 10'000'000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_StdString_PushBack)->RangeMultiplier(10)->Range(1000, 10'000'000)->Unit(benchmark::kMillisecond);
+
+/*1 MB of text, run with every SIMD level */
+static std::string make_text()
+{
+    std::string text(1 << 20, ' ');
+    for (size_t i = 0; i < text.size(); ++i)
+        text[i] = "abcdefghij klmnopqrstuvwxyz.ABCDEFG"[i * 7919 % 35];
+    return text;
+}
+
+static void BM_CountChar(benchmark::State& state)
+{
+    const auto text = make_text();
+    cstring_set_simd_level(static_cast<CSTRING_SIMD_LEVEL>(state.range(0)));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(cstring_count_char(text.data(), text.size(), 'e'));
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+static void BM_AsciiCase(benchmark::State& state)
+{
+    auto text = make_text();
+    cstring_set_simd_level(static_cast<CSTRING_SIMD_LEVEL>(state.range(0)));
+    for (auto _ : state)
+    {
+        cstring_ascii_case(text.data(), text.size(), true);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+static void BM_FindFirstOf(benchmark::State& state)
+{
+    const auto text = make_text();  //has none of the chars searched, so the whole text is scanned
+    cstring_set_simd_level(static_cast<CSTRING_SIMD_LEVEL>(state.range(0)));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(cstring_find_first_of(text.data(), text.size(), ",;:!?\t\n"));
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+static void BM_StdStringView_FindFirstOf(benchmark::State& state)
+{
+    const auto text = make_text();
+    const std::string_view view{ text };
+    for (auto _ : state)
+        benchmark::DoNotOptimize(view.find_first_of(",;:!?\t\n"));
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+/*A CSV of 16 MB, split into about 2M fields */
+static std::string make_csv()
+{
+    std::string csv;
+    for (int row = 0; csv.size() < (16 << 20); ++row)
+        csv += std::to_string(row) + ",name" + std::to_string(row % 97) + ",3.14,," + std::to_string(row * 31) + "\n";
+    return csv;
+}
+
+static void BM_TokenizeViews(benchmark::State& state)
+{
+    CString csv = new_CString(make_csv().c_str());
+    for (auto _ : state)
+    {
+        CStringTokenizer tokenizer = CString_tokenize(&csv, ",");
+        CStringView token;
+        size_t total = 0;
+        while (CString_next_token(&tokenizer, &token))
+            total += token.length;
+        benchmark::DoNotOptimize(total);
+    }
+    state.SetBytesProcessed(state.iterations() * csv.public_->length(&csv));
+    delete_CString(&csv);
+}
+
+static void BM_SplitByChar(benchmark::State& state)
+{
+    CString csv = new_CString(make_csv().c_str());
+    for (auto _ : state)
+    {
+        int n = 0;
+        CString* tokens = csv.public_->split_by_char(&csv, ',', &n);
+        for (int i = 0; i < n; ++i)
+            delete_CString(&tokens[i]);
+        free(tokens);
+    }
+    state.SetBytesProcessed(state.iterations() * csv.public_->length(&csv));
+    delete_CString(&csv);
+}
+
+/*64 MB file of lines of 0 to 120 chars */
+static const char* make_line_file()
+{
+    static const char* const name = "line_reader_benchmark.txt";
+    static bool written = false;
+    if (!written)
+    {
+        FILE* f = fopen(name, "wb");
+        std::string line;
+        for (size_t size = 0, i = 0; size < (64 << 20); ++i, size += line.size() + 1)
+        {
+            line.assign(i * 7919 % 121, 'a' + i % 26);
+            fputs(line.c_str(), f);
+            fputc('\n', f);
+        }
+        fclose(f);
+        written = true;
+    }
+    return name;
+}
+
+static void BM_LineReaderViews(benchmark::State& state)
+{
+    const char* name = make_line_file();
+    size_t bytes = 0;
+    for (auto _ : state)
+    {
+        CStringLineReader reader = CString_line_reader_from(const_cast<char*>(name));
+        CStringView line;
+        while (CString_read_line_view(&reader, &line))
+            bytes += line.length + 1;
+        CString_close_line_reader(&reader);
+    }
+    state.SetBytesProcessed(bytes);
+}
+
+static void BM_LineToCString(benchmark::State& state)
+{
+    const char* name = make_line_file();
+    size_t bytes = 0;
+    for (auto _ : state)
+    {
+        FILE* f = fopen(name, "rb");
+        while (!feof(f))
+        {
+            CString line = line_to_CString(f);
+            bytes += line.public_->length(&line) + 1;
+            delete_CString(&line);
+        }
+        fclose(f);
+    }
+    state.SetBytesProcessed(bytes);
+}
+
+static void BM_Fgets(benchmark::State& state)
+{
+    const char* name = make_line_file();
+    size_t bytes = 0;
+    char line[256];
+    for (auto _ : state)
+    {
+        FILE* f = fopen(name, "rb");
+        while (fgets(line, sizeof(line), f))
+            bytes += strlen(line);
+        fclose(f);
+    }
+    state.SetBytesProcessed(bytes);
+}
+
+/*1M strings of 0 to 40 chars */
+static std::vector<CString> make_strings()
+{
+    std::vector<CString> strings;
+    for (size_t i = 0; i < 1'000'000; ++i)
+        strings.push_back(new_CString(std::string(i * 7919 % 41, 'a' + i % 26).c_str()));
+    return strings;
+}
+
+static void BM_SerializeEach(benchmark::State& state)
+{
+    auto strings = make_strings();
+    for (auto _ : state)
+    {
+        FILE* f = tmpfile();
+        for (auto& str : strings)
+            str.public_->serialize(&str, f);
+        fclose(f);
+    }
+    state.SetItemsProcessed(state.iterations() * strings.size());
+    for (auto& str : strings)
+        delete_CString(&str);
+}
+
+static void BM_SerializeArray(benchmark::State& state)
+{
+    auto strings = make_strings();
+    for (auto _ : state)
+    {
+        FILE* f = tmpfile();
+        CString_serialize_array(strings.data(), strings.size(), f);
+        fclose(f);
+    }
+    state.SetItemsProcessed(state.iterations() * strings.size());
+    for (auto& str : strings)
+        delete_CString(&str);
+}
+
+static void BM_DeserializeArray(benchmark::State& state)
+{
+    auto strings = make_strings();
+    FILE* f = tmpfile();
+    CString_serialize_array(strings.data(), strings.size(), f);
+    for (auto _ : state)
+    {
+        rewind(f);
+        size_t count;
+        CString* read = CString_deserialize_array(f, &count);
+        for (size_t i = 0; i < count; ++i)
+            delete_CString(&read[i]);
+        free(read);
+    }
+    fclose(f);
+    state.SetItemsProcessed(state.iterations() * strings.size());
+    for (auto& str : strings)
+        delete_CString(&str);
+}
+
+static void BM_MapArray(benchmark::State& state)
+{
+    auto strings = make_strings();
+    const char* name = "map_array_benchmark.bin";
+    FILE* f = fopen(name, "wb");
+    CString_serialize_array(strings.data(), strings.size(), f);
+    fclose(f);
+    for (auto _ : state)
+    {
+        CStringMappedArray mapped;
+        CString_map_array(const_cast<char*>(name), &mapped);
+        benchmark::DoNotOptimize(mapped.views);
+        CString_unmap_array(&mapped);
+    }
+    remove(name);
+    state.SetItemsProcessed(state.iterations() * strings.size());
+    for (auto& str : strings)
+        delete_CString(&str);
+}
+
+/*1M words drawn from a vocabulary of 10k, like the tokens of a text */
+static std::vector<CString> make_words()
+{
+    std::vector<CString> words;
+    for (size_t i = 0; i < 1'000'000; ++i)
+    {
+        const size_t word = i * 7919 % 10'000;
+        words.push_back(new_CString(("word_" + std::to_string(word) + std::string(word % 40, 'x')).c_str()));
+    }
+    return words;
+}
+
+static void BM_Intern(benchmark::State& state)
+{
+    auto words = make_words();
+    CStringInternStats stats{};
+    for (auto _ : state)
+    {
+        CStringInternPool pool = CString_intern_pool();
+        for (auto& word : words)
+            benchmark::DoNotOptimize(CString_intern(&pool, &word));
+        stats = CString_intern_stats(&pool);
+        CString_delete_intern_pool(&pool);
+    }
+    size_t separate_bytes = 0;  //what the CStrings themselves take
+    for (auto& word : words)
+        separate_bytes += sizeof(CString) + (word.is_small ? 0 : word.data.impl.capacity);
+    state.counters["separate_MB"] = separate_bytes / 1e6;
+    state.counters["interned_MB"] = (stats.bytes_allocated + words.size() * sizeof(CStringHandle)) / 1e6;
+    state.counters["unique"] = static_cast<double>(stats.unique_strings);
+    state.SetItemsProcessed(state.iterations() * words.size());
+    for (auto& word : words)
+        delete_CString(&word);
+}
+
+/*Count the occurrences of one word, by comparing the text or the handles */
+static void BM_CompareText(benchmark::State& state)
+{
+    auto words = make_words();
+    for (auto _ : state)
+    {
+        size_t count = 0;
+        for (auto& word : words)
+            count += word.public_->is_equal(&word, &words[0]);
+        benchmark::DoNotOptimize(count);
+    }
+    state.SetItemsProcessed(state.iterations() * words.size());
+    for (auto& word : words)
+        delete_CString(&word);
+}
+
+static void BM_CompareHandles(benchmark::State& state)
+{
+    auto words = make_words();
+    CStringInternPool pool = CString_intern_pool();
+    std::vector<CStringHandle> handles;
+    for (auto& word : words)
+        handles.push_back(CString_intern(&pool, &word));
+    for (auto _ : state)
+    {
+        size_t count = 0;
+        for (auto handle : handles)
+            count += handle == handles[0];
+        benchmark::DoNotOptimize(count);
+    }
+    CString_delete_intern_pool(&pool);
+    state.SetItemsProcessed(state.iterations() * words.size());
+    for (auto& word : words)
+        delete_CString(&word);
+}
+
+/*10k edits at random positions of an 8 MB text: typing a few chars, deleting a few chars or replacing a word */
+template<typename Insert, typename Erase>
+static void edit(size_t& size, Insert insert, Erase erase)
+{
+    size_t seed = 1;
+    for (int i = 0; i < 10'000; ++i)
+    {
+        seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+        const size_t pos = (seed >> 20) % size;
+        switch ((seed >> 8) % 3)
+        {
+        case 0:
+            insert(pos, "hello", 5);
+            size += 5;
+            break;
+        case 1:
+            erase(pos, 3);
+            size -= std::min<size_t>(3, size - pos);
+            break;
+        default:
+            erase(pos, 4);
+            size -= std::min<size_t>(4, size - pos);
+            insert(pos, "word", 4);
+            size += 4;
+        }
+    }
+}
+
+static void BM_EditFlatBuffer(benchmark::State& state)
+{
+    const auto text = make_text();
+    std::string big;
+    for (int i = 0; i < 8; ++i)
+        big += text;
+    for (auto _ : state)
+    {
+        auto flat = big;
+        size_t size = flat.size();
+        edit(size, [&](size_t pos, const char* s, size_t n) { flat.insert(pos, s, n); }, [&](size_t pos, size_t n) { flat.erase(pos, n); });
+        benchmark::DoNotOptimize(flat.data());
+    }
+    state.SetItemsProcessed(state.iterations() * 10'000);
+}
+
+static void BM_EditPieceTable(benchmark::State& state)
+{
+    const auto text = make_text();
+    std::string big;
+    for (int i = 0; i < 8; ++i)
+        big += text;
+    CString original = new_CString(big.c_str());
+    for (auto _ : state)
+    {
+        CStringPieceTable table = CString_piece_table(&original);
+        size_t size = big.size();
+        edit(size, [&](size_t pos, const char* s, size_t n) { CString_piece_table_insert(&table, pos, s, n); }, [&](size_t pos, size_t n) { CString_piece_table_erase(&table, pos, n); });
+        if (state.range(0))     //flatten once at the end
+        {
+            CString flat = CString_piece_table_to_CString(&table);
+            delete_CString(&flat);
+        }
+        CString_delete_piece_table(&table);
+    }
+    delete_CString(&original);
+    state.SetItemsProcessed(state.iterations() * 10'000);
+}
+
+/*10^7 numbers formatted into one string, and into a preallocated buffer for snprintf and std::to_chars */
+constexpr size_t format_count = 10'000'000;
+
+static std::vector<int64_t> make_ints()
+{
+    std::vector<int64_t> numbers(format_count);
+    uint64_t seed = 42;
+    for (auto& number : numbers)
+    {
+        seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+        number = static_cast<int64_t>(seed) >> (seed % 60);   //all lengths of digits
+    }
+    return numbers;
+}
+
+static std::vector<double> make_doubles()
+{
+    std::vector<double> numbers(format_count);
+    uint64_t seed = 42;
+    for (auto& number : numbers)
+    {
+        seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+        number = static_cast<double>(seed >> 11) / (1ull << 53) * 1e6 - 5e5;
+    }
+    return numbers;
+}
+
+static void BM_AppendInt(benchmark::State& state)
+{
+    const auto numbers = make_ints();
+    for (auto _ : state)
+    {
+        CString str = empty_CString();
+        for (auto number : numbers)
+            str.public_->append_int(&str, number);
+        benchmark::DoNotOptimize(str.data.impl.ptr);
+        delete_CString(&str);
+    }
+    state.SetItemsProcessed(state.iterations() * numbers.size());
+}
+
+static void BM_SnprintfInt(benchmark::State& state)
+{
+    const auto numbers = make_ints();
+    std::vector<char> buffer(numbers.size() * (CString_max_int_chars + 1));
+    for (auto _ : state)
+    {
+        char* out = buffer.data();
+        for (auto number : numbers)
+            out += snprintf(out, CString_max_int_chars + 1, "%lld", static_cast<long long>(number));
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetItemsProcessed(state.iterations() * numbers.size());
+}
+
+static void BM_ToCharsInt(benchmark::State& state)
+{
+    const auto numbers = make_ints();
+    std::vector<char> buffer(numbers.size() * CString_max_int_chars);
+    for (auto _ : state)
+    {
+        char* out = buffer.data();
+        for (auto number : numbers)
+            out = std::to_chars(out, out + CString_max_int_chars, number).ptr;
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetItemsProcessed(state.iterations() * numbers.size());
+}
+
+static void BM_AppendDouble(benchmark::State& state)
+{
+    const auto numbers = make_doubles();
+    for (auto _ : state)
+    {
+        CString str = empty_CString();
+        for (auto number : numbers)
+            str.public_->append_double(&str, number);
+        benchmark::DoNotOptimize(str.data.impl.ptr);
+        delete_CString(&str);
+    }
+    state.SetItemsProcessed(state.iterations() * numbers.size());
+}
+
+static void BM_SnprintfDouble(benchmark::State& state)
+{
+    const auto numbers = make_doubles();
+    std::vector<char> buffer(numbers.size() * CString_max_double_chars);
+    for (auto _ : state)
+    {
+        char* out = buffer.data();
+        for (auto number : numbers)
+            out += snprintf(out, CString_max_double_chars, "%.17g", number);
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetItemsProcessed(state.iterations() * numbers.size());
+}
+
+static void BM_ToCharsDouble(benchmark::State& state)
+{
+    const auto numbers = make_doubles();
+    std::vector<char> buffer(numbers.size() * CString_max_double_chars);
+    for (auto _ : state)
+    {
+        char* out = buffer.data();
+        for (auto number : numbers)
+            out = std::to_chars(out, out + CString_max_double_chars, number).ptr;
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetItemsProcessed(state.iterations() * numbers.size());
+}
+
+static void BM_AppendFloat(benchmark::State& state)
+{
+    const auto numbers = make_doubles();
+    for (auto _ : state)
+    {
+        CString str = empty_CString();
+        for (auto number : numbers)
+            str.public_->append_float(&str, number, 3);
+        benchmark::DoNotOptimize(str.data.impl.ptr);
+        delete_CString(&str);
+    }
+    state.SetItemsProcessed(state.iterations() * numbers.size());
+}
+
+static void BM_SnprintfFixed(benchmark::State& state)
+{
+    const auto numbers = make_doubles();
+    std::vector<char> buffer(numbers.size() * CString_max_double_chars);
+    for (auto _ : state)
+    {
+        char* out = buffer.data();
+        for (auto number : numbers)
+            out += snprintf(out, CString_max_double_chars, "%.3f", number);
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetItemsProcessed(state.iterations() * numbers.size());
+}
+
+BENCHMARK(BM_AppendInt)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SnprintfInt)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ToCharsInt)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_AppendDouble)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SnprintfDouble)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ToCharsDouble)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_AppendFloat)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SnprintfFixed)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_EditFlatBuffer)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_EditPieceTable)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Intern)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_CompareText)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_CompareHandles)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SerializeEach)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SerializeArray)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_DeserializeArray)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_MapArray)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LineReaderViews)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LineToCString)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Fgets)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_TokenizeViews)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SplitByChar)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_CountChar)->DenseRange(CString_simd_scalar, CString_simd_avx2);
+BENCHMARK(BM_AsciiCase)->DenseRange(CString_simd_scalar, CString_simd_avx2);
+BENCHMARK(BM_FindFirstOf)->DenseRange(CString_simd_scalar, CString_simd_avx2);
+BENCHMARK(BM_StdStringView_FindFirstOf);
+
+BENCHMARK_MAIN();
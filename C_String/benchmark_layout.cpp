@@ -0,0 +1,113 @@
+/* Description: Footprint and per-call cost of the vtable pointer in CString.
+* Built twice: CStringLayoutBenchmark with the vtable, CStringLayoutBenchmarkNoVtable with -DCSTRING_NO_VTABLE
+*/
+#include "cstring_cpp.h"
+
+#include <benchmark/benchmark.h>
+#include <vector>
+
+constexpr size_t string_count = 4'000'000;
+
+static std::vector<CString> make_strings()
+{
+    std::vector<CString> strings;
+    strings.reserve(string_count);
+    for (size_t i = 0; i < string_count; ++i)
+    {
+        strings.push_back(empty_CString());
+        CString_append_int(&strings.back(), static_cast<int64_t>(i));
+    }
+    return strings;
+}
+
+static void delete_strings(std::vector<CString>& strings)
+{
+    for (auto& str : strings)
+        delete_CString(&str);
+}
+
+static void BM_Construct(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        auto strings = make_strings();
+        benchmark::DoNotOptimize(strings.data());
+        state.PauseTiming();
+        delete_strings(strings);
+        state.ResumeTiming();
+    }
+    state.counters["bytes_per_string"] = sizeof(CString);
+    state.counters["array_MB"] = sizeof(CString) * string_count / 1e6;
+    state.SetItemsProcessed(state.iterations() * string_count);
+}
+
+static void BM_LengthDirect(benchmark::State& state)
+{
+    auto strings = make_strings();
+    for (auto _ : state)
+    {
+        size_t total = 0;
+        for (auto& str : strings)
+            total += CString_length(&str);
+        benchmark::DoNotOptimize(total);
+    }
+    state.SetItemsProcessed(state.iterations() * string_count);
+    delete_strings(strings);
+}
+
+static void BM_AppendCharDirect(benchmark::State& state)
+{
+    auto strings = make_strings();
+    for (auto _ : state)
+    {
+        for (auto& str : strings)
+            CString_append_char(&str, 'a');
+        state.PauseTiming();
+        for (auto& str : strings)
+            CString_resize(&str, CString_length(&str) - 1);
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * string_count);
+    delete_strings(strings);
+}
+
+#ifndef CSTRING_NO_VTABLE
+static void BM_LengthVtable(benchmark::State& state)
+{
+    auto strings = make_strings();
+    for (auto _ : state)
+    {
+        size_t total = 0;
+        for (auto& str : strings)
+            total += str.public_->length(&str);
+        benchmark::DoNotOptimize(total);
+    }
+    state.SetItemsProcessed(state.iterations() * string_count);
+    delete_strings(strings);
+}
+
+static void BM_AppendCharVtable(benchmark::State& state)
+{
+    auto strings = make_strings();
+    for (auto _ : state)
+    {
+        for (auto& str : strings)
+            str.public_->append_char(&str, 'a');
+        state.PauseTiming();
+        for (auto& str : strings)
+            str.public_->resize(&str, str.public_->length(&str) - 1);
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * string_count);
+    delete_strings(strings);
+}
+
+BENCHMARK(BM_LengthVtable);
+BENCHMARK(BM_AppendCharVtable);
+#endif
+
+BENCHMARK(BM_Construct)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LengthDirect);
+BENCHMARK(BM_AppendCharDirect);
+
+BENCHMARK_MAIN();
@@ -1,7 +1,22 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200112L     //for mmap(), but not the POSIX 2008 getline() clashing with ours
+#endif
 #include "cstring.h"
+#include "cstring_simd.h"
+#include "cstring_format.h"
 #include <string.h>
 #include <stdlib.h>
 #include <math.h>
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#define CSTRING_HAS_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 #define SMALL_STRING_LENGTH SMALL_STRING-1
 
 #define THROW_EXCEPTION(X) fprintf(stderr, (X))
@@ -11,10 +26,14 @@
 #define THROW_INVALID_ARGUMENT_PTR_EXCEPTION THROW_EXCEPTION("Exception: Argument CString pointer is invalid!\n")
 #define THROW_INVALID_LONG_STR_EXCEPTION THROW_EXCEPTION("Exception: Long CString is invalid!\n")
 
-CString_public global_vtable;
+#ifdef CSTRING_NO_VTABLE
+#define SET_VTABLE(str) ((void)(str))
+#else
+CString_public global_vtable;   //initialized at the end of the file
+#define SET_VTABLE(str) ((str)->public = &global_vtable)
+#endif
 
-static bool global_vtable_init = false;
-static void init_global_vtable();
+static void append_char(CString* dest, char c);
 
 static char* get_data(CString* str)
 {
@@ -25,68 +44,199 @@ static char* get_data(CString* str)
 }
 
 /**
- * @brief: Internal function, get the pointer pointing to the end ('\0') of the string
+ * @brief: Internal function, set the length (excluding '\0') and put the terminator
+ * @param new_length: must fit in the current capacity
  */
-static char* get_end(CString* str)
+static void set_length(CString* str, size_t new_length)
 {
-    if (str)
+    if (str->is_small)
     {
-        if (str->is_small)
-        {
-            char const* start = get_data(str);
-            char const* pos = start;
-            while (*pos != '\0' && pos - start <= SMALL_STRING)
-                ++pos;
-            return pos;
-        }
-        return &str->data.impl.ptr[str->data.impl.length - 1];
+        str->small_length = (unsigned char)new_length;
+        str->data.small_string[new_length] = '\0';
+    }
+    else
+    {
+        str->data.impl.length = new_length + 1;
+        str->data.impl.ptr[new_length] = '\0';
     }
-    THROW_NULL_PARAM_EXCEPTION;
-    return NULL;
 }
 
-/*
- * */
-static CString_public* get_vtable()
-{
-    if (!global_vtable_init)
-        init_global_vtable();
-    return &global_vtable;
-}
 
 static size_t length(CString* str)
 {
     if (str)
     {
         if (str->is_small)
-            return strlen(str->data.small_string);
+            return str->small_length;
         return str->data.impl.length - 1;
     }
     THROW_NULL_PARAM_EXCEPTION;
     return 0;
 }
 
+/**
+ * @brief: Internal function, make sure [str] can hold [bytes] bytes (including '\0')
+ * The heap buffer grows by 1.5x, so that appending one char at a time is amortized O(1).
+ * A moved string does not own its buffer, so it is copied to a new one instead of realloc'ed
+ * @return: false if the allocation failed, and [str] is unchanged
+ */
+static bool grow(CString* str, size_t bytes)
+{
+    if (str->is_small)
+    {
+        if (bytes <= SMALL_STRING)
+            return true;
+        const size_t capacity = bytes > 2 * SMALL_STRING ? bytes : 2 * SMALL_STRING;
+        char* ptr = malloc(capacity);
+        if (ptr == NULL)
+            return false;
+        const size_t small_length = str->small_length;
+        memcpy(ptr, str->data.small_string, small_length + 1);
+        str->is_small = false;
+        str->data.impl.ptr = ptr;
+        str->data.impl.length = small_length + 1;
+        str->data.impl.capacity = capacity;
+        return true;
+    }
+    if (str->data.impl.capacity >= bytes && !str->is_moved)
+        return true;
+    size_t capacity = str->data.impl.capacity + str->data.impl.capacity / 2;
+    if (capacity < bytes)
+        capacity = bytes;
+    char* ptr;
+    if (str->is_moved)
+    {
+        ptr = malloc(capacity);
+        if (ptr)
+            memcpy(ptr, str->data.impl.ptr, str->data.impl.length);
+    }
+    else
+        ptr = realloc(str->data.impl.ptr, capacity);
+    if (ptr == NULL)
+        return false;
+    str->data.impl.ptr = ptr;
+    str->data.impl.capacity = capacity;
+    str->is_moved = false;
+    return true;
+}
+
+/*Serialization helpers*/
+
+/*LEB128: 7 bits per byte, lowest first, the high bit is set on every byte but the last */
+static size_t put_varint(unsigned char* out, uint64_t value)
+{
+    size_t size = 0;
+    while (value >= 0x80)
+    {
+        out[size++] = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    out[size++] = (unsigned char)value;
+    return size;
+}
+
+static size_t varint_size(uint64_t value)
+{
+    size_t size = 1;
+    while (value >= 0x80)
+    {
+        value >>= 7;
+        ++size;
+    }
+    return size;
+}
+
+static bool parse_varint(const unsigned char** current, const unsigned char* end, uint64_t* value)
+{
+    *value = 0;
+    for (unsigned shift = 0; shift < 64 && *current != end; shift += 7)
+    {
+        const unsigned char byte = *(*current)++;
+        *value |= (uint64_t)(byte & 0x7F) << shift;
+        if (byte < 0x80)
+            return true;
+    }
+    return false;
+}
+
+static bool read_varint(FILE* f, uint64_t* value)
+{
+    *value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7)
+    {
+        const int byte = getc(f);
+        if (byte == EOF)
+            return false;
+        *value |= (uint64_t)(byte & 0x7F) << shift;
+        if (byte < 0x80)
+            return true;
+    }
+    return false;
+}
+
+static void put_u32(unsigned char* out, uint32_t value)     //little endian
+{
+    for (int i = 0; i < 4; ++i)
+        out[i] = (unsigned char)(value >> (8 * i));
+}
+
+static uint32_t get_u32(const unsigned char* in)
+{
+    return (uint32_t)in[0] | (uint32_t)in[1] << 8 | (uint32_t)in[2] << 16 | (uint32_t)in[3] << 24;
+}
+
+/*The sums only need the modulo every 5552 bytes before they can overflow */
+static uint32_t adler32(const unsigned char* data, size_t size)
+{
+    uint32_t a = 1, b = 0;
+    while (size)
+    {
+        size_t block = size < 5552 ? size : 5552;
+        size -= block;
+        while (block--)
+        {
+            a += *data++;
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    return b << 16 | a;
+}
+
+/*@return: false if the record is truncated */
+static bool next_record(const unsigned char** current, const unsigned char* end, CStringView* view)
+{
+    uint64_t size;
+    if (!parse_varint(current, end, &size) || size > (uint64_t)(end - *current))
+        return false;
+    view->ptr = (const char*)*current;
+    view->length = (size_t)size;
+    *current += size;
+    return true;
+}
+
 /*Constructor*/
 
 /**@brief: internal function
  * @param length: must be a valid value
  */
-static void copy_data(CString* temp, const char* src, int length)
+static void copy_data(CString* temp, const char* src, size_t length)
 {
     if (length <= SMALL_STRING_LENGTH)
     {
         temp->is_small = true;
-        strcpy_s(temp->data.small_string, length + 1, src);
+        memcpy(temp->data.small_string, src, length);
     }
     else
     {
         temp->is_small = false;
         temp->data.impl.capacity = length + 1;
-        temp->data.impl.length = length + 1;
         temp->data.impl.ptr = malloc(length + 1);
-        strcpy_s(temp->data.impl.ptr, length + 1, src);
+        memcpy(temp->data.impl.ptr, src, length);
     }
-    temp->public = &global_vtable;
+    set_length(temp, length);
+    SET_VTABLE(temp);
 }
 
 CString new_CString(const char* data)
@@ -98,12 +248,10 @@ CString new_CString(const char* data)
     }
     else
     {
-        temp.data.small_string[0] = '\0';
         temp.is_small = true;
+        set_length(&temp, 0);
     }
-    if (!global_vtable_init)
-        init_global_vtable();
-    temp.public = &global_vtable;
+    SET_VTABLE(&temp);
     temp.is_moved = false;
     return temp;
 }
@@ -120,7 +268,7 @@ CString move_to_CString(char* data)
     temp.data.impl.ptr = data;
     temp.data.impl.length = strlen(data) + 1;
     temp.data.impl.capacity = temp.data.impl.length;
-    temp.public = &global_vtable;
+    SET_VTABLE(&temp);
     temp.is_moved = true;
     return temp;
 }
@@ -159,6 +307,7 @@ void delete_CString(CString* str)
             str->data.impl.capacity = 0;
             str->data.impl.length = 0;
             str->is_small = true;
+            set_length(str, 0);
         }
         else    //not small string, but data is NULL
             THROW_NULL_PTR_EXCEPTION;
@@ -168,79 +317,176 @@ void delete_CString(CString* str)
 /*Deserialize*/
 CString CString_deserialize(FILE* f)
 {
-    if (f != NULL)
+    CString temp = empty_CString();
+    uint64_t size;
+    if (f == NULL || !read_varint(f, &size) || size >= SIZE_MAX)    //size + 1 must not wrap around
     {
-        CString temp;
-        temp.is_moved = false;
-        if (fread(&temp, sizeof(temp), 1, f) != 1)
-            THROW_FILE_IO_EXCEPTION;
-        if (global_vtable_init == false)
-            init_global_vtable();
-        temp.public = &global_vtable;
-        if (!temp.is_small)
-        {
-            const size_t capacity = temp.data.impl.capacity;
-            temp.data.impl.ptr = malloc(capacity);
-            fread(temp.data.impl.ptr, 1, temp.data.impl.capacity, f);
-        }
+        THROW_FILE_IO_EXCEPTION;
         return temp;
     }
-    THROW_FILE_IO_EXCEPTION;
-    return empty_CString();
+    if (!grow(&temp, (size_t)size + 1))
+        return temp;
+    if (fread(get_data(&temp), 1, size, f) != size)
+    {
+        THROW_FILE_IO_EXCEPTION;
+        size = 0;
+    }
+    set_length(&temp, size);
+    return temp;
 }
 
 CString CString_deserialize_from(char* fileName)
 {
     if (fileName)
-        return CString_deserialize(fopen(fileName, "rb"));
+    {
+        FILE* f = fopen(fileName, "rb");
+        CString temp = CString_deserialize(f);
+        if (f)
+            fclose(f);
+        return temp;
+    }
     THROW_FILE_IO_EXCEPTION;
     return empty_CString();
 }
 
+/*Reads up to the next '\n' and leaves [f] open, so a file can be read line by line */
 CString line_to_CString(FILE* f)
 {
+    CString temp = empty_CString();
     if (f != NULL)
     {
-        long pos = ftell(f);
-        size_t count = 0;
-        while (fgetc(f) != '\n')
-            ++count;
-        fseek(f, pos, SEEK_SET);
-        CString temp;
-        temp.is_moved = false;
-        if (count <= SMALL_STRING_LENGTH)
-        {
-            temp.is_small = true;
-            fread(temp.data.small_string, 1, count, f);
-            temp.data.small_string[count] = '\0';
-        }
-        else
-        {
-            temp.is_small = false;
-            temp.data.impl.capacity = count + 1;
-            temp.data.impl.length = count + 1;
-            temp.data.impl.ptr = malloc(count + 1);
-            fread(temp.data.impl.ptr, 1, count, f);
-            temp.data.impl.ptr[count] = '\0';
-        }
-        if (!global_vtable_init)
-            init_global_vtable();
-        temp.public = &global_vtable;
-        fclose(f);
-        return temp;
+        int c;
+        while ((c = getc(f)) != EOF && c != '\n')
+            append_char(&temp, (char)c);
     }
-    fclose(f);
-    return new_CString(NULL);
+    else
+        THROW_FILE_IO_EXCEPTION;
+    return temp;
 }
 
 CString line_to_CString_from(char* fileName)
 {
     if (fileName)
-        return line_to_CString(fopen(fileName, "r"));
+    {
+        FILE* f = fopen(fileName, "r");
+        CString temp = line_to_CString(f);
+        if (f)
+            fclose(f);
+        return temp;
+    }
     THROW_FILE_IO_EXCEPTION;
     return empty_CString();
 }
 
+/*Line reader*/
+CStringLineReader CString_line_reader(FILE* f, size_t buffer_size)
+{
+    CStringLineReader reader = { .file = f, .owns_file = false };
+    if (f == NULL)
+    {
+        THROW_FILE_IO_EXCEPTION;
+        reader.eof = true;
+        return reader;
+    }
+    reader.capacity = buffer_size < 16 ? 16 : buffer_size;
+    reader.buffer = malloc(reader.capacity);
+    reader.eof = reader.buffer == NULL;
+    return reader;
+}
+
+CStringLineReader CString_line_reader_from(char* fileName)
+{
+    /*binary mode, so the buffer holds exactly the bytes of the file. "\r\n" is handled when returning a line */
+    CStringLineReader reader = CString_line_reader(fileName ? fopen(fileName, "rb") : NULL, CString_line_reader_buffer);
+    reader.owns_file = reader.file != NULL;
+    return reader;
+}
+
+/**@brief: Internal function, read more of the file into the buffer
+ * The unread bytes are moved to the front first, and the buffer grows only when a single line does not fit
+ */
+static bool refill(CStringLineReader* reader)
+{
+    if (reader->begin != 0)
+    {
+        memmove(reader->buffer, reader->buffer + reader->begin, reader->end - reader->begin);
+        reader->end -= reader->begin;
+        reader->begin = 0;
+    }
+    if (reader->end == reader->capacity)
+    {
+        const size_t new_capacity = reader->capacity * 2;
+        char* new_buffer = realloc(reader->buffer, new_capacity);
+        if (new_buffer == NULL)
+            return false;
+        reader->buffer = new_buffer;
+        reader->capacity = new_capacity;
+    }
+    const size_t read = fread(reader->buffer + reader->end, 1, reader->capacity - reader->end, reader->file);
+    reader->end += read;
+    if (read == 0)
+    {
+        if (ferror(reader->file))
+            THROW_FILE_IO_EXCEPTION;
+        reader->eof = true;
+    }
+    return read != 0;
+}
+
+bool CString_read_line_view(CStringLineReader* reader, CStringView* line)
+{
+    if (reader == NULL || reader->buffer == NULL)
+        return false;
+    size_t searched = 0;    //bytes after begin known to have no '\n'
+    for (;;)
+    {
+        const char* start = reader->buffer + reader->begin;
+        const char* newline = memchr(start + searched, '\n', reader->end - reader->begin - searched);
+        if (newline != NULL)
+        {
+            line->ptr = start;
+            line->length = newline - start;
+            reader->begin += line->length + 1;
+            break;
+        }
+        searched = reader->end - reader->begin;
+        if (reader->eof || !refill(reader))
+        {
+            if (searched == 0)
+                return false;
+            line->ptr = reader->buffer + reader->begin;     //the last line has no '\n'
+            line->length = searched;
+            reader->begin = reader->end;
+            break;
+        }
+    }
+    if (line->length != 0 && line->ptr[line->length - 1] == '\r')
+        --line->length;
+    return true;
+}
+
+bool CString_read_line(CStringLineReader* reader, CString* line)
+{
+    CStringView view;
+    if (!CString_read_line_view(reader, &view))
+        return false;
+    *line = CString_from_view(view);
+    return true;
+}
+
+void CString_close_line_reader(CStringLineReader* reader)
+{
+    if (reader != NULL)
+    {
+        free(reader->buffer);
+        if (reader->owns_file)
+            fclose(reader->file);
+        reader->buffer = NULL;
+        reader->file = NULL;
+        reader->eof = true;
+    }
+}
+
 
 
 // static void assign_string(CString* str, char* data)
@@ -317,25 +563,6 @@ static void swap_cstring(CString* l, CString* r)
         THROW_NULL_PARAM_EXCEPTION;
 }
 
-static bool empty(CString* str)
-{
-    if (str != NULL)
-    {
-        if (str->is_small)
-            return str->data.small_string[0] == '\0';
-        if (str->data.impl.ptr != NULL)
-        {
-            if (str->data.impl.length == 0 && str->data.impl.ptr[0] == '\0')
-                return true;
-        }
-        //str is not small, but nullptr
-        THROW_INVALID_LONG_STR_EXCEPTION;
-        return false;
-    }
-    THROW_INVALID_ARGUMENT_PTR_EXCEPTION;
-    return false;
-}
-
 
 
 size_t bytes(CString* str)
@@ -372,17 +599,34 @@ static CString substr(CString* str, size_t pos)
     }
 }
 
+/**
+ * @param newSize: new capacity in bytes, including '\0'. The string is truncated if it does not fit
+ */
 static void resize(CString* str, size_t newSize)
 {
     if (str != NULL)
     {
+        if (newSize == 0)
+            newSize = 1;
+        const size_t old_length = length(str);
+        const size_t new_length = old_length < newSize ? old_length : newSize - 1;
         if (newSize <= SMALL_STRING)
         {
-            if (str->is_small)
+            if (!str->is_small)
+            {
+                //long string -> small string
+                char* ptr = str->data.impl.ptr;
+                memcpy(str->data.small_string, ptr, new_length);
+                if (!str->is_moved)
+                    free(ptr);
+                str->is_small = true;
+                str->is_moved = false;
+            }
+        }
+        else if (str->is_small || str->is_moved)
+        {
+            if (!grow(str, newSize))
                 return;
-            //long string -> small string
-            strcpy_s(str->data.small_string, SMALL_STRING_LENGTH, str->data.impl.ptr);
-            str->is_small = true;
         }
         else   //long string -> long string
         {
@@ -391,10 +635,13 @@ static void resize(CString* str, size_t newSize)
                 THROW_NULL_PTR_EXCEPTION;
                 return;
             }
-            str->data.impl.ptr = realloc(str->data.impl.ptr, newSize);
-            str->data.impl.length = strlen(str->data.impl.ptr) + 1;
+            char* ptr = realloc(str->data.impl.ptr, newSize);
+            if (ptr == NULL)
+                return;
+            str->data.impl.ptr = ptr;
             str->data.impl.capacity = newSize;
         }
+        set_length(str, new_length);
     }
     else
         THROW_INVALID_ARGUMENT_PTR_EXCEPTION;
@@ -405,33 +652,7 @@ static void resize(CString* str, size_t newSize)
 static void toggle_letter(CString* str, bool upper)
 {
     if (str != NULL)
-    {
-        char* start, * end;
-        if (str->is_small)
-        {
-            start = str->data.small_string;
-            end = str->data.small_string + SMALL_STRING;
-        }
-        else
-        {
-            start = str->data.impl.ptr;
-            end = str->data.impl.ptr + str->data.impl.length;
-        }
-        while (start != end)
-        {
-            if (upper)
-            {
-                if (*start <= 'z' && *start >= 'a')
-                    *start -= ('a' - 'A');
-            }
-            else
-            {
-                if (*start <= 'Z' && *start >= 'A')
-                    *start += ('a' - 'A');
-            }
-            ++start;
-        }
-    }
+        cstring_ascii_case(get_data(str), length(str), upper);
 }
 
 static void to_upper(CString* str)
@@ -448,76 +669,46 @@ static void to_lower(CString* str)
 static bool reserve_bytes(CString* str, size_t bytes)
 {
     if (str != NULL)
-    {
-        if (bytes >= SMALL_STRING)
-        {
-            str->is_small = false;
-            if (str->is_small)
-            {
-                char temp[SMALL_STRING];
-                memcpy(temp, str->data.small_string, SMALL_STRING);
-                str->is_small = false;
-                str->data.impl.ptr = malloc(bytes);
-                if (str->data.impl.ptr) //malloc success
-                {
-                    str->data.impl.capacity = bytes;
-                    strcpy(str->data.impl.ptr, temp);
-                    return true;
-                }
-                return false;
-            }
-            else
-            {
-                if (str->data.impl.capacity >= bytes)
-                    return true;
-                str->data.impl.ptr = realloc(str->data.impl.ptr, bytes);
-                if (str->data.impl.ptr)
-                {
-                    str->data.impl.capacity = bytes;
-                    return true;
-                }
-                return false;
-            }
-        }
-        return true;
-    }
+        return grow(str, bytes);
     THROW_NULL_PARAM_EXCEPTION;
     return false;
 }
 
-/**
- * @brief: Internal function
- * @param dest
- * @param size
- */
-static void expand(CString* dest, int size)
+static bool reserve_length(CString* str, size_t length)
 {
-    if (dest->is_small && length(dest) + size <= SMALL_STRING)
-        return;
-    dest->data.impl.ptr = realloc(dest->data.impl.ptr, dest->data.impl.length + size);
-    dest->data.impl.capacity += size;
+    return reserve_bytes(str, length + 1);
 }
 
 static void append_char(CString* dest, char c)
 {
     if (dest && c != '\0')
     {
-        resize(dest, length(dest) + 2);
-        char* previous_end = get_end(dest);
-        *previous_end = c;
-        ++dest->data.impl.length;
-        *(previous_end + 1) = '\0';
+        const size_t old_length = length(dest);
+        if (!grow(dest, old_length + 2))
+            return;
+        get_data(dest)[old_length] = c;
+        set_length(dest, old_length + 1);
+    }
+}
+
+static void append_view(CString* dest, CStringView src)
+{
+    if (dest && (src.ptr || src.length == 0))
+    {
+        const size_t old_length = length(dest);
+        if (src.length == 0 || !grow(dest, old_length + src.length + 1))
+            return;
+        memcpy(get_data(dest) + old_length, src.ptr, src.length);
+        set_length(dest, old_length + src.length);
     }
 }
 
 static void append_string(CString* dest, char* src)
 {
-    const int to_append_length = strlen(src);
-    if (dest && src && strlen(src) != 0)
+    if (dest && src)
     {
-        expand(dest, to_append_length);
-        strcpy(get_data(dest), src);
-        dest->data.impl.length += to_append_length;
+        CStringView view = { .ptr = src, .length = strlen(src) };
+        append_view(dest, view);
     }
 }
 
@@ -559,40 +750,98 @@ static void reverse_range(CString* str, size_t start, size_t end)
     THROW_INVALID_ARGUMENT_PTR_EXCEPTION;
 }
 
+/*The digits are written straight into the buffer, after reserving their exact length */
 static void append_int(CString* dest, int64_t num)
 {
     if (dest)
     {
-        //        char digits = 0;
-        //        int64_t temp = num;
-        //        while (temp /= 10)
-        //            ++digits;
-                //char buffer[digits + 1 + (num >= 0 ? 0 : 1)];    //VLA warning!
-        char buffer[25];    //ENOUGH for any integer
-        sprintf(buffer, "%lld", num);
-        append_string(dest, buffer);
+        const uint64_t magnitude = num < 0 ? 0 - (uint64_t)num : (uint64_t)num;
+        const size_t chars = cstring_decimal_digits(magnitude) + (num < 0);
+        const size_t old_length = length(dest);
+        if (!grow(dest, old_length + chars + 1))
+            return;
+        char* end = get_data(dest) + old_length + chars;
+        cstring_format_uint_backward(end, magnitude);
+        if (num < 0)
+            end[-(ptrdiff_t)chars] = '-';
+        set_length(dest, old_length + chars);
         return;
     }
     THROW_INVALID_ARGUMENT_PTR_EXCEPTION;
 }
 
-static void append_float(CString* dest, double num, unsigned char digits)
+/*Shortest representation reading back to the same double */
+static void append_double(CString* dest, double num)
 {
-    /*naive implementation, only works if the integer part can be stored in a int64_t */
     if (dest)
     {
-        char buffer[digits + 1];
-        //first extract the integer part
-        int64_t int_part = (int64_t)num;
-        append_int(dest, int_part);
-        double float_part = num - (double)int_part;
-        buffer[0] = '.';
-        sprintf(buffer, "%lld", (int64_t)(float_part * pow(10, digits)));
-        append_string(dest, buffer);
+        const size_t old_length = length(dest);
+        if (dest->is_small && old_length + CString_max_double_chars >= SMALL_STRING)
+        {
+            /*the result may still fit the small string, don't move to the heap for the worst case */
+            char buffer[CString_max_double_chars];
+            append_view(dest, (CStringView){ buffer, cstring_format_double(buffer, num) });
+            return;
+        }
+        if (!grow(dest, old_length + CString_max_double_chars + 1))
+            return;
+        set_length(dest, old_length + cstring_format_double(get_data(dest) + old_length, num));
+        return;
     }
     THROW_INVALID_ARGUMENT_PTR_EXCEPTION;
 }
 
+/*Fixed notation with [digits] digits after the point */
+static void append_float(CString* dest, double num, unsigned char digits)
+{
+    static const double scale[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15 };
+    if (dest == NULL)
+    {
+        THROW_INVALID_ARGUMENT_PTR_EXCEPTION;
+        return;
+    }
+    const double magnitude = fabs(num);
+    const size_t old_length = length(dest);
+    if (digits < sizeof(scale) / sizeof(scale[0]) && magnitude * scale[digits] < 9007199254740992.0)  //2^53
+    {
+        /*round the exact product like printf does: half to even. fma() gives the rounding error of the product,
+        so magnitude * scale == product + error exactly */
+        const double product = magnitude * scale[digits];
+        const double error = fma(magnitude, scale[digits], -product);
+        const double whole = floor(product);
+        const double half_diff = (product - whole) - 0.5;
+        uint64_t scaled = (uint64_t)whole;
+        if (half_diff > -error || (half_diff == -error && (scaled & 1)))
+            ++scaled;
+        const uint64_t divisor = (uint64_t)scale[digits];
+        const uint64_t int_part = scaled / divisor;
+        const bool negative = signbit(num);
+        const size_t chars = negative + cstring_decimal_digits(int_part) + (digits ? digits + 1 : 0);
+        if (!grow(dest, old_length + chars + 1))
+            return;
+        char* const start = get_data(dest) + old_length;
+        char* end = start + chars;
+        if (digits)
+        {
+            uint64_t fraction = scaled % divisor;
+            for (unsigned char i = 0; i < digits; ++i, fraction /= 10)
+                *--end = (char)('0' + fraction % 10);
+            *--end = '.';
+        }
+        cstring_format_uint_backward(end, int_part);
+        if (negative)
+            *start = '-';
+        set_length(dest, old_length + chars);
+        return;
+    }
+    /*huge numbers, nan, inf or many digits */
+    const int chars = snprintf(NULL, 0, "%.*f", digits, num);
+    if (chars < 0 || !grow(dest, old_length + chars + 1))
+        return;
+    snprintf(get_data(dest) + old_length, chars + 1, "%.*f", digits, num);
+    set_length(dest, old_length + chars);
+}
+
 // static void append_string(CString* dest, char* src)
 // {
 //     if(dest!=NULL && src!=NULL)
@@ -629,135 +878,397 @@ static void append_float(CString* dest, double num, unsigned char digits)
 size_t count_occurrence(CString* str, char c)
 {
     if (str)
-    {
-        char* start = get_data(str);
-        char* end = get_end(str);
-        size_t count = 0;
-        while (start++ != end)
-        {
-            if (*start == c)
-                ++count;
-        }
-        return count;
-    }
+        return cstring_count_char(get_data(str), length(str), c);
     THROW_INVALID_ARGUMENT_PTR_EXCEPTION;
     return 0;
 }
 
-
-static size_t* preprocess(const char* pattern)
+static size_t find_first_of_after_pos(CString* str, char* pattern, size_t pos)   //search starts at [pos]
 {
-    const size_t length = strlen(pattern) + 1;
-    size_t* lps = malloc(sizeof(size_t) * length);
-    lps[0] = 0;
-    size_t lps_prev = 0;
-    size_t i = 1;
-    while (i < length)
+    if (str && pattern)
     {
-        if (pattern[i] == pattern[lps_prev])
-        {
-            ++lps_prev;
-            lps[i] = lps_prev;
-            ++i;
-        }
-        else
-        {
-            if (lps_prev != 0)
-                lps_prev = lps[lps_prev - 1];
-            else
-            {
-                lps[i] = 0;
-                ++i;
-            }
-        }
+        const size_t size = length(str);
+        if (pos >= size)
+            return CString_npos;
+        const size_t index = pos + cstring_find_first_of(get_data(str) + pos, size - pos, pattern);
+        return index == size ? CString_npos : index;
     }
-    return lps;
+    THROW_INVALID_ARGUMENT_PTR_EXCEPTION;
+    return CString_npos;
 }
 
-size_t find(CString* str, char* pattern)
+static size_t find_last_of_before_pos(CString* str, char* pattern, size_t pos)   //search starts at [pos] backwards
 {
     if (str && pattern)
     {
-        const size_t pattern_length = strlen(pattern);
-        const size_t text_length = length(str);
-        size_t* lps = preprocess(pattern);
-
-        size_t i = 0; //for text
-        size_t j = 0; //for pattern
-
-        char* ptr = get_data(str);
-        while (i < text_length)
-        {
-            if (pattern[j] == ptr[i])
-            {
-                ++i;
-                ++j;
-            }
-            else
-            {
-                if (j == pattern_length)
-                    return i - pattern_length;
-                else
-                {
-                    if (j != 0)
-                        j = lps[j - 1];
-                    else
-                        ++i;
-                }
-            }
-        }
-        free(lps);
+        const size_t size = length(str);
+        const size_t searched = pos < size ? pos + 1 : size;
+        const size_t index = cstring_find_last_of(get_data(str), searched, pattern);
+        return index == searched ? CString_npos : index;
     }
+    THROW_INVALID_ARGUMENT_PTR_EXCEPTION;
     return CString_npos;
 }
 
-static void replace_string(CString* dest, char* original, char* to_replace)
+static size_t find_first_of(CString* str, char* pattern)
 {
-    size_t index = find(dest, original);
-    if (index != CString_npos)
-    {
+    return find_first_of_after_pos(str, pattern, 0);
+}
+
+static size_t find_last_of(CString* str, char* pattern)
+{
+    return find_last_of_before_pos(str, pattern, CString_npos);
+}
+
+
+/*@return: index of the first occurrence of [pattern] at or after [pos], or CString_npos */
+static size_t find_from(CString* str, const char* pattern, size_t pattern_length, size_t pos)
+{
+    const size_t text_length = length(str);
+    if (pos > text_length)
+        return CString_npos;
+    const size_t index = pos + cstring_find_substring(get_data(str) + pos, text_length - pos, pattern, pattern_length);
+    return index == text_length && pattern_length != 0 ? CString_npos : index;
+}
+
+size_t find(CString* str, char* pattern)
+{
+    if (str && pattern)
+        return find_from(str, pattern, strlen(pattern), 0);
+    THROW_INVALID_ARGUMENT_PTR_EXCEPTION;
+    return CString_npos;
+}
+
+/**@brief: Internal function, replace [erase_length] chars at [pos] by text[0..text_length) in place
+ * Only the tail after the erased chars is moved.
+ * [text] may point into the buffer of [str] itself, which grow() can reallocate and the memmove can overwrite, so it is copied first
+ */
+static bool splice(CString* str, size_t pos, size_t erase_length, const char* text, size_t text_length)
+{
+    const uintptr_t buffer = (uintptr_t)get_data(str);
+    if (text_length != 0 && (uintptr_t)text >= buffer && (uintptr_t)text < buffer + bytes(str))
+    {
+        char* copy = malloc(text_length);
+        if (copy == NULL)
+            return false;
+        memcpy(copy, text, text_length);
+        const bool success = splice(str, pos, erase_length, copy, text_length);
+        free(copy);
+        return success;
+    }
+    const size_t old_length = length(str);
+    const size_t new_length = old_length - erase_length + text_length;
+    if (!grow(str, new_length + 1))
+        return false;
+    char* data = get_data(str);
+    memmove(data + pos + text_length, data + pos + erase_length, old_length - pos - erase_length);
+    memcpy(data + pos, text, text_length);
+    set_length(str, new_length);
+    return true;
+}
 
+/*replace the first occurrence */
+static void replace_string(CString* dest, char* original, char* to_replace)
+{
+    if (dest && original && to_replace)
+    {
+        const size_t original_length = strlen(original);
+        const size_t index = find_from(dest, original, original_length, 0);
+        if (index != CString_npos && original_length != 0)
+            splice(dest, index, original_length, to_replace, strlen(to_replace));
     }
+    else
+        THROW_INVALID_ARGUMENT_PTR_EXCEPTION;
+}
+
+static void replace_cstring(CString* dest, CString* original, CString* to_replace)
+{
+    if (original && to_replace)
+        replace_string(dest, get_data(original), get_data(to_replace));
+    else
+        THROW_INVALID_ARGUMENT_PTR_EXCEPTION;
+}
+
+/**@brief: replace every occurrence, in a single pass building the result in a new buffer
+ * @return: #occurrences replaced
+ */
+static size_t find_and_replace(CString* str, char* original, char* to_replace)
+{
+    if (str == NULL || original == NULL || to_replace == NULL)
+    {
+        THROW_INVALID_ARGUMENT_PTR_EXCEPTION;
+        return 0;
+    }
+    const size_t original_length = strlen(original);
+    const size_t replace_length = strlen(to_replace);
+    size_t index = original_length == 0 ? CString_npos : find_from(str, original, original_length, 0);
+    if (index == CString_npos)
+        return 0;
+
+    CString result = empty_CString();
+    const char* data = get_data(str);
+    size_t copied = 0;
+    size_t count = 0;
+    reserve_length(&result, length(str));
+    do
+    {
+        CStringView unchanged = { .ptr = data + copied, .length = index - copied };
+        CStringView replacement = { .ptr = to_replace, .length = replace_length };
+        append_view(&result, unchanged);
+        append_view(&result, replacement);
+        copied = index + original_length;
+        ++count;
+    } while ((index = find_from(str, original, original_length, copied)) != CString_npos);
+    CStringView tail = { .ptr = data + copied, .length = length(str) - copied };
+    append_view(&result, tail);
+    swap_cstring(str, &result);
+    delete_CString(&result);
+    return count;
 }
 
-/*Serialize*/
 static bool serialize(CString* str, FILE* f)
 {
-    if (str && f)
+    if (str == NULL || f == NULL)
     {
-        if (fwrite(str, sizeof(CString), 1, f) != 1)
-        {
-            THROW_FILE_IO_EXCEPTION;
-            fclose(f);
-            return false;
-        }
-        if (!str->is_small)
-        {
-            if (str->data.impl.ptr || fwrite(str->data.impl.ptr, 1, str->data.impl.capacity, f) != str->data.impl.capacity)
-            {
-                THROW_FILE_IO_EXCEPTION;
-                fclose(f);
-                return false;
-            }
-        }
-        fclose(f);
-        return true;
+        THROW_FILE_IO_EXCEPTION;
+        return false;
     }
-    THROW_FILE_IO_EXCEPTION;
-    fclose(f);
-    return false;
+    unsigned char prefix[CString_max_varint];
+    const size_t size = length(str);
+    const size_t prefix_size = put_varint(prefix, size);
+    if (fwrite(prefix, 1, prefix_size, f) != prefix_size || fwrite(get_data(str), 1, size, f) != size)
+    {
+        THROW_FILE_IO_EXCEPTION;
+        return false;
+    }
+    return true;
 }
+
 static bool serialize_to(CString* str, char* fileName, bool append)
 {
     if (fileName)
     {
         FILE* f = fopen(fileName, append ? "ab" : "wb");
-        return serialize(str, f);
+        const bool success = serialize(str, f);
+        if (f && fclose(f) != 0)
+            return false;
+        return success;
     }
     THROW_FILE_IO_EXCEPTION;
     return false;
 }
 
+/*Serialize array*/
+bool CString_serialize_array(CString* arr, size_t count, FILE* f)
+{
+    if (f == NULL || (arr == NULL && count != 0))
+    {
+        THROW_FILE_IO_EXCEPTION;
+        return false;
+    }
+    size_t payload_size = 0;
+    for (size_t i = 0; i < count; ++i)
+        payload_size += varint_size(length(&arr[i])) + length(&arr[i]);
+    const size_t header_size = sizeof(CString_format_magic) - 1 + 1 + varint_size(count) + varint_size(payload_size);
+    const size_t total = header_size + payload_size + 4;
+
+    /*encode everything first, so the whole array is one fwrite() */
+    unsigned char* const buffer = malloc(total);
+    if (buffer == NULL)
+        return false;
+    unsigned char* out = buffer;
+    memcpy(out, CString_format_magic, sizeof(CString_format_magic) - 1);
+    out += sizeof(CString_format_magic) - 1;
+    *out++ = CString_format_version;
+    out += put_varint(out, count);
+    out += put_varint(out, payload_size);
+    unsigned char* const payload = out;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const size_t size = length(&arr[i]);
+        out += put_varint(out, size);
+        memcpy(out, get_data(&arr[i]), size);
+        out += size;
+    }
+    put_u32(out, adler32(payload, payload_size));
+
+    const bool success = fwrite(buffer, 1, total, f) == total;
+    free(buffer);
+    if (!success)
+        THROW_FILE_IO_EXCEPTION;
+    return success;
+}
+
+CString* CString_deserialize_array(FILE* f, size_t* count)
+{
+    if (f == NULL || count == NULL)
+    {
+        THROW_FILE_IO_EXCEPTION;
+        return NULL;
+    }
+    *count = 0;
+    unsigned char magic[sizeof(CString_format_magic)];
+    uint64_t n, payload_size;
+    if (fread(magic, 1, sizeof(magic), f) != sizeof(magic)
+        || memcmp(magic, CString_format_magic, sizeof(magic) - 1) != 0
+        || magic[sizeof(magic) - 1] != CString_format_version
+        || !read_varint(f, &n)
+        || !read_varint(f, &payload_size)
+        || n > payload_size
+        || payload_size > SIZE_MAX - 4)
+    {
+        THROW_FILE_IO_EXCEPTION;
+        return NULL;
+    }
+    unsigned char* const payload = malloc((size_t)payload_size + 4);
+    CString* arr = malloc(sizeof(CString) * (n == 0 ? 1 : (size_t)n));
+    if (payload == NULL || arr == NULL
+        || fread(payload, 1, (size_t)payload_size + 4, f) != payload_size + 4
+        || get_u32(payload + payload_size) != adler32(payload, (size_t)payload_size))
+    {
+        THROW_FILE_IO_EXCEPTION;
+        free(payload);
+        free(arr);
+        return NULL;
+    }
+    const unsigned char* current = payload;
+    CStringView view;
+    size_t i = 0;
+    while (i < n && next_record(&current, payload + payload_size, &view))
+        arr[i++] = CString_from_view(view);
+    free(payload);
+    if (i != n)
+    {
+        THROW_FILE_IO_EXCEPTION;
+        while (i)
+            delete_CString(&arr[--i]);
+        free(arr);
+        return NULL;
+    }
+    *count = i;
+    return arr;
+}
+
+/**@brief: Internal function, get the whole file in memory, by mmap() if possible
+ */
+static bool map_file(char* fileName, CStringMappedArray* mapped)
+{
+#if defined(CSTRING_HAS_MMAP)
+    const int fd = open(fileName, O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat info;
+    void* mapping = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size > 0)
+        mapping = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  //the mapping stays valid
+    if (mapping == MAP_FAILED)
+        return false;
+    mapped->mapping = mapping;
+    mapped->mapping_size = (size_t)info.st_size;
+    mapped->is_mapped = true;
+    return true;
+#elif defined(_WIN32)
+    HANDLE file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER size;
+    HANDLE mapping = NULL;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+        mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+    if (mapping)
+        CloseHandle(mapping);   //the view stays valid
+    CloseHandle(file);
+    if (view == NULL)
+        return false;
+    mapped->mapping = view;
+    mapped->mapping_size = (size_t)size.QuadPart;
+    mapped->is_mapped = true;
+    return true;
+#else
+    FILE* f = fopen(fileName, "rb");
+    if (f == NULL)
+        return false;
+    bool success = fseek(f, 0, SEEK_END) == 0;
+    const long size = success ? ftell(f) : -1;
+    void* buffer = size > 0 ? malloc((size_t)size) : NULL;
+    success = buffer && fseek(f, 0, SEEK_SET) == 0 && fread(buffer, 1, (size_t)size, f) == (size_t)size;
+    fclose(f);
+    if (!success)
+    {
+        free(buffer);
+        return false;
+    }
+    mapped->mapping = buffer;
+    mapped->mapping_size = (size_t)size;
+    mapped->is_mapped = false;
+    return true;
+#endif
+}
+
+bool CString_map_array(char* fileName, CStringMappedArray* mapped)
+{
+    if (fileName == NULL || mapped == NULL)
+    {
+        THROW_NULL_PARAM_EXCEPTION;
+        return false;
+    }
+    memset(mapped, 0, sizeof(CStringMappedArray));
+    if (!map_file(fileName, mapped))
+    {
+        THROW_FILE_IO_EXCEPTION;
+        return false;
+    }
+    const unsigned char* current = mapped->mapping;
+    const unsigned char* const end = current + mapped->mapping_size;
+    const size_t magic_size = sizeof(CString_format_magic) - 1;
+    uint64_t n, payload_size;
+    bool valid = mapped->mapping_size > magic_size
+        && memcmp(current, CString_format_magic, magic_size) == 0
+        && current[magic_size] == CString_format_version;
+    if (valid)
+    {
+        current += magic_size + 1;
+        valid = parse_varint(&current, end, &n) && parse_varint(&current, end, &payload_size)
+            && n <= payload_size && payload_size <= (uint64_t)(end - current) && 4 <= (uint64_t)(end - current) - payload_size
+            && get_u32(current + payload_size) == adler32(current, (size_t)payload_size);
+    }
+    if (valid)
+        valid = (mapped->views = malloc(sizeof(CStringView) * (n == 0 ? 1 : (size_t)n))) != NULL;
+    if (valid)
+    {
+        const unsigned char* const payload_end = current + payload_size;
+        while (mapped->count < n && next_record(&current, payload_end, &mapped->views[mapped->count]))
+            ++mapped->count;
+        valid = mapped->count == n;
+    }
+    if (!valid)
+    {
+        THROW_FILE_IO_EXCEPTION;
+        CString_unmap_array(mapped);
+    }
+    return valid;
+}
+
+void CString_unmap_array(CStringMappedArray* mapped)
+{
+    if (mapped == NULL)
+        return;
+    free(mapped->views);
+    if (mapped->mapping)
+    {
+#if defined(CSTRING_HAS_MMAP)
+        munmap(mapped->mapping, mapped->mapping_size);
+#elif defined(_WIN32)
+        UnmapViewOfFile(mapped->mapping);
+#else
+        free(mapped->mapping);
+#endif
+    }
+    memset(mapped, 0, sizeof(CStringMappedArray));
+}
+
 static void put_cstring(CString* str)
 {
     if (str != NULL)
@@ -779,7 +1290,8 @@ static void put_cstring(CString* str)
 
 static bool is_equal(CString* str1, CString* str2)
 {
-    return strcmp(get_data(str1), get_data(str2)) == 0;
+    const size_t size = length(str1);
+    return size == length(str2) && memcmp(get_data(str1), get_data(str2), size) == 0;
 }
 
 static bool is_smaller(CString* str1, CString* str2)    //str1 < str2
@@ -793,61 +1305,341 @@ static bool is_bigger(CString* str1, CString* str2)
     return strcmp(get_data(str1), get_data(str2)) > 0;
 }
 
-static CStringArray split_by_char(CString* str, char delim)
+/*Split*/
+CStringView CString_view(CString* str)
 {
-    if (str != NULL && delim != '\0')
+    if (str)
     {
-        const char* start = get_data(str);
-        const char* current = start;
-        int occurrence = 0;
-        while (*current != '\0')
-        {
-            if (*current == delim)
-                ++occurrence;
-            ++current;
-        }
-        CStringArray array = { .count = occurrence, .arr = malloc(sizeof(CString) * occurrence) };
-        current = start;
-        int i = 0;
-        while (*current != '\0')
+        CStringView view = { .ptr = get_data(str), .length = length(str) };
+        return view;
+    }
+    THROW_NULL_PARAM_EXCEPTION;
+    CStringView empty_view = { .ptr = "", .length = 0 };
+    return empty_view;
+}
+
+CString CString_from_view(CStringView view)
+{
+    return new_CString_by((char*)view.ptr, (char*)view.ptr + view.length);
+}
+
+CStringTokenizer CString_tokenize_view(CStringView view, const char* delim, size_t delim_length)
+{
+    CStringTokenizer tokenizer = {
+        .current = view.ptr,
+        .end = view.ptr + view.length,
+        .delim = delim,
+        .delim_length = delim_length,
+        .done = false
+    };
+    return tokenizer;
+}
+
+CStringTokenizer CString_tokenize(CString* str, const char* delim)
+{
+    return CString_tokenize_view(CString_view(str), delim, delim ? strlen(delim) : 0);
+}
+
+bool CString_next_token(CStringTokenizer* tokenizer, CStringView* token)
+{
+    if (tokenizer == NULL || tokenizer->done)
+        return false;
+    const size_t remaining = tokenizer->end - tokenizer->current;
+    const size_t index = tokenizer->delim_length == 0 ? remaining :
+        cstring_find_substring(tokenizer->current, remaining, tokenizer->delim, tokenizer->delim_length);
+    token->ptr = tokenizer->current;
+    token->length = index;
+    if (index == remaining)     //the last token
+        tokenizer->done = true;
+    else
+        tokenizer->current += index + tokenizer->delim_length;
+    return true;
+}
+
+/**@brief: Internal function for the allocating split functions
+ * The array grows like the string buffer, so the string is only scanned once
+ */
+static CString* split_to_array(CString* str, const char* delim, size_t delim_length, int* n)
+{
+    if (str == NULL || n == NULL)
+    {
+        THROW_NULL_PARAM_EXCEPTION;
+        return NULL;
+    }
+    CStringTokenizer tokenizer = CString_tokenize_view(CString_view(str), delim, delim_length);
+    CStringView token;
+    size_t capacity = 0;
+    int count = 0;
+    CString* tokens = NULL;
+    while (CString_next_token(&tokenizer, &token))
+    {
+        if ((size_t)count == capacity)
         {
-            if (*current == delim)
-                array.arr[i++] = new_CString_by(start, current);
-            ++current;
-            start = current;
+            capacity = capacity < 4 ? 4 : capacity + capacity / 2;
+            CString* new_tokens = realloc(tokens, sizeof(CString) * capacity);
+            if (new_tokens == NULL)
+                break;
+            tokens = new_tokens;
         }
-        return array;
-    }
-    CStringArray empty_result = { .count = 0, .arr = NULL };
-    return empty_result;
-}
-
-void init_global_vtable()
-{
-    global_vtable_init = true;
-    // global_vtable.assign_string=&assign_string;
-    // global_vtable.assign_cstring=&assign_cstring;
-    global_vtable.substr = &substr;
-    global_vtable.to_upper = &to_upper;
-    global_vtable.to_lower = &to_lower;
-    global_vtable.serialize = &serialize;
-    global_vtable.serialize_to = &serialize_to;
-    global_vtable.empty = &empty;
-    global_vtable.bytes = &bytes;
-    global_vtable.length = &length;
-    global_vtable.swap_cstring = &swap_cstring;
-    global_vtable.resize = &resize;
-    global_vtable.is_equal = &is_equal;
-    global_vtable.is_bigger = &is_bigger;
-    global_vtable.is_smaller = &is_smaller;
-    global_vtable.split_by_char = &split_by_char;
-    global_vtable.append_char = &append_char;
-    global_vtable.append_string = &append_string;
-    global_vtable.count_occurrence = &count_occurrence;
-    global_vtable.reverse = &reverse;
-    global_vtable.reverse_range = &reverse_range;
-
-    global_vtable.puts = &put_cstring;
+        tokens[count++] = CString_from_view(token);
+    }
+    *n = count;
+    return tokens;
+}
+
+static CString* split_by_char(CString* str, char delim, int* n)
+{
+    return split_to_array(str, &delim, delim == '\0' ? 0 : 1, n);
+}
+
+static CString* split_by_string(CString* str, char* delim, int* n)
+{
+    return split_to_array(str, delim, delim ? strlen(delim) : 0, n);
+}
+
+static CString* split_by_cstring(CString* str, CString* delim, int* n)
+{
+    if (delim == NULL)
+        return split_to_array(str, NULL, 0, n);
+    return split_to_array(str, get_data(delim), length(delim), n);
+}
+
+static size_t for_each_token(CString* str, char* delim, void (*callback)(CStringView token, void* context), void* context)
+{
+    CStringTokenizer tokenizer = CString_tokenize(str, delim);
+    CStringView token;
+    size_t count = 0;
+    while (CString_next_token(&tokenizer, &token))
+    {
+        callback(token, context);
+        ++count;
+    }
+    return count;
+}
+
+#ifndef CSTRING_NO_VTABLE
+/*Only through the vtable, the direct call is the inline CString_empty() in cstring.h*/
+static bool empty(CString* str)
+{
+    if (str != NULL)
+    {
+        if (str->is_small)
+            return str->small_length == 0;
+        if (str->data.impl.ptr != NULL)
+            return str->data.impl.length <= 1;
+        //str is not small, but nullptr
+        THROW_INVALID_LONG_STR_EXCEPTION;
+        return false;
+    }
+    THROW_INVALID_ARGUMENT_PTR_EXCEPTION;
+    return false;
+}
+
+/*static initialization, so constructing a CString needs no check */
+CString_public global_vtable = {
+    .substr = &substr,
+    .to_upper = &to_upper,
+    .to_lower = &to_lower,
+    .serialize = &serialize,
+    .serialize_to = &serialize_to,
+    .empty = &empty,
+    .bytes = &bytes,
+    .length = &length,
+    .swap_cstring = &swap_cstring,
+    .resize = &resize,
+    .reserve_length = &reserve_length,
+    .is_equal = &is_equal,
+    .is_bigger = &is_bigger,
+    .is_smaller = &is_smaller,
+    .split_by_char = &split_by_char,
+    .split_by_string = &split_by_string,
+    .split_by_cstring = &split_by_cstring,
+    .for_each_token = &for_each_token,
+    .append_char = &append_char,
+    .append_string = &append_string,
+    .append_view = &append_view,
+    .append_int = &append_int,
+    .append_float = &append_float,
+    .append_double = &append_double,
+    .find = &find,
+    .replace_string = &replace_string,
+    .replace_cstring = &replace_cstring,
+    .find_and_replace = &find_and_replace,
+    .count_occurrence = &count_occurrence,
+    .find_first_of = &find_first_of,
+    .find_last_of = &find_last_of,
+    .find_first_of_after_pos = &find_first_of_after_pos,
+    .find_last_of_before_pos = &find_last_of_before_pos,
+    .reverse = &reverse,
+    .reverse_range = &reverse_range,
+    .puts = &put_cstring,
+};
+#endif
+
+/*Direct calls*/
+CString CString_substr(CString* str, size_t pos)
+{
+    return substr(str, pos);
+}
+
+void CString_resize(CString* str, size_t newSize)
+{
+    resize(str, newSize);
+}
+
+void CString_to_upper(CString* str)
+{
+    to_upper(str);
+}
+
+void CString_to_lower(CString* str)
+{
+    to_lower(str);
+}
+
+bool CString_reserve_length(CString* str, size_t length)
+{
+    return reserve_length(str, length);
+}
+
+void CString_append_string(CString* dest, char* src)
+{
+    append_string(dest, src);
+}
+
+void CString_append_char(CString* dest, char c)
+{
+    append_char(dest, c);
+}
+
+void CString_append_view(CString* dest, CStringView src)
+{
+    append_view(dest, src);
+}
+
+void CString_append_int(CString* dest, int64_t num)
+{
+    append_int(dest, num);
+}
+
+void CString_append_float(CString* dest, double num, unsigned char digits)
+{
+    append_float(dest, num, digits);
+}
+
+void CString_append_double(CString* dest, double num)
+{
+    append_double(dest, num);
+}
+
+void CString_swap_cstring(CString* l, CString* r)
+{
+    swap_cstring(l, r);
+}
+
+void CString_reverse(CString* str)
+{
+    reverse(str);
+}
+
+void CString_reverse_range(CString* str, size_t start, size_t end)
+{
+    reverse_range(str, start, end);
+}
+
+size_t CString_find(CString* str, char* pattern)
+{
+    return find(str, pattern);
+}
+
+size_t CString_find_first_of(CString* str, char* pattern)
+{
+    return find_first_of(str, pattern);
+}
+
+size_t CString_find_last_of(CString* str, char* pattern)
+{
+    return find_last_of(str, pattern);
+}
+
+size_t CString_find_first_of_after_pos(CString* str, char* pattern, size_t pos)
+{
+    return find_first_of_after_pos(str, pattern, pos);
+}
+
+size_t CString_find_last_of_before_pos(CString* str, char* pattern, size_t pos)
+{
+    return find_last_of_before_pos(str, pattern, pos);
+}
+
+size_t CString_find_and_replace(CString* str, char* original, char* to_replace)
+{
+    return find_and_replace(str, original, to_replace);
+}
+
+size_t CString_count_occurrence(CString* str, char c)
+{
+    return count_occurrence(str, c);
+}
+
+void CString_replace_string(CString* dest, char* original, char* to_replace)
+{
+    replace_string(dest, original, to_replace);
+}
+
+void CString_replace_cstring(CString* dest, CString* original, CString* to_replace)
+{
+    replace_cstring(dest, original, to_replace);
+}
+
+bool CString_is_equal(CString* str1, CString* str2)
+{
+    return is_equal(str1, str2);
+}
+
+bool CString_is_bigger(CString* str1, CString* str2)
+{
+    return is_bigger(str1, str2);
+}
+
+bool CString_is_smaller(CString* str1, CString* str2)
+{
+    return is_smaller(str1, str2);
+}
+
+CString* CString_split_by_char(CString* str, char delim, int* n)
+{
+    return split_by_char(str, delim, n);
+}
+
+CString* CString_split_by_string(CString* str, char* delim, int* n)
+{
+    return split_by_string(str, delim, n);
+}
+
+CString* CString_split_by_cstring(CString* str, CString* delim, int* n)
+{
+    return split_by_cstring(str, delim, n);
+}
+
+size_t CString_for_each_token(CString* str, char* delim, void (*callback)(CStringView token, void* context), void* context)
+{
+    return for_each_token(str, delim, callback, context);
+}
+
+bool CString_serialize(CString* str, FILE* f)
+{
+    return serialize(str, f);
+}
+
+bool CString_serialize_to(CString* str, char* fileName, bool append)
+{
+    return serialize_to(str, fileName, append);
+}
+
+void CString_puts(CString* str)
+{
+    put_cstring(str);
 }
 
 void print_info(const CString* str)
@@ -887,54 +1679,16 @@ CString get_char_n(size_t n)
         while (i < n)
             temp.data.small_string[i++] = (char)getchar();
     }
-    temp.public = get_vtable();
+    set_length(&temp, n);
+    SET_VTABLE(&temp);
     return temp;
 }
 
 CString get_until(char stop_flag)
 {
-    CString temp;
-    size_t count = 0;
-    bool stop = false;
-    temp.is_moved = false;
-    temp.is_small = true;
-    while (count < SMALL_STRING_LENGTH)
-    {
-        char c = (char)getchar();
-        temp.data.small_string[count++] = c;
-        if (c == stop_flag)
-        {
-            stop = true;
-            break;
-        }
-    }
-    if (!stop)   //big string
-    {
-        //first copy the small string part into dynamic memory
-        char* data = malloc(2 * SMALL_STRING);
-        memcpy(data, temp.data.small_string, SMALL_STRING);
-        temp.data.impl.capacity = 2 * SMALL_STRING;
-        temp.data.impl.ptr = data;
-        temp.is_small = false;
-
-        //Then, the capacity will doubled everytime it is full
-        while (true)
-        {
-            if (count == temp.data.impl.capacity - 1)
-            {
-                temp.data.impl.ptr = realloc(temp.data.impl.ptr, 2 * (count + 1));
-                temp.data.impl.capacity *= 2;
-            }
-            char c = (char)getchar();
-            if (c == stop_flag)
-                break;
-            temp.data.impl.ptr[count++] = c;
-        }
-        temp.data.impl.ptr[count + 1] = '\0';
-        temp.data.impl.length = strlen(temp.data.impl.ptr);
-    }
-    else
-        temp.data.small_string[count + 1] = '\0';
-    temp.public = get_vtable();
+    CString temp = empty_CString();
+    int c;
+    while ((c = getchar()) != EOF && c != stop_flag)
+        append_char(&temp, (char)c);
     return temp;
 }
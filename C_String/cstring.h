@@ -11,12 +11,24 @@
  * - traditional O(m*n) method
  * - boyer-moore algorithm (will be in experimental)
 */
+#pragma once
 #include <stdio.h>
 #include <stdbool.h>
 #include <stdint.h>
 
 #define SMALL_STRING 24
 #define CString_npos SIZE_MAX
+#define CString_line_reader_buffer (1 << 20)
+
+/*Serialized format, the integers are LEB128 varints:
+ * CString: length, then the chars without '\0'
+ * array:   "CSTR", 1 byte version, count, size of the strings in bytes, the strings,
+ *          then the Adler-32 checksum of the strings as 4 bytes little endian
+ */
+#define CString_format_magic "CSTR"
+#define CString_format_version 1
+#define CString_max_varint 10
+
 typedef struct cstring_impl_t CString_impl;
 typedef struct cstring_public_t CString_public;
 struct cstring_impl_t
@@ -42,11 +54,53 @@ typedef enum TYPE_ENUM
 typedef struct cstring_t
 {
     Data data;
-    CString_public *public;
+#ifndef CSTRING_NO_VTABLE
+    CString_public *public;     //drop it with -DCSTRING_NO_VTABLE, and call the CString_xxx() functions below instead
+#endif
     bool is_small;
     bool is_moved;
+    unsigned char small_length;     //length of small_string excluding '\0', only valid when is_small
 }CString;
 
+/*A non-owning, not null terminated view of [length] chars at [ptr]. Only valid while the viewed string is unchanged */
+typedef struct CString_view_t
+{
+    const char *ptr;
+    size_t length;
+}CStringView;
+
+/*Splits a string lazily by a delimiter, see CString_tokenize() */
+typedef struct CString_tokenizer_t
+{
+    const char *current;
+    const char *end;
+    const char *delim;
+    size_t delim_length;
+    bool done;
+}CStringTokenizer;
+
+/*Reads a file line by line through one large buffer, see CString_line_reader() */
+typedef struct CString_line_reader_t
+{
+    FILE *file;
+    char *buffer;
+    size_t capacity;
+    size_t begin;   //buffer[begin, end) is read from the file, but not returned yet
+    size_t end;
+    bool eof;
+    bool owns_file;
+}CStringLineReader;
+
+/*An array of strings loaded from a file by CString_map_array(), the views point into the file mapping */
+typedef struct CString_mapped_array_t
+{
+    CStringView *views;
+    size_t count;
+    void *mapping;
+    size_t mapping_size;
+    bool is_mapped;     //false if the platform has no mmap, and the file was read into memory instead
+}CStringMappedArray;
+
 typedef struct CString_Array_t
 {
     int count;
@@ -68,8 +122,10 @@ struct cstring_public_t
     void (*append_cstring)(CString *dest, CString *src);    //dest += src
     void (*append_string)(CString *dest, char *src);    //dest += src
     void (*append_char)(CString *dest, char c); //dest += c
+    void (*append_view)(CString *dest, CStringView src);   //dest += src, [src] may contain '\0'
     void (*append_int)(CString *dest, int64_t num);
-    void (*append_float)(CString* dest, double num, unsigned char digits);
+    void (*append_float)(CString* dest, double num, unsigned char digits);  //fixed notation with [digits] digits after the point
+    void (*append_double)(CString* dest, double num);   //shortest representation that reads back to [num]
     void (*swap_cstring)(CString *l, CString *r);       //l <-> r
     void (*swap_string)(CString *l, char *r);   //l <-> r
     void (*reverse)(CString* str);
@@ -80,11 +136,11 @@ struct cstring_public_t
     size_t (*find_last_of)(CString* str, char *pattern);     //find the last occurrence of characters in pattern
     size_t (*find_first_of_after_pos)(CString *str, char *pattern, size_t pos);//find the first occurrence of characters in pattern after pos position in str
     size_t (*find_last_of_before_pos)(CString *str, char *pattern, size_t pos); //find the last occurrence of characters in pattern before pos position in str
-    size_t (*find_and_replace)(CString* str, char* to_replace);
+    size_t (*find_and_replace)(CString* str, char* original, char* to_replace);   //replace every occurrence of original, return #replaced
     size_t (*count_occurrence)(CString *str, char c);    //count #times 'c' appeared in the string
 
-    void (*replace_string)(CString *dest, char *original, char* to_replace);   //find pattern in dest and replace dest
-    void (*replace_cstring)(CString *dest, CString *original, CString* to_replace);   //find pattern in dest and replace dest
+    void (*replace_string)(CString *dest, char *original, char* to_replace);   //replace the first occurrence of original in dest
+    void (*replace_cstring)(CString *dest, CString *original, CString* to_replace);   //replace the first occurrence of original in dest
 
     /*Compare*/
     bool (*is_equal)(CString* str1, CString* str2);     //str1 =?= str2
@@ -95,6 +151,8 @@ struct cstring_public_t
     CString *(*split_by_char)(CString *str, char delim, int* n);
     CString *(*split_by_string)(CString *str, char *delim, int *n);
     CString *(*split_by_cstring)(CString *str, CString *delim, int *n);
+    /*call [callback] with each token as a view into str, without allocating. Return the number of tokens*/
+    size_t (*for_each_token)(CString *str, char *delim, void (*callback)(CStringView token, void *context), void *context);
 
     /*serialize*/
     bool (*serialize)(CString *str, FILE *f);
@@ -104,12 +162,86 @@ struct cstring_public_t
     void (*puts)(CString *str);
 };
 
+/*Direct calls, same as the vtable ones but without the indirection, and the only API with -DCSTRING_NO_VTABLE.
+ * The accessors are inline, [str] must not be NULL for them */
+static inline char *CString_data(CString *str)
+{
+    return str->is_small ? str->data.small_string : str->data.impl.ptr;
+}
+
+static inline size_t CString_length(CString *str)
+{
+    return str->is_small ? str->small_length : str->data.impl.length - 1;
+}
+
+static inline size_t CString_bytes(CString *str)
+{
+    return str->is_small ? SMALL_STRING : str->data.impl.capacity;
+}
+
+static inline bool CString_empty(CString *str)
+{
+    return CString_length(str) == 0;
+}
+
+CString CString_substr(CString *str, size_t pos);
+void CString_resize(CString *str, size_t newSize);
+void CString_to_upper(CString *str);
+void CString_to_lower(CString *str);
+bool CString_reserve_length(CString *str, size_t length);
+void CString_append_string(CString *dest, char *src);
+void CString_append_char(CString *dest, char c);
+void CString_append_view(CString *dest, CStringView src);
+void CString_append_int(CString *dest, int64_t num);
+void CString_append_float(CString *dest, double num, unsigned char digits);
+void CString_append_double(CString *dest, double num);
+void CString_swap_cstring(CString *l, CString *r);
+void CString_reverse(CString *str);
+void CString_reverse_range(CString *str, size_t start, size_t end);
+size_t CString_find(CString *str, char *pattern);
+size_t CString_find_first_of(CString *str, char *pattern);
+size_t CString_find_last_of(CString *str, char *pattern);
+size_t CString_find_first_of_after_pos(CString *str, char *pattern, size_t pos);
+size_t CString_find_last_of_before_pos(CString *str, char *pattern, size_t pos);
+size_t CString_find_and_replace(CString *str, char *original, char *to_replace);
+size_t CString_count_occurrence(CString *str, char c);
+void CString_replace_string(CString *dest, char *original, char *to_replace);
+void CString_replace_cstring(CString *dest, CString *original, CString *to_replace);
+bool CString_is_equal(CString *str1, CString *str2);
+bool CString_is_bigger(CString *str1, CString *str2);
+bool CString_is_smaller(CString *str1, CString *str2);
+CString *CString_split_by_char(CString *str, char delim, int *n);
+CString *CString_split_by_string(CString *str, char *delim, int *n);
+CString *CString_split_by_cstring(CString *str, CString *delim, int *n);
+size_t CString_for_each_token(CString *str, char *delim, void (*callback)(CStringView token, void *context), void *context);
+bool CString_serialize(CString *str, FILE *f);
+bool CString_serialize_to(CString *str, char *fileName, bool append);
+void CString_puts(CString *str);
+
 /*Constructor*/
 CString new_CString(const char *data);
 CString empty_CString();
 CString move_to_CString(char *data);
 CString new_CString_by(char* start, char* end);
 
+/*Views*/
+CStringView CString_view(CString *str);
+CString CString_from_view(CStringView view);
+
+/**
+ * @brief: Split [str] by [delim] lazily and without allocating, the tokens are views into [str]
+ * Empty tokens are kept, eg. "a,,b," split by "," gives "a", "", "b", ""
+ * @param delim: null terminated, may be longer than 1 char. An empty [delim] gives the whole string as 1 token
+ */
+CStringTokenizer CString_tokenize(CString *str, const char *delim);
+CStringTokenizer CString_tokenize_view(CStringView view, const char *delim, size_t delim_length);
+
+/**
+ * @brief: Get the next token of [tokenizer]
+ * @return: false if there are no more tokens
+ */
+bool CString_next_token(CStringTokenizer *tokenizer, CStringView *token);
+
 /**
  * @brief: Read one line from stdin
  * @return: a CString
@@ -136,9 +268,53 @@ void delete_CString(CString *str);
 /*Deserialize*/
 CString CString_deserialize(FILE *f);
 CString CString_deserialize_from(char* fileName);
+
+/**
+ * @brief: Write [count] CStrings to [f] as one array with a single fwrite(), see the format above.
+ * Several arrays can be written to the same stream
+ */
+bool CString_serialize_array(CString *arr, size_t count, FILE *f);
+
+/**
+ * @brief: Read the next array written by CString_serialize_array() from [f]
+ * @param count: set to the number of CStrings read
+ * @return: the CStrings, to be deleted and then free()'d by the caller. NULL if the array is invalid or the checksum does not match
+ */
+CString *CString_deserialize_array(FILE *f, size_t *count);
+
+/**
+ * @brief: Map the file, and get its first array as views into it, without copying any string
+ * @return: false if the array is invalid or the checksum does not match
+ */
+bool CString_map_array(char *fileName, CStringMappedArray *mapped);
+void CString_unmap_array(CStringMappedArray *mapped);
 CString line_to_CString(FILE *f);
 CString line_to_CString_from(char *fileName);
 
+/*Line reader*/
+/**
+ * @brief: Read [f] line by line, without reading any byte twice. The file can be much larger than the buffer,
+ * which only grows if a single line is longer than it. The reader does not close [f]
+ * @param buffer_size: initial size of the buffer, eg. CString_line_reader_buffer
+ */
+CStringLineReader CString_line_reader(FILE *f, size_t buffer_size);
+CStringLineReader CString_line_reader_from(char *fileName);
+
+/**
+ * @brief: Get the next line, without the '\n' or "\r\n"
+ * @param line: a view into the buffer of the reader, only valid until the next read
+ * @return: false at the end of the file
+ */
+bool CString_read_line_view(CStringLineReader *reader, CStringView *line);
+
+/**
+ * @brief: Same as CString_read_line_view(), but copy the line to a new CString
+ */
+bool CString_read_line(CStringLineReader *reader, CString *line);
+
+/*Free the buffer, and close the file if it was opened by CString_line_reader_from() */
+void CString_close_line_reader(CStringLineReader *reader);
+
 /*Conversions to CString*/
 CString to_cstring(void *data, TYPE_ENUM type);
 
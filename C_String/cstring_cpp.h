@@ -0,0 +1,21 @@
+/* Description: Include cstring.h from C++
+* `public` is a keyword in C++, and getline() clashes with the POSIX one declared in <stdio.h>.
+* Renaming them here changes neither the layout of CString nor the symbols of the other functions,
+* so C++ code uses str.public_->... and cannot call getline().
+*/
+#pragma once
+#include <stdio.h>  //before renaming, so the POSIX getline() keeps its name
+#include <stdbool.h>
+#include <stdint.h>
+
+extern "C" {
+#define public public_
+#define getline CString_getline
+#include "cstring.h"
+#include "cstring_intern.h"
+#include "cstring_piece_table.h"
+#undef getline
+#undef public
+#include "cstring_simd.h"
+#include "cstring_format.h"
+}
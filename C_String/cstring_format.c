@@ -0,0 +1,378 @@
+#include "cstring_format.h"
+#include <string.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+static const char digit_pairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static const uint64_t pow10[20] = {
+    1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull, 1000000000ull,
+    10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull, 100000000000000ull,
+    1000000000000000ull, 10000000000000000ull, 100000000000000000ull, 1000000000000000000ull, 10000000000000000000ull
+};
+
+size_t cstring_decimal_digits(uint64_t value)
+{
+    size_t digits = 1;
+    while (digits < 20 && value >= pow10[digits])
+        ++digits;
+    return digits;
+}
+
+size_t cstring_format_uint_backward(char* end, uint64_t value)
+{
+    char* p = end;
+    while (value >= 100)
+    {
+        const size_t pair = (size_t)(value % 100) * 2;
+        value /= 100;
+        p -= 2;
+        memcpy(p, digit_pairs + pair, 2);
+    }
+    if (value >= 10)
+    {
+        p -= 2;
+        memcpy(p, digit_pairs + value * 2, 2);
+    }
+    else
+        *--p = (char)('0' + value);
+    return (size_t)(end - p);
+}
+
+size_t cstring_format_int(char* out, int64_t value)
+{
+    size_t sign = 0;
+    uint64_t magnitude = (uint64_t)value;
+    if (value < 0)
+    {
+        *out = '-';
+        sign = 1;
+        magnitude = 0 - magnitude;  //also right for INT64_MIN
+    }
+    const size_t digits = cstring_decimal_digits(magnitude);
+    cstring_format_uint_backward(out + sign + digits, magnitude);
+    return sign + digits;
+}
+
+/*Grisu2, see Florian Loitsch, "Printing Floating-Point Numbers Quickly and Accurately with Integers" */
+
+/*A floating point number f * 2^e with a 64 bit significand */
+typedef struct diy_fp_t
+{
+    uint64_t f;
+    int e;
+}DiyFp;
+
+#define SIGNIFICAND_BITS 52
+#define HIDDEN_BIT (1ull << SIGNIFICAND_BITS)
+
+static int leading_zeros(uint64_t x)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse64(&index, x);
+    return 63 - (int)index;
+#else
+    return __builtin_clzll(x);
+#endif
+}
+
+static DiyFp normalize(DiyFp x)
+{
+    const int shift = leading_zeros(x.f);
+    x.f <<= shift;
+    x.e -= shift;
+    return x;
+}
+
+/*the upper 64 bits of the 128 bit product, rounded */
+static DiyFp multiply(DiyFp x, DiyFp y)
+{
+    const uint64_t M32 = 0xFFFFFFFFull;
+    const uint64_t a = x.f >> 32, b = x.f & M32, c = y.f >> 32, d = y.f & M32;
+    const uint64_t ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+    uint64_t tmp = (bd >> 32) + (ad & M32) + (bc & M32);
+    tmp += 1ull << 31;
+    DiyFp result = { ac + (ad >> 32) + (bc >> 32) + (tmp >> 32), x.e + y.e + 64 };
+    return result;
+}
+
+/*10^k for k = -348, -340, ..., 340 */
+static const DiyFp cached_powers[] = {
+    { 0xfa8fd5a0081c0288ull, -1220 },   //1e-348
+    { 0xbaaee17fa23ebf76ull, -1193 },   //1e-340
+    { 0x8b16fb203055ac76ull, -1166 },   //1e-332
+    { 0xcf42894a5dce35eaull, -1140 },   //1e-324
+    { 0x9a6bb0aa55653b2dull, -1113 },   //1e-316
+    { 0xe61acf033d1a45dfull, -1087 },   //1e-308
+    { 0xab70fe17c79ac6caull, -1060 },   //1e-300
+    { 0xff77b1fcbebcdc4full, -1034 },   //1e-292
+    { 0xbe5691ef416bd60cull, -1007 },   //1e-284
+    { 0x8dd01fad907ffc3cull, -980 },   //1e-276
+    { 0xd3515c2831559a83ull, -954 },   //1e-268
+    { 0x9d71ac8fada6c9b5ull, -927 },   //1e-260
+    { 0xea9c227723ee8bcbull, -901 },   //1e-252
+    { 0xaecc49914078536dull, -874 },   //1e-244
+    { 0x823c12795db6ce57ull, -847 },   //1e-236
+    { 0xc21094364dfb5637ull, -821 },   //1e-228
+    { 0x9096ea6f3848984full, -794 },   //1e-220
+    { 0xd77485cb25823ac7ull, -768 },   //1e-212
+    { 0xa086cfcd97bf97f4ull, -741 },   //1e-204
+    { 0xef340a98172aace5ull, -715 },   //1e-196
+    { 0xb23867fb2a35b28eull, -688 },   //1e-188
+    { 0x84c8d4dfd2c63f3bull, -661 },   //1e-180
+    { 0xc5dd44271ad3cdbaull, -635 },   //1e-172
+    { 0x936b9fcebb25c996ull, -608 },   //1e-164
+    { 0xdbac6c247d62a584ull, -582 },   //1e-156
+    { 0xa3ab66580d5fdaf6ull, -555 },   //1e-148
+    { 0xf3e2f893dec3f126ull, -529 },   //1e-140
+    { 0xb5b5ada8aaff80b8ull, -502 },   //1e-132
+    { 0x87625f056c7c4a8bull, -475 },   //1e-124
+    { 0xc9bcff6034c13053ull, -449 },   //1e-116
+    { 0x964e858c91ba2655ull, -422 },   //1e-108
+    { 0xdff9772470297ebdull, -396 },   //1e-100
+    { 0xa6dfbd9fb8e5b88full, -369 },   //1e-92
+    { 0xf8a95fcf88747d94ull, -343 },   //1e-84
+    { 0xb94470938fa89bcfull, -316 },   //1e-76
+    { 0x8a08f0f8bf0f156bull, -289 },   //1e-68
+    { 0xcdb02555653131b6ull, -263 },   //1e-60
+    { 0x993fe2c6d07b7facull, -236 },   //1e-52
+    { 0xe45c10c42a2b3b06ull, -210 },   //1e-44
+    { 0xaa242499697392d3ull, -183 },   //1e-36
+    { 0xfd87b5f28300ca0eull, -157 },   //1e-28
+    { 0xbce5086492111aebull, -130 },   //1e-20
+    { 0x8cbccc096f5088ccull, -103 },   //1e-12
+    { 0xd1b71758e219652cull, -77 },   //1e-4
+    { 0x9c40000000000000ull, -50 },   //1e4
+    { 0xe8d4a51000000000ull, -24 },   //1e12
+    { 0xad78ebc5ac620000ull, 3 },   //1e20
+    { 0x813f3978f8940984ull, 30 },   //1e28
+    { 0xc097ce7bc90715b3ull, 56 },   //1e36
+    { 0x8f7e32ce7bea5c70ull, 83 },   //1e44
+    { 0xd5d238a4abe98068ull, 109 },   //1e52
+    { 0x9f4f2726179a2245ull, 136 },   //1e60
+    { 0xed63a231d4c4fb27ull, 162 },   //1e68
+    { 0xb0de65388cc8ada8ull, 189 },   //1e76
+    { 0x83c7088e1aab65dbull, 216 },   //1e84
+    { 0xc45d1df942711d9aull, 242 },   //1e92
+    { 0x924d692ca61be758ull, 269 },   //1e100
+    { 0xda01ee641a708deaull, 295 },   //1e108
+    { 0xa26da3999aef774aull, 322 },   //1e116
+    { 0xf209787bb47d6b85ull, 348 },   //1e124
+    { 0xb454e4a179dd1877ull, 375 },   //1e132
+    { 0x865b86925b9bc5c2ull, 402 },   //1e140
+    { 0xc83553c5c8965d3dull, 428 },   //1e148
+    { 0x952ab45cfa97a0b3ull, 455 },   //1e156
+    { 0xde469fbd99a05fe3ull, 481 },   //1e164
+    { 0xa59bc234db398c25ull, 508 },   //1e172
+    { 0xf6c69a72a3989f5cull, 534 },   //1e180
+    { 0xb7dcbf5354e9beceull, 561 },   //1e188
+    { 0x88fcf317f22241e2ull, 588 },   //1e196
+    { 0xcc20ce9bd35c78a5ull, 614 },   //1e204
+    { 0x98165af37b2153dfull, 641 },   //1e212
+    { 0xe2a0b5dc971f303aull, 667 },   //1e220
+    { 0xa8d9d1535ce3b396ull, 694 },   //1e228
+    { 0xfb9b7cd9a4a7443cull, 720 },   //1e236
+    { 0xbb764c4ca7a44410ull, 747 },   //1e244
+    { 0x8bab8eefb6409c1aull, 774 },   //1e252
+    { 0xd01fef10a657842cull, 800 },   //1e260
+    { 0x9b10a4e5e9913129ull, 827 },   //1e268
+    { 0xe7109bfba19c0c9dull, 853 },   //1e276
+    { 0xac2820d9623bf429ull, 880 },   //1e284
+    { 0x80444b5e7aa7cf85ull, 907 },   //1e292
+    { 0xbf21e44003acdd2dull, 933 },   //1e300
+    { 0x8e679c2f5e44ff8full, 960 },   //1e308
+    { 0xd433179d9c8cb841ull, 986 },   //1e316
+    { 0x9e19db92b4e31ba9ull, 1013 },   //1e324
+    { 0xeb96bf6ebadf77d9ull, 1039 },   //1e332
+    { 0xaf87023b9bf0ee6bull, 1066 },   //1e340
+};
+
+/*Get a cached power c = 10^-k, so that c * 2^e has its binary exponent in [-60, -32] */
+static DiyFp cached_power(int e, int* k)
+{
+    const double dk = (-61 - e) * 0.30102999566398114 + 347;  //log10(2)
+    int ik = (int)dk;
+    if (dk - ik > 0.0)
+        ++ik;
+    const unsigned index = (unsigned)((ik >> 3) + 1);
+    *k = -(-348 + (int)(index << 3));
+    return cached_powers[index];
+}
+
+static void grisu_round(char* buffer, size_t length, uint64_t delta, uint64_t rest, uint64_t ten_kappa, uint64_t wp_w)
+{
+    while (rest < wp_w && delta - rest >= ten_kappa && (rest + ten_kappa < wp_w || wp_w - rest > rest + ten_kappa - wp_w))
+    {
+        --buffer[length - 1];
+        rest += ten_kappa;
+    }
+}
+
+/*Generate the digits of [mp] until they are within [delta] of it */
+static size_t digit_gen(DiyFp w, DiyFp mp, uint64_t delta, char* buffer, int* k)
+{
+    const DiyFp one = { 1ull << -mp.e, mp.e };
+    const uint64_t wp_w = mp.f - w.f;
+    uint32_t p1 = (uint32_t)(mp.f >> -one.e);
+    uint64_t p2 = mp.f & (one.f - 1);
+    int kappa = (int)cstring_decimal_digits(p1);
+    size_t length = 0;
+    while (kappa > 0)
+    {
+        const uint32_t divisor = (uint32_t)pow10[kappa - 1];
+        const uint32_t d = p1 / divisor;
+        p1 %= divisor;
+        if (d || length)
+            buffer[length++] = (char)('0' + d);
+        --kappa;
+        const uint64_t rest = ((uint64_t)p1 << -one.e) + p2;
+        if (rest <= delta)
+        {
+            *k += kappa;
+            grisu_round(buffer, length, delta, rest, pow10[kappa] << -one.e, wp_w);
+            return length;
+        }
+    }
+    for (;;)
+    {
+        p2 *= 10;
+        delta *= 10;
+        const char d = (char)(p2 >> -one.e);
+        if (d || length)
+            buffer[length++] = (char)('0' + d);
+        p2 &= one.f - 1;
+        --kappa;
+        if (p2 < delta)
+        {
+            *k += kappa;
+            const int index = -kappa;
+            grisu_round(buffer, length, delta, p2, one.f, wp_w * (index < 20 ? pow10[index] : 0));
+            return length;
+        }
+    }
+}
+
+/*Write the digits of a positive finite [value] to [buffer], so that value ~= digits * 10^k */
+static size_t grisu2(double value, char* buffer, int* k)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    const int biased_e = (int)((bits >> SIGNIFICAND_BITS) & 0x7FF);
+    DiyFp v = { bits & (HIDDEN_BIT - 1), 1 - 1075 };
+    if (biased_e != 0)
+    {
+        v.f += HIDDEN_BIT;
+        v.e = biased_e - 1075;
+    }
+
+    /*the boundaries halfway to the neighbouring doubles, with the same exponent */
+    DiyFp plus = { (v.f << 1) + 1, v.e - 1 };
+    while (!(plus.f & (HIDDEN_BIT << 1)))
+    {
+        plus.f <<= 1;
+        --plus.e;
+    }
+    plus.f <<= 64 - SIGNIFICAND_BITS - 2;
+    plus.e -= 64 - SIGNIFICAND_BITS - 2;
+    DiyFp minus = v.f == HIDDEN_BIT ? (DiyFp){ (v.f << 2) - 1, v.e - 2 } : (DiyFp){ (v.f << 1) - 1, v.e - 1 };
+    minus.f <<= minus.e - plus.e;
+    minus.e = plus.e;
+
+    const DiyFp c_mk = cached_power(plus.e, k);
+    const DiyFp w = multiply(normalize(v), c_mk);
+    DiyFp wp = multiply(plus, c_mk);
+    DiyFp wm = multiply(minus, c_mk);
+    ++wm.f;
+    --wp.f;
+    return digit_gen(w, wp, wp.f - wm.f, buffer, k);
+}
+
+static size_t write_exponent(char* out, int exponent)
+{
+    size_t length = 0;
+    out[length++] = 'e';
+    out[length++] = exponent < 0 ? '-' : '+';
+    const unsigned magnitude = (unsigned)(exponent < 0 ? -exponent : exponent);
+    if (magnitude >= 100)
+        out[length++] = (char)('0' + magnitude / 100);
+    memcpy(out + length, digit_pairs + (magnitude % 100) * 2, 2);
+    return length + 2;
+}
+
+size_t cstring_format_double(char* out, double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    size_t length = 0;
+    if (bits >> 63)
+        out[length++] = '-';
+    const uint64_t magnitude_bits = bits & ~(1ull << 63);
+    if (magnitude_bits >= 0x7FF0000000000000ull)
+    {
+        const char* text = magnitude_bits == 0x7FF0000000000000ull ? "inf" : "nan";
+        memcpy(out + length, text, 3);
+        return length + 3;
+    }
+    if (magnitude_bits == 0)
+    {
+        out[length] = '0';
+        return length + 1;
+    }
+
+    char digits[24];
+    int k;
+    double magnitude;
+    memcpy(&magnitude, &magnitude_bits, sizeof(magnitude));
+    const int n = (int)grisu2(magnitude, digits, &k);
+    const int point = n + k;    //value = 0.digits * 10^point
+
+    /*pick the shorter notation, fixed if they are equally long */
+    const int exponent = point - 1;
+    const int exponent_digits = exponent >= 100 || exponent <= -100 ? 3 : 2;
+    const int scientific_length = n + (n > 1) + 2 + exponent_digits;
+    const int fixed_length = point >= n ? point : point > 0 ? n + 1 : 2 - point + n;
+    char* p = out + length;
+    if (fixed_length <= scientific_length)
+    {
+        if (point >= n)         //digits then zeros: 1234000
+        {
+            memcpy(p, digits, n);
+            memset(p + n, '0', point - n);
+        }
+        else if (point > 0)     //12.34
+        {
+            memcpy(p, digits, point);
+            p[point] = '.';
+            memcpy(p + point + 1, digits + point, n - point);
+        }
+        else                    //0.001234
+        {
+            p[0] = '0';
+            p[1] = '.';
+            memset(p + 2, '0', -point);
+            memcpy(p + 2 - point, digits, n);
+        }
+        return length + fixed_length;
+    }
+    p[0] = digits[0];           //1.234e+56
+    size_t written = 1;
+    if (n > 1)
+    {
+        p[1] = '.';
+        memcpy(p + 2, digits + 1, n - 1);
+        written = n + 1;
+    }
+    return length + written + write_exponent(p + written, exponent);
+}
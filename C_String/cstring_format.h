@@ -0,0 +1,35 @@
+/* Description: Number formatting kernels used by cstring.c
+* Integers are written two digits at a time from a table, doubles with Grisu2, which gives the shortest
+* digits that read back to the same double for almost all values, and never more than 17.
+*/
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#define CString_max_int_chars 20        //"-9223372036854775808"
+#define CString_max_double_chars 25     //"-2.2250738585072014e-308"
+
+/**
+ * @return: #decimal digits of [value]
+ */
+size_t cstring_decimal_digits(uint64_t value);
+
+/**
+ * @brief: write the decimal digits of [value] so that they end right before [end]
+ * @return: #chars written
+ */
+size_t cstring_format_uint_backward(char *end, uint64_t value);
+
+/**
+ * @brief: write [value] to [out], which must have room for CString_max_int_chars chars. No '\0' is written
+ * @return: #chars written
+ */
+size_t cstring_format_int(char *out, int64_t value);
+
+/**
+ * @brief: write the shortest representation of [value] that reads back to the same double to [out],
+ * which must have room for CString_max_double_chars chars. No '\0' is written.
+ * Like std::to_chars(), fixed or scientific notation is used, whichever is shorter
+ * @return: #chars written
+ */
+size_t cstring_format_double(char *out, double value);
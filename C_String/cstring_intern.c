@@ -0,0 +1,275 @@
+#include "cstring_intern.h"
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#define INITIAL_TABLE 64
+#define ARENA_BLOCK (64 * 1024)
+
+struct CString_arena_block_t
+{
+    struct CString_arena_block_t *next;
+    size_t size;
+    _Alignas(8) unsigned char data[];
+};
+
+/*wyhash*/
+static const uint64_t wyp0 = 0xa0761d6478bd642full;
+static const uint64_t wyp1 = 0xe7037ed1a0b428dbull;
+static const uint64_t wyp2 = 0x8ebc6af09c88c6e3ull;
+static const uint64_t wyp3 = 0x589965cc75374cc3ull;
+
+/*full 64x64 -> 128 bit multiply, [a] gets the low half and [b] the high half */
+static void wymum(uint64_t* a, uint64_t* b)
+{
+#if defined(__SIZEOF_INT128__)
+    const __uint128_t product = (__uint128_t)*a * *b;
+    *a = (uint64_t)product;
+    *b = (uint64_t)(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    *a = _umul128(*a, *b, b);
+#else
+    const uint64_t ha = *a >> 32, hb = *b >> 32, la = (uint32_t)*a, lb = (uint32_t)*b;
+    const uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    const uint64_t t = rl + (rm0 << 32);
+    uint64_t carry = t < rl;
+    const uint64_t lo = t + (rm1 << 32);
+    carry += lo < t;
+    *a = lo;
+    *b = rh + (rm0 >> 32) + (rm1 >> 32) + carry;
+#endif
+}
+
+static uint64_t wymix(uint64_t a, uint64_t b)
+{
+    wymum(&a, &b);
+    return a ^ b;
+}
+
+/*unaligned little endian reads */
+static uint64_t wyr8(const unsigned char* p)
+{
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return v;
+}
+
+static uint64_t wyr4(const unsigned char* p)
+{
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+static uint64_t wyr3(const unsigned char* p, size_t k)
+{
+    return ((uint64_t)p[0] << 16) | ((uint64_t)p[k >> 1] << 8) | p[k - 1];
+}
+
+uint64_t CString_hash(const char* data, size_t length, uint64_t seed)
+{
+    const unsigned char* p = (const unsigned char*)data;
+    uint64_t a, b;
+    seed ^= wymix(seed ^ wyp0, wyp1);
+    if (length <= 16)
+    {
+        if (length >= 4)
+        {
+            a = (wyr4(p) << 32) | wyr4(p + ((length >> 3) << 2));
+            b = (wyr4(p + length - 4) << 32) | wyr4(p + length - 4 - ((length >> 3) << 2));
+        }
+        else if (length > 0)
+        {
+            a = wyr3(p, length);
+            b = 0;
+        }
+        else
+            a = b = 0;
+    }
+    else
+    {
+        size_t i = length;
+        if (i > 48)
+        {
+            uint64_t see1 = seed, see2 = seed;
+            do
+            {
+                seed = wymix(wyr8(p) ^ wyp1, wyr8(p + 8) ^ seed);
+                see1 = wymix(wyr8(p + 16) ^ wyp2, wyr8(p + 24) ^ see1);
+                see2 = wymix(wyr8(p + 32) ^ wyp3, wyr8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= see1 ^ see2;
+        }
+        while (i > 16)
+        {
+            seed = wymix(wyr8(p) ^ wyp1, wyr8(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        a = wyr8(p + i - 16);
+        b = wyr8(p + i - 8);
+    }
+    a ^= wyp1;
+    b ^= seed;
+    wymum(&a, &b);
+    return wymix(a ^ wyp0 ^ length, b ^ wyp1);
+}
+
+/*Pool*/
+CStringInternPool CString_intern_pool()
+{
+    CStringInternPool pool = { 0 };
+    return pool;
+}
+
+void CString_delete_intern_pool(CStringInternPool* pool)
+{
+    if (pool == NULL)
+        return;
+    while (pool->blocks)
+    {
+        struct CString_arena_block_t* next = pool->blocks->next;
+        free(pool->blocks);
+        pool->blocks = next;
+    }
+    free(pool->table);
+    memset(pool, 0, sizeof(CStringInternPool));
+}
+
+/**@brief: Internal function, bump allocate 8 byte aligned [bytes] from the arena
+ * A string larger than a block gets a block of its own
+ */
+static void* arena_allocate(CStringInternPool* pool, size_t bytes)
+{
+    bytes = (bytes + 7) & ~(size_t)7;
+    if (pool->blocks == NULL || pool->block_size - pool->block_used < bytes)
+    {
+        const size_t size = bytes > ARENA_BLOCK ? bytes : ARENA_BLOCK;
+        struct CString_arena_block_t* block = malloc(sizeof(struct CString_arena_block_t) + size);
+        if (block == NULL)
+            return NULL;
+        block->size = size;
+        if (pool->blocks != NULL && size != ARENA_BLOCK)
+        {
+            /*keep bump allocating from the current block */
+            block->next = pool->blocks->next;
+            pool->blocks->next = block;
+            return block->data;
+        }
+        block->next = pool->blocks;
+        pool->blocks = block;
+        pool->block_size = size;
+        pool->block_used = 0;
+    }
+    void* memory = pool->blocks->data + pool->block_used;
+    pool->block_used += bytes;
+    return memory;
+}
+
+static size_t slot_of(const CStringInternEntry* table, size_t capacity, CStringView view, uint64_t hash)
+{
+    const size_t mask = capacity - 1;
+    size_t slot = (size_t)hash & mask;
+    while (table[slot].handle != NULL)
+    {
+        CStringHandle handle = table[slot].handle;
+        if (table[slot].hash == hash && handle->length == view.length && memcmp(handle->data, view.ptr, view.length) == 0)
+            break;
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+/*Keep the load factor under 3/4 */
+static bool grow_table(CStringInternPool* pool)
+{
+    const size_t capacity = pool->capacity == 0 ? INITIAL_TABLE : pool->capacity * 2;
+    CStringInternEntry* table = calloc(capacity, sizeof(CStringInternEntry));
+    if (table == NULL)
+        return false;
+    for (size_t i = 0; i < pool->capacity; ++i)
+    {
+        if (pool->table[i].handle != NULL)
+        {
+            size_t slot = (size_t)pool->table[i].hash & (capacity - 1);
+            while (table[slot].handle != NULL)
+                slot = (slot + 1) & (capacity - 1);
+            table[slot] = pool->table[i];
+        }
+    }
+    free(pool->table);
+    pool->table = table;
+    pool->capacity = capacity;
+    return true;
+}
+
+CStringHandle CString_intern_view(CStringInternPool* pool, CStringView view)
+{
+    if (pool == NULL || (view.ptr == NULL && view.length != 0))
+        return NULL;
+    if ((pool->count + 1) * 4 > pool->capacity * 3 && !grow_table(pool))
+        return NULL;
+    ++pool->intern_calls;
+    pool->bytes_requested += view.length;
+    const uint64_t hash = CString_hash(view.ptr, view.length, 0);
+    const size_t slot = slot_of(pool->table, pool->capacity, view, hash);
+    if (pool->table[slot].handle != NULL)
+        return pool->table[slot].handle;
+
+    CStringInterned* interned = arena_allocate(pool, offsetof(CStringInterned, data) + view.length + 1);
+    if (interned == NULL)
+        return NULL;
+    interned->length = view.length;
+    interned->hash = hash;
+    if (view.length)
+        memcpy(interned->data, view.ptr, view.length);
+    interned->data[view.length] = '\0';
+    pool->table[slot].hash = hash;
+    pool->table[slot].handle = interned;
+    ++pool->count;
+    return interned;
+}
+
+CStringHandle CString_intern(CStringInternPool* pool, CString* str)
+{
+    if (str == NULL)
+        return NULL;
+    return CString_intern_view(pool, CString_view(str));
+}
+
+CStringHandle CString_intern_find(const CStringInternPool* pool, CStringView view)
+{
+    if (pool == NULL || pool->count == 0)
+        return NULL;
+    return pool->table[slot_of(pool->table, pool->capacity, view, CString_hash(view.ptr, view.length, 0))].handle;
+}
+
+CStringView CString_handle_view(CStringHandle handle)
+{
+    CStringView view = { .ptr = handle ? handle->data : "", .length = handle ? handle->length : 0 };
+    return view;
+}
+
+CStringInternStats CString_intern_stats(const CStringInternPool* pool)
+{
+    CStringInternStats stats = { 0 };
+    if (pool == NULL)
+        return stats;
+    stats.unique_strings = pool->count;
+    stats.intern_calls = pool->intern_calls;
+    stats.bytes_requested = pool->bytes_requested;
+    stats.bytes_allocated = pool->capacity * sizeof(CStringInternEntry);
+    for (const struct CString_arena_block_t* block = pool->blocks; block; block = block->next)
+        stats.bytes_allocated += sizeof(struct CString_arena_block_t) + block->size;
+    for (size_t i = 0; i < pool->capacity; ++i)
+    {
+        if (pool->table[i].handle)
+            stats.bytes_unique += pool->table[i].handle->length;
+    }
+    return stats;
+}
@@ -0,0 +1,66 @@
+/* Description: String interning for CString
+* Each distinct text is stored once in an arena, and interning it again returns the same handle,
+* so comparing interned strings is comparing pointers.
+*/
+#pragma once
+#include "cstring.h"
+
+/*An interned string, never moved or freed until its pool is deleted */
+typedef struct CString_interned_t
+{
+    size_t length;
+    uint64_t hash;
+    char data[];    //null terminated
+}CStringInterned;
+typedef const CStringInterned *CStringHandle;
+
+typedef struct CString_intern_entry_t
+{
+    uint64_t hash;      //kept in the table, so most mismatches are found without touching the string
+    CStringHandle handle;
+}CStringInternEntry;
+
+typedef struct CString_intern_pool_t
+{
+    CStringInternEntry *table;  //open addressing, linear probing, power of 2 size
+    size_t capacity;
+    size_t count;
+    struct CString_arena_block_t *blocks;   //the newest block first, strings are bump allocated from it
+    size_t block_used;
+    size_t block_size;
+    size_t bytes_requested;     //length of all strings interned, including duplicates
+    size_t intern_calls;
+}CStringInternPool;
+
+typedef struct CString_intern_stats_t
+{
+    size_t unique_strings;
+    size_t intern_calls;
+    size_t bytes_requested;     //what storing every string separately would take, excluding '\0'
+    size_t bytes_unique;        //length of the unique strings, excluding '\0'
+    size_t bytes_allocated;     //arena blocks and table actually allocated
+}CStringInternStats;
+
+CStringInternPool CString_intern_pool();
+void CString_delete_intern_pool(CStringInternPool *pool);
+
+/**
+ * @brief: Get the handle of the text of [str], storing a copy of it if it is not in [pool] yet
+ * @return: NULL if the allocation failed
+ */
+CStringHandle CString_intern(CStringInternPool *pool, CString *str);
+CStringHandle CString_intern_view(CStringInternPool *pool, CStringView view);
+
+/**
+ * @brief: Get the handle of [view] without inserting it
+ * @return: NULL if it is not interned
+ */
+CStringHandle CString_intern_find(const CStringInternPool *pool, CStringView view);
+
+CStringView CString_handle_view(CStringHandle handle);
+CStringInternStats CString_intern_stats(const CStringInternPool *pool);
+
+/**
+ * @brief: wyhash, a fast 64 bit hash of data[0..length)
+ */
+uint64_t CString_hash(const char *data, size_t length, uint64_t seed);
@@ -0,0 +1,304 @@
+#include "cstring_piece_table.h"
+#include <string.h>
+#include <stdlib.h>
+
+#define NO_PIECE 0
+
+static size_t subtree_length(const CStringPieceTable* table, uint32_t piece)
+{
+    return piece == NO_PIECE ? 0 : table->pieces[piece].subtree_length;
+}
+
+static void update(CStringPieceTable* table, uint32_t piece)
+{
+    CStringPiece* p = &table->pieces[piece];
+    p->subtree_length = subtree_length(table, p->left) + p->length + subtree_length(table, p->right);
+}
+
+/*xorshift32 */
+static uint32_t next_priority(CStringPieceTable* table)
+{
+    uint32_t x = table->seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    table->seed = x;
+    return x;
+}
+
+/**@brief: Internal function, make sure [count] new pieces can be made without reallocating [pieces],
+ * so the recursive functions below can keep pointers to pieces
+ */
+static bool reserve_pieces(CStringPieceTable* table, uint32_t count)
+{
+    uint32_t available = table->piece_capacity > table->piece_count ? table->piece_capacity - table->piece_count : 0;
+    for (uint32_t piece = table->free_list; piece != NO_PIECE && available < count; piece = table->pieces[piece].left)
+        ++available;
+    if (available >= count)
+        return true;
+    const uint32_t capacity = table->piece_capacity < 16 ? 16 : table->piece_capacity + table->piece_capacity / 2;
+    CStringPiece* pieces = realloc(table->pieces, sizeof(CStringPiece) * (capacity + count));
+    if (pieces == NULL)
+        return false;
+    table->pieces = pieces;
+    table->piece_capacity = capacity + count;
+    return true;
+}
+
+static uint32_t new_piece(CStringPieceTable* table, bool in_added, size_t start, size_t length)
+{
+    uint32_t piece;
+    if (table->free_list != NO_PIECE)
+    {
+        piece = table->free_list;
+        table->free_list = table->pieces[piece].left;
+    }
+    else
+        piece = table->piece_count++;
+    CStringPiece* p = &table->pieces[piece];
+    p->start = start;
+    p->length = length;
+    p->subtree_length = length;
+    p->left = p->right = NO_PIECE;
+    p->priority = next_priority(table);
+    p->in_added = in_added;
+    return piece;
+}
+
+static void free_pieces(CStringPieceTable* table, uint32_t piece)
+{
+    if (piece == NO_PIECE)
+        return;
+    free_pieces(table, table->pieces[piece].left);
+    free_pieces(table, table->pieces[piece].right);
+    table->pieces[piece].left = table->free_list;
+    table->free_list = piece;
+}
+
+static uint32_t merge(CStringPieceTable* table, uint32_t left, uint32_t right)
+{
+    if (left == NO_PIECE)
+        return right;
+    if (right == NO_PIECE)
+        return left;
+    if (table->pieces[left].priority > table->pieces[right].priority)
+    {
+        table->pieces[left].right = merge(table, table->pieces[left].right, right);
+        update(table, left);
+        return left;
+    }
+    table->pieces[right].left = merge(table, left, table->pieces[right].left);
+    update(table, right);
+    return right;
+}
+
+/**@brief: Internal function, split the pieces under [piece] at [pos] into [left] and [right]
+ * A piece containing [pos] is cut in two, and the cut-off tail (which needs 1 free piece) is returned in [tail] instead of being
+ * put in [right]: its priority is random, so it can only be merged in at the root without breaking the heap order
+ */
+static void split_pieces(CStringPieceTable* table, uint32_t piece, size_t pos, uint32_t* left, uint32_t* right, uint32_t* tail)
+{
+    if (piece == NO_PIECE)
+    {
+        *left = *right = NO_PIECE;
+        return;
+    }
+    CStringPiece* p = &table->pieces[piece];
+    const size_t left_length = subtree_length(table, p->left);
+    if (pos <= left_length)
+    {
+        split_pieces(table, p->left, pos, left, &p->left, tail);
+        *right = piece;
+    }
+    else if (pos >= left_length + p->length)
+    {
+        split_pieces(table, p->right, pos - left_length - p->length, &p->right, right, tail);
+        *left = piece;
+    }
+    else
+    {
+        const size_t offset = pos - left_length;
+        *tail = new_piece(table, p->in_added, p->start + offset, p->length - offset);
+        p->length = offset;
+        *right = p->right;
+        p->right = NO_PIECE;
+        *left = piece;
+    }
+    update(table, piece);
+}
+
+/**@brief: Internal function, split the text of [piece] at [pos] into [left] and [right]
+ * A piece containing [pos] is cut in two, which needs 1 free piece
+ */
+static void split(CStringPieceTable* table, uint32_t piece, size_t pos, uint32_t* left, uint32_t* right)
+{
+    uint32_t tail = NO_PIECE;
+    split_pieces(table, piece, pos, left, right, &tail);
+    *right = merge(table, tail, *right);
+}
+
+/*Add text to the added buffer, growing it by 1.5x */
+static bool add_text(CStringPieceTable* table, const char* text, size_t length)
+{
+    if (table->added_length + length > table->added_capacity)
+    {
+        size_t capacity = table->added_capacity + table->added_capacity / 2;
+        if (capacity < table->added_length + length)
+            capacity = table->added_length + length;
+        if (capacity < 4096)
+            capacity = 4096;
+        char* added = realloc(table->added, capacity);
+        if (added == NULL)
+            return false;
+        table->added = added;
+        table->added_capacity = capacity;
+    }
+    memcpy(table->added + table->added_length, text, length);
+    table->added_length += length;
+    return true;
+}
+
+/*Extend the last piece of [tree] by [length] chars if it ends where the new text is added, like when typing */
+static bool extend_last(CStringPieceTable* table, uint32_t tree, size_t length)
+{
+    uint32_t last = tree;
+    if (last == NO_PIECE)
+        return false;
+    while (table->pieces[last].right != NO_PIECE)
+        last = table->pieces[last].right;
+    const CStringPiece* p = &table->pieces[last];
+    if (!p->in_added || p->start + p->length != table->added_length - length)
+        return false;
+    for (uint32_t piece = tree; piece != NO_PIECE; piece = table->pieces[piece].right)
+        table->pieces[piece].subtree_length += length;
+    table->pieces[last].length += length;
+    return true;
+}
+
+CStringPieceTable CString_piece_table(CString* str)
+{
+    CStringPieceTable table = { 0 };
+    table.seed = 2463534242u;
+    table.piece_count = 1;
+    const CStringView view = str ? CString_view(str) : (CStringView){ .ptr = "", .length = 0 };
+    if (view.length != 0)
+    {
+        table.original = malloc(view.length);
+        if (table.original && reserve_pieces(&table, 1))
+        {
+            memcpy(table.original, view.ptr, view.length);
+            table.original_length = view.length;
+            table.root = new_piece(&table, false, 0, view.length);
+        }
+    }
+    return table;
+}
+
+void CString_delete_piece_table(CStringPieceTable* table)
+{
+    if (table)
+    {
+        free(table->original);
+        free(table->added);
+        free(table->pieces);
+        memset(table, 0, sizeof(CStringPieceTable));
+    }
+}
+
+size_t CString_piece_table_length(const CStringPieceTable* table)
+{
+    return table ? subtree_length(table, table->root) : 0;
+}
+
+bool CString_piece_table_insert(CStringPieceTable* table, size_t pos, const char* text, size_t length)
+{
+    if (table == NULL || pos > CString_piece_table_length(table) || (text == NULL && length != 0))
+        return false;
+    if (length == 0)
+        return true;
+    if (!reserve_pieces(table, 2) || !add_text(table, text, length))
+        return false;
+    uint32_t left, right;
+    split(table, table->root, pos, &left, &right);
+    if (!extend_last(table, left, length))
+        left = merge(table, left, new_piece(table, true, table->added_length - length, length));
+    table->root = merge(table, left, right);
+    return true;
+}
+
+void CString_piece_table_erase(CStringPieceTable* table, size_t pos, size_t length)
+{
+    const size_t total = CString_piece_table_length(table);
+    if (table == NULL || pos >= total || length == 0)
+        return;
+    if (length > total - pos)
+        length = total - pos;
+    if (!reserve_pieces(table, 2))
+        return;
+    uint32_t left, middle, right;
+    split(table, table->root, pos, &left, &right);
+    split(table, right, length, &middle, &right);
+    free_pieces(table, middle);
+    table->root = merge(table, left, right);
+}
+
+bool CString_piece_table_replace(CStringPieceTable* table, size_t pos, size_t length, const char* text, size_t text_length)
+{
+    if (table == NULL || pos > CString_piece_table_length(table))
+        return false;
+    CString_piece_table_erase(table, pos, length);
+    return CString_piece_table_insert(table, pos, text, text_length);
+}
+
+char CString_piece_table_char_at(const CStringPieceTable* table, size_t pos)
+{
+    if (table == NULL || pos >= CString_piece_table_length(table))
+        return '\0';
+    uint32_t piece = table->root;
+    for (;;)
+    {
+        const CStringPiece* p = &table->pieces[piece];
+        const size_t left_length = subtree_length(table, p->left);
+        if (pos < left_length)
+            piece = p->left;
+        else if (pos < left_length + p->length)
+            return (p->in_added ? table->added : table->original)[p->start + pos - left_length];
+        else
+        {
+            pos -= left_length + p->length;
+            piece = p->right;
+        }
+    }
+}
+
+static size_t for_each_piece(const CStringPieceTable* table, uint32_t piece, void (*callback)(CStringView chunk, void* context), void* context)
+{
+    if (piece == NO_PIECE)
+        return 0;
+    const CStringPiece* p = &table->pieces[piece];
+    size_t count = for_each_piece(table, p->left, callback, context);
+    CStringView chunk = { .ptr = (p->in_added ? table->added : table->original) + p->start, .length = p->length };
+    callback(chunk, context);
+    return count + 1 + for_each_piece(table, p->right, callback, context);
+}
+
+size_t CString_piece_table_for_each_chunk(const CStringPieceTable* table, void (*callback)(CStringView chunk, void* context), void* context)
+{
+    if (table == NULL || callback == NULL)
+        return 0;
+    return for_each_piece(table, table->root, callback, context);
+}
+
+static void append_chunk(CStringView chunk, void* context)
+{
+    CString* str = context;
+    CString_append_view(str, chunk);
+}
+
+CString CString_piece_table_to_CString(const CStringPieceTable* table)
+{
+    CString str = empty_CString();
+    CString_reserve_length(&str, CString_piece_table_length(table));
+    CString_piece_table_for_each_chunk(table, append_chunk, &str);
+    return str;
+}
@@ -0,0 +1,73 @@
+/* Description: A piece table for editing large texts
+* The text is a sequence of pieces, each referring to a range of either the original text or an append-only buffer
+* of inserted text. The pieces are kept in a treap ordered by position, with the text length of each subtree,
+* so insert/erase/replace are O(log #pieces) and never move the text itself.
+*/
+#pragma once
+#include "cstring.h"
+
+typedef struct CString_piece_t
+{
+    size_t start;           //offset in its buffer
+    size_t length;
+    size_t subtree_length;  //length of the text of this piece and all pieces under it
+    uint32_t left;
+    uint32_t right;
+    uint32_t priority;      //heap ordered, which keeps the tree balanced in expectation
+    bool in_added;          //in [added], or in [original]
+}CStringPiece;
+
+typedef struct CString_piece_table_t
+{
+    char *original;
+    size_t original_length;
+    char *added;            //append only, pieces refer to it by offset so it can be realloc'ed
+    size_t added_length;
+    size_t added_capacity;
+    CStringPiece *pieces;   //pieces[0] is unused, index 0 means no piece
+    uint32_t piece_count;
+    uint32_t piece_capacity;
+    uint32_t free_list;     //erased pieces, linked by [left]
+    uint32_t root;
+    uint32_t seed;
+}CStringPieceTable;
+
+/**
+ * @brief: Make a piece table holding a copy of [str]
+ */
+CStringPieceTable CString_piece_table(CString *str);
+void CString_delete_piece_table(CStringPieceTable *table);
+
+size_t CString_piece_table_length(const CStringPieceTable *table);
+
+/**
+ * @brief: Insert text[0..length) before position [pos]
+ * @return: false if [pos] is out of range or the allocation failed
+ */
+bool CString_piece_table_insert(CStringPieceTable *table, size_t pos, const char *text, size_t length);
+
+/**
+ * @brief: Erase [length] chars starting at [pos], clamped to the end of the text
+ */
+void CString_piece_table_erase(CStringPieceTable *table, size_t pos, size_t length);
+
+/**
+ * @brief: Replace [length] chars at [pos] by text[0..text_length)
+ */
+bool CString_piece_table_replace(CStringPieceTable *table, size_t pos, size_t length, const char *text, size_t text_length);
+
+/**
+ * @return: the char at [pos], or '\0' if it is out of range
+ */
+char CString_piece_table_char_at(const CStringPieceTable *table, size_t pos);
+
+/**
+ * @brief: call [callback] with each piece of the text in order, as a view into the table
+ * @return: #pieces
+ */
+size_t CString_piece_table_for_each_chunk(const CStringPieceTable *table, void (*callback)(CStringView chunk, void *context), void *context);
+
+/**
+ * @brief: Flatten the text into a new CString
+ */
+CString CString_piece_table_to_CString(const CStringPieceTable *table);
@@ -0,0 +1,456 @@
+#include "cstring_simd.h"
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define CSTRING_X64     //SSE2 is always there on x64
+#include <immintrin.h>
+#endif
+
+#if defined(__GNUC__)
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_AVX2
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+static unsigned lowest_bit(uint32_t mask) { unsigned long index; _BitScanForward(&index, mask); return index; }
+static unsigned highest_bit(uint32_t mask) { unsigned long index; _BitScanReverse(&index, mask); return index; }
+#else
+static unsigned lowest_bit(uint32_t mask) { return __builtin_ctz(mask); }
+static unsigned highest_bit(uint32_t mask) { return 31 - __builtin_clz(mask); }
+#endif
+
+static int current_level = -1;
+
+static CSTRING_SIMD_LEVEL detect_level()
+{
+#ifdef CSTRING_X64
+#if defined(__GNUC__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return CString_simd_avx2;
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    const bool os_saves_ymm = (info[2] & (1 << 27)) && (_xgetbv(0) & 6) == 6;
+    __cpuidex(info, 7, 0);
+    if (os_saves_ymm && (info[1] & (1 << 5)))
+        return CString_simd_avx2;
+#endif
+    return CString_simd_sse2;
+#else
+    return CString_simd_scalar;
+#endif
+}
+
+static CSTRING_SIMD_LEVEL simd_level()
+{
+    if (current_level < 0)
+        current_level = detect_level();
+    return (CSTRING_SIMD_LEVEL)current_level;
+}
+
+CSTRING_SIMD_LEVEL cstring_set_simd_level(CSTRING_SIMD_LEVEL level)
+{
+    const CSTRING_SIMD_LEVEL supported = detect_level();
+    current_level = level < supported ? level : supported;
+    return (CSTRING_SIMD_LEVEL)current_level;
+}
+
+/**
+ * @brief: Internal struct, a set of chars prepared for the searching kernels
+ * A byte b is in the set iff (low_table[b & 0xF] & high_table[b >> 4]) != 0, as long as the chars of the set have
+ * no more than 8 different high nibbles: each high nibble gets its own bit. This is looked up 32 bytes at a time with vpshufb
+ */
+typedef struct char_set_t
+{
+    bool member[256];
+    unsigned char chars[8];     //the distinct chars, if there are no more than 8 of them
+    size_t count;
+    bool has_nibble_tables;
+    uint8_t low_table[16];
+    uint8_t high_table[16];
+}CharSet;
+
+static void make_char_set(CharSet* set, const char* chars)
+{
+    memset(set, 0, sizeof(CharSet));
+    int high_nibble_bit[16];
+    int high_nibbles = 0;
+    for (int i = 0; i < 16; ++i)
+        high_nibble_bit[i] = -1;
+    set->has_nibble_tables = true;
+    for (; *chars; ++chars)
+    {
+        const unsigned char c = (unsigned char)*chars;
+        if (set->member[c])
+            continue;
+        set->member[c] = true;
+        if (set->count < 8)
+            set->chars[set->count] = c;
+        ++set->count;
+
+        const int high = c >> 4;
+        if (high_nibble_bit[high] < 0)
+        {
+            if (high_nibbles == 8)
+            {
+                set->has_nibble_tables = false;
+                continue;
+            }
+            high_nibble_bit[high] = high_nibbles++;
+        }
+        set->high_table[high] = (uint8_t)(1u << high_nibble_bit[high]);
+        set->low_table[c & 0xF] |= (uint8_t)(1u << high_nibble_bit[high]);
+    }
+}
+
+/*Scalar*/
+static size_t count_scalar(const char* data, size_t length, char c)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < length; ++i)
+        count += data[i] == c;
+    return count;
+}
+
+static void case_scalar(char* data, size_t length, bool upper)
+{
+    const char first = upper ? 'a' : 'A';
+    for (size_t i = 0; i < length; ++i)
+    {
+        if ((unsigned char)(data[i] - first) < 26)
+            data[i] ^= 0x20;
+    }
+}
+
+static size_t find_first_scalar(const char* data, size_t length, const CharSet* set)
+{
+    for (size_t i = 0; i < length; ++i)
+    {
+        if (set->member[(unsigned char)data[i]])
+            return i;
+    }
+    return length;
+}
+
+/*@return the index, or SIZE_MAX if there is none */
+static size_t find_last_scalar(const char* data, size_t length, const CharSet* set)
+{
+    while (length--)
+    {
+        if (set->member[(unsigned char)data[length]])
+            return length;
+    }
+    return SIZE_MAX;
+}
+
+
+/*memchr() is vectorized in every libc, so use it to look for the first char */
+static size_t find_substring_scalar(const char* data, size_t length, const char* needle, size_t needle_length)
+{
+    if (needle_length > length)
+        return length;
+    const char* const end = data + length - needle_length + 1;
+    for (const char* current = data; current < end; ++current)
+    {
+        current = memchr(current, needle[0], end - current);
+        if (current == NULL)
+            break;
+        if (memcmp(current + 1, needle + 1, needle_length - 1) == 0)
+            return current - data;
+    }
+    return length;
+}
+
+#ifdef CSTRING_X64
+/*SSE2*/
+static size_t count_sse2(const char* data, size_t length, char c)
+{
+    const __m128i needle = _mm_set1_epi8(c);
+    size_t count = 0;
+    size_t i = 0;
+    while (i + 16 <= length)
+    {
+        /*each matching byte subtracts -1 from its byte counter, which overflows after 255 rounds,
+         * so sum the counters up with psadbw before that */
+        size_t rounds = (length - i) / 16;
+        if (rounds > 255)
+            rounds = 255;
+        __m128i counters = _mm_setzero_si128();
+        for (size_t round = 0; round < rounds; ++round, i += 16)
+            counters = _mm_sub_epi8(counters, _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(data + i)), needle));
+        const __m128i sums = _mm_sad_epu8(counters, _mm_setzero_si128());
+        count += (size_t)_mm_cvtsi128_si32(sums) + (size_t)_mm_extract_epi16(sums, 4);
+    }
+    return count + count_scalar(data + i, length - i, c);
+}
+
+static void case_sse2(char* data, size_t length, bool upper)
+{
+    /*there is no unsigned byte compare, so shift the letters to -128..-103 and compare signed */
+    const char first = upper ? 'a' : 'A';
+    const __m128i shift = _mm_set1_epi8((char)(0x80 - first));
+    const __m128i bound = _mm_set1_epi8((char)(-128 + 26));
+    const __m128i flip = _mm_set1_epi8(0x20);
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16)
+    {
+        const __m128i bytes = _mm_loadu_si128((const __m128i*)(data + i));
+        const __m128i is_letter = _mm_cmplt_epi8(_mm_add_epi8(bytes, shift), bound);
+        _mm_storeu_si128((__m128i*)(data + i), _mm_xor_si128(bytes, _mm_and_si128(is_letter, flip)));
+    }
+    case_scalar(data + i, length - i, upper);
+}
+
+/*Without pshufb, compare against each char of a small set */
+static uint32_t match_mask_sse2(const char* data, const CharSet* set)
+{
+    const __m128i bytes = _mm_loadu_si128((const __m128i*)data);
+    __m128i matched = _mm_setzero_si128();
+    for (size_t i = 0; i < set->count; ++i)
+        matched = _mm_or_si128(matched, _mm_cmpeq_epi8(bytes, _mm_set1_epi8((char)set->chars[i])));
+    return (uint32_t)_mm_movemask_epi8(matched);
+}
+
+static size_t find_first_sse2(const char* data, size_t length, const CharSet* set)
+{
+    if (set->count > 8)
+        return find_first_scalar(data, length, set);
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16)
+    {
+        const uint32_t mask = match_mask_sse2(data + i, set);
+        if (mask)
+            return i + lowest_bit(mask);
+    }
+    return i + find_first_scalar(data + i, length - i, set);
+}
+
+static size_t find_last_sse2(const char* data, size_t length, const CharSet* set)
+{
+    if (set->count > 8)
+        return find_last_scalar(data, length, set);
+    size_t i = length;
+    while (i >= 16)
+    {
+        i -= 16;
+        const uint32_t mask = match_mask_sse2(data + i, set);
+        if (mask)
+            return i + highest_bit(mask);
+    }
+    return find_last_scalar(data, i, set);
+}
+
+/*Compare a block against the first char of the needle and the block [needle_length - 1] bytes later against the last one.
+ * Only the positions where both match are compared fully, which is rare unless the text is very repetitive
+ */
+static size_t find_substring_sse2(const char* data, size_t length, const char* needle, size_t needle_length)
+{
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[needle_length - 1]);
+    size_t i = 0;
+    for (; i + needle_length - 1 + 16 <= length; i += 16)
+    {
+        const __m128i block_first = _mm_loadu_si128((const __m128i*)(data + i));
+        const __m128i block_last = _mm_loadu_si128((const __m128i*)(data + i + needle_length - 1));
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(block_first, first), _mm_cmpeq_epi8(block_last, last)));
+        for (; mask; mask &= mask - 1)
+        {
+            const size_t candidate = i + lowest_bit(mask);
+            if (needle_length <= 2 || memcmp(data + candidate + 1, needle + 1, needle_length - 2) == 0)
+                return candidate;
+        }
+    }
+    return i + find_substring_scalar(data + i, length - i, needle, needle_length);
+}
+
+/*AVX2*/
+TARGET_AVX2 static size_t count_avx2(const char* data, size_t length, char c)
+{
+    const __m256i needle = _mm256_set1_epi8(c);
+    size_t count = 0;
+    size_t i = 0;
+    while (i + 32 <= length)
+    {
+        size_t rounds = (length - i) / 32;
+        if (rounds > 255)
+            rounds = 255;
+        __m256i counters = _mm256_setzero_si256();
+        for (size_t round = 0; round < rounds; ++round, i += 32)
+            counters = _mm256_sub_epi8(counters, _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(data + i)), needle));
+        const __m256i sums = _mm256_sad_epu8(counters, _mm256_setzero_si256());
+        const __m128i sum = _mm_add_epi64(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+        count += (size_t)_mm_cvtsi128_si32(sum) + (size_t)_mm_extract_epi16(sum, 4);
+    }
+    return count + count_sse2(data + i, length - i, c);
+}
+
+TARGET_AVX2 static void case_avx2(char* data, size_t length, bool upper)
+{
+    const char first = upper ? 'a' : 'A';
+    const __m256i shift = _mm256_set1_epi8((char)(0x80 - first));
+    const __m256i bound = _mm256_set1_epi8((char)(-128 + 26));
+    const __m256i flip = _mm256_set1_epi8(0x20);
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32)
+    {
+        const __m256i bytes = _mm256_loadu_si256((const __m256i*)(data + i));
+        const __m256i is_letter = _mm256_cmpgt_epi8(bound, _mm256_add_epi8(bytes, shift));
+        _mm256_storeu_si256((__m256i*)(data + i), _mm256_xor_si256(bytes, _mm256_and_si256(is_letter, flip)));
+    }
+    case_sse2(data + i, length - i, upper);
+}
+
+TARGET_AVX2 static uint32_t match_mask_avx2(const char* data, __m256i low_table, __m256i high_table)
+{
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    const __m256i bytes = _mm256_loadu_si256((const __m256i*)data);
+    const __m256i low = _mm256_shuffle_epi8(low_table, _mm256_and_si256(bytes, nibble));
+    const __m256i high = _mm256_shuffle_epi8(high_table, _mm256_and_si256(_mm256_srli_epi16(bytes, 4), nibble));
+    const __m256i not_matched = _mm256_cmpeq_epi8(_mm256_and_si256(low, high), _mm256_setzero_si256());
+    return ~(uint32_t)_mm256_movemask_epi8(not_matched);
+}
+
+TARGET_AVX2 static size_t find_first_avx2(const char* data, size_t length, const CharSet* set)
+{
+    if (!set->has_nibble_tables)
+        return find_first_sse2(data, length, set);
+    /*vpshufb looks up each 128 bit lane separately, so both lanes need the table */
+    const __m256i low_table = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)set->low_table));
+    const __m256i high_table = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)set->high_table));
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32)
+    {
+        const uint32_t mask = match_mask_avx2(data + i, low_table, high_table);
+        if (mask)
+            return i + lowest_bit(mask);
+    }
+    return i + find_first_scalar(data + i, length - i, set);
+}
+
+TARGET_AVX2 static size_t find_last_avx2(const char* data, size_t length, const CharSet* set)
+{
+    if (!set->has_nibble_tables)
+        return find_last_sse2(data, length, set);
+    const __m256i low_table = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)set->low_table));
+    const __m256i high_table = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)set->high_table));
+    size_t i = length;
+    while (i >= 32)
+    {
+        i -= 32;
+        const uint32_t mask = match_mask_avx2(data + i, low_table, high_table);
+        if (mask)
+            return i + highest_bit(mask);
+    }
+    return find_last_scalar(data, i, set);
+}
+TARGET_AVX2 static size_t find_substring_avx2(const char* data, size_t length, const char* needle, size_t needle_length)
+{
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last = _mm256_set1_epi8(needle[needle_length - 1]);
+    size_t i = 0;
+    for (; i + needle_length - 1 + 32 <= length; i += 32)
+    {
+        const __m256i block_first = _mm256_loadu_si256((const __m256i*)(data + i));
+        const __m256i block_last = _mm256_loadu_si256((const __m256i*)(data + i + needle_length - 1));
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(block_first, first), _mm256_cmpeq_epi8(block_last, last)));
+        for (; mask; mask &= mask - 1)
+        {
+            const size_t candidate = i + lowest_bit(mask);
+            if (needle_length <= 2 || memcmp(data + candidate + 1, needle + 1, needle_length - 2) == 0)
+                return candidate;
+        }
+    }
+    return i + find_substring_sse2(data + i, length - i, needle, needle_length);
+}
+#endif
+
+size_t cstring_count_char(const char* data, size_t length, char c)
+{
+    switch (simd_level())
+    {
+#ifdef CSTRING_X64
+    case CString_simd_avx2:
+        return count_avx2(data, length, c);
+    case CString_simd_sse2:
+        return count_sse2(data, length, c);
+#endif
+    default:
+        return count_scalar(data, length, c);
+    }
+}
+
+void cstring_ascii_case(char* data, size_t length, bool upper)
+{
+    switch (simd_level())
+    {
+#ifdef CSTRING_X64
+    case CString_simd_avx2:
+        case_avx2(data, length, upper);
+        return;
+    case CString_simd_sse2:
+        case_sse2(data, length, upper);
+        return;
+#endif
+    default:
+        case_scalar(data, length, upper);
+    }
+}
+
+size_t cstring_find_first_of(const char* data, size_t length, const char* set)
+{
+    CharSet chars;
+    make_char_set(&chars, set);
+    switch (simd_level())
+    {
+#ifdef CSTRING_X64
+    case CString_simd_avx2:
+        return find_first_avx2(data, length, &chars);
+    case CString_simd_sse2:
+        return find_first_sse2(data, length, &chars);
+#endif
+    default:
+        return find_first_scalar(data, length, &chars);
+    }
+}
+
+size_t cstring_find_last_of(const char* data, size_t length, const char* set)
+{
+    CharSet chars;
+    make_char_set(&chars, set);
+    size_t index;
+    switch (simd_level())
+    {
+#ifdef CSTRING_X64
+    case CString_simd_avx2:
+        index = find_last_avx2(data, length, &chars);
+        break;
+    case CString_simd_sse2:
+        index = find_last_sse2(data, length, &chars);
+        break;
+#endif
+    default:
+        index = find_last_scalar(data, length, &chars);
+    }
+    return index == SIZE_MAX ? length : index;
+}
+
+size_t cstring_find_substring(const char* data, size_t length, const char* needle, size_t needle_length)
+{
+    if (needle_length == 0)
+        return 0;
+    switch (simd_level())
+    {
+#ifdef CSTRING_X64
+    case CString_simd_avx2:
+        return find_substring_avx2(data, length, needle, needle_length);
+    case CString_simd_sse2:
+        return find_substring_sse2(data, length, needle, needle_length);
+#endif
+    default:
+        return find_substring_scalar(data, length, needle, needle_length);
+    }
+}
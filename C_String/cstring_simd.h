@@ -0,0 +1,47 @@
+/* Description: Vectorized byte kernels used by cstring.c
+* Each function has a scalar, an SSE2 and an AVX2 version, the best one supported by the CPU is picked at runtime.
+*/
+#pragma once
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef enum CSTRING_SIMD_LEVEL
+{
+    CString_simd_scalar,
+    CString_simd_sse2,
+    CString_simd_avx2,
+}CSTRING_SIMD_LEVEL;
+
+/**
+ * @brief: Limit the kernels to [level], eg. for benchmarking. Levels not supported by the CPU are ignored
+ * @return: the level actually used
+ */
+CSTRING_SIMD_LEVEL cstring_set_simd_level(CSTRING_SIMD_LEVEL level);
+
+/**
+ * @brief: count #times [c] appears in data[0..length)
+ */
+size_t cstring_count_char(const char *data, size_t length, char c);
+
+/**
+ * @brief: convert ASCII letters in data[0..length) to upper or lower case in place, other bytes are unchanged
+ */
+void cstring_ascii_case(char *data, size_t length, bool upper);
+
+/**
+ * @brief: find the first byte in data[0..length) that is one of the chars in the null terminated [set]
+ * @return: its index, or [length] if there is none
+ */
+size_t cstring_find_first_of(const char *data, size_t length, const char *set);
+
+/**
+ * @brief: find the last byte in data[0..length) that is one of the chars in the null terminated [set]
+ * @return: its index, or [length] if there is none
+ */
+size_t cstring_find_last_of(const char *data, size_t length, const char *set);
+
+/**
+ * @brief: find the first occurrence of needle[0..needle_length) in data[0..length)
+ * @return: its index, or [length] if there is none. An empty needle is found at 0
+ */
+size_t cstring_find_substring(const char *data, size_t length, const char *needle, size_t needle_length);
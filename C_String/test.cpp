@@ -1,6 +1,601 @@
-extern "C" {
-    #include "cstring.h"
-}
+#include "cstring_cpp.h"
 
 #include <gtest/gtest.h>
+#include <string>
+#include <string_view>
+#include <algorithm>
+#include <vector>
+#include <charconv>
+#include <limits>
+#include <cmath>
+#include <cstring>
+
+TEST(CString, LengthOfSmallString)
+{
+    CString str = new_CString("Hello world");
+    EXPECT_TRUE(str.is_small);
+    EXPECT_EQ(str.public_->length(&str), 11u);
+    EXPECT_FALSE(str.public_->empty(&str));
+    delete_CString(&str);
+
+    CString empty = empty_CString();
+    EXPECT_EQ(empty.public_->length(&empty), 0u);
+    EXPECT_TRUE(empty.public_->empty(&empty));
+}
+
+TEST(CString, AppendCharFromSmallToLong)
+{
+    CString str = empty_CString();
+    std::string expected;
+    for (int i = 0; i < 1000; ++i)
+    {
+        const char c = 'a' + i % 26;
+        str.public_->append_char(&str, c);
+        expected.push_back(c);
+        ASSERT_EQ(str.public_->length(&str), expected.size());
+    }
+    EXPECT_FALSE(str.is_small);
+    EXPECT_STREQ(str.data.impl.ptr, expected.c_str());
+    EXPECT_LT(str.public_->bytes(&str), 2 * expected.size());  //grows geometrically, but not too much
+    delete_CString(&str);
+}
+
+TEST(CString, AppendString)
+{
+    CString str = new_CString("Hello");
+    str.public_->append_string(&str, const_cast<char*>(" world, this is a longer string"));
+    EXPECT_STREQ(str.data.impl.ptr, "Hello world, this is a longer string");
+    EXPECT_EQ(str.public_->length(&str), 36u);
+    delete_CString(&str);
+}
+
+TEST(CString, ResizeTruncates)
+{
+    CString str = new_CString("A string that is longer than the small buffer");
+    str.public_->resize(&str, 9);
+    EXPECT_TRUE(str.is_small);
+    EXPECT_STREQ(str.data.small_string, "A string");
+    EXPECT_EQ(str.public_->length(&str), 8u);
+    delete_CString(&str);
+}
+
+class CStringSimd : public ::testing::TestWithParam<CSTRING_SIMD_LEVEL>
+{
+protected:
+    void SetUp() override { cstring_set_simd_level(GetParam()); }
+    void TearDown() override { cstring_set_simd_level(CString_simd_avx2); }
+};
+
+static std::string random_text(size_t length, unsigned seed)
+{
+    std::string text(length, ' ');
+    for (auto& c : text)
+    {
+        seed = seed * 1103515245 + 12345;
+        c = static_cast<char>(1 + (seed >> 16) % 255);  //no '\0'
+    }
+    return text;
+}
+
+TEST_P(CStringSimd, CountChar)
+{
+    for (size_t length : { 0, 1, 15, 16, 33, 1000, 20000 })
+    {
+        const auto text = random_text(length, static_cast<unsigned>(length));
+        for (char c : { 'a', '\x80', '\xff' })
+            EXPECT_EQ(cstring_count_char(text.data(), text.size(), c), static_cast<size_t>(std::count(text.begin(), text.end(), c)));
+    }
+    const std::string same(100000, 'x');    //more than 255 rounds of byte counters
+    EXPECT_EQ(cstring_count_char(same.data(), same.size(), 'x'), same.size());
+}
+
+TEST_P(CStringSimd, AsciiCase)
+{
+    const auto text = random_text(1001, 42);
+    auto upper = text;
+    auto lower = text;
+    cstring_ascii_case(upper.data(), upper.size(), true);
+    cstring_ascii_case(lower.data(), lower.size(), false);
+    for (size_t i = 0; i < text.size(); ++i)
+    {
+        const unsigned char c = text[i];
+        EXPECT_EQ(upper[i], c >= 'a' && c <= 'z' ? static_cast<char>(c - 32) : text[i]);
+        EXPECT_EQ(lower[i], c >= 'A' && c <= 'Z' ? static_cast<char>(c + 32) : text[i]);
+    }
+}
+
+TEST_P(CStringSimd, FindFirstAndLastOf)
+{
+    const auto text = random_text(5000, 7);
+    //few chars, many chars, and more than 8 different high nibbles
+    for (const char* set : { ",", "aeiou", " \t\r\n,;", "\x01\x11\x21\x31\x41\x51\x61\x71\x81\x91\xa1", "" })
+    {
+        for (size_t length : { 0, 10, 31, 64, 5000 })
+        {
+            const std::string_view view{ text.data(), length };
+            const auto first = view.find_first_of(set);
+            const auto last = view.find_last_of(set);
+            EXPECT_EQ(cstring_find_first_of(text.data(), length, set), first == view.npos ? length : first);
+            EXPECT_EQ(cstring_find_last_of(text.data(), length, set), last == view.npos ? length : last);
+        }
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(Levels, CStringSimd, ::testing::Values(CString_simd_scalar, CString_simd_sse2, CString_simd_avx2));
+
+TEST(CString, FindFirstOfAndCount)
+{
+    CString str = new_CString("key=value; other key=1; last");
+    EXPECT_EQ(str.public_->count_occurrence(&str, '='), 2u);
+    EXPECT_EQ(str.public_->count_occurrence(&str, 'k'), 2u);
+    EXPECT_EQ(str.public_->find_first_of(&str, const_cast<char*>(";=")), 3u);
+    EXPECT_EQ(str.public_->find_last_of(&str, const_cast<char*>(";=")), 22u);
+    EXPECT_EQ(str.public_->find_first_of_after_pos(&str, const_cast<char*>(";"), 10), 22u);
+    EXPECT_EQ(str.public_->find_last_of_before_pos(&str, const_cast<char*>("="), 19), 3u);
+    EXPECT_EQ(str.public_->find_first_of(&str, const_cast<char*>("#")), CString_npos);
+    str.public_->to_upper(&str);
+    EXPECT_STREQ(str.data.impl.ptr, "KEY=VALUE; OTHER KEY=1; LAST");
+    delete_CString(&str);
+}
+
+TEST_P(CStringSimd, FindSubstring)
+{
+    auto text = random_text(3000, 3);
+    text.replace(2000, 3, "a,b");
+    for (const std::string& needle : std::vector<std::string>{ "a,b", ",", "xyzw", text.substr(100, 40), text.substr(2950, 50), "" })
+    {
+        for (size_t length : { 0, 2, 40, 2002, 2003, 3000 })
+        {
+            const auto expected = std::string_view{ text.data(), length }.find(needle);
+            EXPECT_EQ(cstring_find_substring(text.data(), length, needle.data(), needle.size()), expected == std::string_view::npos ? length : expected);
+        }
+    }
+    const std::string repetitive(1000, 'a');    //every position is a candidate
+    EXPECT_EQ(cstring_find_substring(repetitive.data(), repetitive.size(), "aab", 3), repetitive.size());
+}
+
+static std::vector<std::string> split_tokens(CString& str, const char* delim)
+{
+    std::vector<std::string> tokens;
+    auto tokenizer = CString_tokenize(&str, delim);
+    CStringView token;
+    while (CString_next_token(&tokenizer, &token))
+        tokens.emplace_back(token.ptr, token.length);
+    return tokens;
+}
+
+TEST(CString, TokenizeKeepsEmptyAndLastTokens)
+{
+    CString str = new_CString("a,,b,");
+    EXPECT_EQ(split_tokens(str, ","), (std::vector<std::string>{ "a", "", "b", "" }));
+    EXPECT_EQ(split_tokens(str, ",,"), (std::vector<std::string>{ "a", "b," }));
+    EXPECT_EQ(split_tokens(str, ""), (std::vector<std::string>{ "a,,b," }));
+    delete_CString(&str);
+
+    CString csv = new_CString("name::age::city::a much longer field than the small buffer::last");
+    EXPECT_EQ(split_tokens(csv, "::"), (std::vector<std::string>{ "name", "age", "city", "a much longer field than the small buffer", "last" }));
+    delete_CString(&csv);
+}
+
+TEST(CString, SplitAllocating)
+{
+    CString str = new_CString("one two  three");
+    int n = 0;
+    CString* tokens = str.public_->split_by_char(&str, ' ', &n);
+    ASSERT_EQ(n, 4);
+    EXPECT_STREQ(tokens[0].data.small_string, "one");
+    EXPECT_EQ(tokens[2].public_->length(&tokens[2]), 0u);
+    EXPECT_STREQ(tokens[3].data.small_string, "three");
+    for (int i = 0; i < n; ++i)
+        delete_CString(&tokens[i]);
+    free(tokens);
+
+    CString delim = new_CString("  ");
+    tokens = str.public_->split_by_cstring(&str, &delim, &n);
+    ASSERT_EQ(n, 2);
+    EXPECT_STREQ(tokens[0].data.small_string, "one two");
+    EXPECT_STREQ(tokens[1].data.small_string, "three");
+    for (int i = 0; i < n; ++i)
+        delete_CString(&tokens[i]);
+    free(tokens);
+    delete_CString(&delim);
+    delete_CString(&str);
+}
+
+TEST(CString, ForEachToken)
+{
+    CString str = new_CString("1;22;333;4444");
+    size_t total_length = 0;
+    const auto count = str.public_->for_each_token(&str, const_cast<char*>(";"), [](CStringView token, void* context)
+    {
+        *static_cast<size_t*>(context) += token.length;
+    }, &total_length);
+    EXPECT_EQ(count, 4u);
+    EXPECT_EQ(total_length, 10u);
+    delete_CString(&str);
+}
+
+TEST(CString, LineReader)
+{
+    const std::string long_line(100, 'x');  //longer than the buffer, so it has to grow
+    FILE* f = tmpfile();
+    ASSERT_NE(f, nullptr);
+    fputs("first\n\nwindows\r\n", f);
+    fputs(long_line.c_str(), f);
+    fputs("\nno newline at the end", f);
+    rewind(f);
+
+    CStringLineReader reader = CString_line_reader(f, 16);
+    std::vector<std::string> lines;
+    CStringView line;
+    while (CString_read_line_view(&reader, &line))
+        lines.emplace_back(line.ptr, line.length);
+    EXPECT_EQ(lines, (std::vector<std::string>{ "first", "", "windows", long_line, "no newline at the end" }));
+    EXPECT_FALSE(CString_read_line_view(&reader, &line));
+    CString_close_line_reader(&reader);
+
+    rewind(f);  //the reader does not close a FILE it did not open
+    CString first = line_to_CString(f);
+    CString second = line_to_CString(f);
+    EXPECT_STREQ(first.data.small_string, "first");
+    EXPECT_EQ(second.public_->length(&second), 0u);
+    delete_CString(&first);
+    delete_CString(&second);
+    fclose(f);
+}
+
+TEST(CString, SerializeToOneStream)
+{
+    FILE* f = tmpfile();
+    ASSERT_NE(f, nullptr);
+    CString small = new_CString("Hello world");
+    CString large = new_CString(std::string(300, 'z').c_str());
+    EXPECT_TRUE(small.public_->serialize(&small, f));   //does not close [f] anymore
+    EXPECT_TRUE(large.public_->serialize(&large, f));
+    rewind(f);
+    CString small2 = CString_deserialize(f);
+    CString large2 = CString_deserialize(f);
+    EXPECT_TRUE(small2.public_->is_equal(&small, &small2));
+    EXPECT_TRUE(large2.public_->is_equal(&large, &large2));
+    EXPECT_EQ(large2.public_->length(&large2), 300u);
+    for (CString* str : { &small, &large, &small2, &large2 })
+        delete_CString(str);
+    fclose(f);
+}
 
+TEST(CString, SerializeArray)
+{
+    std::vector<CString> strings;
+    for (const char* s : { "", "a", "a string longer than the small string buffer", "last" })
+        strings.push_back(new_CString(s));
+    FILE* f = tmpfile();
+    ASSERT_NE(f, nullptr);
+    ASSERT_TRUE(CString_serialize_array(strings.data(), strings.size(), f));
+    ASSERT_TRUE(CString_serialize_array(strings.data(), 2, f));
+    rewind(f);
+    for (size_t expected_count : { strings.size(), size_t{ 2 } })
+    {
+        size_t count = 0;
+        CString* read = CString_deserialize_array(f, &count);
+        ASSERT_NE(read, nullptr);
+        ASSERT_EQ(count, expected_count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            EXPECT_TRUE(read[i].public_->is_equal(&read[i], &strings[i]));
+            delete_CString(&read[i]);
+        }
+        free(read);
+    }
+
+    /*flip a byte of a string, the checksum no longer matches */
+    rewind(f);
+    fseek(f, 12, SEEK_SET);
+    fputc('#', f);
+    rewind(f);
+    size_t count = 0;
+    EXPECT_EQ(CString_deserialize_array(f, &count), nullptr);
+    EXPECT_EQ(count, 0u);
+    fclose(f);
+    for (auto& str : strings)
+        delete_CString(&str);
+}
+
+TEST(CString, MapArray)
+{
+    const char* name = "map_array_test.bin";
+    std::vector<CString> strings;
+    for (int i = 0; i < 1000; ++i)
+        strings.push_back(new_CString(std::string(i % 50, 'a' + i % 26).c_str()));
+    FILE* f = fopen(name, "wb");
+    ASSERT_NE(f, nullptr);
+    ASSERT_TRUE(CString_serialize_array(strings.data(), strings.size(), f));
+    fclose(f);
+
+    CStringMappedArray mapped;
+    ASSERT_TRUE(CString_map_array(const_cast<char*>(name), &mapped));
+    ASSERT_EQ(mapped.count, strings.size());
+    for (size_t i = 0; i < mapped.count; ++i)
+    {
+        const CStringView view = CString_view(&strings[i]);
+        EXPECT_EQ(std::string_view(mapped.views[i].ptr, mapped.views[i].length), std::string_view(view.ptr, view.length));
+    }
+    CString_unmap_array(&mapped);
+    EXPECT_EQ(mapped.views, nullptr);
+    remove(name);
+    for (auto& str : strings)
+        delete_CString(&str);
+}
+
+/*a varint of UINT64_MAX, the length or payload size of a corrupt file*/
+static const unsigned char max_varint[] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x01 };
+
+TEST(CString, DeserializeRejectsHugeLength)
+{
+    FILE* f = tmpfile();
+    ASSERT_NE(f, nullptr);
+    fwrite(max_varint, 1, sizeof(max_varint), f);
+    fputs(std::string(100, 'x').c_str(), f);
+    rewind(f);
+    CString str = CString_deserialize(f);
+    EXPECT_EQ(str.public_->length(&str), 0u);
+    delete_CString(&str);
+    fclose(f);
+}
+
+TEST(CString, MapArrayRejectsHugePayloadSize)
+{
+    const char* name = "map_array_huge_test.bin";
+    /*an empty array is the magic and version, n = 0, payload size = 0 and the checksum*/
+    FILE* f = tmpfile();
+    ASSERT_NE(f, nullptr);
+    ASSERT_TRUE(CString_serialize_array(nullptr, 0, f));
+    const long empty_size = ftell(f);
+    std::vector<unsigned char> header(static_cast<size_t>(empty_size) - 2 - 4);
+    rewind(f);
+    ASSERT_EQ(fread(header.data(), 1, header.size(), f), header.size());
+    fclose(f);
+
+    f = fopen(name, "wb");
+    ASSERT_NE(f, nullptr);
+    fwrite(header.data(), 1, header.size(), f);
+    fputc(0, f);
+    fwrite(max_varint, 1, sizeof(max_varint), f);
+    fputs(std::string(100, 'x').c_str(), f);
+    fclose(f);
+
+    CStringMappedArray mapped;
+    EXPECT_FALSE(CString_map_array(const_cast<char*>(name), &mapped));
+    EXPECT_EQ(mapped.views, nullptr);
+    remove(name);
+}
+
+TEST(CString, InternReturnsTheSameHandle)
+{
+    CStringInternPool pool = CString_intern_pool();
+    CString a = new_CString("a repeated string, longer than the small buffer");
+    CString b = new_CString("a repeated string, longer than the small buffer");
+    CString c = new_CString("another one");
+    CStringHandle handle_a = CString_intern(&pool, &a);
+    EXPECT_EQ(CString_intern(&pool, &b), handle_a);
+    EXPECT_NE(CString_intern(&pool, &c), handle_a);
+    EXPECT_STREQ(handle_a->data, "a repeated string, longer than the small buffer");
+
+    /*growing the table and the arena does not move the strings */
+    std::vector<CStringHandle> handles;
+    for (int i = 0; i < 20000; ++i)
+        handles.push_back(CString_intern_view(&pool, CStringView{ std::to_string(i).c_str(), std::to_string(i).size() }));
+    const std::string huge(100000, 'h');    //larger than an arena block
+    CStringHandle huge_handle = CString_intern_view(&pool, CStringView{ huge.data(), huge.size() });
+    for (int i = 0; i < 20000; ++i)
+    {
+        const auto text = std::to_string(i);
+        ASSERT_EQ(CString_intern_find(&pool, CStringView{ text.data(), text.size() }), handles[i]);
+        ASSERT_EQ(std::string_view(handles[i]->data, handles[i]->length), text);
+    }
+    EXPECT_EQ(CString_intern_find(&pool, CStringView{ huge.data(), huge.size() }), huge_handle);
+    EXPECT_EQ(CString_intern_find(&pool, CStringView{ "not interned", 12 }), nullptr);
+    EXPECT_EQ(CString_intern(&pool, &a), handle_a);
+
+    const auto stats = CString_intern_stats(&pool);
+    EXPECT_EQ(stats.unique_strings, 20000u + 3u);
+    EXPECT_EQ(stats.intern_calls, 20000u + 5u);
+    EXPECT_EQ(stats.bytes_requested - stats.bytes_unique, 2 * a.public_->length(&a));
+    CString_delete_intern_pool(&pool);
+    for (CString* str : { &a, &b, &c })
+        delete_CString(str);
+}
+
+TEST(CString, HashIsDeterministicAndSpreads)
+{
+    const std::string text = random_text(200, 5);
+    for (size_t length = 0; length <= text.size(); ++length)
+    {
+        EXPECT_EQ(CString_hash(text.data(), length, 0), CString_hash(std::string(text, 0, length).data(), length, 0));
+        if (length)
+        {
+            EXPECT_NE(CString_hash(text.data(), length, 0), CString_hash(text.data(), length - 1, 0));
+        }
+    }
+}
+
+TEST(CString, FindAndReplace)
+{
+    CString str = new_CString("one fish, two fish, red fish, blue fish");
+    EXPECT_EQ(str.public_->find(&str, const_cast<char*>("fish")), 4u);
+    EXPECT_EQ(str.public_->find(&str, const_cast<char*>("blue fish")), 30u);   //a match at the very end
+    EXPECT_EQ(str.public_->find(&str, const_cast<char*>("cat")), CString_npos);
+
+    str.public_->replace_string(&str, const_cast<char*>("one"), const_cast<char*>("1"));
+    EXPECT_STREQ(str.data.impl.ptr, "1 fish, two fish, red fish, blue fish");
+    EXPECT_EQ(str.public_->find_and_replace(&str, const_cast<char*>("fish"), const_cast<char*>("whale")), 4u);
+    EXPECT_STREQ(str.data.impl.ptr, "1 whale, two whale, red whale, blue whale");
+    EXPECT_EQ(str.public_->find_and_replace(&str, const_cast<char*>(" whale"), const_cast<char*>("")), 4u);
+    const CStringView view = CString_view(&str);
+    EXPECT_EQ(std::string_view(view.ptr, view.length), "1, two, red, blue");
+    delete_CString(&str);
+
+    /*the replacement is the string itself, whose buffer is reallocated by the replace*/
+    std::string expected = "a string longer than the small string buffer";
+    CString self = new_CString(expected.c_str());
+    self.public_->replace_string(&self, const_cast<char*>("small"), self.data.impl.ptr);
+    expected.replace(expected.find("small"), 5, std::string(expected));
+    EXPECT_STREQ(self.data.impl.ptr, expected.c_str());
+    delete_CString(&self);
+}
+
+/*every piece has a priority no smaller than its children's, and returns the depth of the treap*/
+static size_t checked_treap_depth(const CStringPieceTable& table, uint32_t piece)
+{
+    if (piece == 0)
+        return 0;
+    const CStringPiece& p = table.pieces[piece];
+    for (uint32_t child : { p.left, p.right })
+        EXPECT_TRUE(child == 0 || table.pieces[child].priority <= p.priority);
+    return 1 + std::max(checked_treap_depth(table, p.left), checked_treap_depth(table, p.right));
+}
+
+TEST(CString, PieceTableMatchesFlatEdits)
+{
+    CString original = new_CString(random_text(5000, 11).c_str());
+    CStringPieceTable table = CString_piece_table(&original);
+    const CStringView view = CString_view(&original);
+    std::string expected{ view.ptr, view.length };
+    unsigned seed = 1;
+    auto next = [&seed](size_t bound) { seed = seed * 1103515245 + 12345; return bound == 0 ? 0 : (seed >> 8) % bound; };
+    for (int i = 0; i < 3000; ++i)
+    {
+        const size_t pos = next(expected.size() + 1);
+        const std::string text(next(20), static_cast<char>('a' + i % 26));
+        switch (next(4))
+        {
+        case 0:
+        {
+            const size_t length = next(50);
+            CString_piece_table_erase(&table, pos, length);
+            if (pos < expected.size())
+                expected.erase(pos, length);
+            break;
+        }
+        case 1:
+        {
+            const size_t length = next(10);
+            ASSERT_TRUE(CString_piece_table_replace(&table, pos, length, text.data(), text.size()));
+            expected.replace(pos, length, text);
+            break;
+        }
+        default:    //typing: several inserts at consecutive positions
+            for (size_t j = 0; j < text.size(); ++j)
+                ASSERT_TRUE(CString_piece_table_insert(&table, pos + j, &text[j], 1));
+            expected.insert(pos, text);
+        }
+        ASSERT_EQ(CString_piece_table_length(&table), expected.size());
+    }
+    for (size_t pos = 0; pos < expected.size(); pos += 97)
+        ASSERT_EQ(CString_piece_table_char_at(&table, pos), expected[pos]);
+    EXPECT_EQ(CString_piece_table_char_at(&table, expected.size()), '\0');
+    EXPECT_FALSE(CString_piece_table_insert(&table, expected.size() + 1, "x", 1));
+    EXPECT_LT(checked_treap_depth(table, table.root), 100u);  //thousands of pieces, about 3 log2(n) deep in expectation
+
+    CString flat = CString_piece_table_to_CString(&table);
+    const CStringView flat_view = CString_view(&flat);
+    EXPECT_EQ(std::string_view(flat_view.ptr, flat_view.length), expected);
+    delete_CString(&flat);
+    CString_delete_piece_table(&table);
+    delete_CString(&original);
+}
+
+TEST(CString, AppendInt)
+{
+    CString str = empty_CString();
+    std::string expected;
+    for (int64_t value : { int64_t{ 0 }, int64_t{ 7 }, int64_t{ -42 }, int64_t{ 100 }, int64_t{ 99999 }, INT64_MAX, INT64_MIN, int64_t{ -1000000007 } })
+    {
+        str.public_->append_int(&str, value);
+        str.public_->append_char(&str, ' ');
+        expected += std::to_string(value) + ' ';
+    }
+    const CStringView view = CString_view(&str);
+    EXPECT_EQ(std::string_view(view.ptr, view.length), expected);
+    delete_CString(&str);
+}
+
+TEST(CString, AppendFloatFixed)
+{
+    for (double value : { 0.0, -0.0, 3.14159, -2.5, 0.125, 1e-7, 123456.789, -0.004, 1e300, 2.675 })
+    {
+        for (unsigned char digits : { 0, 1, 3, 6, 20 })
+        {
+            CString str = empty_CString();
+            str.public_->append_float(&str, value, digits);
+            char expected[400];
+            snprintf(expected, sizeof(expected), "%.*f", digits, value);
+            const CStringView view = CString_view(&str);
+            EXPECT_EQ(std::string_view(view.ptr, view.length), expected) << value << " " << int(digits);
+            delete_CString(&str);
+        }
+    }
+}
+
+static std::string format_double(double value)
+{
+    char buffer[CString_max_double_chars];
+    return std::string(buffer, cstring_format_double(buffer, value));
+}
+
+TEST(CString, AppendDoubleShortest)
+{
+    for (double value : { 0.0, -0.0, 1.0, 0.1, 0.3, 1.0 / 3, 100.0, 1e21, 1e22, 123456789012345680.0, 5e-324, 2.2250738585072014e-308,
+        1.7976931348623157e308, -12.5, 0.000001, 1e-7, 9007199254740993.0, 3.14159, 1e15, 1.5e16 })
+    {
+        char expected[64];
+        const auto result = std::to_chars(expected, expected + sizeof(expected), value);
+        EXPECT_EQ(format_double(value), std::string(expected, result.ptr)) << value;
+    }
+    EXPECT_EQ(format_double(std::numeric_limits<double>::infinity()), "inf");
+    EXPECT_EQ(format_double(-std::numeric_limits<double>::infinity()), "-inf");
+    EXPECT_EQ(format_double(std::numeric_limits<double>::quiet_NaN()), "nan");
+
+    /*random bit patterns: always reads back, and is almost always as short as std::to_chars */
+    uint64_t seed = 12345;
+    int tested = 0, shortest_count = 0;
+    for (int i = 0; i < 100000; ++i)
+    {
+        seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+        double value;
+        memcpy(&value, &seed, sizeof(value));
+        if (!std::isfinite(value))
+            continue;
+        const auto formatted = format_double(value);
+        ASSERT_EQ(std::strtod(formatted.c_str(), nullptr), value) << formatted;
+        char shortest[64];
+        const auto result = std::to_chars(shortest, shortest + sizeof(shortest), value);
+        ++tested;
+        shortest_count += formatted.size() == static_cast<size_t>(result.ptr - shortest);
+    }
+    EXPECT_GT(shortest_count, tested * 0.99);
+
+    CString str = new_CString("pi=");
+    str.public_->append_double(&str, 3.14159);
+    EXPECT_STREQ(str.data.small_string, "pi=3.14159");
+    delete_CString(&str);
+}
+
+TEST(CString, DirectCalls)
+{
+    CString str = new_CString("Hello");
+    EXPECT_EQ(CString_length(&str), str.public_->length(&str));
+    EXPECT_EQ(CString_bytes(&str), str.public_->bytes(&str));
+    EXPECT_FALSE(CString_empty(&str));
+    CString_append_string(&str, (char*)" world, hello world");
+    CString_append_int(&str, 42);
+    EXPECT_FALSE(str.is_small);
+    EXPECT_STREQ(CString_data(&str), "Hello world, hello world42");
+    EXPECT_EQ(CString_length(&str), str.public_->length(&str));
+    EXPECT_EQ(CString_bytes(&str), str.public_->bytes(&str));
+    EXPECT_EQ(CString_find(&str, (char*)"hello"), 13u);
+    EXPECT_EQ(CString_find_and_replace(&str, (char*)"world", (char*)"there"), 2u);
+    EXPECT_STREQ(CString_data(&str), "Hello there, hello there42");
+    CString_resize(&str, 0);
+    EXPECT_TRUE(CString_empty(&str));
+    delete_CString(&str);
+}
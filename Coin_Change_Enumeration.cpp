@@ -11,6 +11,13 @@
 //Restriction: Use constant amount of memory for local variables and method parameters, so lists, stacks or queues are not allowed!
 
 #include <iostream>
+#include <tuple>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <chrono>
+#include "Memoize/Memoize.hpp"
+#include "BigUint/BigUint.hpp"
 
 enum Coins { penny = 1, nickel = 5, dime = 10, quarter = 25 };
 
@@ -32,7 +39,7 @@ void printResult(const picks& pick)
 
 void print_change(int change, picks pick, Coins last)
 {
-    if (change >= quarter && last == Coins::quarter)
+    if (last == Coins::quarter)
     {
         for (auto i = change / Coins::quarter; i >= 0; --i)
         {
@@ -41,7 +48,7 @@ void print_change(int change, picks pick, Coins last)
             print_change(change - i * Coins::quarter, temp, Coins::dime);
         }
     }
-    else if (change >= dime && last == Coins::dime)
+    else if (last == Coins::dime)
     {
         for (auto i = change / Coins::dime; i >= 0; --i)
         {
@@ -50,7 +57,7 @@ void print_change(int change, picks pick, Coins last)
             print_change(change - i * Coins::dime, temp, Coins::nickel);
         }
     }
-    else if (change >= nickel && last == Coins::nickel)
+    else if (last == Coins::nickel)
     {
         for (auto i = change / Coins::nickel; i >= 0; --i)
         {
@@ -66,10 +73,152 @@ void print_change(int change, picks pick, Coins last)
     }
 }
 
+/*Counting the ways uses the same recursion as print_change(), but many (change, coin) pairs are reached again and again,
+ * so cache them (see Memoize/Memoize.hpp)
+ */
+auto count_change_memo = memoize<flat_cache<std::tuple<int, int>, uint64_t>>([](auto& self, int change, int last) -> uint64_t
+{
+    if (last == Coins::penny)
+        return 1;
+    const int next = last == Coins::quarter ? Coins::dime : (last == Coins::dime ? Coins::nickel : Coins::penny);
+    uint64_t count = 0;
+    for (auto i = change / last; i >= 0; --i)
+        count += self(change - i * last, next);
+    return count;
+});
+
+uint64_t count_change(int change)
+{
+    return count_change_memo(change, static_cast<int>(Coins::quarter));
+}
+
+/*The recursion is not needed for counting: ways[a] = number of ways to pay a with the coins considered so far,
+ * adding one coin at a time, so it is O(amount * coins) for any coin set.
+ * @tparam Count: uint64_t, or BigUint when the count overflows (it does quickly with many small coins)
+ */
+template<typename Count>
+Count count_ways(int amount, std::vector<int> const& coins)
+{
+    if (amount < 0)
+        return Count{ 0 };
+    std::vector<Count> ways(amount + 1, Count{ 0 });
+    ways[0] = Count{ 1 };
+    for (auto coin : coins)
+    {
+        for (int a = coin; a <= amount; ++a)
+            ways[a] += ways[a - coin];
+    }
+    return ways[amount];
+}
+
+/*Enumerate the combinations lazily, one at a time, in the same order as print_change().
+ * Only the current pick of each coin is stored, so it still uses constant memory for a given coin set
+ *
+ * for (auto const& pick : change_generator{ 17, { 25, 10, 5, 1 } })
+ *     pick[i] -> number of coins[i]
+ */
+class change_generator
+{
+    std::vector<int> coins;     //from the largest
+    std::vector<int> pick;
+    int amount;
+    bool done = false;
+
+    /*Fill coins[from..] greedily from what is left, return whether the smallest coin can pay the rest exactly */
+    bool fill_from(size_t from)
+    {
+        int left = amount;
+        for (size_t i = 0; i < from; ++i)
+            left -= pick[i] * coins[i];
+        for (size_t i = from; i < coins.size(); ++i)
+        {
+            pick[i] = left / coins[i];
+            left -= pick[i] * coins[i];
+        }
+        return left == 0;
+    }
+
+    /*Take one coin back from the rightmost non-smallest coin that has any, and refill the coins after it */
+    bool advance()
+    {
+        for (auto i = static_cast<int>(coins.size()) - 2; i >= 0; --i)
+        {
+            if (pick[i] != 0)
+            {
+                --pick[i];
+                if (fill_from(i + 1))
+                    return true;
+                i = static_cast<int>(coins.size()) - 1;     //not payable, keep taking back
+            }
+        }
+        return false;
+    }
+public:
+    change_generator(int amount, std::vector<int> coins) : coins(std::move(coins)), amount(amount)
+    {
+        std::sort(this->coins.begin(), this->coins.end(), std::greater<>{});
+        pick.resize(this->coins.size());
+        done = this->coins.empty() || amount < 0 || (!fill_from(0) && !advance());
+    }
+
+    /*@return: whether there is a next combination */
+    bool next()
+    {
+        if (!done)
+            done = !advance();
+        return !done;
+    }
+
+    std::vector<int> const& current() const { return pick; }
+    std::vector<int> const& coin_values() const { return coins; }
+
+    struct sentinel {};
+    struct iterator
+    {
+        change_generator* generator;
+        std::vector<int> const& operator*() const { return generator->current(); }
+        iterator& operator++() { generator->next(); return *this; }
+        bool operator!=(sentinel) const { return !generator->done; }
+    };
+    iterator begin() { return { this }; }
+    sentinel end() const { return {}; }
+};
+
+template<typename F>
+void time(char const* name, F&& f)
+{
+    auto start = std::chrono::steady_clock::now();
+    auto result = f();
+    std::cout << name << ": " << result << " ways, "
+        << std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count() << " microsec\n";
+}
+
 int main()
 {
     std::cout << "Enter an amount: ";
     int amount{};
     std::cin >> amount;
-    print_change(amount, {}, amount >= Coins::quarter ? Coins::quarter : (amount >= Coins::dime ? Coins::dime : (amount >= Coins::nickel ? Coins::nickel : Coins::penny)));
+    if (amount <= 100)
+    {
+        print_change(amount, {}, Coins::quarter);
+
+        std::cout << "----- Lazily generated -----\n";
+        for (auto const& pick : change_generator{ amount, { quarter, dime, nickel, penny } })
+            printResult({ pick[0], pick[1], pick[2], pick[3] });
+    }
+
+    std::cout << count_change(amount) << " ways\n";
+    const auto stats = count_change_memo.stats();
+    std::cout << "Cache hits: " << stats.hits << ", misses: " << stats.misses << ", hit rate: " << stats.hit_rate() << '\n';
+
+    const std::vector<int> us_coins{ quarter, dime, nickel, penny };
+    time("Counting", [&] { return count_ways<uint64_t>(amount, us_coins); });
+    time("Counting 10^6 cents", [&] { return count_ways<uint64_t>(1'000'000, us_coins); });
+    time("Counting 10^6 cents with big integer", [&] { return count_ways<BigUint>(1'000'000, us_coins); });
+
+    /*every coin from 1 to 100 cents overflows uint64_t very quickly */
+    std::vector<int> all_coins(100);
+    for (int i = 0; i < 100; ++i)
+        all_coins[i] = i + 1;
+    time("Counting 10^4 cents with coins 1..100", [&] { return count_ways<BigUint>(10'000, all_coins); });
 }
\ No newline at end of file
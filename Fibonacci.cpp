@@ -3,6 +3,11 @@
 #include <array>
 #include <vector>
 #include <numeric>
+#include <string>
+#include <algorithm>
+#include <cstdint>
+#include "Memoize/Memoize.hpp"
+#include "BigUint/BigUint.hpp"
 
 class Timer
 {
@@ -39,6 +44,18 @@ uint64_t fib_better_recursive(uint64_t i)
 	return fib_better_recursive_impl(result, i);
 }
 
+/*Or keep the plain recursive version, and let a generic memoization wrapper do the bookkeeping (see Memoize/Memoize.hpp)
+ * The cache is kept between calls, so later calls are mostly hits */
+auto fib_memo = memoize<dense_cache<uint64_t>>([](auto& self, uint64_t i) -> uint64_t
+{
+	return i < 2 ? i : self(i - 1) + self(i - 2);
+});
+
+uint64_t fib_memoized(uint64_t i)
+{
+	return fib_memo(i);
+}
+
 /*We have a non_recursive version */
 uint64_t fib_non_recursive(uint64_t i)
 {
@@ -92,7 +109,7 @@ uint64_t fib_impl(std::index_sequence<I...>, int i)
 
 uint64_t fib_constexpr(int i)
 {
-	return fib_impl(std::make_index_sequence<70>(), i);
+	return fib_impl(std::make_index_sequence<94>(), i);	//F(93) is the largest one fits in uint64_t
 }
 
 /*We can also do template meta programming using if-constexpr*/
@@ -107,6 +124,152 @@ constexpr unsigned long long fib()
 		return fib<N - 1>() + fib<N - 2>();
 }
 
+/*Fast doubling only needs O(log n) steps, using
+ * F(2k)   = F(k) * (2F(k+1) - F(k))
+ * F(2k+1) = F(k)^2 + F(k+1)^2
+ * walking the bits of i from the highest one
+ */
+uint64_t fib_fast_doubling(uint64_t i)
+{
+	uint64_t a{};		//F(k)
+	uint64_t b{ 1 };	//F(k+1)
+	int bit = 63;
+	while (bit >= 0 && !((i >> bit) & 1))
+		--bit;
+	for (; bit >= 0; --bit)
+	{
+		const uint64_t c = a * (2 * b - a);	//F(2k)
+		const uint64_t d = a * a + b * b;	//F(2k+1)
+		if ((i >> bit) & 1)
+		{
+			a = d;
+			b = c + d;
+		}
+		else
+		{
+			a = c;
+			b = d;
+		}
+	}
+	return a;
+}
+
+/*Everything above overflows after F(93), so we need a big integer (see BigUint/BigUint.hpp)
+ * The same fast doubling, but never overflows.
+ * Big multiplications dominate here, so use the form that only needs 2 squares per step:
+ * F(2k-1) = F(k)^2 + F(k-1)^2
+ * F(2k+1) = 4F(k)^2 - F(k-1)^2 + 2(-1)^k
+ * F(2k)   = F(2k+1) - F(2k-1)
+ */
+BigUint fib_big(uint64_t i)
+{
+	if (i == 0)
+		return BigUint{ 0 };
+	BigUint pre{ 0 };	//F(k-1)
+	BigUint cur{ 1 };	//F(k)
+	int bit = 63;
+	while (!((i >> bit) & 1))
+		--bit;
+	bool k_odd = true;	//k = 1
+	for (--bit; bit >= 0; --bit)
+	{
+		const BigUint cur_square = cur * cur;
+		const BigUint pre_square = pre * pre;
+		const BigUint four_cur_square = cur_square + cur_square + cur_square + cur_square;
+		BigUint odd_pre = cur_square + pre_square;	//F(2k-1)
+		BigUint odd_next = k_odd ? four_cur_square - (pre_square + BigUint{ 2 }) : four_cur_square + BigUint{ 2 } - pre_square;	//F(2k+1)
+		BigUint even = odd_next - odd_pre;	//F(2k)
+		if ((i >> bit) & 1)
+		{
+			pre = std::move(even);
+			cur = std::move(odd_next);
+			k_odd = true;
+		}
+		else
+		{
+			pre = std::move(odd_pre);
+			cur = std::move(even);
+			k_odd = false;
+		}
+	}
+	return cur;
+}
+
+/*For comparison, the O(n) non-recursive version with big integer */
+BigUint fib_big_non_recursive(uint64_t i)
+{
+	BigUint pre{ 0 };
+	BigUint cur{ 1 };
+	if (i == 0)
+		return pre;
+	while (--i)
+	{
+		BigUint next = pre + cur;
+		pre = std::move(cur);
+		cur = std::move(next);
+	}
+	return cur;
+}
+
+void benchmark_sweep()
+{
+	constexpr int repeat = 1'000'000;
+	for (uint64_t n : { 10, 40, 70, 93 })
+	{
+		std::cout << "\n---------- n = " << n << ", " << repeat << " times ----------\n";
+		uint64_t sink{};
+		{
+			std::cout << "Non-Recursive: ";
+			Timer t;
+			for (int i = 0; i < repeat; ++i)
+				sink += fib_non_recursive(n + (sink & 1));
+		}
+		{
+			std::cout << "Dynamic Programming: ";
+			Timer t;
+			for (int i = 0; i < repeat; ++i)
+				sink += fib_better_recursive(n + (sink & 1));
+		}
+		{
+			std::cout << "Memoized: ";
+			Timer t;
+			for (int i = 0; i < repeat; ++i)
+				sink += fib_memoized(n + (sink & 1));
+		}
+		{
+			std::cout << "std::adjacent_difference: ";
+			Timer t;
+			for (int i = 0; i < repeat; ++i)
+				sink += fib_std_adjacent_difference(n + (sink & 1));
+		}
+		{
+			std::cout << "Fast doubling: ";
+			Timer t;
+			for (int i = 0; i < repeat; ++i)
+				sink += fib_fast_doubling(n + (sink & 1));
+		}
+		std::cout << (sink & 1) << '\n';	//keep the optimizer from removing the loops
+	}
+
+	for (uint64_t n : { 1'000, 10'000, 100'000, 1'000'000, 10'000'000 })
+	{
+		std::cout << "\n---------- Big n = " << n << " ----------\n";
+		BigUint result;
+		{
+			std::cout << "Big fast doubling: ";
+			Timer t;
+			result = fib_big(n);
+		}
+		if (n <= 100'000)
+		{
+			std::cout << "Big non-recursive: ";
+			Timer t;
+			std::cout << (fib_big_non_recursive(n).to_string() == result.to_string() ? "(same) " : "(MISMATCH) ");
+		}
+		const auto str = result.to_string();
+		std::cout << result.digits() << " digits: " << str.substr(0, 10) << "..." << str.substr(str.size() - 10) << '\n';
+	}
+}
 
 int main()
 {
@@ -128,6 +291,12 @@ int main()
 		Timer t;
 		std::cout << "\nUsing Dynamic Programming: " << fib_better_recursive(i) << '\n';
 	}
+	{
+		Timer t;
+		std::cout << "\nUsing memoization: " << fib_memoized(i) << '\n';
+		const auto stats = fib_memo.stats();
+		std::cout << "Cache hits: " << stats.hits << ", misses: " << stats.misses << '\n';
+	}
 	{
 		Timer t;
 		std::cout <<"\nUsing Normal Recursive: " << fib(i) << '\n';
@@ -136,4 +305,13 @@ int main()
 		Timer t;
 		std::cout << "\nUsing std::adjacent_difference" << fib_std_adjacent_difference(i) << '\n';
 	}
+	{
+		Timer t;
+		std::cout << "\nUsing fast doubling: " << fib_fast_doubling(i) << '\n';
+	}
+	{
+		Timer t;
+		std::cout << "\nUsing big integer fast doubling: " << fib_big(i) << '\n';
+	}
+	benchmark_sweep();
 }
\ No newline at end of file
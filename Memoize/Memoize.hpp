@@ -0,0 +1,424 @@
+#pragma once
+#include <vector>
+#include <tuple>
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <optional>
+#include <functional>
+#include <algorithm>
+#include <type_traits>
+#include <cstdint>
+#include <cstddef>
+
+/*Memoization for pure recursive functions.
+ * The function takes the memoized object itself as the first parameter, so its recursive calls also go through the cache:
+ *
+ *	auto fib = memoize<dense_cache<uint64_t>>([](auto& self, uint64_t i) -> uint64_t
+ *	{
+ *		return i < 2 ? i : self(i - 1) + self(i - 2);
+ *	});
+ *	fib(90);
+ *	fib.stats().hits;
+ *
+ * Caches:
+ *	dense_cache<Value>					-> non-negative integer key, stored in a vector indexed by the key
+ *	flat_cache<Key, Value>				-> any hashable key (eg. a std::tuple of the arguments), open addressing hash table
+ *	lru_cache<Key, Value>				-> same as flat_cache, but keeps at most [capacity] entries, evicting the least recently used
+ *	sharded_cache<Cache, Shards>		-> thread-safe wrapper, splitting the keys into [Shards] caches each with its own mutex
+ */
+
+/*A hash that is good enough for open addressing with power of 2 sizes */
+template<typename Key>
+struct memo_hash
+{
+	size_t operator()(Key const& key) const
+	{
+		return mix(std::hash<Key>{}(key));
+	}
+
+	/*splitmix64 finalizer, so that consecutive integers do not land on consecutive slots */
+	static size_t mix(uint64_t x)
+	{
+		x ^= x >> 30;
+		x *= 0xbf58476d1ce4e5b9ull;
+		x ^= x >> 27;
+		x *= 0x94d049bb133111ebull;
+		x ^= x >> 31;
+		return static_cast<size_t>(x);
+	}
+};
+
+template<typename... Ts>
+struct memo_hash<std::tuple<Ts...>>
+{
+	size_t operator()(std::tuple<Ts...> const& key) const
+	{
+		return std::apply([](auto const&... elements)
+		{
+			uint64_t seed = 0;
+			((seed = seed * 0x9e3779b97f4a7c15ull + std::hash<std::decay_t<decltype(elements)>>{}(elements)), ...);
+			return memo_hash<uint64_t>::mix(seed);
+		}, key);
+	}
+};
+
+struct memo_stats
+{
+	size_t hits{};
+	size_t misses{};
+	double hit_rate() const { return hits + misses == 0 ? 0.0 : static_cast<double>(hits) / (hits + misses); }
+};
+
+template<typename Value>
+class dense_cache
+{
+	std::vector<Value> values;
+	std::vector<bool> known;
+public:
+	using key_type = size_t;
+	using mapped_type = Value;
+	using hasher = memo_hash<size_t>;
+	static constexpr bool is_thread_safe = false;
+
+	explicit dense_cache(size_t initial_size = 0) : values(initial_size), known(initial_size) {}
+
+	std::optional<Value> find(key_type key) const
+	{
+		if (key < known.size() && known[key])
+			return values[key];
+		return std::nullopt;
+	}
+
+	void insert(key_type key, Value const& value)
+	{
+		if (key >= values.size())
+		{
+			const auto new_size = std::max(key + 1, values.size() * 2);
+			values.resize(new_size);
+			known.resize(new_size);
+		}
+		values[key] = value;
+		known[key] = true;
+	}
+
+	size_t size() const { return std::count(known.begin(), known.end(), true); }
+	void clear() { values.clear(); known.clear(); }
+};
+
+template<typename Key, typename Value, typename Hash = memo_hash<Key>>
+class flat_cache
+{
+	/*Linear probing, keeping the load factor under 3/4 */
+	std::vector<Key> keys;
+	std::vector<Value> values;
+	std::vector<bool> occupied;
+	size_t count{};
+	Hash hash;
+
+	size_t slot_of(Key const& key) const
+	{
+		const size_t mask = keys.size() - 1;
+		size_t slot = hash(key) & mask;
+		while (occupied[slot] && !(keys[slot] == key))
+			slot = (slot + 1) & mask;
+		return slot;
+	}
+
+	void grow()
+	{
+		flat_cache bigger{ keys.size() * 2 };
+		for (size_t i = 0; i < keys.size(); ++i)
+		{
+			if (occupied[i])
+				bigger.insert(std::move(keys[i]), std::move(values[i]));
+		}
+		*this = std::move(bigger);
+	}
+public:
+	using key_type = Key;
+	using mapped_type = Value;
+	using hasher = Hash;
+	static constexpr bool is_thread_safe = false;
+
+	/*@param capacity: rounded up to a power of 2 */
+	explicit flat_cache(size_t capacity = 16)
+	{
+		size_t size = 16;
+		while (size < capacity)
+			size *= 2;
+		keys.resize(size);
+		values.resize(size);
+		occupied.resize(size);
+	}
+
+	std::optional<Value> find(Key const& key) const
+	{
+		if (const auto slot = slot_of(key); occupied[slot])
+			return values[slot];
+		return std::nullopt;
+	}
+
+	void insert(Key key, Value value)
+	{
+		if ((count + 1) * 4 > keys.size() * 3)
+			grow();
+		const auto slot = slot_of(key);
+		if (!occupied[slot])
+		{
+			occupied[slot] = true;
+			keys[slot] = std::move(key);
+			++count;
+		}
+		values[slot] = std::move(value);
+	}
+
+	size_t size() const { return count; }
+	void clear() { *this = flat_cache{}; }
+};
+
+template<typename Key, typename Value, typename Hash = memo_hash<Key>>
+class lru_cache
+{
+	static constexpr uint32_t npos = UINT32_MAX;
+	struct Node
+	{
+		Key key;
+		Value value;
+		uint32_t prev;
+		uint32_t next;
+	};
+
+	/*Entries live in [nodes], linked from the most recently used [head] to the least recently used [tail].
+	 * [index] is a linear probing table of node indices, using backward shift deletion so no tombstones are needed
+	 */
+	std::vector<Node> nodes;
+	std::vector<uint32_t> index;
+	uint32_t head = npos;
+	uint32_t tail = npos;
+	size_t capacity;
+	Hash hash;
+
+	size_t mask() const { return index.size() - 1; }
+
+	size_t slot_of(Key const& key) const
+	{
+		size_t slot = hash(key) & mask();
+		while (index[slot] != npos && !(nodes[index[slot]].key == key))
+			slot = (slot + 1) & mask();
+		return slot;
+	}
+
+	void unlink(uint32_t node)
+	{
+		auto& n = nodes[node];
+		(n.prev == npos ? head : nodes[n.prev].next) = n.next;
+		(n.next == npos ? tail : nodes[n.next].prev) = n.prev;
+	}
+
+	void push_front(uint32_t node)
+	{
+		nodes[node].prev = npos;
+		nodes[node].next = head;
+		(head == npos ? tail : nodes[head].prev) = node;
+		head = node;
+	}
+
+	void erase_slot(size_t slot)
+	{
+		index[slot] = npos;
+		for (size_t next = (slot + 1) & mask(); index[next] != npos; next = (next + 1) & mask())
+		{
+			/*move back the entry if its home slot is not in (slot, next] */
+			const size_t home = hash(nodes[index[next]].key) & mask();
+			if (((next - home) & mask()) >= ((next - slot) & mask()))
+			{
+				index[slot] = index[next];
+				index[next] = npos;
+				slot = next;
+			}
+		}
+	}
+public:
+	using key_type = Key;
+	using mapped_type = Value;
+	using hasher = Hash;
+	static constexpr bool is_thread_safe = false;
+
+	explicit lru_cache(size_t capacity = 1024) : capacity(capacity == 0 ? 1 : capacity)
+	{
+		size_t size = 16;
+		while (size < this->capacity * 2)
+			size *= 2;
+		index.assign(size, npos);
+		nodes.reserve(this->capacity);
+	}
+
+	/*Not const: a hit makes the entry the most recently used */
+	std::optional<Value> find(Key const& key)
+	{
+		const auto node = index[slot_of(key)];
+		if (node == npos)
+			return std::nullopt;
+		if (node != head)
+		{
+			unlink(node);
+			push_front(node);
+		}
+		return nodes[node].value;
+	}
+
+	void insert(Key key, Value value)
+	{
+		auto slot = slot_of(key);
+		if (auto node = index[slot]; node != npos)
+		{
+			nodes[node].value = std::move(value);
+			return;
+		}
+		uint32_t node;
+		if (nodes.size() < capacity)
+		{
+			node = static_cast<uint32_t>(nodes.size());
+			nodes.push_back(Node{ std::move(key), std::move(value), npos, npos });
+		}
+		else
+		{
+			node = tail;
+			unlink(node);
+			erase_slot(slot_of(nodes[node].key));
+			nodes[node].key = std::move(key);
+			nodes[node].value = std::move(value);
+			slot = slot_of(nodes[node].key);	//erasing may have shifted the probe sequence
+		}
+		index[slot] = node;
+		push_front(node);
+	}
+
+	size_t size() const { return nodes.size(); }
+	void clear() { *this = lru_cache{ capacity }; }
+};
+
+template<typename Cache, size_t Shards = 16>
+class sharded_cache
+{
+	struct alignas(64) Shard	//avoid false sharing between the mutexes
+	{
+		Cache cache;
+		std::mutex mutex;
+	};
+	std::array<Shard, Shards> shards;
+	typename Cache::hasher hash;
+
+	Shard& shard_of(typename Cache::key_type const& key)
+	{
+		/*the low bits pick the slot inside the cache, so use the high bits here */
+		return shards[(hash(key) >> 48) % Shards];
+	}
+public:
+	using key_type = typename Cache::key_type;
+	using mapped_type = typename Cache::mapped_type;
+	using hasher = typename Cache::hasher;
+	static constexpr bool is_thread_safe = true;
+
+	explicit sharded_cache(Cache const& prototype = Cache{})
+	{
+		for (auto& shard : shards)
+			shard.cache = prototype;
+	}
+
+	sharded_cache(sharded_cache const& other) : sharded_cache{}
+	{
+		for (size_t i = 0; i < Shards; ++i)
+			shards[i].cache = other.shards[i].cache;
+	}
+
+	std::optional<mapped_type> find(key_type const& key)
+	{
+		auto& shard = shard_of(key);
+		std::lock_guard lock{ shard.mutex };
+		return shard.cache.find(key);
+	}
+
+	void insert(key_type const& key, mapped_type const& value)
+	{
+		auto& shard = shard_of(key);
+		std::lock_guard lock{ shard.mutex };
+		shard.cache.insert(key, value);
+	}
+
+	size_t size()
+	{
+		size_t total = 0;
+		for (auto& shard : shards)
+		{
+			std::lock_guard lock{ shard.mutex };
+			total += shard.cache.size();
+		}
+		return total;
+	}
+
+	void clear()
+	{
+		for (auto& shard : shards)
+		{
+			std::lock_guard lock{ shard.mutex };
+			shard.cache.clear();
+		}
+	}
+};
+
+template<typename Cache, typename F>
+class memoized
+{
+	using counter = std::conditional_t<Cache::is_thread_safe, std::atomic<size_t>, size_t>;
+	F f;
+	Cache cache;
+	counter hits{};
+	counter misses{};
+
+	template<typename... Args>
+	static typename Cache::key_type make_key(Args const&... args)
+	{
+		if constexpr (std::is_arithmetic_v<typename Cache::key_type>)
+			return typename Cache::key_type(args...);
+		else
+			return typename Cache::key_type{ args... };
+	}
+public:
+	using value_type = typename Cache::mapped_type;
+
+	explicit memoized(F f, Cache cache = Cache{}) : f(std::move(f)), cache(std::move(cache)) {}
+
+	template<typename... Args>
+	value_type operator()(Args const&... args)
+	{
+		auto key = make_key(args...);
+		if (auto found = cache.find(key))
+		{
+			++hits;
+			return *std::move(found);
+		}
+		++misses;
+		/*The recursive calls may grow the cache, so only insert after the value is computed */
+		value_type value = f(*this, args...);
+		cache.insert(std::move(key), value);
+		return value;
+	}
+
+	memo_stats stats() const { return { hits, misses }; }
+	size_t size() { return cache.size(); }
+
+	void clear()
+	{
+		cache.clear();
+		hits = 0;
+		misses = 0;
+	}
+};
+
+template<typename Cache, typename F>
+auto memoize(F f, Cache cache = Cache{})
+{
+	return memoized<Cache, F>{ std::move(f), std::move(cache) };
+}
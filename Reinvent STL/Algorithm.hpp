@@ -1,7 +1,31 @@
 #pragma once
 #include <cstddef>
 #include <cstring>
+#include <atomic>
+#include <optional>
+#include <vector>
+#include <functional>   //for std::plus, std::less
+#include <type_traits>  //for std::is_convertible_v
+#include <iterator>     //for std::iterator_traits, the library iterators are std-compatible
+#include <bit>
 #include "TypeTraits.hpp"
+#include "ExecutionPolicy.hpp"
+#include "ThreadPool.hpp"
+#include "Sort.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define REINVENT_STL_SSE2
+#endif
+
+//Tell the compiler the iterations of the next loop are independent, for the unseq policies
+#if defined(__clang__)
+#define REINVENT_STL_IVDEP _Pragma("clang loop vectorize(enable) interleave(enable)")
+#elif defined(__GNUC__)
+#define REINVENT_STL_IVDEP _Pragma("GCC ivdep")
+#else
+#define REINVENT_STL_IVDEP
+#endif
 
 namespace details
 {
@@ -20,11 +44,11 @@ namespace details
 template<typename InputIt1, typename InputIt2>
 bool equal(InputIt1 first1, InputIt1 last1, InputIt2 first2)
 {
-    //TODO: Why can we only use memcmp when it is either integer or pointer?
+    //memcmp only for integers and pointers, see details::is_memcmpable
     if constexpr(!is_class_v<InputIt1> && !is_class_v<InputIt2> && is_memcmpable<InputIt1, InputIt2>::value)
     {
         if (const auto num = last1 - first1)
-            return details::memcmp(first1, first2, num);
+            return details::memcmp(first1, first2, num) == 0;
         return true;    //because num == 0
     }
     else
@@ -40,10 +64,22 @@ bool equal(InputIt1 first1, InputIt1 last1, InputIt2 first2)
 
 namespace details
 {
+    /*memcmp compares as unsigned char, so it only orders like operator< for unsigned bytes*/
+    template<typename Iter1, typename Iter2> struct is_lexicographical_memcmpable : false_type {};
+    template<typename T, typename U> struct is_lexicographical_memcmpable<T*, U*>
+        : bool_constant<is_integral_v<T> && is_unsigned_v<remove_cv_t<T>> && sizeof(T) == 1 && is_same_v<remove_cv_t<T>, remove_cv_t<U>>> {};
+
     template<typename InputIt1, typename InputIt2>
     bool lexicographical_compare_impl(InputIt1 first1, InputIt1 last1, InputIt2 first2, InputIt2 last2)
     {
-        
+        const std::size_t len1 = last1 - first1;
+        const std::size_t len2 = last2 - first2;
+        if (const auto num = len1 < len2 ? len1 : len2)
+        {
+            if (const auto result = details::memcmp(first1, first2, num))
+                return result < 0;
+        }
+        return len1 < len2;
     }
 }
 
@@ -55,10 +91,11 @@ namespace details
  * @param last2 the second range of elements to examine
  * @return true if the first range is lexicographically < second range
  */
-//TODO: utilize memcmp
 template<typename InputIt1, typename InputIt2>
 bool lexicographical_compare(InputIt1 first1, InputIt1 last1, InputIt2 first2, InputIt2 last2)
 {
+    if constexpr (details::is_lexicographical_memcmpable<InputIt1, InputIt2>::value)
+        return details::lexicographical_compare_impl(first1, last1, first2, last2);
     for (; (first1 != last1) && (first2 != last2); ++first1, (void) ++first2) 
     {
         if (*first1 < *first2) return true;
@@ -81,7 +118,7 @@ bool lexicographical_compare(InputIt1 first1, InputIt1 last1, InputIt2 first2, I
  * @param compare comparison function object, which returns true if the first argument < second argument
  * @return true if the first range is lexicographically < second range
  */
-template<typename InputIt1, typename InputIt2, typename Compare>
+template<typename InputIt1, typename InputIt2, typename Compare, typename = enable_if_t<!is_execution_policy_v<InputIt1>>>
 bool lexicographical_compare(InputIt1 first1, InputIt1 last1, InputIt2 first2, InputIt2 last2, Compare compare)
 {
     for (; (first1 != last1) && (first2 != last2); ++first1, (void) ++first2) 
@@ -92,3 +129,641 @@ bool lexicographical_compare(InputIt1 first1, InputIt1 last1, InputIt2 first2, I
     return (first1 == last1) && (first2 != last2);
 }
 
+
+/*============================== Execution policies ==============================*/
+
+namespace details
+{
+    template<typename Iter>
+    inline constexpr bool is_random_access_v = std::is_convertible_v<typename std::iterator_traits<Iter>::iterator_category, std::random_access_iterator_tag>;
+
+    /*Only for random access iterators, the chunks are found by offsets*/
+    template<typename ExecutionPolicy>
+    constexpr bool use_parallel(std::size_t n)
+    {
+        return is_parallel_policy_v<ExecutionPolicy> && n >= 2 * parallel_grain;
+    }
+
+    /*The SIMD kernels: contiguous integers only, compared by their bits*/
+    template<typename Iter>
+    inline constexpr bool is_simd_integer_range_v = false;
+    template<typename T>
+    inline constexpr bool is_simd_integer_range_v<T*> = is_integral_v<T> && !is_same_v<remove_cv_t<T>, bool>
+        && (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8);
+
+    /**
+     * @brief Convert the value searched by find()/count() to the element type
+     * @returns empty if no element can compare equal to value
+     */
+    template<typename T, typename U>
+    std::optional<T> simd_key(U const& value)
+    {
+        const auto key = static_cast<T>(value);
+        if (!(key == value))    //compared as *first == value would be, not by the bits that survive the cast
+            return std::nullopt;
+        return key;
+    }
+
+#ifdef REINVENT_STL_SSE2
+    /*All bits set in the lanes of the 16-byte blocks a and b that are equal*/
+    template<std::size_t Size>
+    __m128i equal_lanes(__m128i a, __m128i b)
+    {
+        if constexpr (Size == 1)
+            return _mm_cmpeq_epi8(a, b);
+        else if constexpr (Size == 2)
+            return _mm_cmpeq_epi16(a, b);
+        else if constexpr (Size == 4)
+            return _mm_cmpeq_epi32(a, b);
+        else
+        {
+            //SSE2 has no 64-bit compare, both 32-bit halves need to be equal
+            const auto halves = _mm_cmpeq_epi32(a, b);
+            return _mm_and_si128(halves, _mm_shuffle_epi32(halves, _MM_SHUFFLE(2, 3, 0, 1)));
+        }
+    }
+
+    /*An equal lane is -1, so subtracting it counts the match in that lane*/
+    template<std::size_t Size>
+    __m128i subtract_lanes(__m128i a, __m128i b)
+    {
+        if constexpr (Size == 1)
+            return _mm_sub_epi8(a, b);
+        else if constexpr (Size == 2)
+            return _mm_sub_epi16(a, b);
+        else if constexpr (Size == 4)
+            return _mm_sub_epi32(a, b);
+        else
+            return _mm_sub_epi64(a, b);
+    }
+
+    template<typename T>
+    __m128i broadcast(T key)
+    {
+        if constexpr (sizeof(T) == 1)
+            return _mm_set1_epi8(static_cast<char>(key));
+        else if constexpr (sizeof(T) == 2)
+            return _mm_set1_epi16(static_cast<short>(key));
+        else if constexpr (sizeof(T) == 4)
+            return _mm_set1_epi32(static_cast<int>(key));
+        else
+            return _mm_set1_epi64x(static_cast<long long>(key));
+    }
+
+    template<typename T>
+    __m128i load(T const* p) { return _mm_loadu_si128(reinterpret_cast<__m128i const*>(p)); }
+#endif
+
+    template<typename T>
+    T* simd_find(T* first, T* last, remove_cv_t<T> key)
+    {
+#ifdef REINVENT_STL_SSE2
+        constexpr std::ptrdiff_t lanes = 16 / sizeof(T);
+        const auto needle = broadcast(key);
+        //4 blocks per branch, the block with the match is found again after
+        for (; last - first >= 4 * lanes; first += 4 * lanes)
+        {
+            const auto any = _mm_or_si128(_mm_or_si128(equal_lanes<sizeof(T)>(load(first), needle), equal_lanes<sizeof(T)>(load(first + lanes), needle)),
+                _mm_or_si128(equal_lanes<sizeof(T)>(load(first + 2 * lanes), needle), equal_lanes<sizeof(T)>(load(first + 3 * lanes), needle)));
+            if (_mm_movemask_epi8(any) != 0)
+                break;
+        }
+        for (; last - first >= lanes; first += lanes)
+        {
+            if (const auto mask = static_cast<unsigned>(_mm_movemask_epi8(equal_lanes<sizeof(T)>(load(first), needle))))
+                return first + std::countr_zero(mask) / sizeof(T);
+        }
+#endif
+        for (; first != last; ++first)
+        {
+            if (*first == key)
+                return first;
+        }
+        return last;
+    }
+
+    template<typename T>
+    std::ptrdiff_t simd_count(T* first, T* last, remove_cv_t<T> key)
+    {
+        std::ptrdiff_t result = 0;
+#ifdef REINVENT_STL_SSE2
+        constexpr std::ptrdiff_t lanes = 16 / sizeof(T);
+        const auto needle = broadcast(key);
+        while (last - first >= lanes)
+        {
+            //a lane counts to at most 255 blocks, so 1-byte lanes can't overflow
+            auto counts = _mm_setzero_si128();
+            const auto blocks = (last - first) / lanes < 255 ? (last - first) / lanes : 255;
+            for (std::ptrdiff_t i = 0; i != blocks; ++i, first += lanes)
+                counts = subtract_lanes<sizeof(T)>(counts, equal_lanes<sizeof(T)>(load(first), needle));
+            unsigned char bytes[16];
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(bytes), counts);
+            for (std::size_t lane = 0; lane != 16; lane += sizeof(T))
+                result += bytes[lane];  //little endian, the counts fit in the lowest byte
+        }
+#endif
+        for (; first != last; ++first)
+            result += *first == key;
+        return result;
+    }
+
+    template<typename ExecutionPolicy, typename InputIt, typename T>
+    InputIt find_seq(InputIt first, InputIt last, T const& value)
+    {
+        if constexpr (is_vectorized_policy_v<ExecutionPolicy> && is_simd_integer_range_v<InputIt> && is_integral_v<T>)
+        {
+            if (const auto key = simd_key<remove_cv_t<remove_reference_t<decltype(*first)>>>(value))
+                return simd_find(first, last, *key);
+            return last;
+        }
+        else
+        {
+            for (; first != last; ++first)
+            {
+                if (*first == value)
+                    return first;
+            }
+            return last;
+        }
+    }
+
+    template<typename ExecutionPolicy, typename InputIt, typename T>
+    typename std::iterator_traits<InputIt>::difference_type count_seq(InputIt first, InputIt last, T const& value)
+    {
+        if constexpr (is_vectorized_policy_v<ExecutionPolicy> && is_simd_integer_range_v<InputIt> && is_integral_v<T>)
+        {
+            if (const auto key = simd_key<remove_cv_t<remove_reference_t<decltype(*first)>>>(value))
+                return simd_count(first, last, *key);
+            return 0;
+        }
+        else
+        {
+            typename std::iterator_traits<InputIt>::difference_type result = 0;
+            for (; first != last; ++first)
+            {
+                if (*first == value)
+                    ++result;
+            }
+            return result;
+        }
+    }
+
+    /**
+     * @brief Fold with 8 independent accumulators, so the additions don't wait on each other and the compiler can use vector registers
+     * @details Only valid for an associative and commutative op, which reduce() requires anyway
+     */
+    template<typename T, typename RandomIt, typename BinaryOp>
+    T reduce_unseq(RandomIt first, RandomIt last, T init, BinaryOp op)
+    {
+        constexpr std::ptrdiff_t ways = 8;
+        const auto n = static_cast<std::ptrdiff_t>(last - first);
+        std::ptrdiff_t i = 0;
+        if (n >= ways)
+        {
+            T acc[ways]{ first[0], first[1], first[2], first[3], first[4], first[5], first[6], first[7] };
+            for (i = ways; i + ways <= n; i += ways)
+            {
+                REINVENT_STL_IVDEP
+                for (std::ptrdiff_t j = 0; j < ways; ++j)
+                    acc[j] = op(acc[j], first[i + j]);
+            }
+            for (auto const& partial : acc)
+                init = op(init, partial);
+        }
+        for (; i < n; ++i)
+            init = op(init, first[i]);
+        return init;
+    }
+
+    /*reduce() may regroup under any policy, so even seq gets the independent accumulators*/
+    template<typename ExecutionPolicy, typename InputIt, typename T, typename BinaryOp>
+    T reduce_seq(InputIt first, InputIt last, T init, BinaryOp op)
+    {
+        if constexpr (is_random_access_v<InputIt>)
+            return reduce_unseq(first, last, std::move(init), op);
+        else
+        {
+            for (; first != last; ++first)
+                init = op(std::move(init), *first);
+            return init;
+        }
+    }
+
+    template<typename ExecutionPolicy, typename InputIt, typename OutputIt, typename UnaryOp>
+    OutputIt transform_seq(InputIt first, InputIt last, OutputIt d_first, UnaryOp op)
+    {
+        if constexpr (is_vectorized_policy_v<ExecutionPolicy> && is_random_access_v<InputIt> && is_random_access_v<OutputIt>)
+        {
+            const auto n = last - first;
+            REINVENT_STL_IVDEP
+            for (decltype(last - first) i = 0; i < n; ++i)
+                d_first[i] = op(first[i]);
+            return d_first + n;
+        }
+        else
+        {
+            for (; first != last; ++first, (void)++d_first)
+                *d_first = op(*first);
+            return d_first;
+        }
+    }
+
+    template<typename ExecutionPolicy, typename InputIt1, typename InputIt2, typename OutputIt, typename BinaryOp>
+    OutputIt transform_seq(InputIt1 first1, InputIt1 last1, InputIt2 first2, OutputIt d_first, BinaryOp op)
+    {
+        if constexpr (is_vectorized_policy_v<ExecutionPolicy> && is_random_access_v<InputIt1> && is_random_access_v<InputIt2> && is_random_access_v<OutputIt>)
+        {
+            const auto n = last1 - first1;
+            REINVENT_STL_IVDEP
+            for (decltype(last1 - first1) i = 0; i < n; ++i)
+                d_first[i] = op(first1[i], first2[i]);
+            return d_first + n;
+        }
+        else
+        {
+            for (; first1 != last1; ++first1, (void)++first2, (void)++d_first)
+                *d_first = op(*first1, *first2);
+            return d_first;
+        }
+    }
+
+    template<typename InputIt, typename OutputIt>
+    inline constexpr bool is_memmove_copyable_v = false;
+    template<typename T, typename U>
+    inline constexpr bool is_memmove_copyable_v<T*, U*> = is_same_v<remove_cv_t<T>, U> && is_nonvolatile_trivially_copyable_v<U>;
+
+    template<typename InputIt, typename OutputIt>
+    OutputIt copy_seq(InputIt first, InputIt last, OutputIt d_first)
+    {
+        if constexpr (is_memmove_copyable_v<InputIt, OutputIt>)
+        {
+            const auto n = last - first;
+            if (n != 0)
+                std::memmove(d_first, first, n * sizeof(*first));
+            return d_first + n;
+        }
+        else
+        {
+            for (; first != last; ++first, (void)++d_first)
+                *d_first = *first;
+            return d_first;
+        }
+    }
+
+    template<typename ForwardIt, typename T>
+    void fill_seq(ForwardIt first, ForwardIt last, T const& value)
+    {
+        if constexpr (is_simd_integer_range_v<ForwardIt> && sizeof(*first) == 1)
+        {
+            if (last != first)
+                std::memset(first, static_cast<unsigned char>(value), last - first);
+        }
+        else
+        {
+            for (; first != last; ++first)
+                *first = value;
+        }
+    }
+
+    /**
+     * @returns the index of the first i where a[i] and b[i] differ, that is comp(a[i], b[i]) or comp(b[i], a[i]), or n
+     */
+    template<typename ExecutionPolicy, typename RandomIt1, typename RandomIt2, typename Compare>
+    std::size_t first_difference(RandomIt1 first1, RandomIt2 first2, std::size_t n, Compare comp)
+    {
+        auto differ = [&](std::size_t i) { return comp(first1[i], first2[i]) || comp(first2[i], first1[i]); };
+        if (!use_parallel<ExecutionPolicy>(n))
+        {
+            std::size_t i = 0;
+            while (i != n && !differ(i))
+                ++i;
+            return i;
+        }
+        std::atomic<std::size_t> found{ n };
+        parallel_chunks(n, [&](std::size_t, std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i != end && i < found.load(std::memory_order_relaxed); ++i)
+            {
+                if (differ(i))
+                {
+                    auto current = found.load();
+                    while (i < current && !found.compare_exchange_weak(current, i)) {}
+                    return;
+                }
+            }
+        });
+        return found.load();
+    }
+}
+
+/**
+ * @brief Returns the first element in the range [first, last) that is equal to value
+ * @return Iterator to the first such element, or last if no such element is found
+ */
+template<typename InputIt, typename T>
+InputIt find(InputIt first, InputIt last, T const& value)
+{
+    return details::find_seq<execution::sequenced_policy>(first, last, value);
+}
+
+/**
+ * @brief find() executed according to policy
+ * @details unseq compares 16 bytes at a time for contiguous integers, par searches the chunks on the thread pool
+ * and keeps the smallest index found, so the result is the same as the sequential one
+ */
+template<typename ExecutionPolicy, typename ForwardIt, typename T>
+details::enable_if_execution_policy_t<ExecutionPolicy, ForwardIt> find(ExecutionPolicy&&, ForwardIt first, ForwardIt last, T const& value)
+{
+    if constexpr (details::is_random_access_v<ForwardIt>)
+    {
+        const std::size_t n = last - first;
+        if (details::use_parallel<ExecutionPolicy>(n))
+        {
+            std::atomic<std::size_t> found{ n };
+            details::parallel_chunks(n, [&](std::size_t, std::size_t begin, std::size_t end)
+            {
+                if (begin >= found.load(std::memory_order_relaxed))
+                    return; //an earlier chunk already has it
+                const auto it = details::find_seq<ExecutionPolicy>(first + begin, first + end, value);
+                if (it == first + end)
+                    return;
+                const std::size_t index = it - first;
+                auto current = found.load();
+                while (index < current && !found.compare_exchange_weak(current, index)) {}
+            });
+            return first + found.load();
+        }
+    }
+    return details::find_seq<ExecutionPolicy>(first, last, value);
+}
+
+/**
+ * @brief Returns the number of elements in the range [first, last) that are equal to value
+ */
+template<typename InputIt, typename T>
+typename std::iterator_traits<InputIt>::difference_type count(InputIt first, InputIt last, T const& value)
+{
+    return details::count_seq<execution::sequenced_policy>(first, last, value);
+}
+
+template<typename ExecutionPolicy, typename ForwardIt, typename T>
+details::enable_if_execution_policy_t<ExecutionPolicy, typename std::iterator_traits<ForwardIt>::difference_type>
+count(ExecutionPolicy&&, ForwardIt first, ForwardIt last, T const& value)
+{
+    if constexpr (details::is_random_access_v<ForwardIt>)
+    {
+        const std::size_t n = last - first;
+        if (details::use_parallel<ExecutionPolicy>(n))
+        {
+            std::atomic<typename std::iterator_traits<ForwardIt>::difference_type> result{ 0 };
+            details::parallel_chunks(n, [&](std::size_t, std::size_t begin, std::size_t end)
+            {
+                result.fetch_add(details::count_seq<ExecutionPolicy>(first + begin, first + end, value), std::memory_order_relaxed);
+            });
+            return result.load();
+        }
+    }
+    return details::count_seq<ExecutionPolicy>(first, last, value);
+}
+
+/**
+ * @brief Applies op to each element of [first, last) and stores the result in the range beginning at d_first
+ * @return Output iterator to the element past the last element transformed
+ */
+template<typename InputIt, typename OutputIt, typename UnaryOp>
+OutputIt transform(InputIt first, InputIt last, OutputIt d_first, UnaryOp op)
+{
+    return details::transform_seq<execution::sequenced_policy>(first, last, d_first, op);
+}
+
+/**
+ * @brief Applies op to the pairs of elements of [first1, last1) and the range beginning at first2
+ */
+template<typename InputIt1, typename InputIt2, typename OutputIt, typename BinaryOp, typename = enable_if_t<!is_execution_policy_v<InputIt1>>>
+OutputIt transform(InputIt1 first1, InputIt1 last1, InputIt2 first2, OutputIt d_first, BinaryOp op)
+{
+    return details::transform_seq<execution::sequenced_policy>(first1, last1, first2, d_first, op);
+}
+
+template<typename ExecutionPolicy, typename ForwardIt1, typename ForwardIt2, typename UnaryOp>
+details::enable_if_execution_policy_t<ExecutionPolicy, ForwardIt2> transform(ExecutionPolicy&&, ForwardIt1 first, ForwardIt1 last, ForwardIt2 d_first, UnaryOp op)
+{
+    if constexpr (details::is_random_access_v<ForwardIt1> && details::is_random_access_v<ForwardIt2>)
+    {
+        const std::size_t n = last - first;
+        if (details::use_parallel<ExecutionPolicy>(n))
+        {
+            details::parallel_chunks(n, [&](std::size_t, std::size_t begin, std::size_t end)
+            {
+                details::transform_seq<ExecutionPolicy>(first + begin, first + end, d_first + begin, op);
+            });
+            return d_first + n;
+        }
+    }
+    return details::transform_seq<ExecutionPolicy>(first, last, d_first, op);
+}
+
+template<typename ExecutionPolicy, typename ForwardIt1, typename ForwardIt2, typename ForwardIt3, typename BinaryOp>
+details::enable_if_execution_policy_t<ExecutionPolicy, ForwardIt3>
+transform(ExecutionPolicy&&, ForwardIt1 first1, ForwardIt1 last1, ForwardIt2 first2, ForwardIt3 d_first, BinaryOp op)
+{
+    if constexpr (details::is_random_access_v<ForwardIt1> && details::is_random_access_v<ForwardIt2> && details::is_random_access_v<ForwardIt3>)
+    {
+        const std::size_t n = last1 - first1;
+        if (details::use_parallel<ExecutionPolicy>(n))
+        {
+            details::parallel_chunks(n, [&](std::size_t, std::size_t begin, std::size_t end)
+            {
+                details::transform_seq<ExecutionPolicy>(first1 + begin, first1 + end, first2 + begin, d_first + begin, op);
+            });
+            return d_first + n;
+        }
+    }
+    return details::transform_seq<ExecutionPolicy>(first1, last1, first2, d_first, op);
+}
+
+/**
+ * @brief Reduces the range [first, last) with op, starting from init, in any order and grouping
+ * @details Unlike accumulate, the result is only deterministic when op is associative and commutative
+ */
+template<typename InputIt, typename T, typename BinaryOp>
+T reduce(InputIt first, InputIt last, T init, BinaryOp op)
+{
+    return details::reduce_seq<execution::sequenced_policy>(first, last, std::move(init), op);
+}
+
+template<typename InputIt, typename T, typename = enable_if_t<!is_execution_policy_v<InputIt>>>
+T reduce(InputIt first, InputIt last, T init)
+{
+    return ::reduce(first, last, std::move(init), std::plus<>{});
+}
+
+template<typename InputIt, typename = enable_if_t<!is_execution_policy_v<InputIt>>>
+typename std::iterator_traits<InputIt>::value_type reduce(InputIt first, InputIt last)
+{
+    return ::reduce(first, last, typename std::iterator_traits<InputIt>::value_type{});
+}
+
+/**
+ * @brief reduce() executed according to policy
+ * @details Each chunk is reduced on its own starting from its first element, then the partial results are reduced in chunk order
+ */
+template<typename ExecutionPolicy, typename ForwardIt, typename T, typename BinaryOp>
+details::enable_if_execution_policy_t<ExecutionPolicy, T> reduce(ExecutionPolicy&&, ForwardIt first, ForwardIt last, T init, BinaryOp op)
+{
+    if constexpr (details::is_random_access_v<ForwardIt>)
+    {
+        const std::size_t n = last - first;
+        if (details::use_parallel<ExecutionPolicy>(n))
+        {
+            std::vector<std::optional<T>> partials(details::parallel_chunk_count(n));
+            details::parallel_chunks(n, [&](std::size_t i, std::size_t begin, std::size_t end)
+            {
+                partials[i].emplace(details::reduce_seq<ExecutionPolicy>(first + begin + 1, first + end, T(first[begin]), op));
+            });
+            for (auto& partial : partials)
+            {
+                if (partial)
+                    init = op(std::move(init), std::move(*partial));
+            }
+            return init;
+        }
+    }
+    return details::reduce_seq<ExecutionPolicy>(first, last, std::move(init), op);
+}
+
+template<typename ExecutionPolicy, typename ForwardIt, typename T>
+details::enable_if_execution_policy_t<ExecutionPolicy, T> reduce(ExecutionPolicy&& policy, ForwardIt first, ForwardIt last, T init)
+{
+    return ::reduce(policy, first, last, std::move(init), std::plus<>{});
+}
+
+template<typename ExecutionPolicy, typename ForwardIt>
+details::enable_if_execution_policy_t<ExecutionPolicy, typename std::iterator_traits<ForwardIt>::value_type>
+reduce(ExecutionPolicy&& policy, ForwardIt first, ForwardIt last)
+{
+    return ::reduce(policy, first, last, typename std::iterator_traits<ForwardIt>::value_type{});
+}
+
+/**
+ * @brief Copies the elements in the range [first, last) to another range beginning at d_first, with memmove for trivially copyable types
+ * @return Output iterator to the element in the destination range, one past the last element copied
+ */
+template<typename InputIt, typename OutputIt>
+OutputIt copy(InputIt first, InputIt last, OutputIt d_first)
+{
+    return details::copy_seq(first, last, d_first);
+}
+
+/**
+ * @details The ranges must not overlap, like std::copy with a policy
+ */
+template<typename ExecutionPolicy, typename ForwardIt1, typename ForwardIt2>
+details::enable_if_execution_policy_t<ExecutionPolicy, ForwardIt2> copy(ExecutionPolicy&&, ForwardIt1 first, ForwardIt1 last, ForwardIt2 d_first)
+{
+    if constexpr (details::is_random_access_v<ForwardIt1> && details::is_random_access_v<ForwardIt2>)
+    {
+        const std::size_t n = last - first;
+        if (details::use_parallel<ExecutionPolicy>(n))
+        {
+            details::parallel_chunks(n, [&](std::size_t, std::size_t begin, std::size_t end)
+            {
+                details::copy_seq(first + begin, first + end, d_first + begin);
+            });
+            return d_first + n;
+        }
+    }
+    return details::copy_seq(first, last, d_first);
+}
+
+/**
+ * @brief Assigns the given value to the elements in the range [first, last), with memset for byte-sized integers
+ */
+template<typename ForwardIt, typename T>
+void fill(ForwardIt first, ForwardIt last, T const& value)
+{
+    details::fill_seq(first, last, value);
+}
+
+template<typename ExecutionPolicy, typename ForwardIt, typename T>
+details::enable_if_execution_policy_t<ExecutionPolicy> fill(ExecutionPolicy&&, ForwardIt first, ForwardIt last, T const& value)
+{
+    if constexpr (details::is_random_access_v<ForwardIt>)
+    {
+        const std::size_t n = last - first;
+        if (details::use_parallel<ExecutionPolicy>(n))
+        {
+            details::parallel_chunks(n, [&](std::size_t, std::size_t begin, std::size_t end)
+            {
+                details::fill_seq(first + begin, first + end, value);
+            });
+            return;
+        }
+    }
+    details::fill_seq(first, last, value);
+}
+
+/**
+ * @brief Sorts the elements in the range [first, last) in non-descending order with pdqsort, not stable
+ */
+template<typename RandomIt, typename Compare, typename = enable_if_t<!is_execution_policy_v<RandomIt>>>
+void sort(RandomIt first, RandomIt last, Compare comp)
+{
+    ::pdqsort(first, last, comp);
+}
+
+template<typename RandomIt>
+void sort(RandomIt first, RandomIt last)
+{
+    ::pdqsort(first, last);
+}
+
+/**
+ * @details par uses sample_sort() for large ranges
+ */
+template<typename ExecutionPolicy, typename RandomIt, typename Compare>
+details::enable_if_execution_policy_t<ExecutionPolicy> sort(ExecutionPolicy&&, RandomIt first, RandomIt last, Compare comp)
+{
+    if (details::use_parallel<ExecutionPolicy>(last - first))
+        ::sample_sort(first, last, comp);
+    else
+        ::pdqsort(first, last, comp);
+}
+
+template<typename ExecutionPolicy, typename RandomIt>
+details::enable_if_execution_policy_t<ExecutionPolicy> sort(ExecutionPolicy&& policy, RandomIt first, RandomIt last)
+{
+    ::sort(policy, first, last, std::less<typename std::iterator_traits<RandomIt>::value_type>{});
+}
+
+/**
+ * @brief lexicographical_compare() executed according to policy
+ * @details par looks for the first pair of different elements on the thread pool, only that pair decides the result
+ */
+template<typename ExecutionPolicy, typename ForwardIt1, typename ForwardIt2, typename Compare>
+details::enable_if_execution_policy_t<ExecutionPolicy, bool>
+lexicographical_compare(ExecutionPolicy&&, ForwardIt1 first1, ForwardIt1 last1, ForwardIt2 first2, ForwardIt2 last2, Compare comp)
+{
+    if constexpr (!details::is_random_access_v<ForwardIt1> || !details::is_random_access_v<ForwardIt2>)
+        return ::lexicographical_compare(first1, last1, first2, last2, comp);
+    else
+    {
+        const std::size_t len1 = last1 - first1;
+        const std::size_t len2 = last2 - first2;
+        const auto n = len1 < len2 ? len1 : len2;
+        const auto index = details::first_difference<ExecutionPolicy>(first1, first2, n, comp);
+        if (index == n)
+            return len1 < len2;
+        return comp(first1[index], first2[index]);
+    }
+}
+
+template<typename ExecutionPolicy, typename ForwardIt1, typename ForwardIt2>
+details::enable_if_execution_policy_t<ExecutionPolicy, bool>
+lexicographical_compare(ExecutionPolicy&& policy, ForwardIt1 first1, ForwardIt1 last1, ForwardIt2 first2, ForwardIt2 last2)
+{
+    if constexpr (details::is_lexicographical_memcmpable<ForwardIt1, ForwardIt2>::value && !details::is_parallel_policy_v<ExecutionPolicy>)
+        return details::lexicographical_compare_impl(first1, last1, first2, last2);
+    else
+        return ::lexicographical_compare(policy, first1, last1, first2, last2, std::less<>{});
+}
@@ -3,7 +3,11 @@
 #include <new>          //for placement new
 #include <type_traits>  //for std::true_type
 #include "TypeTraits.hpp"
+#include "AllocatorTraits.hpp"
 #include <limits>
+#include <cstdlib>     //for malloc
+#include <cstdint>     //for std::uintptr_t
+#include <atomic>
 
 /**
  * @brief Reinvent std::allocator using GCC's source code
@@ -33,6 +37,7 @@ public:
     allocator(const allocator&) noexcept{};
     template <typename U>
     allocator(const allocator<U> &) noexcept{};
+    allocator& operator=(const allocator&) noexcept = default;
 
     /*Member functions*/
 
@@ -48,15 +53,14 @@ public:
      * @brief Allocates n*sizeof(T) bytes of uninitialized memory
      * 
      * @param n the number of objects to allocate storage for
-     * @param hint pointer to a nearby memory location
+     * @param hint pointer to a nearby memory location, unused
      */
-    auto allocate(std::size_t n, const void *hint = nullptr)
+    auto allocate(std::size_t n, [[maybe_unused]] const void *hint = nullptr)
     {
         if(n > m_max_size())
             throw std::bad_alloc{};
-        constexpr auto alignment = static_cast<std::align_val_t>(alignof(T));
-        if constexpr(alignment > alignof(std::max_align_t))
-            return static_cast<T*>(::operator new(n * sizeof(T), alignment));
+        if constexpr(alignof(T) > alignof(std::max_align_t))
+            return static_cast<T*>(::operator new(n * sizeof(T), static_cast<std::align_val_t>(alignof(T))));
         else
             return static_cast<T*>(::operator new(n * sizeof(T)));
     }
@@ -69,10 +73,376 @@ public:
      */
     void deallocate(T* p, std::size_t n)
     {
-        constexpr auto alignment = alignof(T);
-        if constexpr(alignment > alignof(std::max_align_t))
-            ::operator delete(p, n * sizeof(T), alignment);
+        if constexpr(alignof(T) > alignof(std::max_align_t))
+            ::operator delete(p, n * sizeof(T), static_cast<std::align_val_t>(alignof(T)));
         else
             ::operator delete(p, n * sizeof(T));
     }
-};
\ No newline at end of file
+};
+
+/*All allocator<T> are interchangeable, memory allocated by one can be deallocated by any other*/
+template<typename T, typename U>
+constexpr bool operator==(allocator<T> const&, allocator<U> const&) noexcept { return true; }
+template<typename T, typename U>
+constexpr bool operator!=(allocator<T> const&, allocator<U> const&) noexcept { return false; }
+
+/**
+ * @brief An allocator using malloc()/free(), so it can also grow a block with realloc()
+ * 
+ * @tparam T Type of allocated object, alignof(T) must be <= alignof(std::max_align_t)
+ * @details realloc() extends the block in place if the memory after it is free, and large blocks are remapped
+ * by the OS without copying. Containers use reallocate() only for trivially relocatable types, see allocator_traits::reallocate
+ */
+template<typename T>
+class malloc_allocator
+{
+    static_assert(alignof(T) <= alignof(std::max_align_t), "malloc() can't align T");
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using propagate_on_container_move_assignment = std::true_type;
+    using is_always_equal = std::true_type;
+
+    malloc_allocator() noexcept = default;
+    template <typename U>
+    malloc_allocator(const malloc_allocator<U> &) noexcept{};
+
+    constexpr auto max_size() const noexcept
+    {
+        return std::numeric_limits<size_type>::max() / sizeof(value_type);
+    }
+
+    T* allocate(std::size_t n)
+    {
+        if (n > max_size())
+            throw std::bad_alloc{};
+        if (auto p = static_cast<T*>(std::malloc(n * sizeof(T))))
+            return p;
+        throw std::bad_alloc{};
+    }
+
+    void deallocate(T* p, std::size_t)
+    {
+        std::free(p);
+    }
+
+    /**
+     * @brief Resize the storage at p from old_n to n objects, the first min(old_n, n) objects are copied byte by byte if it moves
+     * @return the new storage, p is no longer valid
+     * @throw std::bad_alloc, and p is still valid
+     */
+    T* reallocate(T* p, std::size_t old_n, std::size_t n)
+    {
+        (void)old_n;
+        if (n > max_size())
+            throw std::bad_alloc{};
+        if (auto new_p = static_cast<T*>(std::realloc(static_cast<void*>(p), n * sizeof(T))))
+            return new_p;
+        throw std::bad_alloc{};
+    }
+};
+
+template<typename T, typename U>
+constexpr bool operator==(malloc_allocator<T> const&, malloc_allocator<U> const&) noexcept { return true; }
+template<typename T, typename U>
+constexpr bool operator!=(malloc_allocator<T> const&, malloc_allocator<U> const&) noexcept { return false; }
+
+
+/**
+ * @brief A fixed buffer that arena_allocator hands out by bumping a pointer, meant to live on the stack next to the container using it
+ * 
+ * @tparam Size size of the buffer in bytes
+ * @tparam Alignment alignment of every block, a power of 2
+ * @details Only the most recent block is freed (or grown in place), others stay used until reset(). When the buffer is full,
+ * the blocks come from ::operator new instead. Not thread-safe
+ */
+template<std::size_t Size, std::size_t Alignment = alignof(std::max_align_t)>
+class inline_arena
+{
+    static_assert(Alignment != 0 && (Alignment & (Alignment - 1)) == 0, "Alignment must be a power of 2");
+
+    alignas(Alignment) unsigned char m_buffer[Size];
+    unsigned char* m_top = m_buffer;
+
+    static constexpr std::size_t align_up(std::size_t bytes) noexcept
+    {
+        return (bytes + (Alignment - 1)) & ~(Alignment - 1);
+    }
+
+    /*The end of the buffer too: allocate(0) returns it when the buffer is full*/
+    bool owns(void const* p) const noexcept
+    {
+        const auto address = reinterpret_cast<std::uintptr_t>(p);
+        return reinterpret_cast<std::uintptr_t>(m_buffer) <= address && address <= reinterpret_cast<std::uintptr_t>(m_buffer + Size);
+    }
+
+    std::size_t remaining() const noexcept
+    {
+        return static_cast<std::size_t>(m_buffer + Size - m_top);
+    }
+
+public:
+    static constexpr std::size_t alignment = Alignment;
+
+    inline_arena() noexcept = default;
+    inline_arena(inline_arena const&) = delete;
+    inline_arena& operator=(inline_arena const&) = delete;
+
+    /**
+     * @brief Allocate bytes aligned to Alignment, from the buffer if it has room, otherwise from ::operator new
+     */
+    void* allocate(std::size_t bytes)
+    {
+        if (align_up(bytes) <= remaining())
+        {
+            auto p = m_top;
+            m_top += align_up(bytes);
+            return p;
+        }
+        if constexpr (Alignment > alignof(std::max_align_t))
+            return ::operator new(bytes, static_cast<std::align_val_t>(Alignment));
+        else
+            return ::operator new(bytes);
+    }
+
+    /**
+     * @brief Free the block at p of the given size. A block of the buffer is only reused if it is the most recent one
+     */
+    void deallocate(void* p, std::size_t bytes) noexcept
+    {
+        if (owns(p))
+        {
+            if (static_cast<unsigned char*>(p) + align_up(bytes) == m_top)
+                m_top = static_cast<unsigned char*>(p);
+        }
+        else if constexpr (Alignment > alignof(std::max_align_t))
+            ::operator delete(p, bytes, static_cast<std::align_val_t>(Alignment));
+        else
+            ::operator delete(p, bytes);
+    }
+
+    /**
+     * @brief Grow the block at p from old_bytes to bytes without moving it, possible if it is the most recent block of the buffer
+     */
+    bool try_expand(void* p, std::size_t old_bytes, std::size_t bytes) noexcept
+    {
+        if (!owns(p) || static_cast<unsigned char*>(p) + align_up(old_bytes) != m_top)
+            return false;
+        if (align_up(bytes) > align_up(old_bytes) + remaining())
+            return false;
+        m_top = static_cast<unsigned char*>(p) + align_up(bytes);
+        return true;
+    }
+
+    static constexpr std::size_t size() noexcept { return Size; }
+    std::size_t used() const noexcept { return static_cast<std::size_t>(m_top - m_buffer); }
+
+    /**
+     * @brief Make the whole buffer available again, the blocks handed out must no longer be in use
+     */
+    void reset() noexcept { m_top = m_buffer; }
+};
+
+/**
+ * @brief An allocator taking its memory from an inline_arena, so small short-lived containers don't touch the heap
+ * 
+ * @tparam T Type of allocated object
+ * @details The arena must outlive every container using it. A container moved to or swapped with another one takes the allocator
+ * with the storage (the propagate traits are true), so moves and swaps never copy elements. A copy keeps its own allocator, so
+ * copying into a container never fills another container's arena. Allocators are equal if they share the arena
+ */
+template<typename T, std::size_t Size, std::size_t Alignment = alignof(std::max_align_t)>
+class arena_allocator
+{
+    static_assert(alignof(T) <= Alignment, "the arena can't align T");
+
+    template<typename, std::size_t, std::size_t> friend class arena_allocator;
+
+    inline_arena<Size, Alignment>* m_arena;
+
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using arena_type = inline_arena<Size, Alignment>;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    //Needed because the size is not a type template parameter, see allocator_traits::rebind_alloc
+    template<typename U>
+    struct rebind { using other = arena_allocator<U, Size, Alignment>; };
+
+    arena_allocator(arena_type& arena) noexcept : m_arena{ &arena } {}
+    template<typename U>
+    arena_allocator(arena_allocator<U, Size, Alignment> const& other) noexcept : m_arena{ other.m_arena } {}
+
+    constexpr auto max_size() const noexcept
+    {
+        return std::numeric_limits<size_type>::max() / sizeof(value_type);
+    }
+
+    T* allocate(std::size_t n)
+    {
+        if (n > max_size())
+            throw std::bad_alloc{};
+        return static_cast<T*>(m_arena->allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept
+    {
+        m_arena->deallocate(p, n * sizeof(T));
+    }
+
+    /**
+     * @brief Grow the storage at p from old_n to n objects in place, see inline_arena::try_expand
+     */
+    bool try_expand(T* p, std::size_t old_n, std::size_t n) noexcept
+    {
+        return n <= max_size() && m_arena->try_expand(p, old_n * sizeof(T), n * sizeof(T));
+    }
+
+    template<typename U>
+    bool operator==(arena_allocator<U, Size, Alignment> const& other) const noexcept { return m_arena == other.m_arena; }
+    template<typename U>
+    bool operator!=(arena_allocator<U, Size, Alignment> const& other) const noexcept { return m_arena != other.m_arena; }
+};
+
+
+/**
+ * @brief Counters of a stats_allocator, shared by all its copies. Relaxed atomics, so containers on several threads can share them
+ */
+struct allocation_stats
+{
+    std::atomic<std::size_t> allocations{ 0 };
+    std::atomic<std::size_t> deallocations{ 0 };
+    std::atomic<std::size_t> bytes_allocated{ 0 };    //in total
+    std::atomic<std::size_t> bytes_in_use{ 0 };
+    std::atomic<std::size_t> peak_bytes_in_use{ 0 };
+
+    void on_allocate(std::size_t bytes) noexcept
+    {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        bytes_allocated.fetch_add(bytes, std::memory_order_relaxed);
+        const auto in_use = bytes_in_use.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        auto peak = peak_bytes_in_use.load(std::memory_order_relaxed);
+        while (peak < in_use && !peak_bytes_in_use.compare_exchange_weak(peak, in_use, std::memory_order_relaxed)) {}
+    }
+
+    void on_deallocate(std::size_t bytes) noexcept
+    {
+        deallocations.fetch_add(1, std::memory_order_relaxed);
+        bytes_in_use.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    void reset() noexcept
+    {
+        allocations = 0;
+        deallocations = 0;
+        bytes_allocated = 0;
+        peak_bytes_in_use = bytes_in_use.load();
+    }
+
+    /**
+     * @brief The counters of default-constructed stats_allocator
+     */
+    static allocation_stats& global() noexcept
+    {
+        static allocation_stats stats;
+        return stats;
+    }
+};
+
+/**
+ * @brief Wraps the allocator Alloc, counting its allocations and bytes into an allocation_stats
+ * 
+ * @details reallocate(), try_expand(), construct() and destroy() are only there if Alloc has them, so containers take the same paths
+ * as with Alloc itself. The allocator moves with the storage if Alloc does or if Alloc is stateless, so the bytes stay counted where
+ * they were allocated. Allocators are equal if their Alloc are and they count into the same allocation_stats
+ */
+template<typename Alloc>
+class stats_allocator
+{
+    using traits = allocator_traits<Alloc>;
+
+    template<typename> friend class stats_allocator;
+
+    Alloc m_alloc;
+    allocation_stats* m_stats;
+
+public:
+    using value_type = typename traits::value_type;
+    using size_type = typename traits::size_type;
+    using difference_type = typename traits::difference_type;
+    using propagate_on_container_copy_assignment = typename traits::propagate_on_container_copy_assignment;
+    using propagate_on_container_move_assignment = bool_constant<traits::propagate_on_container_move_assignment::value || traits::is_always_equal::value>;
+    using propagate_on_container_swap = bool_constant<traits::propagate_on_container_swap::value || traits::is_always_equal::value>;
+    using is_always_equal = std::false_type;
+
+    template<typename U>
+    struct rebind { using other = stats_allocator<typename traits::template rebind_alloc<U>>; };
+
+    stats_allocator() : m_alloc{}, m_stats{ &allocation_stats::global() } {}
+    explicit stats_allocator(allocation_stats& stats, Alloc const& alloc = Alloc{}) : m_alloc{ alloc }, m_stats{ &stats } {}
+    template<typename OtherAlloc>
+    stats_allocator(stats_allocator<OtherAlloc> const& other) : m_alloc{ other.m_alloc }, m_stats{ other.m_stats } {}
+
+    allocation_stats& stats() const noexcept { return *m_stats; }
+    Alloc const& inner_allocator() const noexcept { return m_alloc; }
+
+    size_type max_size() const noexcept { return traits::max_size(m_alloc); }
+
+    value_type* allocate(std::size_t n)
+    {
+        auto p = traits::allocate(m_alloc, n);
+        m_stats->on_allocate(n * sizeof(value_type));
+        return p;
+    }
+
+    void deallocate(value_type* p, std::size_t n)
+    {
+        traits::deallocate(m_alloc, p, n);
+        m_stats->on_deallocate(n * sizeof(value_type));
+    }
+
+    value_type* reallocate(value_type* p, std::size_t old_n, std::size_t n) requires traits::can_reallocate
+    {
+        auto new_p = traits::reallocate(m_alloc, p, old_n, n);
+        m_stats->on_deallocate(old_n * sizeof(value_type));
+        m_stats->on_allocate(n * sizeof(value_type));
+        return new_p;
+    }
+
+    bool try_expand(value_type* p, std::size_t old_n, std::size_t n) requires traits::can_try_expand
+    {
+        if (!traits::try_expand(m_alloc, p, old_n, n))
+            return false;
+        m_stats->on_deallocate(old_n * sizeof(value_type));
+        m_stats->on_allocate(n * sizeof(value_type));
+        return true;
+    }
+
+    template<typename U, typename... Args>
+    void construct(U* p, Args&&... args) requires (!traits::template constructs_in_place<U, Args...>)
+    {
+        traits::construct(m_alloc, p, ::forward<Args>(args)...);
+    }
+
+    template<typename U>
+    void destroy(U* p) requires (!traits::template destroys_in_place<U>)
+    {
+        traits::destroy(m_alloc, p);
+    }
+
+    stats_allocator select_on_container_copy_construction() const
+    {
+        return stats_allocator{ *m_stats, traits::select_on_container_copy_construction(m_alloc) };
+    }
+
+    template<typename OtherAlloc>
+    bool operator==(stats_allocator<OtherAlloc> const& other) const noexcept { return m_stats == other.m_stats && m_alloc == other.m_alloc; }
+    template<typename OtherAlloc>
+    bool operator!=(stats_allocator<OtherAlloc> const& other) const noexcept { return !(*this == other); }
+};
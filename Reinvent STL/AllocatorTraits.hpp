@@ -39,12 +39,16 @@ private:
     template <typename Void, typename Allocator, typename Pointer, typename... Args>
     struct can_construct : false_type{};
     template <typename Allocator, typename Pointer, typename... Args>
-    struct can_construct<decltype(declval<Pointer>().construct(declval<Pointer*>(), declval<Args>()...), void()), Allocator, Pointer, Args...>
+    struct can_construct<decltype(declval<Allocator&>().construct(declval<Pointer*>(), declval<Args>()...), void()), Allocator, Pointer, Args...>
         : true_type{};
 
     template<typename Void, typename Allocator, typename Pointer> struct can_destroy : false_type{};
     template<typename Allocator, typename Pointer>
-    struct can_destroy<decltype(declval<Allocator>().destory(declval<Pointer>()), void()), Allocator, Pointer> : true_type{};
+    struct can_destroy<decltype(declval<Allocator&>().destroy(declval<Pointer*>()), void()), Allocator, Pointer> : true_type{};
+
+    template<typename T> using m_reallocate = decltype(declval<T&>().reallocate(declval<typename T::value_type*>(), std::size_t{}, std::size_t{}));
+
+    template<typename T> using m_try_expand = decltype(declval<T&>().try_expand(declval<typename T::value_type*>(), std::size_t{}, std::size_t{}));
 
     template<typename Void, typename Allocator> struct has_max_size : false_type{};
     template<typename Allocator> struct has_max_size<decltype(declval<Allocator>().max_size(), void()), Allocator> : true_type{};
@@ -68,9 +72,10 @@ public:
     using propagate_on_container_swap           = detected_or_t<false_type, m_propagate_on_container_swap, Alloc>;
     using is_always_equal                       = detected_or_t<typename is_empty<Alloc>::type, m_is_always_equal, Alloc>;
 
-    //<Alloc::rebind<T>::other> if present, otherwise <Alloc<T, Args>> if this Alloc is <Alloc<U, Args>>
+    //<Alloc::rebind<T>::other> if present, otherwise <Alloc<T, Args>> if this Alloc is <Alloc<U, Args>>.
+    //The replacement is only named when chosen, Alloc may have non-type template parameters if it has rebind
     template<typename T>
-    using rebind_alloc = detected_or_t<replace_first_template_type_t<Alloc, T>, m_rebind_other, Alloc, T>;
+    using rebind_alloc = typename conditional_t<detected_v<m_rebind_other, Alloc, T>, detected<void, m_rebind_other, Alloc, T>, replace_first_template_type<Alloc, T>>::type;
 
     template<typename T>
     using rebind_traits = rebind_alloc<T>;
@@ -96,7 +101,40 @@ public:
      */
     static pointer allocate(Alloc& a, size_type n, const_void_pointer hint)
     {
-        return a.allocate(a, n, hint);
+        return a.allocate(n, hint);
+    }
+
+    /*Not in the standard: Alloc may grow or shrink an allocation, see reallocate() and try_expand() */
+    static constexpr bool can_reallocate = detected_v<m_reallocate, Alloc>;
+    static constexpr bool can_try_expand = detected_v<m_try_expand, Alloc>;
+
+    /*Not in the standard: construct() and destroy() are placement new and the destructor, so the uninitialized algorithms may use memcpy/memset*/
+    template<typename T, typename... Args>
+    static constexpr bool constructs_in_place = !can_construct<void, Alloc, T, Args...>::value;
+    template<typename T>
+    static constexpr bool destroys_in_place = !can_destroy<void, Alloc, T>::value;
+
+    /**
+     * @brief Resize the storage at p from old_n to n objects, by calling a.reallocate(p, old_n, n).
+     *  The objects are moved byte by byte, so only use it for trivially relocatable types
+     * @return the new storage, p is no longer valid
+     * @note Only available if can_reallocate
+     */
+    static pointer reallocate(Alloc& a, pointer p, size_type old_n, size_type n)
+    {
+        return a.reallocate(p, old_n, n);
+    }
+
+    /**
+     * @brief Try to grow the storage at p from old_n to n objects without moving it, by calling a.try_expand(p, old_n, n)
+     * @return true if it grew, false if p is unchanged, or Alloc can't do it
+     */
+    static bool try_expand(Alloc& a, pointer p, size_type old_n, size_type n)
+    {
+        if constexpr (can_try_expand)
+            return a.try_expand(p, old_n, n);
+        else
+            return false;
     }
 
     /**
@@ -123,9 +161,9 @@ public:
     static void construct(Alloc& a, T* p, Args&&... args)
     {
         if constexpr (can_construct<void, Alloc, T, Args...>::value)
-            a.construct(p, forward<Args>(args)...);
+            a.construct(p, ::forward<Args>(args)...);
         else
-            ::new (static_cast<void*>(p)) T(std::forward<Args>(args)...);
+            ::new (static_cast<void*>(p)) T(::forward<Args>(args)...);
     }
 
 
@@ -7,6 +7,7 @@ template<auto v>
 struct integral_constant
 {
     using value_type = decltype(v);
+    using type = integral_constant;
     static constexpr value_type value = v;
 
     /**
@@ -78,5 +79,5 @@ struct integral_constant
     template<typename Rhs>
     using bit_xor = integral_constant<value^ Rhs::value>;
 
-    using bit_not = integral_constant<~value>;
+    using bit_not = integral_constant<~+value>;    //promoted explicitly, ~ on a bool warns
 };
\ No newline at end of file
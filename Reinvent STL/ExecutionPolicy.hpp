@@ -0,0 +1,45 @@
+#pragma once
+#include "TypeTraits.hpp"
+
+/**
+ * @brief The execution policies of the parallel algorithms in Algorithm.hpp, like <execution>
+ * @details
+ *  seq         runs on the calling thread, in order
+ *  unseq       runs on the calling thread, vectorized (SIMD kernels, or loops the compiler may vectorize)
+ *  par         split into chunks run on the thread pool (see ThreadPool.hpp)
+ *  par_unseq   both
+ */
+namespace execution
+{
+    struct sequenced_policy { explicit sequenced_policy() = default; };
+    struct unsequenced_policy { explicit unsequenced_policy() = default; };
+    struct parallel_policy { explicit parallel_policy() = default; };
+    struct parallel_unsequenced_policy { explicit parallel_unsequenced_policy() = default; };
+
+    inline constexpr sequenced_policy seq{};
+    inline constexpr unsequenced_policy unseq{};
+    inline constexpr parallel_policy par{};
+    inline constexpr parallel_unsequenced_policy par_unseq{};
+}
+
+template<typename T> struct is_execution_policy : false_type {};
+template<> struct is_execution_policy<execution::sequenced_policy> : true_type {};
+template<> struct is_execution_policy<execution::unsequenced_policy> : true_type {};
+template<> struct is_execution_policy<execution::parallel_policy> : true_type {};
+template<> struct is_execution_policy<execution::parallel_unsequenced_policy> : true_type {};
+template<typename T> inline constexpr bool is_execution_policy_v = is_execution_policy<remove_cv_t<remove_reference_t<T>>>::value;
+
+namespace details
+{
+    template<typename ExecutionPolicy>
+    inline constexpr bool is_parallel_policy_v = is_same_v<remove_cv_t<remove_reference_t<ExecutionPolicy>>, execution::parallel_policy>
+        || is_same_v<remove_cv_t<remove_reference_t<ExecutionPolicy>>, execution::parallel_unsequenced_policy>;
+
+    template<typename ExecutionPolicy>
+    inline constexpr bool is_vectorized_policy_v = is_same_v<remove_cv_t<remove_reference_t<ExecutionPolicy>>, execution::unsequenced_policy>
+        || is_same_v<remove_cv_t<remove_reference_t<ExecutionPolicy>>, execution::parallel_unsequenced_policy>;
+
+    /*Only for the algorithms taking an ExecutionPolicy, so they don't collide with the overloads without one*/
+    template<typename ExecutionPolicy, typename Result = void>
+    using enable_if_execution_policy_t = enable_if_t<is_execution_policy_v<ExecutionPolicy>, Result>;
+}
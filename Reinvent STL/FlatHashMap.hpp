@@ -0,0 +1,846 @@
+#pragma once
+#include "AllocatorTraits.hpp"
+#include "Allocator.hpp"
+#include "Utility.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>      //for std::memset, std::memcpy
+#include <bit>          //for std::countr_zero, std::countl_zero
+#include <utility>      //for std::pair, std::piecewise_construct
+#include <tuple>        //for std::forward_as_tuple
+#include <functional>   //for std::hash, std::equal_to
+#include <iterator>     //for std::forward_iterator_tag
+#include <stdexcept>    //for std::out_of_range
+#include <initializer_list>
+#include <type_traits>  //for std::is_convertible_v, std::is_nothrow_invocable_v
+#include <memory>       //for std::unique_ptr
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace details
+{
+    /**
+     * @brief The control byte of a slot of the hash table:
+     *  full:       0b0xxxxxxx, the low 7 bits of the hash (H2)
+     *  empty:      0b10000000
+     *  deleted:    0b11111110
+     *  sentinel:   0b11111111, after the last slot, so iterators stop there
+     */
+    using ctrl_t = signed char;
+    inline constexpr ctrl_t ctrl_empty = -128;
+    inline constexpr ctrl_t ctrl_deleted = -2;
+    inline constexpr ctrl_t ctrl_sentinel = -1;
+
+    inline constexpr bool is_full(ctrl_t c) noexcept { return c >= 0; }
+    inline constexpr bool is_empty_or_deleted(ctrl_t c) noexcept { return c < ctrl_sentinel; }
+
+    /**
+     * @brief The matching slots of a group, one bit (or byte, if Shift is 3) per slot
+     */
+    template<typename Mask, int Width, int Shift>
+    class bit_mask
+    {
+        Mask m_mask;
+    public:
+        explicit bit_mask(Mask mask) noexcept : m_mask{ mask } {}
+
+        explicit operator bool() const noexcept { return m_mask != 0; }
+
+        int lowest() const noexcept { return std::countr_zero(m_mask) >> Shift; }
+
+        /*Number of non-matching slots at the end of the group*/
+        int leading_zeros() const noexcept
+        {
+            constexpr int unused_bits = sizeof(Mask) * 8 - (Width << Shift);
+            return (std::countl_zero(m_mask) - unused_bits) >> Shift;
+        }
+
+        /*Iterate over the matching slots*/
+        int operator*() const noexcept { return lowest(); }
+        bit_mask& operator++() noexcept { m_mask &= m_mask - 1; return *this; }
+        bit_mask begin() const noexcept { return *this; }
+        bit_mask end() const noexcept { return bit_mask{ 0 }; }
+        bool operator!=(bit_mask const& rhs) const noexcept { return m_mask != rhs.m_mask; }
+    };
+
+#if defined(__SSE2__) || defined(_M_X64)
+    /*16 control bytes, compared at once with SSE2*/
+    struct group
+    {
+        static constexpr int width = 16;
+        using mask = bit_mask<std::uint32_t, width, 0>;
+
+        __m128i m_ctrl;
+
+        explicit group(ctrl_t const* ctrl) noexcept : m_ctrl{ _mm_loadu_si128(reinterpret_cast<__m128i const*>(ctrl)) } {}
+
+        mask match(ctrl_t h2) const noexcept
+        {
+            return mask{ static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), m_ctrl))) };
+        }
+
+        mask match_empty() const noexcept { return match(ctrl_empty); }
+
+        mask match_empty_or_deleted() const noexcept
+        {
+            return mask{ static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(ctrl_sentinel), m_ctrl))) };
+        }
+    };
+#else
+    /*8 control bytes in a 64-bit word, compared with bit tricks. Assumes little endian*/
+    struct group
+    {
+        static constexpr int width = 8;
+        using mask = bit_mask<std::uint64_t, width, 3>;
+
+        static constexpr std::uint64_t lsbs = 0x0101010101010101ull;
+        static constexpr std::uint64_t msbs = 0x8080808080808080ull;
+
+        std::uint64_t m_ctrl;
+
+        explicit group(ctrl_t const* ctrl) noexcept { std::memcpy(&m_ctrl, ctrl, sizeof(m_ctrl)); }
+
+        /*May have false positives, which are filtered out by comparing the keys*/
+        mask match(ctrl_t h2) const noexcept
+        {
+            const auto x = m_ctrl ^ (lsbs * static_cast<unsigned char>(h2));
+            return mask{ (x - lsbs) & ~x & msbs };
+        }
+
+        mask match_empty() const noexcept { return mask{ (m_ctrl & (~m_ctrl << 6)) & msbs }; }
+
+        mask match_empty_or_deleted() const noexcept { return mask{ (m_ctrl & (~m_ctrl << 7)) & msbs }; }
+    };
+#endif
+
+    /*The control bytes of a table without slots, so lookups need no special case*/
+    alignas(16) inline constexpr ctrl_t empty_group[group::width] = {
+        ctrl_sentinel, ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty,
+#if defined(__SSE2__) || defined(_M_X64)
+        ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty
+#endif
+    };
+
+    /*Spread the bits of the hash, because std::hash of integers is the identity*/
+    inline constexpr std::uint64_t mix_hash(std::uint64_t h) noexcept
+    {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ull;
+        h ^= h >> 33;
+        return h;
+    }
+}
+
+/**
+ * @brief An unordered associative container in one flat array, with open addressing, like Abseil's SwissTable
+ *
+ * @tparam Key type of the keys
+ * @tparam T type of the mapped values
+ * @tparam Hash hash function of Key
+ * @tparam KeyEqual compares the keys for equality
+ * @tparam Allocator for the slots (value_type) and the control bytes
+ *
+ * @details Every slot has a control byte with 7 bits of its hash. A lookup compares a group of 16 control bytes at once (SSE2),
+ * and only compares the keys of the matching slots, so it rarely touches more than one cache line of slots.
+ * The capacity is 2^n - 1, and at most 7/8 of it is used.
+ * Differences from std::unordered_map:
+ *  - rehashing moves the elements, so references and iterators are invalidated by insertion
+ *  - erase() leaves a tombstone, which is reused by later insertions
+ *  - find(), contains(), count() and erase() accept any type comparable with Key if both Hash and KeyEqual are transparent
+ */
+template<typename Key, typename T, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>,
+    typename Allocator = allocator<std::pair<const Key, T>>>
+class flat_hash_map
+{
+public:
+    /*Member types*/
+    using key_type          = Key;
+    using mapped_type       = T;
+    using value_type        = std::pair<const Key, T>;
+    using size_type         = std::size_t;
+    using difference_type   = std::ptrdiff_t;
+    using hasher            = Hash;
+    using key_equal         = KeyEqual;
+    using allocator_type    = Allocator;
+    using reference         = value_type&;
+    using const_reference   = value_type const&;
+
+private:
+    using ctrl_t = details::ctrl_t;
+    using group = details::group;
+    using slot_alloc_type = typename allocator_traits<Allocator>::template rebind_alloc<value_type>;
+    using slot_traits = allocator_traits<slot_alloc_type>;
+    using ctrl_alloc_type = typename allocator_traits<Allocator>::template rebind_alloc<ctrl_t>;
+    using ctrl_traits = allocator_traits<ctrl_alloc_type>;
+    using slot_pointer = value_type*;
+
+    static constexpr bool transparent = details::is_transparent<Hash>::value && details::is_transparent<KeyEqual>::value;
+
+    template<bool Const>
+    class iterator_impl
+    {
+        friend class flat_hash_map;
+        ctrl_t* m_ctrl{};
+        slot_pointer m_slot{};
+
+        iterator_impl(ctrl_t* ctrl, slot_pointer slot) noexcept : m_ctrl{ ctrl }, m_slot{ slot } {}
+
+        void skip_empty_or_deleted() noexcept
+        {
+            while (details::is_empty_or_deleted(*m_ctrl))
+                ++m_ctrl, ++m_slot;
+        }
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = typename flat_hash_map::value_type;
+        using difference_type   = std::ptrdiff_t;
+        using reference         = conditional_t<Const, value_type const&, value_type&>;
+        using pointer           = conditional_t<Const, value_type const*, value_type*>;
+
+        iterator_impl() noexcept = default;
+
+        /*iterator -> const_iterator*/
+        template<bool WasConst, typename = enable_if_t<Const && !WasConst>>
+        iterator_impl(iterator_impl<WasConst> const& other) noexcept : m_ctrl{ other.m_ctrl }, m_slot{ other.m_slot } {}
+
+        reference operator*() const noexcept { return *m_slot; }
+        pointer operator->() const noexcept { return m_slot; }
+
+        iterator_impl& operator++() noexcept
+        {
+            ++m_ctrl, ++m_slot;
+            skip_empty_or_deleted();
+            return *this;
+        }
+
+        iterator_impl operator++(int) noexcept
+        {
+            auto temp = *this;
+            ++*this;
+            return temp;
+        }
+
+        friend bool operator==(iterator_impl const& lhs, iterator_impl const& rhs) noexcept { return lhs.m_ctrl == rhs.m_ctrl; }
+        friend bool operator!=(iterator_impl const& lhs, iterator_impl const& rhs) noexcept { return lhs.m_ctrl != rhs.m_ctrl; }
+    };
+
+public:
+    using iterator          = iterator_impl<false>;
+    using const_iterator    = iterator_impl<true>;
+
+private:
+    ctrl_t* m_ctrl = const_cast<ctrl_t*>(details::empty_group);
+    slot_pointer m_slots{};
+    size_type m_size{};
+    size_type m_capacity{};
+    size_type m_growth_left{};
+    [[no_unique_address]] Hash m_hash;
+    [[no_unique_address]] KeyEqual m_equal;
+    [[no_unique_address]] slot_alloc_type m_alloc;
+
+    /*Number of control bytes: one per slot, the sentinel, and a copy of the first group - 1 bytes, so a group can be loaded from any slot*/
+    static constexpr size_type ctrl_bytes(size_type capacity) noexcept { return capacity + group::width; }
+
+    /*At most 7/8 of the slots are full, and at least one slot is always empty so probing ends*/
+    static constexpr size_type capacity_to_growth(size_type capacity) noexcept
+    {
+        const auto growth = capacity - capacity / 8;
+        return growth == capacity ? capacity - 1 : growth;
+    }
+
+    /*The smallest capacity 2^n - 1 for n elements*/
+    static constexpr size_type capacity_for(size_type n) noexcept
+    {
+        size_type capacity = 7;
+        while (capacity_to_growth(capacity) < n)
+            capacity = capacity * 2 + 1;
+        return capacity;
+    }
+
+    template<typename K>
+    std::uint64_t hash_of(K const& key) const { return details::mix_hash(static_cast<std::uint64_t>(m_hash(key))); }
+
+    static size_type h1(std::uint64_t hash) noexcept { return static_cast<size_type>(hash >> 7); }
+    static ctrl_t h2(std::uint64_t hash) noexcept { return static_cast<ctrl_t>(hash & 0x7f); }
+
+    /*Set the control byte of slot i, and its copy after the sentinel*/
+    void set_ctrl(size_type i, ctrl_t h) noexcept
+    {
+        constexpr size_type cloned = group::width - 1;
+        m_ctrl[i] = h;
+        m_ctrl[((i - cloned) & m_capacity) + (cloned & m_capacity)] = h;
+    }
+
+    /**
+     * @brief Quadratic probing over the groups, starting from the group of the hash
+     * @details Visits every group once when the capacity is 2^n - 1
+     */
+    struct probe_sequence
+    {
+        size_type m_mask;
+        size_type m_offset;
+        size_type m_index{};
+
+        probe_sequence(std::uint64_t hash, size_type mask) noexcept : m_mask{ mask }, m_offset{ h1(hash) & mask } {}
+
+        size_type offset(size_type i) const noexcept { return (m_offset + i) & m_mask; }
+
+        void next() noexcept
+        {
+            m_index += group::width;
+            m_offset = (m_offset + m_index) & m_mask;
+        }
+    };
+
+    template<typename K>
+    size_type find_index(K const& key, std::uint64_t hash) const
+    {
+        probe_sequence seq{ hash, m_capacity };
+        while (true)
+        {
+            const group g{ m_ctrl + seq.m_offset };
+            for (auto i : g.match(h2(hash)))
+            {
+                const auto index = seq.offset(i);
+                if (m_equal(m_slots[index].first, key))
+                    return index;
+            }
+            if (g.match_empty())
+                return m_capacity;
+            seq.next();
+        }
+    }
+
+    /*The first empty or deleted slot for the hash*/
+    size_type find_first_non_full(std::uint64_t hash) const noexcept
+    {
+        probe_sequence seq{ hash, m_capacity };
+        while (true)
+        {
+            if (const auto mask = group{ m_ctrl + seq.m_offset }.match_empty_or_deleted())
+                return seq.offset(mask.lowest());
+            seq.next();
+        }
+    }
+
+    /**
+     * @brief Construct an element for the hash from args in a free slot, growing the table if needed
+     * @return the index of the new element
+     */
+    template<typename... Args>
+    size_type insert_new(std::uint64_t hash, Args&&... args)
+    {
+        auto index = find_first_non_full(hash);
+        if (m_growth_left == 0 && m_ctrl[index] != details::ctrl_deleted)
+        {
+            grow();
+            index = find_first_non_full(hash);
+        }
+        slot_traits::construct(m_alloc, m_slots + index, ::forward<Args>(args)...);
+        m_growth_left -= (m_ctrl[index] == details::ctrl_empty);
+        set_ctrl(index, h2(hash));
+        ++m_size;
+        return index;
+    }
+
+    /*Twice the capacity, or the same capacity to drop the tombstones if they take much of it*/
+    void grow()
+    {
+        if (m_capacity > group::width && m_size * 32 <= m_capacity * 25)
+            resize(m_capacity);
+        else
+            resize(m_capacity ? m_capacity * 2 + 1 : capacity_for(1));
+    }
+
+    /*Move the elements to a new table of new_capacity. Elements that can't be moved without throwing are copied*/
+    void resize(size_type new_capacity)
+    {
+        ctrl_alloc_type ctrl_alloc{ m_alloc };
+        const auto new_ctrl = ctrl_traits::allocate(ctrl_alloc, ctrl_bytes(new_capacity));
+        slot_pointer new_slots;
+        try
+        {
+            new_slots = slot_traits::allocate(m_alloc, new_capacity);
+        }
+        catch (...)
+        {
+            ctrl_traits::deallocate(ctrl_alloc, new_ctrl, ctrl_bytes(new_capacity));
+            throw;
+        }
+        //a hash that can throw runs on every element before any of them is moved out
+        constexpr bool hash_may_throw = !std::is_nothrow_invocable_v<Hash const&, Key const&>;
+        std::unique_ptr<std::uint64_t[]> hashes;
+        if constexpr (hash_may_throw)
+        {
+            try
+            {
+                hashes.reset(new std::uint64_t[m_capacity]);
+                for (size_type i = 0; i != m_capacity; ++i)
+                {
+                    if (details::is_full(m_ctrl[i]))
+                        hashes[i] = hash_of(m_slots[i].first);
+                }
+            }
+            catch (...)
+            {
+                slot_traits::deallocate(m_alloc, new_slots, new_capacity);
+                ctrl_traits::deallocate(ctrl_alloc, new_ctrl, ctrl_bytes(new_capacity));
+                throw;
+            }
+        }
+        std::memset(new_ctrl, static_cast<unsigned char>(details::ctrl_empty), ctrl_bytes(new_capacity));
+        new_ctrl[new_capacity] = details::ctrl_sentinel;
+
+        flat_hash_map old{ m_hash, m_equal, m_alloc };
+        old.adopt(m_ctrl, m_slots, m_size, m_capacity, m_growth_left);
+        adopt(new_ctrl, new_slots, 0, new_capacity, capacity_to_growth(new_capacity));
+        try
+        {
+            for (size_type i = 0; i != old.m_capacity; ++i)
+            {
+                if (!details::is_full(old.m_ctrl[i]))
+                    continue;
+                auto& slot = old.m_slots[i];
+                const auto hash = hash_may_throw ? hashes[i] : hash_of(slot.first);
+                const auto index = find_first_non_full(hash);
+                slot_traits::construct(m_alloc, m_slots + index,
+                    std::move_if_noexcept(const_cast<Key&>(slot.first)), std::move_if_noexcept(slot.second));
+                set_ctrl(index, h2(hash));
+                ++m_size;
+                --m_growth_left;
+            }
+        }
+        catch (...)
+        {
+            //only copying an element can throw here, so the old elements are untouched, give them back
+            swap_table(old);
+            throw;
+        }
+    }
+
+    void adopt(ctrl_t* ctrl, slot_pointer slots, size_type size, size_type capacity, size_type growth_left) noexcept
+    {
+        m_ctrl = ctrl;
+        m_slots = slots;
+        m_size = size;
+        m_capacity = capacity;
+        m_growth_left = growth_left;
+    }
+
+    void swap_table(flat_hash_map& other) noexcept
+    {
+        using std::swap;
+        swap(m_ctrl, other.m_ctrl);
+        swap(m_slots, other.m_slots);
+        swap(m_size, other.m_size);
+        swap(m_capacity, other.m_capacity);
+        swap(m_growth_left, other.m_growth_left);
+    }
+
+    void destroy_slots() noexcept
+    {
+        if constexpr (!is_trivially_destructible_v<value_type>)
+        {
+            for (size_type i = 0; i != m_capacity; ++i)
+            {
+                if (details::is_full(m_ctrl[i]))
+                    slot_traits::destroy(m_alloc, m_slots + i);
+            }
+        }
+    }
+
+    /*Destroy the elements and free the table*/
+    void release() noexcept
+    {
+        if (!m_capacity)
+            return;
+        destroy_slots();
+        ctrl_alloc_type ctrl_alloc{ m_alloc };
+        ctrl_traits::deallocate(ctrl_alloc, m_ctrl, ctrl_bytes(m_capacity));
+        slot_traits::deallocate(m_alloc, m_slots, m_capacity);
+        adopt(const_cast<ctrl_t*>(details::empty_group), nullptr, 0, 0, 0);
+    }
+
+    void erase_at(size_type index) noexcept
+    {
+        slot_traits::destroy(m_alloc, m_slots + index);
+        --m_size;
+        //An empty slot ends the probing, so it can only be marked empty if no group containing it has ever been full
+        const auto index_before = (index - group::width) & m_capacity;
+        const auto empty_after = group{ m_ctrl + index }.match_empty();
+        const auto empty_before = group{ m_ctrl + index_before }.match_empty();
+        const bool was_never_full = empty_before && empty_after &&
+            empty_after.lowest() + empty_before.leading_zeros() < group::width;
+        set_ctrl(index, was_never_full ? details::ctrl_empty : details::ctrl_deleted);
+        m_growth_left += was_never_full;
+    }
+
+    iterator iterator_at(size_type index) noexcept { return { m_ctrl + index, m_slots + index }; }
+    const_iterator iterator_at(size_type index) const noexcept { return { m_ctrl + index, m_slots + index }; }
+
+public:
+    /*Constructors*/
+
+    flat_hash_map() = default;
+
+    /**
+     * @brief Construct an empty map with space for bucket_count elements
+     */
+    explicit flat_hash_map(size_type bucket_count, Hash const& hash = Hash{}, KeyEqual const& equal = KeyEqual{}, Allocator const& alloc = Allocator{})
+        : flat_hash_map(hash, equal, alloc)
+    {
+        reserve(bucket_count);
+    }
+
+    flat_hash_map(Hash const& hash, KeyEqual const& equal, Allocator const& alloc) : m_hash{ hash }, m_equal{ equal }, m_alloc{ alloc } {}
+
+    explicit flat_hash_map(Allocator const& alloc) : m_alloc{ alloc } {}
+
+    /**
+     * @brief Construct the map with the elements of [first, last). Of the elements with equal keys, only the first is inserted
+     */
+    template<typename InputIt>
+    flat_hash_map(InputIt first, InputIt last, size_type bucket_count = 0, Hash const& hash = Hash{}, KeyEqual const& equal = KeyEqual{}, Allocator const& alloc = Allocator{})
+        : flat_hash_map(bucket_count, hash, equal, alloc)
+    {
+        insert(first, last);
+    }
+
+    flat_hash_map(std::initializer_list<value_type> init, size_type bucket_count = 0, Hash const& hash = Hash{}, KeyEqual const& equal = KeyEqual{}, Allocator const& alloc = Allocator{})
+        : flat_hash_map(init.begin(), init.end(), bucket_count ? bucket_count : init.size(), hash, equal, alloc)
+    {
+    }
+
+    flat_hash_map(flat_hash_map const& other)
+        : flat_hash_map(other.size(), other.m_hash, other.m_equal, slot_traits::select_on_container_copy_construction(other.m_alloc))
+    {
+        for (auto const& value : other)
+            insert_new(hash_of(value.first), value);
+    }
+
+    flat_hash_map(flat_hash_map&& other) noexcept : m_hash{ other.m_hash }, m_equal{ other.m_equal }, m_alloc{ other.m_alloc }
+    {
+        swap_table(other);
+    }
+
+    ~flat_hash_map() { release(); }
+
+    flat_hash_map& operator=(flat_hash_map const& other)
+    {
+        if (this == &other)
+            return *this;
+        release();
+        if constexpr (slot_traits::propagate_on_container_copy_assignment::value)
+            m_alloc = other.m_alloc;
+        m_hash = other.m_hash;
+        m_equal = other.m_equal;
+        reserve(other.size());
+        for (auto const& value : other)
+            insert_new(hash_of(value.first), value);
+        return *this;
+    }
+
+    flat_hash_map& operator=(flat_hash_map&& other) noexcept(slot_traits::propagate_on_container_move_assignment::value || slot_traits::is_always_equal::value)
+    {
+        if (this == &other)
+            return *this;
+        release();
+        m_hash = other.m_hash;
+        m_equal = other.m_equal;
+        if constexpr (slot_traits::propagate_on_container_move_assignment::value)
+        {
+            m_alloc = ::move(other.m_alloc);
+            swap_table(other);
+        }
+        else
+        {
+            if (slot_traits::is_always_equal::value || m_alloc == other.m_alloc)
+                swap_table(other);
+            else
+            {
+                reserve(other.size());
+                for (auto& value : other)
+                    insert_new(hash_of(value.first), ::move(const_cast<Key&>(value.first)), ::move(value.second));
+                other.clear();
+            }
+        }
+        return *this;
+    }
+
+    flat_hash_map& operator=(std::initializer_list<value_type> ilist)
+    {
+        clear();
+        insert(ilist);
+        return *this;
+    }
+
+    allocator_type get_allocator() const noexcept { return allocator_type{ m_alloc }; }
+    hasher hash_function() const { return m_hash; }
+    key_equal key_eq() const { return m_equal; }
+
+    /*Iterators*/
+
+    iterator begin() noexcept
+    {
+        auto it = iterator_at(0);
+        it.skip_empty_or_deleted();
+        return it;
+    }
+
+    const_iterator begin() const noexcept { return const_cast<flat_hash_map*>(this)->begin(); }
+    const_iterator cbegin() const noexcept { return begin(); }
+    iterator end() noexcept { return iterator_at(m_capacity); }
+    const_iterator end() const noexcept { return iterator_at(m_capacity); }
+    const_iterator cend() const noexcept { return end(); }
+
+    /*Capacity*/
+
+    bool empty() const noexcept { return m_size == 0; }
+    size_type size() const noexcept { return m_size; }
+    size_type max_size() const noexcept { return slot_traits::max_size(m_alloc); }
+
+    /*Number of slots, a 7/8 of them can be used*/
+    size_type capacity() const noexcept { return m_capacity; }
+    size_type bucket_count() const noexcept { return m_capacity; }
+    float load_factor() const noexcept { return m_capacity ? static_cast<float>(m_size) / m_capacity : 0.0f; }
+    float max_load_factor() const noexcept { return 7.0f / 8; }
+
+    /**
+     * @brief Make space for at least count elements, so inserting them doesn't rehash
+     */
+    void reserve(size_type count)
+    {
+        if (count > m_size + m_growth_left)
+            resize(capacity_for(count));
+    }
+
+    /**
+     * @brief Rebuild the table for at least count elements, which also drops the tombstones
+     */
+    void rehash(size_type count)
+    {
+        const auto capacity = capacity_for(count > m_size ? count : m_size);
+        if (m_size == 0 && count == 0)
+            release();
+        else
+            resize(capacity);
+    }
+
+    /*Modifiers*/
+
+    /**
+     * @brief Destroy all elements, the capacity is unchanged
+     */
+    void clear() noexcept
+    {
+        if (!m_capacity)
+            return;
+        destroy_slots();
+        std::memset(m_ctrl, static_cast<unsigned char>(details::ctrl_empty), ctrl_bytes(m_capacity));
+        m_ctrl[m_capacity] = details::ctrl_sentinel;
+        m_size = 0;
+        m_growth_left = capacity_to_growth(m_capacity);
+    }
+
+    /**
+     * @brief Insert an element with key and mapped_type constructed from args, if there is no element with key
+     * @return the iterator to the element with key, and whether it is inserted
+     */
+    template<typename... Args>
+    std::pair<iterator, bool> try_emplace(Key const& key, Args&&... args)
+    {
+        const auto hash = hash_of(key);
+        if (const auto index = find_index(key, hash); index != m_capacity)
+            return { iterator_at(index), false };
+        return { iterator_at(insert_new(hash, std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(::forward<Args>(args)...))), true };
+    }
+
+    template<typename... Args>
+    std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args)
+    {
+        const auto hash = hash_of(key);
+        if (const auto index = find_index(key, hash); index != m_capacity)
+            return { iterator_at(index), false };
+        return { iterator_at(insert_new(hash, std::piecewise_construct, std::forward_as_tuple(::move(key)), std::forward_as_tuple(::forward<Args>(args)...))), true };
+    }
+
+    /**
+     * @brief Construct an element from args, and insert it if there is no element with its key
+     */
+    template<typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args)
+    {
+        value_type value(::forward<Args>(args)...);
+        const auto hash = hash_of(value.first);
+        if (const auto index = find_index(value.first, hash); index != m_capacity)
+            return { iterator_at(index), false };
+        return { iterator_at(insert_new(hash, ::move(const_cast<Key&>(value.first)), ::move(value.second))), true };
+    }
+
+    std::pair<iterator, bool> insert(value_type const& value)
+    {
+        const auto hash = hash_of(value.first);
+        if (const auto index = find_index(value.first, hash); index != m_capacity)
+            return { iterator_at(index), false };
+        return { iterator_at(insert_new(hash, value)), true };
+    }
+
+    std::pair<iterator, bool> insert(value_type&& value)
+    {
+        const auto hash = hash_of(value.first);
+        if (const auto index = find_index(value.first, hash); index != m_capacity)
+            return { iterator_at(index), false };
+        return { iterator_at(insert_new(hash, ::move(value))), true };
+    }
+
+    template<typename InputIt>
+    void insert(InputIt first, InputIt last)
+    {
+        for (; first != last; ++first)
+            insert(*first);
+    }
+
+    void insert(std::initializer_list<value_type> ilist) { insert(ilist.begin(), ilist.end()); }
+
+    /**
+     * @brief Assign obj to the element with key, or insert it if there is none
+     */
+    template<typename M>
+    std::pair<iterator, bool> insert_or_assign(Key const& key, M&& obj)
+    {
+        auto result = try_emplace(key, ::forward<M>(obj));
+        if (!result.second)
+            result.first->second = ::forward<M>(obj);
+        return result;
+    }
+
+    template<typename M>
+    std::pair<iterator, bool> insert_or_assign(Key&& key, M&& obj)
+    {
+        auto result = try_emplace(::move(key), ::forward<M>(obj));
+        if (!result.second)
+            result.first->second = ::forward<M>(obj);
+        return result;
+    }
+
+    /**
+     * @brief Remove the element at pos
+     * @return iterator following the removed element
+     */
+    iterator erase(const_iterator pos) noexcept
+    {
+        const auto index = static_cast<size_type>(pos.m_ctrl - m_ctrl);
+        erase_at(index);
+        auto next = iterator_at(index);
+        ++next;
+        return next;
+    }
+
+    iterator erase(iterator pos) noexcept { return erase(const_iterator{ pos }); }
+
+    /**
+     * @brief Remove the element with key
+     * @return number of elements removed (0 or 1)
+     */
+    size_type erase(Key const& key)
+    {
+        const auto index = find_index(key, hash_of(key));
+        if (index == m_capacity)
+            return 0;
+        erase_at(index);
+        return 1;
+    }
+
+    template<typename K, typename = enable_if_t<transparent && !std::is_convertible_v<K, const_iterator> && !std::is_convertible_v<K, iterator>>>
+    size_type erase(K const& key)
+    {
+        const auto index = find_index(key, hash_of(key));
+        if (index == m_capacity)
+            return 0;
+        erase_at(index);
+        return 1;
+    }
+
+    void swap(flat_hash_map& other) noexcept
+    {
+        using std::swap;
+        swap_table(other);
+        swap(m_hash, other.m_hash);
+        swap(m_equal, other.m_equal);
+        if constexpr (slot_traits::propagate_on_container_swap::value)
+            swap(m_alloc, other.m_alloc);
+    }
+
+    /*Lookup*/
+
+    iterator find(Key const& key)
+    {
+        const auto index = find_index(key, hash_of(key));
+        return index == m_capacity ? end() : iterator_at(index);
+    }
+
+    const_iterator find(Key const& key) const { return const_cast<flat_hash_map*>(this)->find(key); }
+
+    template<typename K, typename = enable_if_t<transparent && sizeof(K)>>
+    iterator find(K const& key)
+    {
+        const auto index = find_index(key, hash_of(key));
+        return index == m_capacity ? end() : iterator_at(index);
+    }
+
+    template<typename K, typename = enable_if_t<transparent && sizeof(K)>>
+    const_iterator find(K const& key) const { return const_cast<flat_hash_map*>(this)->find(key); }
+
+    bool contains(Key const& key) const { return find_index(key, hash_of(key)) != m_capacity; }
+
+    template<typename K, typename = enable_if_t<transparent && sizeof(K)>>
+    bool contains(K const& key) const { return find_index(key, hash_of(key)) != m_capacity; }
+
+    size_type count(Key const& key) const { return contains(key); }
+
+    template<typename K, typename = enable_if_t<transparent && sizeof(K)>>
+    size_type count(K const& key) const { return contains(key); }
+
+    /**
+     * @brief Returns a reference to the mapped value of the element with key
+     * @throw std::out_of_range if there is no such element
+     */
+    T& at(Key const& key)
+    {
+        const auto index = find_index(key, hash_of(key));
+        if (index == m_capacity)
+            throw std::out_of_range{ "flat_hash_map::at()" };
+        return m_slots[index].second;
+    }
+
+    T const& at(Key const& key) const { return const_cast<flat_hash_map*>(this)->at(key); }
+
+    /**
+     * @brief Returns a reference to the mapped value of the element with key, inserting a value-initialized one if there is none
+     */
+    T& operator[](Key const& key) { return try_emplace(key).first->second; }
+    T& operator[](Key&& key) { return try_emplace(::move(key)).first->second; }
+};
+
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Alloc>
+void swap(flat_hash_map<Key, T, Hash, KeyEqual, Alloc>& lhs, flat_hash_map<Key, T, Hash, KeyEqual, Alloc>& rhs) noexcept { lhs.swap(rhs); }
+
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Alloc>
+bool operator==(flat_hash_map<Key, T, Hash, KeyEqual, Alloc> const& lhs, flat_hash_map<Key, T, Hash, KeyEqual, Alloc> const& rhs)
+{
+    if (lhs.size() != rhs.size())
+        return false;
+    for (auto const& [key, value] : lhs)
+    {
+        const auto it = rhs.find(key);
+        if (it == rhs.end() || !(it->second == value))
+            return false;
+    }
+    return true;
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Alloc>
+bool operator!=(flat_hash_map<Key, T, Hash, KeyEqual, Alloc> const& lhs, flat_hash_map<Key, T, Hash, KeyEqual, Alloc> const& rhs) { return !(lhs == rhs); }
@@ -0,0 +1,711 @@
+#pragma once
+#include "Vector.hpp"
+#include <functional>   //for std::less
+#include <algorithm>    //for std::sort, std::stable_sort, std::unique
+#include <utility>      //for std::pair
+#include <iterator>     //for std::random_access_iterator_tag
+#include <stdexcept>    //for std::out_of_range
+#include <initializer_list>
+
+/**
+ * @brief Tag to construct or insert a range that is already sorted and has no duplicate keys, so it isn't sorted again
+ */
+struct sorted_unique_t { explicit sorted_unique_t() = default; };
+inline constexpr sorted_unique_t sorted_unique{};
+
+namespace details
+{
+    /**
+     * @brief Without a branch the CPU can't speculate which half comes next, so load the middle of both,
+     *  otherwise every step of a large search waits for a cache miss. Ranges that fit in L1 don't need it
+     */
+    template<typename RandomIt>
+    inline void prefetch_both_halves([[maybe_unused]] RandomIt first, [[maybe_unused]] std::size_t n, [[maybe_unused]] std::size_t half)
+    {
+#if defined(__GNUC__)
+        if (n * sizeof(*first) <= 16 * 1024)
+            return;
+        __builtin_prefetch(::addressof(first[half / 2]));
+        __builtin_prefetch(::addressof(first[half + (n - half) / 2]));
+#endif
+    }
+
+    /**
+     * @brief lower_bound() without a branch on the comparison, so the loop has no mispredictions
+     * @details The range shrinks by half every step whatever the result, and the comparison only selects the next base with a cmov.
+     * Its number of steps only depends on n.
+     */
+    template<typename RandomIt, typename K, typename Compare>
+    RandomIt branchless_lower_bound(RandomIt first, std::size_t n, K const& key, Compare& compare)
+    {
+        if (n == 0)
+            return first;
+        while (n > 1)
+        {
+            const auto half = n / 2;
+            prefetch_both_halves(first, n, half);
+            first += compare(first[half], key) ? half : 0;
+            n -= half;
+        }
+        return first + compare(*first, key);
+    }
+
+    template<typename RandomIt, typename K, typename Compare>
+    RandomIt branchless_upper_bound(RandomIt first, std::size_t n, K const& key, Compare& compare)
+    {
+        if (n == 0)
+            return first;
+        while (n > 1)
+        {
+            const auto half = n / 2;
+            prefetch_both_halves(first, n, half);
+            first += compare(key, first[half]) ? 0 : half;
+            n -= half;
+        }
+        return first + !compare(key, *first);
+    }
+
+    /**
+     * @brief The permutation that stable sorts keys, without the later duplicates
+     */
+    template<typename KeyContainer, typename Compare>
+    vector<std::size_t> sorted_unique_permutation(KeyContainer const& keys, Compare& compare)
+    {
+        vector<std::size_t> order(keys.size());
+        for (std::size_t i = 0; i != order.size(); ++i)
+            order[i] = i;
+        std::stable_sort(order.begin(), order.end(), [&](auto lhs, auto rhs) { return compare(keys[lhs], keys[rhs]); });
+        const auto last = std::unique(order.begin(), order.end(), [&](auto lhs, auto rhs) { return !compare(keys[lhs], keys[rhs]); });
+        order.erase(last, order.end());
+        return order;
+    }
+
+    /*Reorder the container by the permutation, which may drop elements*/
+    template<typename Container>
+    void apply_permutation(Container& container, vector<std::size_t> const& order)
+    {
+        Container result(container.get_allocator());
+        result.reserve(order.size());
+        for (auto i : order)
+            result.push_back(::move(container[i]));
+        container = ::move(result);
+    }
+}
+
+/**
+ * @brief A sorted set in a contiguous container, for read-mostly lookup tables
+ *
+ * @tparam Key type of the keys
+ * @tparam Compare the ordering of the keys
+ * @tparam KeyContainer a random access container of the keys, sorted
+ *
+ * @details Lookups are branchless binary searches (see details::branchless_lower_bound), and iteration is a walk over an array.
+ * Insertion and erasure move the elements after them, so build it in bulk when possible: the range constructor and insert(first, last) sort once.
+ */
+template<typename Key, typename Compare = std::less<Key>, typename KeyContainer = vector<Key>>
+class flat_set
+{
+public:
+    /*Member types*/
+    using key_type                  = Key;
+    using value_type                = Key;
+    using key_compare               = Compare;
+    using value_compare             = Compare;
+    using container_type            = KeyContainer;
+    using size_type                 = typename KeyContainer::size_type;
+    using difference_type           = typename KeyContainer::difference_type;
+    using reference                 = value_type&;
+    using const_reference           = value_type const&;
+    using iterator                  = typename KeyContainer::const_iterator;   //keys can't be modified in place
+    using const_iterator            = typename KeyContainer::const_iterator;
+    using reverse_iterator          = typename KeyContainer::const_reverse_iterator;
+    using const_reverse_iterator    = typename KeyContainer::const_reverse_iterator;
+
+private:
+    KeyContainer m_keys;
+    [[no_unique_address]] Compare m_compare;
+
+    static constexpr bool transparent = details::is_transparent<Compare>::value;
+
+    bool equivalent(Key const& lhs, Key const& rhs) const { return !m_compare(lhs, rhs) && !m_compare(rhs, lhs); }
+
+    void sort_and_unique()
+    {
+        std::stable_sort(m_keys.begin(), m_keys.end(), m_compare);    //of the equivalent keys, the first wins as in flat_map
+        m_keys.erase(std::unique(m_keys.begin(), m_keys.end(), [this](auto const& lhs, auto const& rhs) { return equivalent(lhs, rhs); }), m_keys.end());
+    }
+
+    template<typename K>
+    const_iterator lower_bound_of(K const& key) const { return details::branchless_lower_bound(m_keys.begin(), m_keys.size(), key, m_compare); }
+
+    template<typename K>
+    const_iterator upper_bound_of(K const& key) const { return details::branchless_upper_bound(m_keys.begin(), m_keys.size(), key, m_compare); }
+
+    template<typename K>
+    const_iterator find_of(K const& key) const
+    {
+        const auto it = lower_bound_of(key);
+        return it != m_keys.end() && !m_compare(key, *it) ? it : m_keys.end();
+    }
+
+public:
+    /*Constructors*/
+
+    flat_set() = default;
+
+    explicit flat_set(Compare const& compare) : m_compare{ compare } {}
+
+    /**
+     * @brief Construct the set from keys, which are sorted once
+     */
+    explicit flat_set(KeyContainer keys, Compare const& compare = Compare{}) : m_keys{ ::move(keys) }, m_compare{ compare }
+    {
+        sort_and_unique();
+    }
+
+    /**
+     * @brief Construct the set from keys, which must already be sorted and have no duplicates
+     */
+    flat_set(sorted_unique_t, KeyContainer keys, Compare const& compare = Compare{}) : m_keys{ ::move(keys) }, m_compare{ compare } {}
+
+    template<typename InputIt, typename = enable_if_t<details::is_input_iterator<InputIt>::value>>
+    flat_set(InputIt first, InputIt last, Compare const& compare = Compare{}) : m_keys(first, last), m_compare{ compare }
+    {
+        sort_and_unique();
+    }
+
+    template<typename InputIt, typename = enable_if_t<details::is_input_iterator<InputIt>::value>>
+    flat_set(sorted_unique_t, InputIt first, InputIt last, Compare const& compare = Compare{}) : m_keys(first, last), m_compare{ compare } {}
+
+    flat_set(std::initializer_list<Key> init, Compare const& compare = Compare{}) : flat_set(init.begin(), init.end(), compare) {}
+
+    flat_set& operator=(std::initializer_list<Key> ilist)
+    {
+        m_keys.assign(ilist.begin(), ilist.end());
+        sort_and_unique();
+        return *this;
+    }
+
+    /*Iterators*/
+
+    const_iterator begin() const noexcept { return m_keys.begin(); }
+    const_iterator cbegin() const noexcept { return m_keys.begin(); }
+    const_iterator end() const noexcept { return m_keys.end(); }
+    const_iterator cend() const noexcept { return m_keys.end(); }
+    const_reverse_iterator rbegin() const noexcept { return m_keys.rbegin(); }
+    const_reverse_iterator crbegin() const noexcept { return m_keys.rbegin(); }
+    const_reverse_iterator rend() const noexcept { return m_keys.rend(); }
+    const_reverse_iterator crend() const noexcept { return m_keys.rend(); }
+
+    /*Capacity*/
+
+    bool empty() const noexcept { return m_keys.empty(); }
+    size_type size() const noexcept { return m_keys.size(); }
+    size_type max_size() const noexcept { return m_keys.max_size(); }
+    void reserve(size_type n) { m_keys.reserve(n); }
+    void shrink_to_fit() { m_keys.shrink_to_fit(); }
+
+    /*Modifiers*/
+
+    /**
+     * @brief Insert key if there is no equivalent key
+     * @return the iterator to the equivalent key, and whether key is inserted
+     */
+    std::pair<iterator, bool> insert(Key const& key)
+    {
+        const auto it = lower_bound_of(key);
+        if (it != m_keys.end() && !m_compare(key, *it))
+            return { it, false };
+        return { m_keys.insert(it, key), true };
+    }
+
+    std::pair<iterator, bool> insert(Key&& key)
+    {
+        const auto it = lower_bound_of(key);
+        if (it != m_keys.end() && !m_compare(key, *it))
+            return { it, false };
+        return { m_keys.insert(it, ::move(key)), true };
+    }
+
+    template<typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args) { return insert(Key(::forward<Args>(args)...)); }
+
+    /**
+     * @brief Insert the keys of [first, last), appended and then sorted once. Existing keys win over equivalent new ones
+     */
+    template<typename InputIt, typename = enable_if_t<details::is_input_iterator<InputIt>::value>>
+    void insert(InputIt first, InputIt last)
+    {
+        m_keys.insert(m_keys.end(), first, last);
+        std::stable_sort(m_keys.begin(), m_keys.end(), m_compare);
+        m_keys.erase(std::unique(m_keys.begin(), m_keys.end(), [this](auto const& lhs, auto const& rhs) { return equivalent(lhs, rhs); }), m_keys.end());
+    }
+
+    void insert(std::initializer_list<Key> ilist) { insert(ilist.begin(), ilist.end()); }
+
+    iterator erase(const_iterator pos) { return m_keys.erase(pos); }
+    iterator erase(const_iterator first, const_iterator last) { return m_keys.erase(first, last); }
+
+    /**
+     * @brief Remove the key equivalent to key
+     * @return number of keys removed (0 or 1)
+     */
+    size_type erase(Key const& key)
+    {
+        const auto it = find_of(key);
+        if (it == m_keys.end())
+            return 0;
+        m_keys.erase(it);
+        return 1;
+    }
+
+    void clear() noexcept { m_keys.clear(); }
+
+    void swap(flat_set& other) noexcept
+    {
+        using std::swap;
+        swap(m_keys, other.m_keys);
+        swap(m_compare, other.m_compare);
+    }
+
+    /**
+     * @brief Take the container out, the set is left empty
+     */
+    KeyContainer extract() &&
+    {
+        auto keys = ::move(m_keys);
+        m_keys.clear();
+        return keys;
+    }
+
+    /**
+     * @brief Replace the container, keys must be sorted and have no duplicates
+     */
+    void replace(KeyContainer&& keys) { m_keys = ::move(keys); }
+
+    /*Lookup*/
+
+    const_iterator find(Key const& key) const { return find_of(key); }
+    bool contains(Key const& key) const { return find_of(key) != m_keys.end(); }
+    size_type count(Key const& key) const { return contains(key); }
+    const_iterator lower_bound(Key const& key) const { return lower_bound_of(key); }
+    const_iterator upper_bound(Key const& key) const { return upper_bound_of(key); }
+    std::pair<const_iterator, const_iterator> equal_range(Key const& key) const { return { lower_bound_of(key), upper_bound_of(key) }; }
+
+    template<typename K, typename = enable_if_t<transparent && sizeof(K)>>
+    const_iterator find(K const& key) const { return find_of(key); }
+    template<typename K, typename = enable_if_t<transparent && sizeof(K)>>
+    bool contains(K const& key) const { return find_of(key) != m_keys.end(); }
+    template<typename K, typename = enable_if_t<transparent && sizeof(K)>>
+    size_type count(K const& key) const { return contains(key); }
+    template<typename K, typename = enable_if_t<transparent && sizeof(K)>>
+    const_iterator lower_bound(K const& key) const { return lower_bound_of(key); }
+    template<typename K, typename = enable_if_t<transparent && sizeof(K)>>
+    const_iterator upper_bound(K const& key) const { return upper_bound_of(key); }
+
+    /*Observers*/
+
+    key_compare key_comp() const { return m_compare; }
+    value_compare value_comp() const { return m_compare; }
+    KeyContainer const& keys() const noexcept { return m_keys; }
+
+    friend bool operator==(flat_set const& lhs, flat_set const& rhs) { return lhs.m_keys == rhs.m_keys; }
+    friend bool operator!=(flat_set const& lhs, flat_set const& rhs) { return !(lhs == rhs); }
+};
+
+/**
+ * @brief A sorted map in two contiguous containers, one of the keys and one of the values, for read-mostly lookup tables
+ *
+ * @tparam Key type of the keys
+ * @tparam T type of the mapped values
+ * @tparam Compare the ordering of the keys
+ * @tparam KeyContainer a random access container of the keys, sorted
+ * @tparam MappedContainer a random access container of the values, values[i] belongs to keys[i]
+ *
+ * @details Separate containers keep the keys dense, so a lookup only touches keys, and the value of the found key at the end.
+ * Lookups are branchless binary searches. Insertion and erasure move the elements after them,
+ * so build it in bulk when possible: the range constructor and insert(first, last) sort once.
+ * The iterators are random access, and dereference to std::pair<Key const&, T&>, not to a value_type&.
+ */
+template<typename Key, typename T, typename Compare = std::less<Key>, typename KeyContainer = vector<Key>, typename MappedContainer = vector<T>>
+class flat_map
+{
+public:
+    /*Member types*/
+    using key_type                  = Key;
+    using mapped_type               = T;
+    using value_type                = std::pair<Key, T>;
+    using key_compare               = Compare;
+    using size_type                 = std::size_t;
+    using difference_type           = std::ptrdiff_t;
+    using key_container_type        = KeyContainer;
+    using mapped_container_type     = MappedContainer;
+    using reference                 = std::pair<Key const&, T&>;
+    using const_reference           = std::pair<Key const&, T const&>;
+
+private:
+    template<bool Const>
+    class iterator_impl
+    {
+        friend class flat_map;
+        using key_iterator = typename KeyContainer::const_iterator;
+        using mapped_iterator = conditional_t<Const, typename MappedContainer::const_iterator, typename MappedContainer::iterator>;
+
+        key_iterator m_key{};
+        mapped_iterator m_mapped{};
+
+        iterator_impl(key_iterator key, mapped_iterator mapped) noexcept : m_key{ key }, m_mapped{ mapped } {}
+
+        /*operator-> has to return something with ->, the pair of references is a temporary*/
+        struct arrow_proxy
+        {
+            conditional_t<Const, const_reference, reference> m_pair;
+            auto* operator->() noexcept { return &m_pair; }
+        };
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type        = typename flat_map::value_type;
+        using difference_type   = std::ptrdiff_t;
+        using reference         = conditional_t<Const, typename flat_map::const_reference, typename flat_map::reference>;
+        using pointer           = arrow_proxy;
+
+        iterator_impl() noexcept = default;
+
+        /*iterator -> const_iterator*/
+        template<bool WasConst, typename = enable_if_t<Const && !WasConst>>
+        iterator_impl(iterator_impl<WasConst> const& other) noexcept : m_key{ other.m_key }, m_mapped{ other.m_mapped } {}
+
+        reference operator*() const noexcept { return { *m_key, *m_mapped }; }
+        pointer operator->() const noexcept { return { **this }; }
+        reference operator[](difference_type n) const noexcept { return { m_key[n], m_mapped[n] }; }
+
+        iterator_impl& operator++() noexcept { ++m_key, ++m_mapped; return *this; }
+        iterator_impl& operator--() noexcept { --m_key, --m_mapped; return *this; }
+        iterator_impl operator++(int) noexcept { auto temp = *this; ++*this; return temp; }
+        iterator_impl operator--(int) noexcept { auto temp = *this; --*this; return temp; }
+        iterator_impl& operator+=(difference_type n) noexcept { m_key += n, m_mapped += n; return *this; }
+        iterator_impl& operator-=(difference_type n) noexcept { m_key -= n, m_mapped -= n; return *this; }
+        friend iterator_impl operator+(iterator_impl it, difference_type n) noexcept { return it += n; }
+        friend iterator_impl operator+(difference_type n, iterator_impl it) noexcept { return it += n; }
+        friend iterator_impl operator-(iterator_impl it, difference_type n) noexcept { return it -= n; }
+        friend difference_type operator-(iterator_impl const& lhs, iterator_impl const& rhs) noexcept { return lhs.m_key - rhs.m_key; }
+
+        friend bool operator==(iterator_impl const& lhs, iterator_impl const& rhs) noexcept { return lhs.m_key == rhs.m_key; }
+        friend bool operator!=(iterator_impl const& lhs, iterator_impl const& rhs) noexcept { return lhs.m_key != rhs.m_key; }
+        friend bool operator<(iterator_impl const& lhs, iterator_impl const& rhs) noexcept { return lhs.m_key < rhs.m_key; }
+        friend bool operator>(iterator_impl const& lhs, iterator_impl const& rhs) noexcept { return rhs < lhs; }
+        friend bool operator<=(iterator_impl const& lhs, iterator_impl const& rhs) noexcept { return !(rhs < lhs); }
+        friend bool operator>=(iterator_impl const& lhs, iterator_impl const& rhs) noexcept { return !(lhs < rhs); }
+    };
+
+public:
+    using iterator                  = iterator_impl<false>;
+    using const_iterator            = iterator_impl<true>;
+    using reverse_iterator          = std::reverse_iterator<iterator>;
+    using const_reverse_iterator    = std::reverse_iterator<const_iterator>;
+
+private:
+    KeyContainer m_keys;
+    MappedContainer m_values;
+    [[no_unique_address]] Compare m_compare;
+
+    static constexpr bool transparent = details::is_transparent<Compare>::value;
+
+    /*Sort by key, keeping the first of the equivalent keys*/
+    void sort_and_unique()
+    {
+        const auto order = details::sorted_unique_permutation(m_keys, m_compare);
+        details::apply_permutation(m_keys, order);
+        details::apply_permutation(m_values, order);
+    }
+
+    iterator iterator_at(size_type i) noexcept { return { m_keys.begin() + i, m_values.begin() + i }; }
+    const_iterator iterator_at(size_type i) const noexcept { return { m_keys.begin() + i, m_values.begin() + i }; }
+
+    template<typename K>
+    size_type lower_bound_index(K const& key) const
+    {
+        return details::branchless_lower_bound(m_keys.begin(), m_keys.size(), key, m_compare) - m_keys.begin();
+    }
+
+    template<typename K>
+    size_type upper_bound_index(K const& key) const
+    {
+        return details::branchless_upper_bound(m_keys.begin(), m_keys.size(), key, m_compare) - m_keys.begin();
+    }
+
+    /*Index of key, or size() if there is none*/
+    template<typename K>
+    size_type find_index(K const& key) const
+    {
+        const auto i = lower_bound_index(key);
+        return i != m_keys.size() && !m_compare(key, m_keys[i]) ? i : m_keys.size();
+    }
+
+    template<typename K, typename... Args>
+    std::pair<iterator, bool> try_emplace_impl(K&& key, Args&&... args)
+    {
+        const auto i = lower_bound_index(key);
+        if (i != m_keys.size() && !m_compare(key, m_keys[i]))
+            return { iterator_at(i), false };
+        m_values.emplace(m_values.begin() + i, ::forward<Args>(args)...);
+        try
+        {
+            m_keys.emplace(m_keys.begin() + i, ::forward<K>(key));
+        }
+        catch (...)
+        {
+            m_values.erase(m_values.begin() + i);
+            throw;
+        }
+        return { iterator_at(i), true };
+    }
+
+public:
+    /*Constructors*/
+
+    flat_map() = default;
+
+    explicit flat_map(Compare const& compare) : m_compare{ compare } {}
+
+    /**
+     * @brief Construct the map from the keys and their values, which are sorted once
+     * @note keys.size() must be values.size()
+     */
+    flat_map(KeyContainer keys, MappedContainer values, Compare const& compare = Compare{})
+        : m_keys{ ::move(keys) }, m_values{ ::move(values) }, m_compare{ compare }
+    {
+        sort_and_unique();
+    }
+
+    /**
+     * @brief Construct the map from the keys and their values, the keys must already be sorted and have no duplicates
+     */
+    flat_map(sorted_unique_t, KeyContainer keys, MappedContainer values, Compare const& compare = Compare{})
+        : m_keys{ ::move(keys) }, m_values{ ::move(values) }, m_compare{ compare }
+    {
+    }
+
+    /**
+     * @brief Construct the map from the pairs in [first, last), sorted once. Of the equivalent keys, the first is kept
+     */
+    template<typename InputIt, typename = enable_if_t<details::is_input_iterator<InputIt>::value>>
+    flat_map(InputIt first, InputIt last, Compare const& compare = Compare{}) : m_compare{ compare }
+    {
+        insert(first, last);
+    }
+
+    template<typename InputIt, typename = enable_if_t<details::is_input_iterator<InputIt>::value>>
+    flat_map(sorted_unique_t, InputIt first, InputIt last, Compare const& compare = Compare{}) : m_compare{ compare }
+    {
+        for (; first != last; ++first)
+        {
+            m_keys.push_back(first->first);
+            m_values.push_back(first->second);
+        }
+    }
+
+    flat_map(std::initializer_list<value_type> init, Compare const& compare = Compare{}) : flat_map(init.begin(), init.end(), compare) {}
+
+    flat_map& operator=(std::initializer_list<value_type> ilist)
+    {
+        clear();
+        insert(ilist);
+        return *this;
+    }
+
+    /*Iterators*/
+
+    iterator begin() noexcept { return iterator_at(0); }
+    const_iterator begin() const noexcept { return iterator_at(0); }
+    const_iterator cbegin() const noexcept { return begin(); }
+    iterator end() noexcept { return iterator_at(size()); }
+    const_iterator end() const noexcept { return iterator_at(size()); }
+    const_iterator cend() const noexcept { return end(); }
+    reverse_iterator rbegin() noexcept { return reverse_iterator{ end() }; }
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator{ end() }; }
+    const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+    reverse_iterator rend() noexcept { return reverse_iterator{ begin() }; }
+    const_reverse_iterator rend() const noexcept { return const_reverse_iterator{ begin() }; }
+    const_reverse_iterator crend() const noexcept { return rend(); }
+
+    /*Capacity*/
+
+    bool empty() const noexcept { return m_keys.empty(); }
+    size_type size() const noexcept { return m_keys.size(); }
+    size_type max_size() const noexcept { return m_keys.max_size() < m_values.max_size() ? m_keys.max_size() : m_values.max_size(); }
+
+    void reserve(size_type n)
+    {
+        m_keys.reserve(n);
+        m_values.reserve(n);
+    }
+
+    /*Element access*/
+
+    /**
+     * @brief Returns a reference to the value of key
+     * @throw std::out_of_range if there is no such key
+     */
+    T& at(Key const& key)
+    {
+        const auto i = find_index(key);
+        if (i == size())
+            throw std::out_of_range{ "flat_map::at()" };
+        return m_values[i];
+    }
+
+    T const& at(Key const& key) const { return const_cast<flat_map*>(this)->at(key); }
+
+    /**
+     * @brief Returns a reference to the value of key, inserting a value-initialized one if there is none
+     */
+    T& operator[](Key const& key) { return try_emplace_impl(key).first->second; }
+    T& operator[](Key&& key) { return try_emplace_impl(::move(key)).first->second; }
+
+    /*Modifiers*/
+
+    template<typename... Args>
+    std::pair<iterator, bool> try_emplace(Key const& key, Args&&... args) { return try_emplace_impl(key, ::forward<Args>(args)...); }
+
+    template<typename... Args>
+    std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args) { return try_emplace_impl(::move(key), ::forward<Args>(args)...); }
+
+    template<typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args)
+    {
+        value_type value(::forward<Args>(args)...);
+        return try_emplace_impl(::move(value.first), ::move(value.second));
+    }
+
+    std::pair<iterator, bool> insert(value_type const& value) { return try_emplace_impl(value.first, value.second); }
+    std::pair<iterator, bool> insert(value_type&& value) { return try_emplace_impl(::move(value.first), ::move(value.second)); }
+
+    /**
+     * @brief Insert the pairs of [first, last), appended and then sorted once. Existing keys win over equivalent new ones
+     */
+    template<typename InputIt, typename = enable_if_t<details::is_input_iterator<InputIt>::value>>
+    void insert(InputIt first, InputIt last)
+    {
+        for (; first != last; ++first)
+        {
+            m_keys.push_back((*first).first);
+            m_values.push_back((*first).second);
+        }
+        sort_and_unique();
+    }
+
+    void insert(std::initializer_list<value_type> ilist) { insert(ilist.begin(), ilist.end()); }
+
+    template<typename M>
+    std::pair<iterator, bool> insert_or_assign(Key const& key, M&& obj)
+    {
+        auto result = try_emplace_impl(key, ::forward<M>(obj));
+        if (!result.second)
+            result.first->second = ::forward<M>(obj);
+        return result;
+    }
+
+    template<typename M>
+    std::pair<iterator, bool> insert_or_assign(Key&& key, M&& obj)
+    {
+        auto result = try_emplace_impl(::move(key), ::forward<M>(obj));
+        if (!result.second)
+            result.first->second = ::forward<M>(obj);
+        return result;
+    }
+
+    iterator erase(const_iterator pos)
+    {
+        const auto i = static_cast<size_type>(pos.m_key - m_keys.begin());
+        m_keys.erase(m_keys.begin() + i);
+        m_values.erase(m_values.begin() + i);
+        return iterator_at(i);
+    }
+
+    iterator erase(iterator pos) { return erase(const_iterator{ pos }); }
+
+    iterator erase(const_iterator first, const_iterator last)
+    {
+        const auto i = static_cast<size_type>(first.m_key - m_keys.begin());
+        const auto j = static_cast<size_type>(last.m_key - m_keys.begin());
+        m_keys.erase(m_keys.begin() + i, m_keys.begin() + j);
+        m_values.erase(m_values.begin() + i, m_values.begin() + j);
+        return iterator_at(i);
+    }
+
+    /**
+     * @brief Remove the element with key
+     * @return number of elements removed (0 or 1)
+     */
+    size_type erase(Key const& key)
+    {
+        const auto i = find_index(key);
+        if (i == size())
+            return 0;
+        erase(iterator_at(i));
+        return 1;
+    }
+
+    void clear() noexcept
+    {
+        m_keys.clear();
+        m_values.clear();
+    }
+
+    void swap(flat_map& other) noexcept
+    {
+        using std::swap;
+        swap(m_keys, other.m_keys);
+        swap(m_values, other.m_values);
+        swap(m_compare, other.m_compare);
+    }
+
+    /**
+     * @brief Take the containers out, the map is left empty
+     */
+    std::pair<KeyContainer, MappedContainer> extract() &&
+    {
+        std::pair<KeyContainer, MappedContainer> result{ ::move(m_keys), ::move(m_values) };
+        clear();
+        return result;
+    }
+
+    /**
+     * @brief Replace the containers, keys must be sorted and have no duplicates
+     */
+    void replace(KeyContainer&& keys, MappedContainer&& values)
+    {
+        m_keys = ::move(keys);
+        m_values = ::move(values);
+    }
+
+    /*Lookup*/
+
+    iterator find(Key const& key) { return iterator_at(find_index(key)); }
+    const_iterator find(Key const& key) const { return iterator_at(find_index(key)); }
+    bool contains(Key const& key) const { return find_index(key) != size(); }
+    size_type count(Key const& key) const { return contains(key); }
+    iterator lower_bound(Key const& key) { return iterator_at(lower_bound_index(key)); }
+    const_iterator lower_bound(Key const& key) const { return iterator_at(lower_bound_index(key)); }
+    iterator upper_bound(Key const& key) { return iterator_at(upper_bound_index(key)); }
+    const_iterator upper_bound(Key const& key) const { return iterator_at(upper_bound_index(key)); }
+
+    template<typename K, typename = enable_if_t<transparent && sizeof(K)>>
+    iterator find(K const& key) { return iterator_at(find_index(key)); }
+    template<typename K, typename = enable_if_t<transparent && sizeof(K)>>
+    const_iterator find(K const& key) const { return iterator_at(find_index(key)); }
+    template<typename K, typename = enable_if_t<transparent && sizeof(K)>>
+    bool contains(K const& key) const { return find_index(key) != size(); }
+    template<typename K, typename = enable_if_t<transparent && sizeof(K)>>
+    size_type count(K const& key) const { return contains(key); }
+
+    /*Observers*/
+
+    key_compare key_comp() const { return m_compare; }
+    KeyContainer const& keys() const noexcept { return m_keys; }
+    MappedContainer const& values() const noexcept { return m_values; }
+
+    friend bool operator==(flat_map const& lhs, flat_map const& rhs) { return lhs.m_keys == rhs.m_keys && lhs.m_values == rhs.m_values; }
+    friend bool operator!=(flat_map const& lhs, flat_map const& rhs) { return !(lhs == rhs); }
+};
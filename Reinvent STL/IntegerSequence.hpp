@@ -5,27 +5,144 @@
 
 template<typename T, T... Ints>
 struct integer_sequence;
+
+/* Every algorithm below builds its result in one pack expansion over an index sequence, so the instantiation depth doesn't grow
+ * with the length of the sequence (the old versions recursed once per element, and went over g++'s -ftemplate-depth of 900
+ * at about 420 elements).
+ * See compile_benchmark_integer_sequence.cpp for the measurements
+ */
 namespace details
 {
-    template<typename Seq1, typename Seq2>
-    struct reverse_impl {};
+    /*Double integer_sequence<T, 0, ... N-1> into 0, ... 2N-1, plus 2N if Odd*/
+    template<typename Seq, bool Odd>
+    struct double_sequence;
+
+    template<typename T, T... Is>
+    struct double_sequence<integer_sequence<T, Is...>, false>
+    {
+        using type = integer_sequence<T, Is..., static_cast<T>(sizeof...(Is) + Is)...>;
+    };
+
+    template<typename T, T... Is>
+    struct double_sequence<integer_sequence<T, Is...>, true>
+    {
+        using type = integer_sequence<T, Is..., static_cast<T>(sizeof...(Is) + Is)..., static_cast<T>(2 * sizeof...(Is))>;
+    };
 
-    template<typename T, T...Ints2>
-    struct reverse_impl<integer_sequence<T>, integer_sequence<T, Ints2...>>
+    /*0, ... N-1 by doubling, log2(N) levels deep*/
+    template<typename T, std::size_t N>
+    struct make_index_sequence_by_doubling
     {
-        using type = integer_sequence<T, Ints2...>; //end condition
+        using type = typename double_sequence<typename make_index_sequence_by_doubling<T, N / 2>::type, N % 2 == 1>::type;
     };
 
-    template<typename T, T front, T...Ints1, T...Ints2>
-    struct reverse_impl<integer_sequence<T, front, Ints1...>, integer_sequence<T, Ints2...>>
+    template<typename T>
+    struct make_index_sequence_by_doubling<T, 0>
     {
-        //push front of seq1 -> front of seq2
-        using type = typename reverse_impl<integer_sequence<T, Ints1...>, integer_sequence<T, front, Ints2...>>::type;
+        using type = integer_sequence<T>;
+    };
 
-        /* Using the back of seq1 won't work because non-terminal pack is not deduced
-        That is: integer_sequence<T, Ints..., back>, where Ints... is not deducible
-        */
+    /*integer_sequence<T, 0, ... N-1>, with the builtin of the compiler if it has one, which takes no recursion at all.
+     * Define REINVENT_STL_NO_INTEGER_BUILTINS to always use the doubling version
+     */
+#if defined(REINVENT_STL_NO_INTEGER_BUILTINS)
+#elif defined(__has_builtin)
+#if __has_builtin(__make_integer_seq)
+#define REINVENT_STL_MAKE_INTEGER_SEQ
+#elif __has_builtin(__integer_pack)
+#define REINVENT_STL_INTEGER_PACK
+#endif
+#elif defined(_MSC_VER)
+#define REINVENT_STL_MAKE_INTEGER_SEQ
+#endif
+
+#if defined(REINVENT_STL_MAKE_INTEGER_SEQ)
+    template<typename T, std::size_t N>
+    using zero_based_sequence = __make_integer_seq<integer_sequence, T, static_cast<T>(N)>;
+#elif defined(REINVENT_STL_INTEGER_PACK)
+    template<typename T, std::size_t N>
+    using zero_based_sequence = integer_sequence<T, __integer_pack(static_cast<T>(N))...>;
+#else
+    template<typename T, std::size_t N>
+    using zero_based_sequence = typename make_index_sequence_by_doubling<T, N>::type;
+#endif
+
+    template<std::size_t N>
+    using indices = zero_based_sequence<std::size_t, N>;
+
+    /* The algorithms compute their result as an std::array in a constexpr function, and from_array turns it back into a sequence.
+     * Indexing an array template parameter is cheap, while naming a template-id with the N elements as arguments costs O(N) every
+     * time (a values_of<T, Ints...> variable template indexed once per element made even the eager member aliases quadratic in N).
+     * from_array is a partial specialization rather than a function taking an index sequence by value, because the member aliases
+     * are instantiated together with integer_sequence itself, and indices<N> may be that very class
+     */
+    template<typename T, auto Values, typename Indices>
+    struct from_array_impl;
+
+    template<typename T, auto Values, std::size_t... Is>
+    struct from_array_impl<T, Values, integer_sequence<std::size_t, Is...>>
+    {
+        using type = integer_sequence<T, Values[Is]...>;
     };
+
+    template<typename T, auto Values>
+    using from_array = typename from_array_impl<T, Values, indices<Values.size()>>::type;
+
+    /*Count elements of values starting at Offset*/
+    template<std::size_t Offset, std::size_t Count, typename T, std::size_t N>
+    constexpr auto slice_of(std::array<T, N> const& values) noexcept
+    {
+        std::array<T, Count> result{};
+        for (std::size_t i = 0; i < Count; ++i)
+            result[i] = values[Offset + i];
+        return result;
+    }
+
+    template<typename T, std::size_t N>
+    constexpr auto reverse_of(std::array<T, N> const& values) noexcept
+    {
+        std::array<T, N> result{};
+        for (std::size_t i = 0; i < N; ++i)
+            result[i] = values[N - 1 - i];
+        return result;
+    }
+
+    template<std::size_t Times, typename T, std::size_t N>
+    constexpr auto repeat_of(std::array<T, N> const& values) noexcept
+    {
+        std::array<T, N * Times> result{};
+        for (std::size_t i = 0; i < N * Times; ++i)
+            result[i] = values[i % N];
+        return result;
+    }
+
+    /*The Count elements of values whose keep is true*/
+    template<std::size_t Count, typename T, std::size_t N>
+    constexpr auto select_of(std::array<T, N> const& values, std::array<bool, N> const& keep) noexcept
+    {
+        std::array<T, Count> result{};
+        for (std::size_t i = 0, j = 0; i < N; ++i)
+        {
+            if (keep[i])
+                result[j++] = values[i];
+        }
+        return result;
+    }
+
+    template<std::size_t N>
+    constexpr std::size_t count_true(std::array<bool, N> const& keep) noexcept
+    {
+        std::size_t count = 0;
+        for (auto value : keep)
+            count += value;
+        return count;
+    }
+
+    template<typename T, T... Ints>
+    using reverse_sequence = from_array<T, reverse_of(std::array<T, sizeof...(Ints)>{ Ints... })>;
+
+    template<typename T, std::size_t Offset, std::size_t Count, T... Ints>
+    using slice = from_array<T, slice_of<Offset, Count>(std::array<T, sizeof...(Ints)>{ Ints... })>;
 }
 
 /**
@@ -40,15 +157,7 @@ template<typename T, T... Ints>
 struct integer_sequence
 {
 private:
-
-    template<int N, T... Values>
-    static constexpr auto pop_back_impl() noexcept
-    {
-        if constexpr (N == size() - 1)
-            return type_identity<integer_sequence<T, Values...>>{};
-        else
-            return pop_back_impl<N + 1, Values..., at(N)>();
-    }
+    static constexpr std::array<T, sizeof...(Ints)> values{ Ints... };
 
     template<T front, T... Values>
     static constexpr auto pop_front_impl() noexcept
@@ -56,26 +165,6 @@ private:
         return type_identity<integer_sequence<T, Values...>>{};
     }
 
-    template<T element, typename Predicate>
-    static constexpr auto filter_impl(integer_sequence<T, element>, Predicate predicate) noexcept
-    {
-        if constexpr (predicate(element))
-            return integer_sequence<T, element>{};
-        else
-            return integer_sequence<T>{};
-    }
-
-    template<int N, int Start, int End, T... Values>
-    static constexpr auto split_impl()
-    {
-        if constexpr (N < Start)
-            return split_impl<N + 1, Start, End>();
-        else if constexpr (N >= Start && N <= End)
-            return split_impl<N + 1, Start, End, Values..., at(N)>();
-        else
-            return integer_sequence<T, Values...>{};
-    }
-
     static constexpr auto GetThis() noexcept
     {
         return integer_sequence<T, Ints...>{};
@@ -99,7 +188,7 @@ public:
      */
     static constexpr auto back() noexcept
     {
-        return ((Ints, ...));
+        return values[size() - 1];
     }
 
     /**
@@ -115,7 +204,7 @@ public:
      */
     static constexpr auto at(int i) noexcept
     {
-        return to_array()[i];
+        return values[i];
     }
 
     /**
@@ -124,7 +213,7 @@ public:
     template<int i>
     static constexpr auto at() noexcept
     {
-        return to_array()[i];
+        return values[i];
     }
 
     /**
@@ -181,7 +270,7 @@ public:
     static constexpr auto pop_back() noexcept
     {
         if constexpr (size() > 0)
-            return pop_back_impl<0>();
+            return type_identity<details::slice<T, 0, size() - 1, Ints...>>{};
         else
             return type_identity<integer_sequence<T>>{};
     }
@@ -217,7 +306,7 @@ public:
     template<int Pos>
     static constexpr auto split_first_part() noexcept
     {
-        return split_impl<0, 0, Pos>();
+        return details::slice<T, 0, Pos + 1, Ints...>{};
     }
 
     /**
@@ -236,10 +325,10 @@ public:
     template<int Pos>
     static constexpr auto split_second_part() noexcept
     {
-        if constexpr (Pos + 1 > size() - 1)
+        if constexpr (Pos + 1 >= static_cast<int>(size()))
             return type_identity<integer_sequence<T>>{};
         else
-            return type_identity<decltype(split_impl<Pos, Pos + 1, size() - 1>())>{};
+            return type_identity<details::slice<T, Pos + 1, size() - (Pos + 1), Ints...>>{};
     }
 
     /**
@@ -422,10 +511,8 @@ public:
     static constexpr auto filter(Predicate predicate) noexcept
     {
         //TODO: assert the predicate return type
-        if constexpr (sizeof...(Ints) > 0)
-            return integer_sequence<T>{}.append(filter_impl(integer_sequence<T, Ints>{}, predicate)...);
-        else
-            return integer_sequence<T>{};
+        constexpr std::array<bool, sizeof...(Ints)> keep{ static_cast<bool>(predicate(Ints))... };
+        return details::from_array<T, details::select_of<details::count_true(keep)>(values, keep)>{};
     }
 
     /**
@@ -464,10 +551,10 @@ public:
     static constexpr auto repeat() noexcept
     {
         static_assert(times >= 0, "Cannot repeat negative times!");
-        if constexpr (times == 0)
+        if constexpr (size() == 0)
             return integer_sequence<T>{};
         else
-            return append(repeat<times - 1>());
+            return details::from_array<T, details::repeat_of<times>(values)>{};
     }
 
     /**
@@ -477,8 +564,10 @@ public:
     template<int times>
     using repeat_t = decltype(repeat<times>());
 
-    //using reverse = typename decltype(details::reverse_impl<integer_sequence<T, Ints...>, integer_sequence<T>>())::type;
-    using reverse = typename details::reverse_impl<integer_sequence<T, Ints...>, integer_sequence<T>>::type;
+    /**
+     * @brief New type of the sequence with the elements in reverse order
+     */
+    using reverse = details::reverse_sequence<T, Ints...>;
 
     /**
      * @brief Get the type of type_list<integral_constant<Int1>, integral_constant<Int2>...>
@@ -488,15 +577,11 @@ public:
 
 namespace details
 {
-    template<typename T, T Start, T N, T... Ints>
-    constexpr auto make_integer_sequence_impl()
+    template<typename T, T Start, std::size_t... Is>
+    constexpr auto offset_sequence(integer_sequence<std::size_t, Is...>) noexcept
     {
-        if constexpr (N == Start)
-            return integer_sequence<T, Ints...>{};
-        else
-            return make_integer_sequence_impl<T, Start, N - 1, N - 1, Ints...>();
+        return integer_sequence<T, static_cast<T>(Start + static_cast<T>(Is))...>{};
     }
-
 }
 
 /**
@@ -506,7 +591,7 @@ namespace details
  * @tparam Start The starting value
  */
 template<typename T, T End, T Start = T{0}>
-using make_integer_sequence = decltype(details::make_integer_sequence_impl<T, Start, End>());
+using make_integer_sequence = decltype(details::offset_sequence<T, Start>(details::indices<static_cast<std::size_t>(End - Start)>{}));
 
 /**
  * @brief A helper alias template std::index_sequence is defined for the common case where T is std::size_t
@@ -20,7 +20,7 @@ namespace details
     };
 
     template<typename Iter>
-    struct is_input_iterator<Iter, decltype(declval<Iter>() != declval<Iter>(), *(declval<Iter>()), ++(declval<Iter>()), void())> : true_type {};
+    struct is_input_iterator<Iter, void_t<decltype(declval<Iter&>() != declval<Iter&>()), decltype(*(declval<Iter&>())), decltype(++(declval<Iter&>()))>> : true_type {};
 
     template<typename Iter>
     struct is_output_iterator {};
@@ -0,0 +1,230 @@
+#pragma once
+#include "Allocator.hpp"
+#include <cstddef>
+#include <cstdint>      //for std::uintptr_t
+#include <new>          //for std::bad_alloc
+#include <type_traits>
+#include <limits>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/* Allocators mapping whole pages from the OS, for big buffers: huge pages and NUMA-node-local memory.
+ * They are Linux-only, elsewhere they fall back to allocator<T>
+ */
+
+namespace details
+{
+    inline constexpr std::size_t huge_page_size = std::size_t{ 2 } << 20;
+
+    constexpr std::size_t round_up(std::size_t bytes, std::size_t alignment) noexcept
+    {
+        return (bytes + (alignment - 1)) & ~(alignment - 1);
+    }
+
+#if defined(__linux__)
+    inline std::size_t page_size() noexcept
+    {
+        static const auto size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        return size;
+    }
+
+    /**
+     * @brief Map bytes (a multiple of huge_page_size) of anonymous memory aligned to huge_page_size:
+     * from the reserved huge pages if there are enough, otherwise as normal pages advised to be backed by transparent huge pages
+     * @return nullptr if out of memory
+     */
+    inline void* map_huge_pages(std::size_t bytes) noexcept
+    {
+        auto p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED)
+            return p;
+        //Over-map by a huge page and trim, mmap() only aligns to the normal page size
+        auto mapped = ::mmap(nullptr, bytes + huge_page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapped == MAP_FAILED)
+            return nullptr;
+        const auto address = reinterpret_cast<std::uintptr_t>(mapped);
+        const auto head = round_up(address, huge_page_size) - address;
+        if (head != 0)
+            ::munmap(mapped, head);
+        ::munmap(static_cast<char*>(mapped) + head + bytes, huge_page_size - head);
+        p = static_cast<char*>(mapped) + head;
+#if defined(MADV_HUGEPAGE)
+        ::madvise(p, bytes, MADV_HUGEPAGE);
+#endif
+        return p;
+    }
+
+    /**
+     * @brief Make the pages of [p, p + bytes) prefer node when they are first touched, with the mbind() system call
+     * (called directly, so there is no dependency on libnuma)
+     * @return false if the kernel refused, eg. no such node or no NUMA support
+     */
+    inline bool prefer_numa_node(void* p, std::size_t bytes, int node) noexcept
+    {
+        constexpr int preferred_policy = 1;     //MPOL_PREFERRED of <numaif.h>
+        constexpr std::size_t bits = std::numeric_limits<unsigned long>::digits;
+        unsigned long mask[16]{};
+        if (node < 0 || static_cast<std::size_t>(node) >= bits * 16)
+            return false;
+        mask[node / bits] = 1ul << (node % bits);
+        return ::syscall(SYS_mbind, p, bytes, preferred_policy, mask, bits * 16, 0) == 0;
+    }
+#endif
+
+    /**
+     * @brief The NUMA node of the CPU the calling thread runs on, 0 if unknown
+     */
+    inline int current_numa_node() noexcept
+    {
+#if defined(__linux__)
+        unsigned cpu = 0;
+        unsigned node = 0;
+        if (::syscall(SYS_getcpu, &cpu, &node, nullptr) == 0)
+            return static_cast<int>(node);
+#endif
+        return 0;
+    }
+}
+
+/**
+ * @brief An allocator backing big blocks (at least huge_page_size bytes) by 2 MiB huge pages, so a buffer of hundreds of MiB
+ * takes hundreds of TLB entries instead of tens of thousands
+ *
+ * @tparam T Type of allocated object
+ * @details Uses the huge pages reserved by the system (MAP_HUGETLB) if there are enough, otherwise normal pages advised to be
+ * merged into transparent huge pages (MADV_HUGEPAGE), which only works if /sys/kernel/mm/transparent_hugepage/enabled
+ * isn't "never". Blocks are rounded up to a multiple of 2 MiB. Smaller blocks come from allocator<T>
+ */
+template<typename T>
+class huge_page_allocator
+{
+    static_assert(alignof(T) <= details::huge_page_size, "a huge page can't align T");
+
+    static constexpr bool is_huge(std::size_t n) noexcept
+    {
+        return n * sizeof(T) >= details::huge_page_size;
+    }
+
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using propagate_on_container_move_assignment = std::true_type;
+    using is_always_equal = std::true_type;
+
+    huge_page_allocator() noexcept = default;
+    template <typename U>
+    huge_page_allocator(const huge_page_allocator<U> &) noexcept{};
+
+    constexpr auto max_size() const noexcept
+    {
+        return (std::numeric_limits<size_type>::max() - details::huge_page_size) / sizeof(value_type);
+    }
+
+    T* allocate(std::size_t n)
+    {
+        if (n > max_size())
+            throw std::bad_alloc{};
+#if defined(__linux__)
+        if (is_huge(n))
+        {
+            if (auto p = details::map_huge_pages(details::round_up(n * sizeof(T), details::huge_page_size)))
+                return static_cast<T*>(p);
+            throw std::bad_alloc{};
+        }
+#endif
+        return allocator<T>{}.allocate(n);
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept
+    {
+#if defined(__linux__)
+        if (is_huge(n))
+        {
+            ::munmap(p, details::round_up(n * sizeof(T), details::huge_page_size));
+            return;
+        }
+#endif
+        allocator<T>{}.deallocate(p, n);
+    }
+};
+
+template<typename T, typename U>
+constexpr bool operator==(huge_page_allocator<T> const&, huge_page_allocator<U> const&) noexcept { return true; }
+template<typename T, typename U>
+constexpr bool operator!=(huge_page_allocator<T> const&, huge_page_allocator<U> const&) noexcept { return false; }
+
+/**
+ * @brief An allocator placing its memory on one NUMA node, whichever thread touches it first
+ *
+ * @tparam T Type of allocated object
+ * @details Every block is mapped as whole pages with mbind(MPOL_PREFERRED), so it is for big buffers. The node is a preference:
+ * when it is full the kernel takes pages from another node rather than failing. A container moved to or swapped with another one
+ * takes the allocator with the storage, so it keeps growing on the node its elements are on; a copy keeps its own node.
+ * Allocators are equal if they have the same node
+ */
+template<typename T>
+class numa_allocator
+{
+    template<typename> friend class numa_allocator;
+
+    int m_node;
+
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    /**
+     * @brief Allocate on the node of the CPU the constructing thread runs on
+     */
+    numa_allocator() noexcept : m_node{ details::current_numa_node() } {}
+    explicit numa_allocator(int node) noexcept : m_node{ node } {}
+    template <typename U>
+    numa_allocator(const numa_allocator<U> & other) noexcept : m_node{ other.m_node } {}
+
+    int node() const noexcept { return m_node; }
+
+    constexpr auto max_size() const noexcept
+    {
+        return (std::numeric_limits<size_type>::max() >> 1) / sizeof(value_type);
+    }
+
+    T* allocate(std::size_t n)
+    {
+        if (n > max_size())
+            throw std::bad_alloc{};
+#if defined(__linux__)
+        const auto bytes = details::round_up(n * sizeof(T), details::page_size());
+        auto p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED)
+            throw std::bad_alloc{};
+        details::prefer_numa_node(p, bytes, m_node);    //nothing is touched yet, so every page follows the policy
+        return static_cast<T*>(p);
+#else
+        return allocator<T>{}.allocate(n);
+#endif
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept
+    {
+#if defined(__linux__)
+        ::munmap(p, details::round_up(n * sizeof(T), details::page_size()));
+#else
+        allocator<T>{}.deallocate(p, n);
+#endif
+    }
+
+    template<typename U>
+    bool operator==(numa_allocator<U> const& other) const noexcept { return m_node == other.m_node; }
+    template<typename U>
+    bool operator!=(numa_allocator<U> const& other) const noexcept { return m_node != other.m_node; }
+};
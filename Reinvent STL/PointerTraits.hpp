@@ -83,6 +83,6 @@ struct pointer_traits<T*>
      */
     static pointer pointer_to(element_type& r)
     {
-        return Ptr::pointer_to(r);
+        return ::addressof(r);
     }
 };
\ No newline at end of file
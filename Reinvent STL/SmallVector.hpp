@@ -0,0 +1,118 @@
+#pragma once
+#include "Vector.hpp"
+
+namespace details
+{
+    /**
+     * @brief The storage of small_vector: up to N elements inline, more are allocated by the Allocator
+     * @details Same interface as vector_base. The elements are inline exactly when m_start points to m_buffer
+     */
+    template<typename T, std::size_t N, typename Allocator>
+    struct small_vector_base
+    {
+        static_assert(N != 0, "use vector for no inline elements");
+
+        using alloc_type = typename vector_base<T, Allocator>::alloc_type;
+        using alloc_traits = allocator_traits<alloc_type>;
+        using pointer = typename alloc_traits::pointer;
+        using vector_impl = typename vector_base<T, Allocator>::vector_impl;
+
+        vector_impl m_impl;
+        alignas(T) unsigned char m_buffer[N * sizeof(T)];
+
+        pointer inline_data() noexcept { return reinterpret_cast<pointer>(m_buffer); }
+
+        pointer allocate(size_t n)
+        {
+            return n != 0 ? alloc_traits::allocate(m_impl, n) : pointer{};
+        }
+
+        void deallocate(pointer p, size_t n)
+        {
+            if (p && p != inline_data())
+                alloc_traits::deallocate(m_impl, p, n);
+        }
+
+        alloc_type& get_alloc() noexcept { return m_impl; }
+        alloc_type const& get_alloc() const noexcept { return m_impl; }
+
+        small_vector_base() { reset_storage(); }
+        small_vector_base(Allocator const& a) noexcept : m_impl{ alloc_type(a) } { reset_storage(); }
+        small_vector_base(size_t n) : small_vector_base() { create_storage(n); }
+        small_vector_base(size_t n, Allocator const& a) : small_vector_base(a) { create_storage(n); }
+
+        //The inline elements can't be stolen, they are moved one by one
+        small_vector_base(small_vector_base&& other) noexcept(is_nothrow_move_constructible_v<T>) : m_impl{ alloc_type(other.get_alloc()) }
+        {
+            reset_storage();
+            take_storage(other);
+        }
+
+        ~small_vector_base() noexcept
+        {
+            deallocate(m_impl.m_start, m_impl.m_end_of_storage - m_impl.m_start);
+        }
+
+    protected:
+        void create_storage(std::size_t n)
+        {
+            if (n <= N)
+                return;
+            m_impl.m_start = allocate(n);
+            m_impl.m_finish = m_impl.m_start;
+            m_impl.m_end_of_storage = m_impl.m_start + n;
+        }
+
+        static constexpr bool nothrow_take_storage = is_nothrow_move_constructible_v<T>;
+
+        bool is_allocated() const noexcept { return m_impl.m_start != reinterpret_cast<T const*>(m_buffer); }
+
+        void reset_storage() noexcept
+        {
+            m_impl.m_start = m_impl.m_finish = inline_data();
+            m_impl.m_end_of_storage = m_impl.m_start + N;
+        }
+
+        void take_storage(small_vector_base& other) noexcept(nothrow_take_storage)
+        {
+            if (other.is_allocated())
+            {
+                m_impl.copy_data(other.m_impl);
+                other.reset_storage();
+                return;
+            }
+            auto& from = other.m_impl;
+            m_impl.m_finish = uninitialized_copy_a(std::make_move_iterator(from.m_start), std::make_move_iterator(from.m_finish), m_impl.m_start, get_alloc());
+            details::destroy(from.m_start, from.m_finish, other.get_alloc());
+            from.m_finish = from.m_start;
+        }
+
+        void swap_storage(small_vector_base& other) noexcept(nothrow_take_storage)
+        {
+            if (is_allocated() && other.is_allocated())
+            {
+                m_impl.swap_data(other.m_impl);
+                return;
+            }
+            small_vector_base temp{ get_alloc() };
+            temp.take_storage(*this);
+            take_storage(other);
+            other.take_storage(temp);
+        }
+    };
+}
+
+/**
+ * @brief A vector that keeps up to N elements inline, so short-lived small containers never allocate
+ *
+ * @tparam T type of the elements
+ * @tparam N number of elements kept inline
+ * @tparam Allocator used for the storage once there are more than N elements
+ *
+ * @details It is a vector with another storage, so it has the same members and iterators.
+ * Differences from vector:
+ *  - moving or swapping inline elements moves them one by one, so iterators are not kept
+ *  - capacity() is at least N
+ */
+template<typename T, std::size_t N, typename Allocator = allocator<T>>
+using small_vector = vector<T, Allocator, details::small_vector_base<T, N, Allocator>>;
@@ -0,0 +1,715 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <iterator>     //for std::iterator_traits, std::iter_swap
+#include <utility>
+#include <memory>       //for std::make_unique_for_overwrite
+#include <algorithm>    //for std::make_heap and std::sort_heap, the worst case fallback of pdqsort
+#include <functional>   //for std::less, std::greater
+#include <bit>
+#include <vector>
+#include "TypeTraits.hpp"
+#include "ThreadPool.hpp"
+
+/**
+ * @brief The runtime sorting algorithms
+ * @details
+ *  pdqsort         pattern-defeating quicksort (Orson Peters), the default of sort()
+ *  radix_sort      LSD radix sort of integer and floating point keys, O(n) with an n-element buffer
+ *  sample_sort     splits into buckets by sampled splitters, sorted in parallel, used by sort(execution::par, ...)
+ */
+
+namespace details
+{
+    inline constexpr std::ptrdiff_t insertion_sort_threshold = 24;     //smaller partitions are insertion sorted
+    inline constexpr std::ptrdiff_t ninther_threshold = 128;           //larger partitions use the pseudomedian of 9 as the pivot
+    inline constexpr std::size_t partial_insertion_sort_limit = 8;     //moves before giving up on an almost sorted partition
+    inline constexpr std::size_t partition_block_size = 64;            //elements compared before swapping, in the branchless partition
+
+    /*Comparing arithmetic types with the standard comparators has no side effects, so the comparisons can be done in blocks without branches*/
+    template<typename T, typename Compare>
+    inline constexpr bool is_branchless_comparison_v = is_arithmetic_v<T>
+        && (is_same_v<Compare, std::less<T>> || is_same_v<Compare, std::less<>> || is_same_v<Compare, std::greater<T>> || is_same_v<Compare, std::greater<>>);
+
+    template<typename RandomIt, typename Compare>
+    void insertion_sort(RandomIt begin, RandomIt end, Compare& comp)
+    {
+        if (begin == end)
+            return;
+        for (auto current = begin + 1; current != end; ++current)
+        {
+            auto sift = current;
+            auto sift_1 = current - 1;
+            if (comp(*sift, *sift_1))
+            {
+                auto tmp = std::move(*sift);
+                do
+                {
+                    *sift-- = std::move(*sift_1);
+                } while (sift != begin && comp(tmp, *--sift_1));
+                *sift = std::move(tmp);
+            }
+        }
+    }
+
+    /*Insertion sort of a partition that isn't the leftmost: the pivot before begin is <= every element, and stops the inner loop*/
+    template<typename RandomIt, typename Compare>
+    void unguarded_insertion_sort(RandomIt begin, RandomIt end, Compare& comp)
+    {
+        if (begin == end)
+            return;
+        for (auto current = begin + 1; current != end; ++current)
+        {
+            auto sift = current;
+            auto sift_1 = current - 1;
+            if (comp(*sift, *sift_1))
+            {
+                auto tmp = std::move(*sift);
+                do
+                {
+                    *sift-- = std::move(*sift_1);
+                } while (comp(tmp, *--sift_1));
+                *sift = std::move(tmp);
+            }
+        }
+    }
+
+    /**
+     * @brief Insertion sort that gives up after partial_insertion_sort_limit moves
+     * @returns true if [begin, end) is sorted
+     */
+    template<typename RandomIt, typename Compare>
+    bool partial_insertion_sort(RandomIt begin, RandomIt end, Compare& comp)
+    {
+        if (begin == end)
+            return true;
+        std::size_t moves = 0;
+        for (auto current = begin + 1; current != end; ++current)
+        {
+            auto sift = current;
+            auto sift_1 = current - 1;
+            if (comp(*sift, *sift_1))
+            {
+                auto tmp = std::move(*sift);
+                do
+                {
+                    *sift-- = std::move(*sift_1);
+                } while (sift != begin && comp(tmp, *--sift_1));
+                *sift = std::move(tmp);
+                moves += current - sift;
+            }
+            if (moves > partial_insertion_sort_limit)
+                return false;
+        }
+        return true;
+    }
+
+    template<typename RandomIt, typename Compare>
+    void sort2(RandomIt a, RandomIt b, Compare& comp)
+    {
+        if (comp(*b, *a))
+            std::iter_swap(a, b);
+    }
+
+    template<typename RandomIt, typename Compare>
+    void sort3(RandomIt a, RandomIt b, RandomIt c, Compare& comp)
+    {
+        sort2(a, b, comp);
+        sort2(b, c, comp);
+        sort2(a, b, comp);
+    }
+
+    /**
+     * @brief Partition [begin, end) around the pivot *begin, the elements equal to it go to the right
+     * @returns the position of the pivot, and whether the range was already partitioned (no swaps)
+     */
+    template<typename RandomIt, typename Compare>
+    std::pair<RandomIt, bool> partition_right(RandomIt begin, RandomIt end, Compare& comp)
+    {
+        auto pivot = std::move(*begin);
+        auto first = begin;
+        auto last = end;
+
+        //The median of 3 guarantees an element >= pivot on the left, and the guards the scans can't pass
+        while (comp(*++first, pivot)) {}
+        if (first - 1 == begin)
+        {
+            while (first < last && !comp(*--last, pivot)) {}
+        }
+        else
+        {
+            while (!comp(*--last, pivot)) {}
+        }
+
+        const bool already_partitioned = first >= last;
+        while (first < last)
+        {
+            std::iter_swap(first, last);
+            while (comp(*++first, pivot)) {}
+            while (!comp(*--last, pivot)) {}
+        }
+
+        auto pivot_position = first - 1;
+        *begin = std::move(*pivot_position);
+        *pivot_position = std::move(pivot);
+        return { pivot_position, already_partitioned };
+    }
+
+    /*Swap the elements at the offsets from both sides, with a cyclic permutation (one move per element) when the counts differ*/
+    template<typename RandomIt>
+    void swap_offsets(RandomIt first, RandomIt last, unsigned char const* offsets_l, unsigned char const* offsets_r, std::size_t num, bool use_swaps)
+    {
+        if (use_swaps)
+        {
+            //With as many elements on both sides, a cycle would end on an element that has already been moved
+            for (std::size_t i = 0; i < num; ++i)
+                std::iter_swap(first + offsets_l[i], last - offsets_r[i]);
+        }
+        else if (num > 0)
+        {
+            auto l = first + offsets_l[0];
+            auto r = last - offsets_r[0];
+            auto tmp = std::move(*l);
+            *l = std::move(*r);
+            for (std::size_t i = 1; i < num; ++i)
+            {
+                l = first + offsets_l[i];
+                *r = std::move(*l);
+                r = last - offsets_r[i];
+                *l = std::move(*r);
+            }
+            *r = std::move(tmp);
+        }
+    }
+
+    /**
+     * @brief partition_right() of BlockQuicksort (Edelkamp & Weiss): compares a block of elements and records the offsets of the
+     * misplaced ones without branching on the results, then swaps them. Removes the branch mispredictions of random inputs
+     */
+    template<typename RandomIt, typename Compare>
+    std::pair<RandomIt, bool> partition_right_branchless(RandomIt begin, RandomIt end, Compare& comp)
+    {
+        auto pivot = std::move(*begin);
+        auto first = begin;
+        auto last = end;
+
+        while (comp(*++first, pivot)) {}
+        if (first - 1 == begin)
+        {
+            while (first < last && !comp(*--last, pivot)) {}
+        }
+        else
+        {
+            while (!comp(*--last, pivot)) {}
+        }
+
+        const bool already_partitioned = first >= last;
+        if (!already_partitioned)
+        {
+            std::iter_swap(first, last);
+            ++first;
+
+            alignas(64) unsigned char offsets_l[partition_block_size];
+            alignas(64) unsigned char offsets_r[partition_block_size];
+            auto offsets_l_base = first;
+            auto offsets_r_base = last;
+            std::size_t num_l = 0, num_r = 0, start_l = 0, start_r = 0;
+            while (first < last)
+            {
+                //Fill the offsets of the side that ran out, split the rest between both sides if they both did
+                const std::size_t num_unknown = last - first;
+                const std::size_t left_split = num_l == 0 ? (num_r == 0 ? num_unknown / 2 : num_unknown) : 0;
+                const std::size_t right_split = num_r == 0 ? (num_unknown - left_split) : 0;
+
+                if (left_split >= partition_block_size)
+                {
+                    for (std::size_t i = 0; i < partition_block_size; )
+                    {
+                        offsets_l[num_l] = static_cast<unsigned char>(i++); num_l += !comp(*first, pivot); ++first;
+                        offsets_l[num_l] = static_cast<unsigned char>(i++); num_l += !comp(*first, pivot); ++first;
+                        offsets_l[num_l] = static_cast<unsigned char>(i++); num_l += !comp(*first, pivot); ++first;
+                        offsets_l[num_l] = static_cast<unsigned char>(i++); num_l += !comp(*first, pivot); ++first;
+                    }
+                }
+                else
+                {
+                    for (std::size_t i = 0; i < left_split; )
+                    {
+                        offsets_l[num_l] = static_cast<unsigned char>(i++); num_l += !comp(*first, pivot); ++first;
+                    }
+                }
+
+                if (right_split >= partition_block_size)
+                {
+                    for (std::size_t i = 0; i < partition_block_size; )
+                    {
+                        offsets_r[num_r] = static_cast<unsigned char>(++i); num_r += comp(*--last, pivot);
+                        offsets_r[num_r] = static_cast<unsigned char>(++i); num_r += comp(*--last, pivot);
+                        offsets_r[num_r] = static_cast<unsigned char>(++i); num_r += comp(*--last, pivot);
+                        offsets_r[num_r] = static_cast<unsigned char>(++i); num_r += comp(*--last, pivot);
+                    }
+                }
+                else
+                {
+                    for (std::size_t i = 0; i < right_split; )
+                    {
+                        offsets_r[num_r] = static_cast<unsigned char>(++i); num_r += comp(*--last, pivot);
+                    }
+                }
+
+                const auto num = num_l < num_r ? num_l : num_r;
+                swap_offsets(offsets_l_base, offsets_r_base, offsets_l + start_l, offsets_r + start_r, num, num_l == num_r);
+                num_l -= num;
+                num_r -= num;
+                start_l += num;
+                start_r += num;
+                if (num_l == 0)
+                {
+                    start_l = 0;
+                    offsets_l_base = first;
+                }
+                if (num_r == 0)
+                {
+                    start_r = 0;
+                    offsets_r_base = last;
+                }
+            }
+
+            //One side may have misplaced elements left, move them next to the boundary
+            if (num_l)
+            {
+                while (num_l--)
+                    std::iter_swap(offsets_l_base + offsets_l[start_l + num_l], --last);
+                first = last;
+            }
+            if (num_r)
+            {
+                while (num_r--)
+                {
+                    std::iter_swap(offsets_r_base - offsets_r[start_r + num_r], first);
+                    ++first;
+                }
+                last = first;
+            }
+        }
+
+        auto pivot_position = first - 1;
+        *begin = std::move(*pivot_position);
+        *pivot_position = std::move(pivot);
+        return { pivot_position, already_partitioned };
+    }
+
+    /**
+     * @brief Partition [begin, end) around the pivot *begin, the elements equal to it go to the left
+     * @details Used when the pivot equals the one of the parent partition, which is before begin:
+     * no element is less than the pivot, so the elements equal to it are done
+     */
+    template<typename RandomIt, typename Compare>
+    RandomIt partition_left(RandomIt begin, RandomIt end, Compare& comp)
+    {
+        auto pivot = std::move(*begin);
+        auto first = begin;
+        auto last = end;
+
+        while (comp(pivot, *--last)) {}
+        if (last + 1 == end)
+        {
+            while (first < last && !comp(pivot, *++first)) {}
+        }
+        else
+        {
+            while (!comp(pivot, *++first)) {}
+        }
+
+        while (first < last)
+        {
+            std::iter_swap(first, last);
+            while (comp(pivot, *--last)) {}
+            while (!comp(pivot, *++first)) {}
+        }
+
+        auto pivot_position = last;
+        *begin = std::move(*pivot_position);
+        *pivot_position = std::move(pivot);
+        return pivot_position;
+    }
+
+    template<bool Branchless, typename RandomIt, typename Compare>
+    void pdqsort_loop(RandomIt begin, RandomIt end, Compare& comp, int bad_allowed, bool leftmost = true)
+    {
+        while (true)
+        {
+            const auto size = end - begin;
+            if (size < insertion_sort_threshold)
+            {
+                if (leftmost)
+                    insertion_sort(begin, end, comp);
+                else
+                    unguarded_insertion_sort(begin, end, comp);
+                return;
+            }
+
+            //The pivot goes to *begin
+            const auto half = size / 2;
+            if (size > ninther_threshold)
+            {
+                sort3(begin, begin + half, end - 1, comp);
+                sort3(begin + 1, begin + (half - 1), end - 2, comp);
+                sort3(begin + 2, begin + (half + 1), end - 3, comp);
+                sort3(begin + (half - 1), begin + half, begin + (half + 1), comp);
+                std::iter_swap(begin, begin + half);
+            }
+            else
+                sort3(begin + half, begin, end - 1, comp);
+
+            //Many equal elements: the pivot equals the one of the parent partition, which is <= every element here
+            if (!leftmost && !comp(*(begin - 1), *begin))
+            {
+                begin = partition_left(begin, end, comp) + 1;
+                continue;
+            }
+
+            std::pair<RandomIt, bool> partitioned;
+            if constexpr (Branchless)
+                partitioned = partition_right_branchless(begin, end, comp);
+            else
+                partitioned = partition_right(begin, end, comp);
+            const auto [pivot_position, already_partitioned] = partitioned;
+
+            const auto l_size = pivot_position - begin;
+            const auto r_size = end - (pivot_position + 1);
+            if (l_size < size / 8 || r_size < size / 8)
+            {
+                //Too many bad partitions means an adversarial pattern, fall back to heapsort for O(n log n)
+                if (--bad_allowed == 0)
+                {
+                    std::make_heap(begin, end, comp);
+                    std::sort_heap(begin, end, comp);
+                    return;
+                }
+
+                //Otherwise break the pattern by swapping a few elements
+                if (l_size >= insertion_sort_threshold)
+                {
+                    std::iter_swap(begin, begin + l_size / 4);
+                    std::iter_swap(pivot_position - 1, pivot_position - l_size / 4);
+                    if (l_size > ninther_threshold)
+                    {
+                        std::iter_swap(begin + 1, begin + (l_size / 4 + 1));
+                        std::iter_swap(begin + 2, begin + (l_size / 4 + 2));
+                        std::iter_swap(pivot_position - 2, pivot_position - (l_size / 4 + 1));
+                        std::iter_swap(pivot_position - 3, pivot_position - (l_size / 4 + 2));
+                    }
+                }
+                if (r_size >= insertion_sort_threshold)
+                {
+                    std::iter_swap(pivot_position + 1, pivot_position + (1 + r_size / 4));
+                    std::iter_swap(end - 1, end - r_size / 4);
+                    if (r_size > ninther_threshold)
+                    {
+                        std::iter_swap(pivot_position + 2, pivot_position + (2 + r_size / 4));
+                        std::iter_swap(pivot_position + 3, pivot_position + (3 + r_size / 4));
+                        std::iter_swap(end - 2, end - (1 + r_size / 4));
+                        std::iter_swap(end - 3, end - (2 + r_size / 4));
+                    }
+                }
+            }
+            //A balanced partition without swaps: the input may be (almost) sorted already
+            else if (already_partitioned && partial_insertion_sort(begin, pivot_position, comp) && partial_insertion_sort(pivot_position + 1, end, comp))
+                return;
+
+            //Recurse into the left side, loop on the right one
+            pdqsort_loop<Branchless>(begin, pivot_position, comp, bad_allowed, leftmost);
+            begin = pivot_position + 1;
+            leftmost = false;
+        }
+    }
+}
+
+/**
+ * @brief Sorts [first, last) with pattern-defeating quicksort, not stable
+ * @details Quicksort with insertion sort for small partitions, the pseudomedian of 9 for large ones and
+ * branchless block partitioning for arithmetic types with the standard comparators.
+ * O(n) for sorted, reversed and equal inputs, O(n log n) worst case by falling back to heapsort
+ */
+template<typename RandomIt, typename Compare>
+void pdqsort(RandomIt first, RandomIt last, Compare comp)
+{
+    if (last - first < 2)
+        return;
+    constexpr bool branchless = details::is_branchless_comparison_v<typename std::iterator_traits<RandomIt>::value_type, Compare>;
+    details::pdqsort_loop<branchless>(first, last, comp, static_cast<int>(std::bit_width(static_cast<std::size_t>(last - first))));
+}
+
+template<typename RandomIt>
+void pdqsort(RandomIt first, RandomIt last)
+{
+    ::pdqsort(first, last, std::less<typename std::iterator_traits<RandomIt>::value_type>{});
+}
+
+
+namespace details
+{
+    template<std::size_t Size> struct unsigned_of_size {};
+    template<> struct unsigned_of_size<1> { using type = std::uint8_t; };
+    template<> struct unsigned_of_size<2> { using type = std::uint16_t; };
+    template<> struct unsigned_of_size<4> { using type = std::uint32_t; };
+    template<> struct unsigned_of_size<8> { using type = std::uint64_t; };
+
+    template<typename T>
+    inline constexpr bool is_radix_sortable_v = (is_integral_v<T> && !is_same_v<remove_cv_t<T>, bool>)
+        || is_same_v<remove_cv_t<T>, float> || is_same_v<remove_cv_t<T>, double>;
+
+    /**
+     * @brief Map a key to an unsigned integer with the same order
+     * @details signed integers: flip the sign bit, so the negative ones come first
+     *          floating points: flip the sign bit of positive values, and all bits of negative ones, whose order is reversed
+     *          NaNs go to the ends, -0.0 before 0.0
+     */
+    template<typename T>
+    auto radix_bits(T key)
+    {
+        using U = typename unsigned_of_size<sizeof(T)>::type;
+        constexpr auto sign = static_cast<U>(U{ 1 } << (sizeof(T) * 8 - 1));
+        if constexpr (is_floating_point_v<T>)
+        {
+            const auto bits = std::bit_cast<U>(key);
+            return static_cast<U>(bits ^ ((bits & sign) ? static_cast<U>(~U{ 0 }) : sign));
+        }
+        else if constexpr (is_signed_v<T>)
+            return static_cast<U>(static_cast<U>(key) ^ sign);
+        else
+            return static_cast<U>(key);
+    }
+
+    /**
+     * @brief One counting pass per byte of the key, from the least significant one, moving the elements between the range and buffer
+     * @details The histograms of all bytes are counted in a single read of the input, and a byte that is the same for all keys skips its pass
+     */
+    template<typename RandomIt, typename T, typename Key>
+    void radix_sort_impl(RandomIt first, std::size_t n, T* buffer, Key& key)
+    {
+        using KeyType = remove_cv_t<remove_reference_t<decltype(key(*first))>>;
+        constexpr std::size_t bytes = sizeof(KeyType);
+
+        std::size_t counts[bytes][256]{};
+        for (std::size_t i = 0; i != n; ++i)
+        {
+            const auto bits = radix_bits(static_cast<KeyType>(key(first[i])));
+            for (std::size_t byte = 0; byte != bytes; ++byte)
+                ++counts[byte][(bits >> (byte * 8)) & 0xFF];
+        }
+
+        bool in_buffer = false;
+        auto scatter = [&](auto from, auto to, std::size_t byte)
+        {
+            std::size_t offsets[256];
+            std::size_t sum = 0;
+            for (std::size_t digit = 0; digit != 256; ++digit)
+            {
+                offsets[digit] = sum;
+                sum += counts[byte][digit];
+            }
+            for (std::size_t i = 0; i != n; ++i)
+            {
+                const auto digit = (radix_bits(static_cast<KeyType>(key(from[i]))) >> (byte * 8)) & 0xFF;
+                to[offsets[digit]++] = std::move(from[i]);
+            }
+        };
+        for (std::size_t byte = 0; byte != bytes; ++byte)
+        {
+            const auto digit = (radix_bits(static_cast<KeyType>(key(first[0]))) >> (byte * 8)) & 0xFF;
+            if (counts[byte][digit] == n)
+                continue;   //the first key's digit is everyone's, this pass would not move anything
+            if (in_buffer)
+                scatter(buffer, first, byte);
+            else
+                scatter(first, buffer, byte);
+            in_buffer = !in_buffer;
+        }
+        if (in_buffer)
+        {
+            for (std::size_t i = 0; i != n; ++i)
+                first[i] = std::move(buffer[i]);
+        }
+    }
+
+    inline constexpr std::size_t radix_sort_threshold = 256;   //below it, the histograms cost more than pdqsort
+}
+
+/**
+ * @brief Sorts [first, last) in ascending order of key(element) with LSD radix sort, stable
+ * @param key returns an integer or a float/double, for example a member of the elements
+ * @details O(n * sizeof(key)) with a buffer of n elements, the elements need to be default constructible
+ */
+template<typename RandomIt, typename Key>
+void radix_sort(RandomIt first, RandomIt last, Key key)
+{
+    using T = typename std::iterator_traits<RandomIt>::value_type;
+    using KeyType = remove_cv_t<remove_reference_t<decltype(key(*first))>>;
+    static_assert(details::is_radix_sortable_v<KeyType>, "radix_sort needs integer or floating point keys");
+
+    const std::size_t n = last - first;
+    if (n < details::radix_sort_threshold)
+    {
+        //insertion sort is stable too, with the same order
+        auto less = [&key](auto const& a, auto const& b) { return details::radix_bits(static_cast<KeyType>(key(a))) < details::radix_bits(static_cast<KeyType>(key(b))); };
+        details::insertion_sort(first, last, less);
+        return;
+    }
+    const auto buffer = std::make_unique_for_overwrite<T[]>(n);
+    details::radix_sort_impl(first, n, buffer.get(), key);
+}
+
+/**
+ * @brief Sorts [first, last) of integers or floats in ascending order, with LSD radix sort
+ */
+template<typename RandomIt>
+void radix_sort(RandomIt first, RandomIt last)
+{
+    ::radix_sort(first, last, [](auto const& value) { return value; });
+}
+
+
+namespace details
+{
+    inline constexpr std::size_t sample_sort_threshold = std::size_t{ 1 } << 16;  //below it, pdqsort on the calling thread
+    inline constexpr std::size_t sample_sort_oversampling = 16;                  //samples per splitter
+    inline constexpr std::size_t sample_sort_splitters = 127;                    //not from the thread count, 2 buckets per splitter and an extra one fit in a byte
+
+    /**
+     * @brief The bucket of value among the splitters: bucket 2i holds the values between splitters i - 1 and i,
+     * bucket 2i + 1 the values equal to splitter i. The equal buckets are already sorted, which handles inputs with few unique keys
+     */
+    template<typename T, typename Compare>
+    std::size_t sample_sort_bucket(std::vector<T> const& splitters, T const& value, Compare& comp)
+    {
+        //upper bound, with the comparison as a conditional move rather than a branch that random keys mispredict
+        std::size_t index = 0;
+        auto size = splitters.size();
+        while (size > 1)
+        {
+            const auto half = size / 2;
+            index = comp(value, splitters[index + half]) ? index : index + half;
+            size -= half;
+        }
+        index += !comp(value, splitters[index]);
+        if (index > 0 && !comp(splitters[index - 1], value))
+            return 2 * index - 1;
+        return 2 * index;
+    }
+}
+
+/**
+ * @brief Sorts [first, last) with parallel sample sort on the global thread pool, not stable
+ * @details 1. Sort an oversampled random sample and pick the splitters from it
+ *          2. Classify the elements of each chunk into the buckets between the splitters, in parallel, and count them
+ *          3. Move the elements into a buffer ordered by bucket, in parallel, and back
+ *          4. Sort the buckets with pdqsort, in parallel
+ * The buckets don't depend on the number of threads, so neither does the result. The elements need to be default constructible
+ * If comp throws, the elements are left in an unspecified order
+ */
+template<typename RandomIt, typename Compare>
+void sample_sort(RandomIt first, RandomIt last, Compare comp)
+{
+    using T = typename std::iterator_traits<RandomIt>::value_type;
+    const std::size_t n = last - first;
+    if (n < details::sample_sort_threshold)
+    {
+        ::pdqsort(first, last, comp);
+        return;
+    }
+
+    auto& pool = thread_pool::global();
+    const std::size_t splitter_count = details::sample_sort_splitters;
+    const std::size_t bucket_count = 2 * splitter_count + 1;
+
+    //1. The samples, by a fixed xorshift so the result is reproducible
+    std::vector<T> splitters;
+    {
+        std::vector<T> samples;
+        const auto sample_count = (splitter_count + 1) * details::sample_sort_oversampling;
+        samples.reserve(sample_count);
+        std::uint64_t state = 0x9E3779B97F4A7C15ull;
+        for (std::size_t i = 0; i != sample_count; ++i)
+        {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            samples.push_back(first[state % n]);
+        }
+        ::pdqsort(samples.begin(), samples.end(), comp);
+        splitters.reserve(splitter_count);
+        for (std::size_t i = 1; i <= splitter_count; ++i)
+            splitters.push_back(samples[i * details::sample_sort_oversampling - 1]);
+    }
+
+    //2. Classify, and count the elements of each bucket in each chunk
+    const auto chunk_count = details::parallel_chunk_count(n);
+    const auto buckets = std::make_unique_for_overwrite<std::uint8_t[]>(n);
+    std::vector<std::size_t> offsets(chunk_count * bucket_count);
+    details::parallel_chunks(n, [&](std::size_t chunk, std::size_t begin, std::size_t end)
+    {
+        auto counts = offsets.data() + chunk * bucket_count;
+        for (auto i = begin; i != end; ++i)
+        {
+            const auto bucket = details::sample_sort_bucket(splitters, first[i], comp);
+            buckets[i] = static_cast<std::uint8_t>(bucket);
+            ++counts[bucket];
+        }
+    });
+
+    //The counts become the offsets where each chunk moves the elements of each bucket
+    std::vector<std::size_t> bucket_begin(bucket_count + 1);
+    std::size_t sum = 0;
+    for (std::size_t bucket = 0; bucket != bucket_count; ++bucket)
+    {
+        bucket_begin[bucket] = sum;
+        for (std::size_t chunk = 0; chunk != chunk_count; ++chunk)
+        {
+            const auto count = offsets[chunk * bucket_count + bucket];
+            offsets[chunk * bucket_count + bucket] = sum;
+            sum += count;
+        }
+    }
+    bucket_begin[bucket_count] = n;
+
+    //3. Move them to the buffer ordered by bucket, and back
+    {
+        const auto buffer = std::make_unique_for_overwrite<T[]>(n);
+        details::parallel_chunks(n, [&](std::size_t chunk, std::size_t begin, std::size_t end)
+        {
+            auto positions = offsets.data() + chunk * bucket_count;
+            for (auto i = begin; i != end; ++i)
+                buffer[positions[buckets[i]]++] = std::move(first[i]);
+        });
+        details::parallel_chunks(n, [&](std::size_t, std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i != end; ++i)
+                first[i] = std::move(buffer[i]);
+        });
+    }
+
+    //4. Sort the buckets between the splitters, the largest ones first so they don't end up last on a thread
+    std::vector<std::size_t> unsorted;
+    for (std::size_t bucket = 0; bucket < bucket_count; bucket += 2)
+    {
+        if (bucket_begin[bucket + 1] - bucket_begin[bucket] > 1)
+            unsorted.push_back(bucket);
+    }
+    ::pdqsort(unsorted.begin(), unsorted.end(), [&](std::size_t a, std::size_t b)
+    {
+        return bucket_begin[a + 1] - bucket_begin[a] > bucket_begin[b + 1] - bucket_begin[b];
+    });
+    pool.parallel_for(unsorted.size(), [&](std::size_t i)
+    {
+        const auto bucket = unsorted[i];
+        ::pdqsort(first + bucket_begin[bucket], first + bucket_begin[bucket + 1], comp);
+    });
+}
+
+template<typename RandomIt>
+void sample_sort(RandomIt first, RandomIt last)
+{
+    ::sample_sort(first, last, std::less<typename std::iterator_traits<RandomIt>::value_type>{});
+}
@@ -0,0 +1,188 @@
+#pragma once
+#include <cstddef>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <exception>
+#include <deque>
+#include <vector>
+
+/**
+ * @brief A fixed set of worker threads running fork-join loops, used by the parallel execution policies
+ * @details parallel_for() blocks until all of its tasks are done, and the calling thread runs tasks too,
+ * so it can be nested (a task calling parallel_for() never waits for a worker that is waiting for it)
+ */
+class thread_pool
+{
+    /*The shared state of one parallel_for(): the tasks are taken by an atomic counter*/
+    struct job
+    {
+        std::function<void(std::size_t)> const* m_task;
+        std::size_t m_count;
+        std::atomic<std::size_t> m_next{ 0 };
+        std::atomic<std::size_t> m_done{ 0 };
+        std::mutex m_mutex;
+        std::condition_variable m_finished;
+        std::exception_ptr m_exception;
+
+        job(std::function<void(std::size_t)> const& task, std::size_t count) : m_task{ &task }, m_count{ count } {}
+
+        void run()
+        {
+            std::size_t done = 0;
+            for (auto i = m_next.fetch_add(1); i < m_count; i = m_next.fetch_add(1))
+            {
+                try
+                {
+                    (*m_task)(i);
+                }
+                catch (...)
+                {
+                    std::lock_guard lock{ m_mutex };
+                    if (!m_exception)
+                        m_exception = std::current_exception();
+                }
+                ++done;
+            }
+            if (done != 0 && m_done.fetch_add(done) + done == m_count)
+            {
+                std::lock_guard lock{ m_mutex };
+                m_finished.notify_all();
+            }
+        }
+
+        void wait()
+        {
+            std::unique_lock lock{ m_mutex };
+            m_finished.wait(lock, [this] { return m_done.load() == m_count; });
+        }
+    };
+
+    std::vector<std::thread> m_workers;
+    std::deque<std::shared_ptr<job>> m_jobs;
+    std::mutex m_mutex;
+    std::condition_variable m_has_job;
+    bool m_stop = false;
+
+    void work()
+    {
+        while (true)
+        {
+            std::shared_ptr<job> current;
+            {
+                std::unique_lock lock{ m_mutex };
+                m_has_job.wait(lock, [this] { return m_stop || !m_jobs.empty(); });
+                if (m_stop && m_jobs.empty())
+                    return;
+                current = std::move(m_jobs.front());
+                m_jobs.pop_front();
+            }
+            current->run();
+        }
+    }
+
+public:
+    /**
+     * @brief Start thread_count - 1 workers, the thread calling parallel_for() is the last one
+     */
+    explicit thread_pool(std::size_t thread_count = std::thread::hardware_concurrency())
+    {
+        for (std::size_t i = 1; i < thread_count; ++i)
+            m_workers.emplace_back([this] { work(); });
+    }
+
+    thread_pool(thread_pool const&) = delete;
+    thread_pool& operator=(thread_pool const&) = delete;
+
+    ~thread_pool()
+    {
+        {
+            std::lock_guard lock{ m_mutex };
+            m_stop = true;
+        }
+        m_has_job.notify_all();
+        for (auto& worker : m_workers)
+            worker.join();
+    }
+
+    /**
+     * @brief Number of threads running the tasks, including the calling one
+     */
+    std::size_t size() const noexcept { return m_workers.size() + 1; }
+
+    /**
+     * @brief Run task(0) ... task(count - 1) on the workers and the calling thread, and wait for all of them
+     * @throw the first exception thrown by a task, after all tasks are done
+     */
+    void parallel_for(std::size_t count, std::function<void(std::size_t)> const& task)
+    {
+        if (count == 0)
+            return;
+        if (count == 1 || m_workers.empty())
+        {
+            for (std::size_t i = 0; i != count; ++i)
+                task(i);
+            return;
+        }
+        auto current = std::make_shared<job>(task, count);
+        const auto helpers = count - 1 < m_workers.size() ? count - 1 : m_workers.size();
+        {
+            std::lock_guard lock{ m_mutex };
+            for (std::size_t i = 0; i != helpers; ++i)
+                m_jobs.push_back(current);
+        }
+        if (helpers == 1)
+            m_has_job.notify_one();
+        else
+            m_has_job.notify_all();
+        current->run();
+        current->wait();
+        if (current->m_exception)
+            std::rethrow_exception(current->m_exception);
+    }
+
+    /**
+     * @brief The pool of the parallel algorithms, with a thread per hardware thread
+     */
+    static thread_pool& global()
+    {
+        static thread_pool pool;
+        return pool;
+    }
+};
+
+namespace details
+{
+    /*Smallest chunk worth a task, smaller ranges run on the calling thread*/
+    inline constexpr std::size_t parallel_grain = std::size_t{ 1 } << 14;
+
+    /**
+     * @brief Number of chunks parallel_chunks() splits n elements into, a few per thread so a slow thread doesn't hold up the others
+     */
+    inline std::size_t parallel_chunk_count(std::size_t n)
+    {
+        const auto chunks = n / parallel_grain;
+        const auto most = thread_pool::global().size() * 4;
+        return chunks == 0 ? 1 : chunks < most ? chunks : most;
+    }
+
+    /**
+     * @brief Split [0, n) into contiguous chunks and run f(chunk_index, begin, end) for each one on the global thread pool
+     * @details The chunk boundaries only depend on n, callers combining per-chunk results in chunk order
+     * get the same result as the sequential algorithm
+     * @returns the number of chunks
+     */
+    template<typename Function>
+    std::size_t parallel_chunks(std::size_t n, Function&& f)
+    {
+        const auto chunks = parallel_chunk_count(n);
+        if (chunks == 1)
+            f(std::size_t{ 0 }, std::size_t{ 0 }, n);
+        else
+            thread_pool::global().parallel_for(chunks, [&](std::size_t i) { f(i, n * i / chunks, n * (i + 1) / chunks); });
+        return chunks;
+    }
+}
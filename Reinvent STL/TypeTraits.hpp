@@ -633,8 +633,10 @@ template<typename T> inline constexpr bool is_nonvolatile_trivially_copyable_v =
 namespace details
 {
     template<typename Iter1, typename Iter2> struct is_memcmpable : bool_constant<false> {};
+    //Only integers and pointers: floating points have -0.0 == 0.0 and NaN != NaN, and classes may have padding
     template<typename T, typename U> struct is_memcmpable<T*, U*> 
-        : bool_constant<is_nonvolatile_trivially_copyable_v<T> && is_nonvolatile_trivially_copyable_v<U>> {};
+        : bool_constant<is_nonvolatile_trivially_copyable_v<T> && is_nonvolatile_trivially_copyable_v<U>
+            && (is_integral_v<T> || is_pointer_v<T>) && (is_integral_v<U> || is_pointer_v<U>) && sizeof(T) == sizeof(U)> {};
 }
 template<typename Iter1, typename Iter2> struct is_memcmpable : details::is_memcmpable<Iter1, Iter2> {};
 
@@ -657,6 +659,24 @@ template<typename T, typename... Args> inline constexpr bool is_nothrow_construc
 template<typename T> struct is_trivial : bool_constant<is_trivially_copyable_v<T> && is_trivially_default_constructible_v<T>> {};
 template<typename T> inline constexpr bool is_trivial_v = is_trivial<T>::value;
 
+template<typename T> struct is_nothrow_move_constructible : is_nothrow_constructible<T, add_rvalue_reference_t<T>> {};
+template<typename T> inline constexpr bool is_nothrow_move_constructible_v = is_nothrow_move_constructible<T>::value;
+
+//Also requires compiler intrinsics
+template<typename T> struct is_trivially_destructible : bool_constant<__has_trivial_destructor(T)> {};
+template<typename T> inline constexpr bool is_trivially_destructible_v = is_trivially_destructible<T>::value;
+
+/**
+ * Relocating an object = move-constructing it to a new address, then destroying the original.
+ * A type is trivially relocatable if doing so is the same as copying its bytes, so containers can grow with memcpy/realloc.
+ * Every trivially copyable type is, and so are many others like std::unique_ptr or a vector of 3 pointers,
+ * but that can't be detected, so specialize this for them:
+ *      template<> struct is_trivially_relocatable<MyType> : true_type {};
+ * Types pointing into themselves (eg. libstdc++'s std::string pointing at its small buffer) are NOT trivially relocatable
+ */
+template<typename T> struct is_trivially_relocatable : is_trivially_copyable<T> {};
+template<typename T> inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
 namespace details
 {
     template<typename Void, typename T, typename U> struct is_assignable : false_type {};
@@ -690,6 +710,16 @@ struct is_base_of : bool_constant<is_class_v<Base>&& is_class_v<Derived>&& declt
 template<typename Base, typename Derived> inline constexpr bool is_base_of_v = is_base_of<Base, Derived>::value;
 
 
+namespace details
+{
+    /*Whether a hash or comparison function object accepts any type comparable with the key (heterogeneous lookup)*/
+    template<typename T, typename = void>
+    struct is_transparent : false_type {};
+
+    template<typename T>
+    struct is_transparent<T, void_t<typename T::is_transparent>> : true_type {};
+}
+
 template<typename T>
 struct type_identity
 {
@@ -5,11 +5,17 @@
 #include "PointerTraits.hpp" //for addressof
 #include "InitializedMemory.hpp"
 #include "AllocatorTraits.hpp"
+#include <cstring>
+#include <iterator>     //for std::move_iterator
+
+/* The calls below are qualified with ::, otherwise argument-dependent lookup also finds std::destroy, std::addressof...
+ * for pointers to std types, and the call is ambiguous
+ */
 
 template<typename T, typename... Args>
 inline void construct(T* p, Args&&... args)
 {
-    ::new(static_cast<void*>(p)) T(forward<Args>(args)...);
+    ::new(static_cast<void*>(p)) T(::forward<Args>(args)...);
 }
 
 template<typename T>
@@ -22,39 +28,127 @@ template<typename Iter>
 inline void destroy(Iter first, Iter last)
 {
     for (; first != last; ++first)
-        destroy(addressof(*first));
+        ::destroy(::addressof(*first));
 }
 
 
+/*Tag for the containers: default-initialize the new elements, which leaves trivial types like int or float uninitialized instead of zeroed*/
+struct default_init_t { explicit default_init_t() = default; };
+inline constexpr default_init_t default_init{};
+
+/*The memcpy/memset fast paths*/
+namespace details
+{
+    /*Moving a trivially copyable type is copying it, so std::move_iterator<T*> can take the memcpy path too*/
+    template<typename Iter> Iter unwrap_move_iterator(Iter it) { return it; }
+    template<typename Iter> Iter unwrap_move_iterator(std::move_iterator<Iter> it) { return it.base(); }
+
+    /*The objects of [first, last) can be created at d_first by copying their bytes*/
+    template<typename InputIt, typename ForwardIt>
+    inline constexpr bool is_memcpy_constructible_v = false;
+    template<typename T, typename U>
+    inline constexpr bool is_memcpy_constructible_v<T*, U*> = is_same_v<remove_cv_t<T>, U> && is_trivially_copyable_v<U>;
 
+    template<typename T>
+    bool is_zero_bytes(T const& value) noexcept
+    {
+        unsigned char bytes[sizeof(T)];
+        std::memcpy(bytes, ::addressof(value), sizeof(T));
+        for (auto byte : bytes)
+        {
+            if (byte != 0)
+                return false;
+        }
+        return true;
+    }
 
+    /**
+     * @brief Fill count objects at first with value by memset, if its bytes are all the same: a byte-sized type, or all zero bytes
+     * (0, 0.0, nullptr, but not -0.0 or a null pointer to member, which is -1)
+     * @return false if not possible, nothing is written then
+     */
+    template<typename T, typename U>
+    bool fill_bytes(T* first, std::size_t count, U const& value) noexcept
+    {
+        const T converted(value);
+        if constexpr (sizeof(T) == 1)
+        {
+            std::memset(static_cast<void*>(first), *reinterpret_cast<unsigned char const*>(::addressof(converted)), count);
+            return true;
+        }
+        else
+        {
+            if (!is_zero_bytes(converted))
+                return false;
+            std::memset(static_cast<void*>(first), 0, count * sizeof(T));
+            return true;
+        }
+    }
+}
+
+template<typename ForwardIt, typename SizeType, typename T>
+ForwardIt uninitialized_fill_n(ForwardIt first, SizeType count, T const& value);
+
+/**
+ * @brief Copies the given value to an uninitialized memory area, defined by the range [first, last)
+ * @param first the range of the elements to initialize
+ * @param last the range of the elements to initialize
+ * @param value the value to construct the elements with
+ */
 template<typename ForwardIt, typename T>
 void uninitialized_fill(ForwardIt first, ForwardIt last, T const& value)
 {
-
+    if constexpr (is_pointer_v<ForwardIt>)
+    {
+        if constexpr (is_trivially_copyable_v<typename iterator_traits<ForwardIt>::value_type>)
+        {
+            ::uninitialized_fill_n(first, last - first, value);
+            return;
+        }
+    }
+    auto current = first;
+    try
+    {
+        for (; current != last; ++current)
+            ::construct(::addressof(*current), value);
+    }
+    catch (...)
+    {
+        ::destroy(first, current);
+        throw;
+    }
 }
 
+/**
+ * @brief Copies the given value value to the first count elements in an uninitialized memory area beginning at first
+ * @return Iterator to the element past the last element copied
+ */
 template<typename ForwardIt, typename SizeType, typename T>
 ForwardIt uninitialized_fill_n(ForwardIt first, SizeType count, T const& value)
 {
     using value_type = typename iterator_traits<ForwardIt>::value_type;
     static_assert(is_constructible_v<value_type, T const&>, "result type must be constructible from input type");
-    if constexpr (is_trivial_v<T> && is_copy_assignable_v<T>) //check if we can use std::fill
+    if constexpr (is_pointer_v<ForwardIt> && is_trivially_copyable_v<value_type>)
+    {
+        if (count > 0 && details::fill_bytes(first, static_cast<std::size_t>(count), value))
+            return first + count;
+    }
+    if constexpr (is_trivial_v<value_type> && is_copy_assignable_v<value_type>) //check if we can use std::fill
     {
-        return fill_n(first, count, value);
+        return ::fill_n(first, count, value);
     }
     else
     {
         auto current = first;
         try
         {
-            for (; n > 0; --n, (void)++current)
-                construct(addressof(*current), value);
+            for (; count > 0; --count, (void)++current)
+                ::construct(::addressof(*current), value);
             return current;
         }
         catch (...)
         {
-            destroy(first, current);
+            ::destroy(first, current);
             throw;
         }
     }
@@ -62,23 +156,49 @@ ForwardIt uninitialized_fill_n(ForwardIt first, SizeType count, T const& value)
 
 /**
  * @brief Construct objects of type typename iterator_traits<ForwardIt>::value_type in the uninitialized storage designated 
- * by the range [first, last) by default-initialization.
+ * by the range [first, last) by default-initialization. Does nothing for trivially default constructible types
  * @param first the range of the elements to initialize
  * @param last the range of the elements to initialize
  */
-template<typename ForwardIt, typename SizeType>
+template<typename ForwardIt>
 ForwardIt uninitialized_default_construct(ForwardIt first, ForwardIt last)
 {
     using value_type = typename iterator_traits<ForwardIt>::value_type;
+    if constexpr (is_trivially_default_constructible_v<value_type>)
+        return last;
     auto current = first;
     try
     {
         for (; current != last; ++current)
-            ::new (static_cast<void*>(addressof(*current))) value;
+            ::new (static_cast<void*>(::addressof(*current))) value_type;
+    }
+    catch (...)
+    {
+        ::destroy(first, current);
+        throw;
+    }
+    return current;
+}
+
+/**
+ * @brief Construct count objects by default-initialization in the uninitialized storage beginning at first
+ * @return Iterator to the element past the last element constructed
+ */
+template<typename ForwardIt, typename SizeType>
+ForwardIt uninitialized_default_construct_n(ForwardIt first, SizeType count)
+{
+    using value_type = typename iterator_traits<ForwardIt>::value_type;
+    if constexpr (is_trivially_default_constructible_v<value_type> && is_pointer_v<ForwardIt>)
+        return first + count;
+    auto current = first;
+    try
+    {
+        for (; count > 0; --count, (void)++current)
+            ::new (static_cast<void*>(::addressof(*current))) value_type;
     }
     catch (...)
     {
-        destroy(first, current);
+        ::destroy(first, current);
         throw;
     }
     return current;
@@ -94,44 +214,95 @@ template<typename InputIt, typename ForwardIt>
 ForwardIt uninitialized_copy(InputIt first, InputIt last, ForwardIt d_first)
 {
     using value_type = typename iterator_traits<ForwardIt>::value_type;
+    if constexpr (details::is_memcpy_constructible_v<decltype(details::unwrap_move_iterator(first)), ForwardIt>)
+    {
+        const auto source = details::unwrap_move_iterator(first);
+        const auto n = details::unwrap_move_iterator(last) - source;
+        if (n > 0)
+            std::memcpy(static_cast<void*>(d_first), static_cast<void const*>(source), n * sizeof(value_type));
+        return d_first + n;
+    }
     auto current = d_first;
     try
     {
         for (; first != last; ++first, (void)++current)
-            ::new (static_cast<void*>(addressof(*current))) value_type{ *first };
+            ::new (static_cast<void*>(::addressof(*current))) value_type(*first);
         return current;
     }
     catch (...)
     {
-        destroy(first, current);
+        ::destroy(d_first, current);
         throw;
     }
 }
 
 
+/**
+ * @brief Relocates [first, last) to the uninitialized memory at d_first: move constructs the new objects and destroys the old ones
+ * @details Trivially relocatable types (see is_trivially_relocatable) are moved by memmove, and then the ranges may overlap.
+ * Otherwise they must not, and if a move constructor throws, the objects of both ranges are destroyed
+ * @return Pointer to the element past the last element relocated
+ */
+template<typename T>
+T* uninitialized_relocate(T* first, T* last, T* d_first)
+{
+    if constexpr (is_trivially_relocatable_v<T>)
+    {
+        const auto n = static_cast<std::size_t>(last - first);
+        if (n != 0)
+            std::memmove(static_cast<void*>(d_first), static_cast<void const*>(first), n * sizeof(T));
+        return d_first + n;
+    }
+    else
+    {
+        auto current = d_first;
+        try
+        {
+            for (; first != last; ++first, (void)++current)
+            {
+                ::construct(current, ::move(*first));
+                ::destroy(first);
+            }
+            return current;
+        }
+        catch (...)
+        {
+            ::destroy(d_first, current);
+            ::destroy(first, last);
+            throw;
+        }
+    }
+}
+
+
+/*The same algorithms, but constructing and destroying through an allocator, for the containers.
+ *They take the fast paths above when the allocator constructs and destroys in place*/
 namespace details
 {
     template<typename Iter, typename Allocator>
     inline void destroy(Iter first, Iter last, Allocator& a)
     {
         for (; first != last; ++first)
-            allocator_traits<Allocator>::destory(a, addressof(*first));
+            allocator_traits<Allocator>::destroy(a, ::addressof(*first));
     }
 
     template<typename ForwardIt, typename SizeType, typename T, typename Allocator>
     ForwardIt uninitialized_fill_n_a(ForwardIt first, SizeType count, T const& value, Allocator& a)
     {   
-        auto current = first;
+        using value_type = typename iterator_traits<ForwardIt>::value_type;
         static_assert(is_constructible_v<value_type, T const&>, "result type must be constructible from input type");
+        if constexpr (allocator_traits<Allocator>::template constructs_in_place<value_type, T const&>)
+            return ::uninitialized_fill_n(first, count, value);
+        auto current = first;
         try
         {
-            for (; n > 0; --n, (void)++current)
-                allocator_traits<Allocator>::construct(a, addressof(*current), value);
+            for (; count > 0; --count, (void)++current)
+                allocator_traits<Allocator>::construct(a, ::addressof(*current), value);
             return current;
         }
         catch (...)
         {
-            destroy(first, current, a);
+            details::destroy(first, current, a);
             throw;
         }
     }
@@ -143,26 +314,134 @@ namespace details
         try
         {
             for (; current != last; ++current)
-                allocator_traits<Allocator>::construct(a, addressof(*current));
+                allocator_traits<Allocator>::construct(a, ::addressof(*current));
         }
         catch (...)
         {
-            destroy(first, current, a);
+            details::destroy(first, current, a);
             throw;
         }
     }
 
+    /**
+     * @brief Value-initialize count objects at first, eg. ints are zeroed
+     * @return Iterator to the element past the last element constructed
+     */
+    template<typename ForwardIt, typename SizeType, typename Allocator>
+    ForwardIt uninitialized_default_n_a(ForwardIt first, SizeType count, Allocator& a)
+    {
+        using value_type = typename iterator_traits<ForwardIt>::value_type;
+        if constexpr (is_trivial_v<value_type> && is_copy_assignable_v<value_type> && allocator_traits<Allocator>::template constructs_in_place<value_type>)
+        {
+            return ::uninitialized_fill_n(first, count, value_type{});  //memset if value_type{} is zero bytes
+        }
+        else
+        {
+            auto current = first;
+            try
+            {
+                for (; count > 0; --count, (void)++current)
+                    allocator_traits<Allocator>::construct(a, ::addressof(*current));
+                return current;
+            }
+            catch (...)
+            {
+                details::destroy(first, current, a);
+                throw;
+            }
+        }
+    }
+
+    /**
+     * @brief Default-initialize count objects at first: unlike uninitialized_default_n_a(), trivial types are left uninitialized
+     * @details An allocator with its own construct() still value-initializes them, construct(p) is the only way to call it
+     */
     template<typename ForwardIt, typename SizeType, typename Allocator>
-    ForwardIt uninitialized_default_n_a(ForwardIt first, SizeType n, Allocator& a)
+    ForwardIt uninitialized_default_init_n_a(ForwardIt first, SizeType count, Allocator& a)
     {
         using value_type = typename iterator_traits<ForwardIt>::value_type;
-        if constexpr (is_trivial_v<value_type> && is_copy_assignable_v<value_type>)
+        if constexpr (allocator_traits<Allocator>::template constructs_in_place<value_type>)
+            return ::uninitialized_default_construct_n(first, count);
+        else
+            return details::uninitialized_default_n_a(first, count, a);
+    }
+
+    template<typename InputIt, typename ForwardIt, typename Allocator>
+    ForwardIt uninitialized_copy_a(InputIt first, InputIt last, ForwardIt d_first, Allocator& a)
+    {
+        using value_type = typename iterator_traits<ForwardIt>::value_type;
+        if constexpr (allocator_traits<Allocator>::template constructs_in_place<value_type, decltype(*first)>)
+            return ::uninitialized_copy(first, last, d_first);
+        auto current = d_first;
+        try
+        {
+            for (; first != last; ++first, (void)++current)
+                allocator_traits<Allocator>::construct(a, ::addressof(*current), *first);
+            return current;
+        }
+        catch (...)
+        {
+            details::destroy(d_first, current, a);
+            throw;
+        }
+    }
+
+    /**
+     * @brief Move [first, last) to d_first if the move constructor can't throw, otherwise copy, so the source is intact on exception
+     */
+    template<typename ForwardIt1, typename ForwardIt2, typename Allocator>
+    ForwardIt2 uninitialized_move_if_noexcept_a(ForwardIt1 first, ForwardIt1 last, ForwardIt2 d_first, Allocator& a)
+    {
+        using value_type = typename iterator_traits<ForwardIt1>::value_type;
+        if constexpr (details::is_memcpy_constructible_v<ForwardIt1, ForwardIt2> && allocator_traits<Allocator>::template constructs_in_place<value_type, value_type&&>)
+            return ::uninitialized_copy(first, last, d_first);
+        auto current = d_first;
+        try
         {
-            return uninitialized_fill_n(first, n, value_type{});
+            for (; first != last; ++first, (void)++current)
+            {
+                if constexpr (is_nothrow_move_constructible_v<value_type> || !is_constructible_v<value_type, value_type const&>)
+                    allocator_traits<Allocator>::construct(a, ::addressof(*current), ::move(*first));
+                else
+                    allocator_traits<Allocator>::construct(a, ::addressof(*current), *first);
+            }
+            return current;
         }
+        catch (...)
+        {
+            details::destroy(d_first, current, a);
+            throw;
+        }
+    }
+
+    /**
+     * @brief uninitialized_relocate() through the allocator a
+     * @details memmove when the allocator constructs and destroys in place, otherwise the ranges must not overlap
+     */
+    template<typename T, typename Allocator>
+    T* uninitialized_relocate_a(T* first, T* last, T* d_first, Allocator& a)
+    {
+        using alloc_traits = allocator_traits<Allocator>;
+        if constexpr (alloc_traits::template constructs_in_place<T, T&&> && alloc_traits::template destroys_in_place<T>)
+            return ::uninitialized_relocate(first, last, d_first);
         else
         {
-            return details::uninitialized_fill_n_a(first, n, value_type{}, a);
+            auto current = d_first;
+            try
+            {
+                for (; first != last; ++first, (void)++current)
+                {
+                    alloc_traits::construct(a, current, ::move(*first));
+                    alloc_traits::destroy(a, first);
+                }
+                return current;
+            }
+            catch (...)
+            {
+                details::destroy(d_first, current, a);
+                details::destroy(first, last, a);
+                throw;
+            }
         }
     }
-}
\ No newline at end of file
+}
@@ -1,21 +1,25 @@
 #pragma once
-#include "Iterator.hpp"
 #include "AllocatorTraits.hpp"
 #include "Allocator.hpp"
 #include "UninitializedMemory.hpp"
 #include "Algorithm.hpp"
+#include "IteratorTraits.hpp"
 #include <initializer_list>
+#include <iterator>     //for reverse_iterator and iterator_traits of any iterator passed in
+#include <algorithm>    //for std::rotate, std::copy, std::fill
+#include <stdexcept>    //for std::out_of_range, std::length_error
+#include <cstdint>      //for PTRDIFF_MAX
 
 namespace details
 {
     template<typename T, typename Allocator>
     struct vector_base
     {
-        using pointer = typename  allocator_traits<Allocator>::pointer;
-
         //<Alloc::rebind<T>::other> if present, otherwise <Alloc<T, Args>> if this Alloc is <Alloc<U, Args>>
         using alloc_type = typename allocator_traits<Allocator>::template rebind_alloc<T>;
-        
+        using alloc_traits = allocator_traits<alloc_type>;
+        using pointer = typename alloc_traits::pointer;
+
         struct vector_impl_data
         {
             pointer m_start{};
@@ -23,7 +27,7 @@ namespace details
             pointer m_end_of_storage{};
 
             vector_impl_data() noexcept = default;
-            vector_impl_data(vector_impl_data&& x) noexcept 
+            vector_impl_data(vector_impl_data&& x) noexcept
                 : m_start{x.m_start}, m_finish{x.m_finish}, m_end_of_storage{x.m_end_of_storage}
             {
                 x.m_start = x.m_finish = x.m_end_of_storage = nullptr;
@@ -48,72 +52,130 @@ namespace details
 
         struct vector_impl : alloc_type, vector_impl_data
         {
-            vector_impl() noexcept(is_nothrow_default_constructible_v<alloc_type>) : alloc_type{} {}
-            vector_impl(alloc_type const& a) : alloc_type{ a } {}
-            vector_impl(vector_impl&& x) : alloc_type{ std::move(x) }, vector_impl_data{ std::move(x) } {}
-            vector_impl(alloc_type&& a) : alloc_type{ std::move(a) } {}
-            vector_impl(alloc_type&& a, vector_impl&& x) : alloc_type{ std::move(a) }, vector_impl{ std::move(x) }{}
+            vector_impl() noexcept(is_nothrow_constructible_v<alloc_type>) : alloc_type{} {}
+            vector_impl(alloc_type const& a) noexcept : alloc_type{ a } {}
+            vector_impl(vector_impl&& x) noexcept : alloc_type{ std::move(x) }, vector_impl_data{ std::move(x) } {}
+            vector_impl(alloc_type&& a) noexcept : alloc_type{ std::move(a) } {}
+            vector_impl(alloc_type&& a, vector_impl&& x) noexcept : alloc_type{ std::move(a) }, vector_impl_data{ std::move(x) } {}
         };
 
         vector_impl m_impl;
 
         pointer allocate(size_t n)
         {
-            return n != 0 ? allocator_traits<alloc_type>::allocate(m_impl, n);
+            return n != 0 ? alloc_traits::allocate(m_impl, n) : pointer{};
         }
 
         void deallocate(pointer p, size_t n)
         {
             if (p)
-                allocator_traits<alloc_type>::deallocate(m_impl, p, n);
+                alloc_traits::deallocate(m_impl, p, n);
         }
 
+        alloc_type& get_alloc() noexcept { return m_impl; }
+        alloc_type const& get_alloc() const noexcept { return m_impl; }
+
         vector_base() = default;
-        vector_base(Allocator const& a) noexcept : m_impl{ a } {}
-        vector_base(Allocator const& a, vector_base&& x) : m_impl{ alloc_type(a), std::move(x.m_impl) } {}
+        vector_base(Allocator const& a) noexcept : m_impl{ alloc_type(a) } {}
+        vector_base(Allocator const& a, vector_base&& x) noexcept : m_impl{ alloc_type(a), std::move(x.m_impl) } {}
         vector_base(size_t n) : m_impl{} { create_storage(n); }
-        vector_base(size_t n, Allocator const& a) : m_impl{ a } { create_storage(n); }
+        vector_base(size_t n, Allocator const& a) : m_impl{ alloc_type(a) } { create_storage(n); }
         vector_base(vector_base&&) = default;
         vector_base(alloc_type&& a) noexcept : m_impl{ std::move(a) } {}
 
         ~vector_base() noexcept
         {
-            deallocate(m_impl.m_start, m_impl.end_of_stroage - m_impl.start);
+            deallocate(m_impl.m_start, m_impl.m_end_of_storage - m_impl.m_start);
         }
-            
+
     protected:
         void create_storage(std::size_t n)
         {
             m_impl.m_start = allocate(n);
             m_impl.m_finish = m_impl.m_start;
-            m_impl.m_end_of_storage = m_impl.start + n;
+            m_impl.m_end_of_storage = m_impl.m_start + n;
         }
+
+        /*The storage hooks used by vector, so another storage (see small_vector_base) can keep its own buffer*/
+
+        static constexpr bool nothrow_take_storage = true;
+
+        /*Whether the storage came from the allocator*/
+        bool is_allocated() const noexcept { return m_impl.m_start != pointer{}; }
+
+        /*Back to no storage, after it has been deallocated*/
+        void reset_storage() noexcept { m_impl.m_start = m_impl.m_finish = m_impl.m_end_of_storage = pointer{}; }
+
+        /*Take other's elements and storage, other is left with none. This must have no storage*/
+        void take_storage(vector_base& other) noexcept { m_impl.swap_data(other.m_impl); }
+
+        void swap_storage(vector_base& other) noexcept { m_impl.swap_data(other.m_impl); }
     };
 }
 
 /**
  * @brief a sequence container that encapsulates dynamic size arrays
- * 
+ *
  * @tparam T type of the elements
  * @tparam Allocator 	An allocator that is used to acquire/release memory and to construct/destroy the elements in that memory
- * 
+ * @tparam Storage where the elements live, details::vector_base or details::small_vector_base (see small_vector)
+ *
  * @details Requirement of T:
  *          Erasable
- * 
+ *          Growing is where this vector differs from std::vector:
+ *          - trivially relocatable T (see is_trivially_relocatable) are moved with memmove (see uninitialized_relocate), instead of one by one
+ *          - if the Allocator has reallocate() (eg. malloc_allocator), such T are grown with realloc(), which can extend the block in place
+ *          - if the Allocator has try_expand(), any T is first tried to be grown in place
+ *
  */
-template<typename T, typename Allocator = allocator<T>>
-class vector : protected details::vector_base<T, Allocator>
+template<typename T, typename Allocator = allocator<T>, typename Storage = details::vector_base<T, Allocator>>
+class vector : protected Storage
 {
-    using base = details::vector_base<T, Allocator>;
+    using base = Storage;
+    using alloc_traits = typename base::alloc_traits;
+    using base::m_impl;
+    using base::allocate;
+    using base::deallocate;
+    using base::create_storage;
+    using base::get_alloc;
+    using base::is_allocated;
+    using base::reset_storage;
+    using base::take_storage;
+
+    static_assert(is_same_v<typename alloc_traits::pointer, T*>, "vector only supports allocators with raw pointers");
+
+    /*Whether growing may move the elements without a new buffer, so a value referring to an element has to be copied first*/
+    static constexpr bool may_grow_in_place = (is_trivially_relocatable_v<T> && alloc_traits::can_reallocate) || alloc_traits::can_try_expand;
 
+public:
+    /*Member types*/
+    using value_type                = T;
+    using size_type                 = std::size_t;
+    using difference_type           = std::ptrdiff_t;
+    using reference                 = value_type&;
+    using const_reference           = value_type const&;
+    using pointer                   = value_type *;
+    using const_pointer             = value_type const *;
+    using iterator                  = pointer;      //plain pointers like array, so they work with any algorithm
+    using const_iterator            = const_pointer;
+    using reverse_iterator          = std::reverse_iterator<iterator>;
+    using const_reverse_iterator    = std::reverse_iterator<const_iterator>;
+    using allocator_type            = Allocator;
+
+private:
     void fill_initialize(size_type n, value_type const& value)
     {
-        m_impl.m_finish = unintialized_fill_n(m_impl.m_start, n, value, m_impl);
+        m_impl.m_finish = details::uninitialized_fill_n_a(m_impl.m_start, n, value, get_alloc());
     }
 
     void default_initialize(size_type n)
     {
-        m_impl.m_finish = details::uninitialized_default_n_a(m_impl.m_start, n, m_impl);
+        m_impl.m_finish = details::uninitialized_default_n_a(m_impl.m_start, n, get_alloc());
+    }
+
+    void default_init_initialize(size_type n)
+    {
+        m_impl.m_finish = details::uninitialized_default_init_n_a(m_impl.m_start, n, get_alloc());
     }
 
     /**
@@ -127,17 +189,17 @@ class vector : protected details::vector_base<T, Allocator>
      * If it is input_iterator, we have to use emplace_back()/push_back() every time we advance the iterator
      */
     template<typename ForwardIt>
-    void range_initialize(ForwardIt first, ForwardIt last, forward_iterator_tag)
+    void range_initialize(ForwardIt first, ForwardIt last, std::forward_iterator_tag)
     {
-        const auto n = distance(first, last);
-        create_storage(n);
-        m_impl.m_finish = uninitialized_copy(first, last, m_impl.m_start, m_impl);
+        const auto n = static_cast<size_type>(std::distance(first, last));
+        create_storage(check_length(n));
+        m_impl.m_finish = details::uninitialized_copy_a(first, last, m_impl.m_start, get_alloc());
     }
 
     template<typename InputIt>
-    void range_initialize(InputIt first, InputIt last, input_iterator_tag)
+    void range_initialize(InputIt first, InputIt last, std::input_iterator_tag)
     {
-        try 
+        try
         {
             for (; first != last; ++first)
                 emplace_back(*first);   //should be the same as push_back(*first), which is used if __cplusplus < 201103L
@@ -149,29 +211,237 @@ class vector : protected details::vector_base<T, Allocator>
         }
     }
 
+    template<typename InputIt>
+    using iterator_category = typename std::iterator_traits<InputIt>::iterator_category;
 
-public:
-    /*Member types*/
-    using value_type                = T;
-    using size_type                 = std::size_t;
-    using difference_type           = std::ptrdiff_t;
-    using reference                 = value_type&;
-    using const_reference           = value_type const&;
-    using pointer                   = value_type *;
-    using const_pointer             = value_type const *;
-    using iterator                  = normal_iterator<pointer, vector>;
-    using const_iterator            = normal_iterator<pointer const, vector>;
-    using reverse_iterator          = reverse_iterator<iterator>;
-    using const_reverse_iterator    = reverse_iterator<const_iterator>;
-    using allocator_type            = Allocator;
+    template<typename InputIt>
+    static constexpr bool is_forward_iterator = is_base_of_v<std::forward_iterator_tag, iterator_category<InputIt>>;
+
+    size_type check_length(size_type n) const
+    {
+        if (n > max_size())
+            throw std::length_error{ "vector: requested size is larger than max_size()" };
+        return n;
+    }
+
+    /*The capacity to grow to, for n more elements: double the size, or just enough if that's more*/
+    size_type next_capacity(size_type n) const
+    {
+        const auto size = this->size();
+        if (max_size() - size < n)
+            throw std::length_error{ "vector: requested size is larger than max_size()" };
+        const auto grown = size + (size > n ? size : n);
+        return grown > max_size() ? max_size() : grown;
+    }
+
+    /**
+     * @brief Move the elements to the storage at new_start, leaving gap uninitialized slots before pos, and destroy the originals
+     * @details Elements that can't be moved without throwing are copied, so on exception nothing has changed
+     */
+    void relocate_to(pointer new_start, pointer pos, size_type gap)
+    {
+        auto& impl = m_impl;
+        if constexpr (is_trivially_relocatable_v<T>)
+        {
+            ::uninitialized_relocate(impl.m_start, pos, new_start);
+            ::uninitialized_relocate(pos, impl.m_finish, new_start + (pos - impl.m_start) + gap);
+        }
+        else
+        {
+            const auto middle = details::uninitialized_move_if_noexcept_a(impl.m_start, pos, new_start, get_alloc());
+            try
+            {
+                details::uninitialized_move_if_noexcept_a(pos, impl.m_finish, middle + gap, get_alloc());
+            }
+            catch (...)
+            {
+                details::destroy(new_start, middle, get_alloc());
+                throw;
+            }
+            details::destroy(impl.m_start, impl.m_finish, get_alloc());
+        }
+    }
+
+    /*Move the elements to a new buffer of new_cap*/
+    void reallocate_to(size_type new_cap)
+    {
+        auto& impl = m_impl;
+        const auto size = this->size();
+        const auto new_start = allocate(new_cap);
+        try
+        {
+            relocate_to(new_start, impl.m_finish, 0);
+        }
+        catch (...)
+        {
+            deallocate(new_start, new_cap);
+            throw;
+        }
+        deallocate(impl.m_start, capacity());
+        impl.m_start = new_start;
+        impl.m_finish = new_start + size;
+        impl.m_end_of_storage = new_start + new_cap;
+    }
+
+    /**
+     * @brief Grow the storage to new_cap without relocating the elements one by one: by realloc() for trivially relocatable T,
+     * or in place if the allocator can
+     * @return false if not possible, nothing is changed then
+     * @note The elements may have moved, even if the iterators are the same
+     */
+    bool grow_in_place(size_type new_cap)
+    {
+        auto& impl = m_impl;
+        if (!is_allocated())
+            return false;
+        if constexpr (is_trivially_relocatable_v<T> && alloc_traits::can_reallocate)
+        {
+            const auto size = this->size();
+            impl.m_start = alloc_traits::reallocate(get_alloc(), impl.m_start, capacity(), new_cap);
+            impl.m_finish = impl.m_start + size;
+            impl.m_end_of_storage = impl.m_start + new_cap;
+            return true;
+        }
+        else
+        {
+            if (!alloc_traits::try_expand(get_alloc(), impl.m_start, capacity(), new_cap))
+                return false;
+            impl.m_end_of_storage = impl.m_start + new_cap;
+            return true;
+        }
+    }
+
+    /**
+     * @brief Open a gap of n slots before pos and construct them with construct_gap(gap_start), within the capacity
+     * @param construct_gap either constructs all n elements or none, and must not refer to the elements of this vector
+     */
+    template<typename ConstructGap>
+    void insert_in_capacity(pointer pos, size_type n, ConstructGap&& construct_gap)
+    {
+        auto& impl = m_impl;
+        if constexpr (is_trivially_relocatable_v<T>)
+        {
+            ::uninitialized_relocate(pos, impl.m_finish, pos + n);
+            try
+            {
+                construct_gap(pos);
+            }
+            catch (...)
+            {
+                ::uninitialized_relocate(pos + n, impl.m_finish + n, pos);
+                throw;
+            }
+            impl.m_finish += n;
+        }
+        else
+        {
+            //construct at the end, then rotate them into place
+            const auto old_finish = impl.m_finish;
+            construct_gap(old_finish);
+            impl.m_finish += n;
+            std::rotate(pos, old_finish, impl.m_finish);
+        }
+    }
+
+    /*Same as insert_in_capacity(), but into a new buffer. construct_gap is called while the old elements are still there*/
+    template<typename ConstructGap>
+    pointer insert_with_new_buffer(difference_type index, size_type n, ConstructGap&& construct_gap)
+    {
+        auto& impl = m_impl;
+        const auto size = this->size();
+        const auto new_cap = next_capacity(n);
+        const auto new_start = allocate(new_cap);
+        try
+        {
+            construct_gap(new_start + index);
+        }
+        catch (...)
+        {
+            deallocate(new_start, new_cap);
+            throw;
+        }
+        try
+        {
+            if (static_cast<size_type>(index) == size)
+                relocate_to(new_start, impl.m_finish, 0);   //appending, nothing goes after the gap
+            else
+                relocate_to(new_start, impl.m_start + index, n);
+        }
+        catch (...)
+        {
+            details::destroy(new_start + index, new_start + index + n, get_alloc());
+            deallocate(new_start, new_cap);
+            throw;
+        }
+        deallocate(impl.m_start, capacity());
+        impl.m_start = new_start;
+        impl.m_finish = new_start + size + n;
+        impl.m_end_of_storage = new_start + new_cap;
+        return new_start + index;
+    }
 
+    /**
+     * @brief Insert n elements constructed by construct_gap(gap_start) before pos
+     * @return pointer to the first inserted element
+     */
+    template<typename ConstructGap>
+    pointer insert_n(pointer pos, size_type n, ConstructGap&& construct_gap)
+    {
+        if (n == 0)
+            return pos;
+        auto& impl = m_impl;
+        //pos is dead from here on, grow_in_place() may realloc the buffer it points into
+        const auto index = pos - impl.m_start;
+        if (static_cast<size_type>(impl.m_end_of_storage - impl.m_finish) < n && !grow_in_place(next_capacity(n)))
+            return insert_with_new_buffer(index, n, construct_gap);
+        const auto gap = impl.m_start + index;
+        insert_in_capacity(gap, n, construct_gap);
+        return gap;
+    }
+
+    template<typename... Args>
+    pointer emplace_slow(pointer pos, Args&&... args)
+    {
+        auto& impl = m_impl;
+        if (!may_grow_in_place && impl.m_finish == impl.m_end_of_storage)
+        {
+            //a new buffer anyway, args can be used before the old elements are gone
+            return insert_with_new_buffer(pos - impl.m_start, 1, [&](pointer p) { alloc_traits::construct(get_alloc(), p, ::forward<Args>(args)...); });
+        }
+        //args may refer to an element that is about to move
+        T value(::forward<Args>(args)...);
+        return insert_n(pos, 1, [&](pointer p) { alloc_traits::construct(get_alloc(), p, ::move(value)); });
+    }
+
+    void erase_at_end(pointer pos) noexcept
+    {
+        details::destroy(pos, m_impl.m_finish, get_alloc());
+        m_impl.m_finish = pos;
+    }
+
+    /*Free the storage, the elements must be destroyed already*/
+    void release_storage() noexcept
+    {
+        deallocate(m_impl.m_start, capacity());
+        reset_storage();
+    }
+
+    /*Take other's storage, other is left empty*/
+    void steal(vector& other) noexcept(base::nothrow_take_storage)
+    {
+        clear();
+        release_storage();
+        take_storage(other);
+    }
+
+public:
     /*Constructors*/
 
     /**
      * @brief Default constructor, constructs an empty container with a default-constructed allocator
      */
     vector() = default;
-    
+
     /**
      * @brief Construct an empty container with the given allocator alloc
      * @param alloc allocator to use for all memory allocations of this container
@@ -184,7 +454,7 @@ public:
      * @param value the value to initialize elements of the container with
      * @param alloc allocator to use for all memory allocations of this container
      */
-    explicit vector(size_type count, T const& value, Allocator const& alloc = Allocator{}) : base{count, alloc} 
+    explicit vector(size_type count, T const& value, Allocator const& alloc = Allocator{}) : base{check_length(count), alloc}
     {
         fill_initialize(count, value);
     }
@@ -194,51 +464,78 @@ public:
      * @param count the size of the container
      * @param alloc allocator to use for all memory allocations of this container
      */
-    explicit vector(size_type count, Allocator const& alloc = Allocator{}) : base{count, alloc}
+    explicit vector(size_type count, Allocator const& alloc = Allocator{}) : base{check_length(count), alloc}
     {
         default_initialize(count);
     }
 
+    /**
+     * @brief Construct the container with count default-initialized instances of T: trivial types like int are left uninitialized
+     * instead of zeroed, for buffers that are written before they are read
+     * @param count the size of the container
+     * @param alloc allocator to use for all memory allocations of this container
+     */
+    vector(size_type count, default_init_t, Allocator const& alloc = Allocator{}) : base{check_length(count), alloc}
+    {
+        default_init_initialize(count);
+    }
+
     /**
      * @brief Construct the container with the contents of the range [first, last)
      * @param first the iterator to the first element of the range to copy the elements from
      * @param last the iterator to the past-end element of the range to copy
      * @param alloc allocator to use for all memory allocations of this container
+     * @note This overload only participates in overload resolution if InputIt satisfies LegacyInputIterator, to avoid ambiguity with vector(count, value)
      */
-    template<typename InputIt>
-    vector(InputIt first, InputIt last, Allocator const& alloc = Allocator{})
+    template<typename InputIt, typename = enable_if_t<details::is_input_iterator<InputIt>::value>>
+    vector(InputIt first, InputIt last, Allocator const& alloc = Allocator{}) : base{alloc}
     {
-
+        range_initialize(first, last, iterator_category<InputIt>{});
     }
 
     /**
      * @brief copy constructor
      * @param other another container to be used as source to initialize the elements of the container with
      */
-    vector(vector const& other);
+    vector(vector const& other)
+        : vector(other, alloc_traits::select_on_container_copy_construction(other.get_alloc()))
+    {
+    }
 
     /**
      * @brief Constructs the container with the copy of the contents of other, using alloc as the allocator.
      * @param other another container to be used as source to initialize the elements of the container with
      * @param alloc allocator to use for all memory allocations of this container
      */
-    vector(vector const& other, Allocator const& alloc);
+    vector(vector const& other, Allocator const& alloc) : base{other.size(), alloc}
+    {
+        m_impl.m_finish = details::uninitialized_copy_a(other.begin(), other.end(), m_impl.m_start, get_alloc());
+    }
 
     /**
      * @brief move constructor.
      * @param other another container to be used as source to initialize the elements of the container with
      * @note After the move, other is guaranteed to be empty()
      */
-    vector(vector&& other) noexcept;
+    vector(vector&& other) noexcept(base::nothrow_take_storage) = default;
 
     /**
-     * @brief Allocator-extended move constructor. Using alloc as the allocator for the new container, 
-     *  moving the contents from other; if alloc != other.get_allocator(), 
+     * @brief Allocator-extended move constructor. Using alloc as the allocator for the new container,
+     *  moving the contents from other; if alloc != other.get_allocator(),
      *  this results in an element-wise move. (in that case, other is not guaranteed to be empty after the move)
      * @param other another container to be used as source to initialize the elements of the container with
      * @param alloc allocator to use for all memory allocations of this container
      */
-    vector(vector&& other, Allocator const& alloc);
+    vector(vector&& other, Allocator const& alloc) : base{alloc}
+    {
+        if (alloc_traits::is_always_equal::value || get_alloc() == other.get_alloc())
+            take_storage(other);
+        else
+        {
+            create_storage(other.size());
+            m_impl.m_finish = details::uninitialized_copy_a(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()), m_impl.m_start, get_alloc());
+        }
+    }
 
 
     /**
@@ -246,45 +543,100 @@ public:
      * @param init initializer list to initialize the elements of the container with
      * @param alloc allocator to use for all memory allocations of this container
      */
-    vector(std::initializer_list<T> init, Allocator const& alloc = Allocator{});
+    vector(std::initializer_list<T> init, Allocator const& alloc = Allocator{}) : vector(init.begin(), init.end(), alloc) {}
 
     /*Destructor*/
-    
+
     /**
      * @brief Destruct the vector
      * @details The destructors of the elements are called and the used storage is deallocated.
      * @note If the elements are pointers, the pointed_to objects are not destroyed
      */
-    ~vector();
+    ~vector()
+    {
+        details::destroy(m_impl.m_start, m_impl.m_finish, get_alloc());
+    }
 
     /*Assignment operator*/
-    
+
     /**
      * @brief Copy assignment operator.
      * @param other another container to be used as source to initialize the elements of the container with
      */
-    vector& operator=(vector const& other);
+    vector& operator=(vector const& other)
+    {
+        if (this == &other)
+            return *this;
+        if constexpr (alloc_traits::propagate_on_container_copy_assignment::value)
+        {
+            if (!alloc_traits::is_always_equal::value && get_alloc() != other.get_alloc())
+            {
+                clear();
+                release_storage();  //the memory must be freed by the allocator that allocated it
+            }
+            get_alloc() = other.get_alloc();
+        }
+        assign(other.begin(), other.end());
+        return *this;
+    }
 
     /**
      * @brief Move assignment operator.
      * @param other another container to be used as source to initialize the elements of the container with
      */
-    vector& operator=(vector&& other);
+    vector& operator=(vector&& other) noexcept((alloc_traits::propagate_on_container_move_assignment::value || alloc_traits::is_always_equal::value) && base::nothrow_take_storage)
+    {
+        if (this == &other)
+            return *this;
+        if constexpr (alloc_traits::propagate_on_container_move_assignment::value)
+        {
+            steal(other);
+            get_alloc() = std::move(other.get_alloc());
+        }
+        else if constexpr (alloc_traits::is_always_equal::value)
+            steal(other);
+        else
+        {
+            if (get_alloc() == other.get_alloc())
+                steal(other);
+            else
+                assign(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+        }
+        return *this;
+    }
 
     /**
      * @brief Replaces the contents with those identified by initializer_list
      * @param ilist initializer list to use as data source
      */
-    vector& operator=(std::initializer_list<T> ilist);
+    vector& operator=(std::initializer_list<T> ilist)
+    {
+        assign(ilist.begin(), ilist.end());
+        return *this;
+    }
 
     /*assignment*/
-    
+
     /**
      * @brief Replaces the contents with count copies of value value
      * @param count the new size of the container
      * @param value the value to initialize elements of the container with
      */
-    void assign(size_type count, T const& value);
+    void assign(size_type count, T const& value)
+    {
+        if (count > capacity())
+        {
+            vector temp(count, value, get_allocator());
+            steal(temp);
+        }
+        else if (count > size())
+        {
+            std::fill(begin(), end(), value);
+            m_impl.m_finish = details::uninitialized_fill_n_a(m_impl.m_finish, count - size(), value, get_alloc());
+        }
+        else
+            erase_at_end(std::fill_n(begin(), count, value));
+    }
 
     /**
      * @brief Replaces the contents with copies of those in the rage [first, last).
@@ -292,21 +644,70 @@ public:
      * @param last the range to copy the elements from
      * @note The behavior is undefined if either argument is an iterator to *this
      */
-    template<typename InputIt>
-    void assign(InputIt first, InputIt last);
+    template<typename InputIt, typename = enable_if_t<details::is_input_iterator<InputIt>::value>>
+    void assign(InputIt first, InputIt last)
+    {
+        auto& impl = m_impl;
+        if constexpr (is_forward_iterator<InputIt>)
+        {
+            const auto n = static_cast<size_type>(std::distance(first, last));
+            if (n > capacity())
+            {
+                const auto new_start = allocate(check_length(n));
+                try
+                {
+                    details::uninitialized_copy_a(first, last, new_start, get_alloc());
+                }
+                catch (...)
+                {
+                    deallocate(new_start, n);
+                    throw;
+                }
+                clear();
+                release_storage();
+                impl.m_start = new_start;
+                impl.m_finish = impl.m_end_of_storage = new_start + n;
+            }
+            else if (size() >= n)
+                erase_at_end(std::copy(first, last, impl.m_start));
+            else
+            {
+                auto middle = first;
+                std::advance(middle, size());
+                std::copy(first, middle, impl.m_start);
+                impl.m_finish = details::uninitialized_copy_a(middle, last, impl.m_finish, get_alloc());
+            }
+        }
+        else
+        {
+            auto current = begin();
+            for (; first != last && current != end(); ++first, (void)++current)
+                *current = *first;
+            if (first == last)
+                erase_at_end(current);
+            else
+            {
+                for (; first != last; ++first)
+                    emplace_back(*first);
+            }
+        }
+    }
 
     /**
      * @brief Replaces the contents with the elements from the initializer list ilist.
      * @param ilist initializer list to copy the values from
      */
-    void assign(std::initializer_list<T> ilist);
+    void assign(std::initializer_list<T> ilist)
+    {
+        assign(ilist.begin(), ilist.end());
+    }
 
     /**
      * @brief Returns the allocator associated with the container.
      */
     allocator_type get_allocator() const noexcept
     {
-        return allocator_type{ m_impl };
+        return allocator_type{ get_alloc() };
     }
 
     /*Accessors*/
@@ -316,53 +717,77 @@ public:
      * @param pos position of the element to return
      * @throw std::out_of_range if pos is not within the range of the container
      */
-    reference at(size_type pos);
+    reference at(size_type pos)
+    {
+        if (pos >= size())
+            throw std::out_of_range{ "vector::at()" };
+        return m_impl.m_start[pos];
+    }
+
+    /**
+     * @brief Returns a reference to the element at specified location pos, with bounds checking
+     * @param pos position of the element to return
+     * @throw std::out_of_range if pos is not within the range of the container
+     */
+    const_reference at(size_type pos) const
+    {
+        if (pos >= size())
+            throw std::out_of_range{ "vector::at()" };
+        return m_impl.m_start[pos];
+    }
+
+    /**
+     * @brief Returns a reference to the element at specified location pos. No bounds checking is performed.
+     * @param pos position of the element to return
+     * @return Reference to the requested element
+     */
+    reference operator[](size_type pos) { return m_impl.m_start[pos]; }
 
     /**
      * @brief Returns a reference to the element at specified location pos. No bounds checking is performed.
      * @param pos position of the element to return
      * @return Reference to the requested element
      */
-    reference operator[](size_type pos);
+    const_reference operator[](size_type pos) const { return m_impl.m_start[pos]; }
 
     /**
      * @brief Returns a reference to the first element in the container.
      * @note Calling front() on an empty container is undefined.
      */
-    reference front();
+    reference front() { return *m_impl.m_start; }
 
     /**
      * @brief Returns a reference to the first element in the container.
      * @note Calling front() on an empty container is undefined.
      */
-    const_reference front() const;
+    const_reference front() const { return *m_impl.m_start; }
 
     /**
      * @brief Returns a reference to the last element in the container.
      * @note Calling back() on an empty container is undefined.
      */
-    reference back();
+    reference back() { return m_impl.m_finish[-1]; }
 
     /**
      * @brief Returns a reference to the last element in the container.
      * @note Calling back() on an empty container is undefined.
      */
-    const_reference back() const;
+    const_reference back() const { return m_impl.m_finish[-1]; }
 
     /**
      * @brief Returns pointer to the underlying array serving as element storage.
      * @note If size() is 0, data() may or may not return a null pointer
      */
-    T* data() noexcept;
+    T* data() noexcept { return m_impl.m_start; }
 
     /**
      * @brief Returns pointer to the underlying array serving as element storage.
      * @note If size() is 0, data() may or may not return a null pointer
      */
-    T const* data() const noexcept;
+    T const* data() const noexcept { return m_impl.m_start; }
 
     /*Iterators*/
-    
+
     /**
      * @brief Returns an iterator to the first element of the array
      *
@@ -401,7 +826,7 @@ public:
      */
     const_iterator end() const noexcept
     {
-        return data() + N;
+        return m_impl.m_finish;
     }
 
     /**
@@ -412,7 +837,7 @@ public:
      */
     iterator end() noexcept
     {
-        return data() + N;
+        return m_impl.m_finish;
     }
 
     /**
@@ -435,7 +860,7 @@ public:
      */
     const_reverse_iterator rbegin() const noexcept
     {
-        return end();
+        return const_reverse_iterator{ end() };
     }
 
     /**
@@ -447,7 +872,7 @@ public:
      */
     reverse_iterator rbegin() noexcept
     {
-        return end();
+        return reverse_iterator{ end() };
     }
 
     /**
@@ -471,7 +896,7 @@ public:
      */
     const_reverse_iterator rend() const noexcept
     {
-        return begin();
+        return const_reverse_iterator{ begin() };
     }
 
     /**
@@ -483,7 +908,7 @@ public:
      */
     reverse_iterator rend() noexcept
     {
-        return begin();
+        return reverse_iterator{ begin() };
     }
 
     /**
@@ -503,39 +928,65 @@ public:
     /**
      * @brief Check if the container has no elements.
      */
-    bool empty() const noexcept;
+    bool empty() const noexcept { return m_impl.m_start == m_impl.m_finish; }
 
     /**
      * @brief Returns the number of elements in the container.
      */
-    size_type size() const noexcept;
+    size_type size() const noexcept { return static_cast<size_type>(m_impl.m_finish - m_impl.m_start); }
 
     /**
      * @brief Reurns the maximum number of elements the container is able to hold due to system or library implementation limimtations.
-     * @note This value typically reflects the theoretical limit on the size of the container, at most std::numeric_limits<difference_type>::max(). 
+     * @note This value typically reflects the theoretical limit on the size of the container, at most std::numeric_limits<difference_type>::max().
      * At runtime, the size of the container may be limited to a value smaller than max_size() by the amount of RAM available.
      */
-    size_type max_size() const noexcept;
+    size_type max_size() const noexcept
+    {
+        constexpr size_type diff_max = PTRDIFF_MAX / sizeof(T);
+        const size_type alloc_max = alloc_traits::max_size(get_alloc());
+        return diff_max < alloc_max ? diff_max : alloc_max;
+    }
 
     /**
-     * @brief Increase the capacity of the vector to a value that's >= new_cap. If new_cap is >= the current capacity(), new storage is allocated, 
+     * @brief Increase the capacity of the vector to a value that's >= new_cap. If new_cap is >= the current capacity(), new storage is allocated,
      * otherwise the method does nothing.
      * @param new_cap new capacity of the vector
      * @note T must meet the requirements of MoveInsertable
      * @throw std::length_error if new_cap > max_size(), and any exception thrown by Allocator::allocate(), typically std::bad_alloc
      */
-    void reserve(size_type new_cap);
+    void reserve(size_type new_cap)
+    {
+        if (new_cap <= capacity())
+            return;
+        check_length(new_cap);
+        if (!grow_in_place(new_cap))
+            reallocate_to(new_cap);
+    }
 
     /**
      * @brief Returns the number of elements that the container has currently allocated space for.
      */
-    size_type capacity() const noexcept;
+    size_type capacity() const noexcept { return static_cast<size_type>(m_impl.m_end_of_storage - m_impl.m_start); }
 
     /**
      * @brief Requests the removal of unsed capacity.
      * @note It depends on the implementation whether the request is fulfilled
      */
-    void shrink_to_fit();
+    void shrink_to_fit()
+    {
+        if (capacity() == size() || !is_allocated())
+            return;
+        if (empty())
+            release_storage();
+        else if constexpr (is_trivially_relocatable_v<T> && alloc_traits::can_reallocate)
+        {
+            const auto size = this->size();
+            m_impl.m_start = alloc_traits::reallocate(get_alloc(), m_impl.m_start, capacity(), size);
+            m_impl.m_finish = m_impl.m_end_of_storage = m_impl.m_start + size;
+        }
+        else
+            reallocate_to(size());
+    }
 
     /*Modifiers*/
 
@@ -543,21 +994,21 @@ public:
      * @brief Erase all elements from the container. After this call, size() returns 0
      * @note capacity() is unchanged.
      */
-    void clear() noexcept;
+    void clear() noexcept { erase_at_end(m_impl.m_start); }
 
     /**
      * @brief Inserts value before pos.
      * @param pos iterator before which the content will be inserted. pos may be the end() iterator
      * param value element value to insert
      */
-    iterator insert(const_iterator pos, T const& value);
+    iterator insert(const_iterator pos, T const& value) { return emplace(pos, value); }
 
     /**
      * @brief Inserts value before pos.
      * @param pos iterator before which the content will be inserted. pos may be the end() iterator
      * param value element value to insert
      */
-    iterator insert(const_iterator pos, T&& value);
+    iterator insert(const_iterator pos, T&& value) { return emplace(pos, ::move(value)); }
 
     /**
      * @brief insert count copies of the value before pos.
@@ -565,7 +1016,11 @@ public:
      * @param count number of copies of value to insert
      * @param value element value to insert
      */
-    iterator insert(const_iterator pos, size_type count, T const& value);
+    iterator insert(const_iterator pos, size_type count, T const& value)
+    {
+        T const copy(value);    //value may be an element that is about to move
+        return insert_n(const_cast<pointer>(pos), count, [&](pointer p) { details::uninitialized_fill_n_a(p, count, copy, get_alloc()); });
+    }
 
     /**
      * @brief insert elements from range [first, last) before pos.
@@ -574,95 +1029,194 @@ public:
      * @note This overload only participates in overload resolution if InputIt satisfies LegacyInputIterator to avoid ambiguity
      * with insert(pos, count, value)
      */
-    template<typename InputIt>
-    iterator insert(const_iterator pos, InputIt first, InputIt last);
+    template<typename InputIt, typename = enable_if_t<details::is_input_iterator<InputIt>::value>>
+    iterator insert(const_iterator pos, InputIt first, InputIt last)
+    {
+        if constexpr (is_forward_iterator<InputIt>)
+        {
+            const auto n = static_cast<size_type>(std::distance(first, last));
+            return insert_n(const_cast<pointer>(pos), n, [&](pointer p) { details::uninitialized_copy_a(first, last, p, get_alloc()); });
+        }
+        else
+        {
+            //unknown length, append them, then rotate into place
+            const auto index = pos - begin();
+            const auto old_size = size();
+            for (; first != last; ++first)
+                emplace_back(*first);
+            std::rotate(begin() + index, begin() + old_size, end());
+            return begin() + index;
+        }
+    }
 
     /**
      * @brief Inserts elements from initializer list ilist before pos.
      * @param ilist initializer list to insert the values from
      */
-    iterator insert(const_iterator pos, std::initializer_list<T> ilist);
+    iterator insert(const_iterator pos, std::initializer_list<T> ilist) { return insert(pos, ilist.begin(), ilist.end()); }
 
     /**
      * @brief Inserts a new element into the container before pos.
      * @param pos iterator before which the new element will be constructed
      * @param args arguments to forward to the constructor of the element
-     * @details The element is constructed through std::allocator_traits::construct, 
-     * which typically uses placement-new to construct the element in-place at a location provided by the container. 
-     * However, if the required location has been occupied by an existing element, 
+     * @details The element is constructed through std::allocator_traits::construct,
+     * which typically uses placement-new to construct the element in-place at a location provided by the container.
+     * However, if the required location has been occupied by an existing element,
      * the inserted element is constructed at another location at first, and then move assigned into the required location.
      */
     template<typename... Args>
-    iterator emplace(const_iterator pos, Args&&... args);
+    iterator emplace(const_iterator pos, Args&&... args)
+    {
+        auto& impl = m_impl;
+        if (pos == impl.m_finish && impl.m_finish != impl.m_end_of_storage)
+        {
+            alloc_traits::construct(get_alloc(), impl.m_finish, ::forward<Args>(args)...);
+            return impl.m_finish++;
+        }
+        return emplace_slow(const_cast<pointer>(pos), ::forward<Args>(args)...);
+    }
 
     /**
      * @brief Removes the element at pos.
      * @param pos iterator to the element to remove
      */
-    iterator erase(const_iterator pos);
+    iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
 
     /**
      * @brief Removes the elements in the range [first, last).
      * @param first range of elements to remove
      * @param last range of elements to remove
      */
-    iterator erase(const_iterator first, const_iterator last);
+    iterator erase(const_iterator first, const_iterator last)
+    {
+        const auto p = const_cast<pointer>(first);
+        const auto q = const_cast<pointer>(last);
+        if (p == q)
+            return p;
+        if constexpr (is_trivially_relocatable_v<T>)
+        {
+            details::destroy(p, q, get_alloc());
+            ::uninitialized_relocate(q, m_impl.m_finish, p);
+            m_impl.m_finish -= q - p;
+        }
+        else
+            erase_at_end(std::move(q, m_impl.m_finish, p));
+        return p;
+    }
 
     /**
      * @brief Appends the given element value to the end of the container, the new element is initialized as a copy of value
      * @param value the value of the element to append
      */
-    void push_back(T const& value);
+    void push_back(T const& value) { emplace_back(value); }
 
     /**
      * @brief Appends the given element value to the end of the container, value is momved into the new element.
      * @param value the value of the element to append
      */
-    void push_back(T&& value);
+    void push_back(T&& value) { emplace_back(::move(value)); }
 
     /**
      * @breif Append a new element to the end of the container, the element is constructed through allocator_traits::construct.
      * @param args arguments to forward to the constructor of the element
      */
     template<typename... Args>
-    reference emplace_back(Args&&... args);
+    reference emplace_back(Args&&... args)
+    {
+        auto& impl = m_impl;
+        if (impl.m_finish != impl.m_end_of_storage)
+        {
+            alloc_traits::construct(get_alloc(), impl.m_finish, ::forward<Args>(args)...);
+            ++impl.m_finish;
+        }
+        else
+            emplace_slow(impl.m_finish, ::forward<Args>(args)...);
+        return back();
+    }
 
     /**
      * @brief Remomves the last element of the container.
      * @note Calling pop_back() on an empty container results in undefined behavior.
      */
-    void pop_back();
+    void pop_back()
+    {
+        --m_impl.m_finish;
+        alloc_traits::destroy(get_alloc(), m_impl.m_finish);
+    }
 
     /**
      * @brief Resizes the container. If size() <= count, additional default-inserted elements are appended
      * @param count new size of the container
      */
-    void resize(size_type count);
+    void resize(size_type count)
+    {
+        const auto size = this->size();
+        if (count < size)
+            erase_at_end(m_impl.m_start + count);
+        else if (count > size)
+            insert_n(m_impl.m_finish, count - size, [&](pointer p) { details::uninitialized_default_n_a(p, count - size, get_alloc()); });
+    }
+
+    /**
+     * @brief Resizes the container. If size() <= count, additional default-initialized elements are appended, trivial types are left uninitialized
+     * @param count new size of the container
+     */
+    void resize(size_type count, default_init_t)
+    {
+        const auto size = this->size();
+        if (count < size)
+            erase_at_end(m_impl.m_start + count);
+        else if (count > size)
+            insert_n(m_impl.m_finish, count - size, [&](pointer p) { details::uninitialized_default_init_n_a(p, count - size, get_alloc()); });
+    }
 
     /**
      * @brief Resizes the container. If size() <= count, additional copies of value are appended
      * @param count new size of the container
      * @param value the value to initialize the new elements with
      */
-    void resize(size_type count, T const& value);
+    void resize(size_type count, T const& value)
+    {
+        const auto size = this->size();
+        if (count < size)
+            erase_at_end(m_impl.m_start + count);
+        else if (count > size)
+            insert(end(), count - size, value);
+    }
 
     /**
-     * @brief Exchanges the contents of the container with those of other. Doesn't invoke any move/copy/swap operations on individual elements
+     * @brief Exchanges the contents of the container with those of other. Doesn't invoke any move/copy/swap operations on individual elements,
+     * unless the storage keeps them inline (small_vector)
      * @throw nothrow if (std::allocator_traits<Allocator>::propagate_on_container_swap::value || std::allocator_traits<Allocator>::is_always_equal::value)
      */
-    void swap(vector& other) noexcept();
+    void swap(vector& other) noexcept(base::nothrow_take_storage)
+    {
+        base::swap_storage(other);
+        if constexpr (alloc_traits::propagate_on_container_swap::value)
+        {
+            using std::swap;
+            swap(get_alloc(), other.get_alloc());
+        }
+    }
 };
 
-template<typename T, typename Alloc>
-bool operator==(vector<T, Alloc> const& lhs, vector<T, Alloc> const& rhs) { return lhs.size() == rhs.size() && equal(lhs.begin(), lhs.end(), rhs.begin()); }
-template<typename T, typename Alloc>
-bool operator!=(vector<T, Alloc> const& lhs, vector<T, Alloc> const& rhs) { return !(lhs == rhs); }
-template<typename T, typename Alloc>
-bool operator<(vector<T, Alloc> const& lhs, vector<T, Alloc> const& rhs)
-{ return lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end()); }
-template<typename T, typename Alloc>
-bool operator<=(vector<T, Alloc> const& lhs, vector<T, Alloc> const& rhs) { }
-template<typename T, typename Alloc>
-bool operator>(vector<T, Alloc> const& lhs, vector<T, Alloc> const& rhs);
-template<typename T, typename Alloc>
-bool operator>=(vector<T, Alloc> const& lhs, vector<T, Alloc> const& rhs);
\ No newline at end of file
+/*Deduction guide, so vector(first, last) deduces the element type*/
+template<typename InputIt, typename Alloc = allocator<typename std::iterator_traits<InputIt>::value_type>>
+vector(InputIt, InputIt, Alloc = Alloc()) -> vector<typename std::iterator_traits<InputIt>::value_type, Alloc>;
+
+template<typename T, typename Alloc, typename Storage>
+void swap(vector<T, Alloc, Storage>& lhs, vector<T, Alloc, Storage>& rhs) noexcept(noexcept(lhs.swap(rhs))) { lhs.swap(rhs); }
+
+template<typename T, typename Alloc, typename Storage>
+bool operator==(vector<T, Alloc, Storage> const& lhs, vector<T, Alloc, Storage> const& rhs) { return lhs.size() == rhs.size() && ::equal(lhs.begin(), lhs.end(), rhs.begin()); }
+template<typename T, typename Alloc, typename Storage>
+bool operator!=(vector<T, Alloc, Storage> const& lhs, vector<T, Alloc, Storage> const& rhs) { return !(lhs == rhs); }
+template<typename T, typename Alloc, typename Storage>
+bool operator<(vector<T, Alloc, Storage> const& lhs, vector<T, Alloc, Storage> const& rhs)
+{ return ::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end()); }
+template<typename T, typename Alloc, typename Storage>
+bool operator<=(vector<T, Alloc, Storage> const& lhs, vector<T, Alloc, Storage> const& rhs) { return !(rhs < lhs); }
+template<typename T, typename Alloc, typename Storage>
+bool operator>(vector<T, Alloc, Storage> const& lhs, vector<T, Alloc, Storage> const& rhs) { return rhs < lhs; }
+template<typename T, typename Alloc, typename Storage>
+bool operator>=(vector<T, Alloc, Storage> const& lhs, vector<T, Alloc, Storage> const& rhs) { return !(lhs < rhs); }
@@ -0,0 +1,145 @@
+/* Description: push_back-heavy workloads, vector against std::vector of libstdc++,
+* short-lived small_vector against both, and sized construction, zeroed or default-initialized
+*/
+#include "SmallVector.hpp"
+
+#include <benchmark/benchmark.h>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <new>
+
+/*Every allocation goes through here, so the benchmarks can report allocations per iteration.
+* Not inlined, otherwise g++ sees malloc paired with a sized delete at the call sites and warns -Wmismatched-new-delete*/
+static std::size_t allocation_count = 0;
+
+[[gnu::noinline]] void* operator new(std::size_t size)
+{
+    ++allocation_count;
+    if (auto p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc{};
+}
+
+[[gnu::noinline]] void operator delete(void* p) noexcept { std::free(p); }
+[[gnu::noinline]] void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+/*Not trivially copyable, so std::vector copies it one by one when growing*/
+struct Relocatable
+{
+    int value;
+    Relocatable(int value) : value{ value } {}
+    Relocatable(Relocatable const& other) : value{ other.value } {}
+    ~Relocatable() {}
+};
+
+template<>
+struct is_trivially_relocatable<Relocatable> : true_type {};
+
+template<typename Vector, typename Make>
+static void push_back(benchmark::State& state, Make make)
+{
+    const auto n = static_cast<int>(state.range(0));
+    for (auto _ : state)
+    {
+        Vector v;
+        for (int i = 0; i < n; ++i)
+            v.push_back(make(i));
+        benchmark::DoNotOptimize(v.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+static auto make_int = [](int i) { return i; };
+static auto make_relocatable = [](int i) { return Relocatable{ i }; };
+static auto make_string = [](int i) { return std::string(32, static_cast<char>('a' + i % 26)); };
+
+static void BM_StdInt(benchmark::State& state) { push_back<std::vector<int>>(state, make_int); }
+static void BM_Int(benchmark::State& state) { push_back<vector<int>>(state, make_int); }
+static void BM_IntMalloc(benchmark::State& state) { push_back<vector<int, malloc_allocator<int>>>(state, make_int); }
+
+static void BM_StdRelocatable(benchmark::State& state) { push_back<std::vector<Relocatable>>(state, make_relocatable); }
+static void BM_Relocatable(benchmark::State& state) { push_back<vector<Relocatable>>(state, make_relocatable); }
+static void BM_RelocatableMalloc(benchmark::State& state) { push_back<vector<Relocatable, malloc_allocator<Relocatable>>>(state, make_relocatable); }
+
+static void BM_StdString(benchmark::State& state) { push_back<std::vector<std::string>>(state, make_string); }
+static void BM_String(benchmark::State& state) { push_back<vector<std::string>>(state, make_string); }
+
+BENCHMARK(BM_StdInt)->Range(1 << 10, 1 << 22);
+BENCHMARK(BM_Int)->Range(1 << 10, 1 << 22);
+BENCHMARK(BM_IntMalloc)->Range(1 << 10, 1 << 22);
+BENCHMARK(BM_StdRelocatable)->Range(1 << 10, 1 << 22);
+BENCHMARK(BM_Relocatable)->Range(1 << 10, 1 << 22);
+BENCHMARK(BM_RelocatableMalloc)->Range(1 << 10, 1 << 22);
+BENCHMARK(BM_StdString)->Range(1 << 10, 1 << 18);
+BENCHMARK(BM_String)->Range(1 << 10, 1 << 18);
+
+/*A container of a few elements built and dropped per iteration, like in a hot path*/
+template<typename Vector>
+static void short_lived(benchmark::State& state)
+{
+    const auto n = static_cast<int>(state.range(0));
+    const auto allocations = allocation_count;
+    for (auto _ : state)
+    {
+        Vector v;
+        for (int i = 0; i < n; ++i)
+            v.push_back(i);
+        benchmark::DoNotOptimize(v.data());
+        benchmark::ClobberMemory();
+    }
+    state.counters["allocations"] = benchmark::Counter(static_cast<double>(allocation_count - allocations), benchmark::Counter::kAvgIterations);
+}
+
+static void BM_ShortLivedStd(benchmark::State& state) { short_lived<std::vector<int>>(state); }
+static void BM_ShortLivedVector(benchmark::State& state) { short_lived<vector<int>>(state); }
+static void BM_ShortLivedSmall(benchmark::State& state) { short_lived<small_vector<int, 16>>(state); }
+
+BENCHMARK(BM_ShortLivedStd)->Arg(4)->Arg(15)->Arg(64);
+BENCHMARK(BM_ShortLivedVector)->Arg(4)->Arg(15)->Arg(64);
+BENCHMARK(BM_ShortLivedSmall)->Arg(4)->Arg(15)->Arg(64);
+
+/*A buffer of n ints filled right after construction, so zeroing it first is wasted*/
+template<typename Vector, typename... Init>
+static void fill_buffer(benchmark::State& state, Init... init)
+{
+    const auto n = static_cast<std::size_t>(state.range(0));
+    for (auto _ : state)
+    {
+        Vector v(n, init...);
+        for (std::size_t i = 0; i < n; ++i)
+            v[i] = static_cast<int>(i);
+        benchmark::DoNotOptimize(v.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * n * sizeof(int));
+}
+
+static void BM_FillStd(benchmark::State& state) { fill_buffer<std::vector<int>>(state); }
+static void BM_FillZeroed(benchmark::State& state) { fill_buffer<vector<int>>(state); }
+static void BM_FillDefaultInit(benchmark::State& state) { fill_buffer<vector<int>>(state, default_init); }
+
+/*Copy construction, element by element for std::vector<int> on some standard libraries, memcpy here*/
+template<typename Vector>
+static void copy(benchmark::State& state)
+{
+    const Vector source(static_cast<std::size_t>(state.range(0)), 1);
+    for (auto _ : state)
+    {
+        auto v = source;
+        benchmark::DoNotOptimize(v.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * source.size() * sizeof(int));
+}
+
+static void BM_CopyStd(benchmark::State& state) { copy<std::vector<int>>(state); }
+static void BM_Copy(benchmark::State& state) { copy<vector<int>>(state); }
+
+BENCHMARK(BM_FillStd)->Range(1 << 10, 1 << 22);
+BENCHMARK(BM_FillZeroed)->Range(1 << 10, 1 << 22);
+BENCHMARK(BM_FillDefaultInit)->Range(1 << 10, 1 << 22);
+BENCHMARK(BM_CopyStd)->Range(1 << 10, 1 << 22);
+BENCHMARK(BM_Copy)->Range(1 << 10, 1 << 22);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,221 @@
+/* Description: the algorithms of Algorithm.hpp under each execution policy, against the <execution> policies of the standard library
+* The standard parallel policies need TBB with libstdc++, without it they run sequentially
+*/
+#include "Algorithm.hpp"
+#include "Vector.hpp"
+
+#include <benchmark/benchmark.h>
+#include <execution>
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <cstdint>
+
+static vector<std::int32_t> random_values(std::size_t n)
+{
+    std::mt19937 rng{ 1 };
+    vector<std::int32_t> values(n);
+    for (auto& value : values)
+        value = static_cast<std::int32_t>(rng() % 1'000'000);
+    return values;
+}
+
+/*Policies are passed as indices: 0 seq, 1 unseq, 2 par, 3 par_unseq*/
+template<typename Function>
+static decltype(auto) with_policy(benchmark::State& state, Function&& f)
+{
+    switch (state.range(1))
+    {
+    case 0: return f(execution::seq, std::execution::seq);
+    case 1: return f(execution::unseq, std::execution::unseq);
+    case 2: return f(execution::par, std::execution::par);
+    default: return f(execution::par_unseq, std::execution::par_unseq);
+    }
+}
+
+template<bool Std>
+static void find(benchmark::State& state)
+{
+    auto values = random_values(state.range(0));
+    values.back() = -1;     //the only match, so the whole range is searched
+    for (auto _ : state)
+    {
+        with_policy(state, [&](auto policy, auto std_policy)
+        {
+            if constexpr (Std)
+                benchmark::DoNotOptimize(std::find(std_policy, values.begin(), values.end(), -1));
+            else
+                benchmark::DoNotOptimize(::find(policy, values.begin(), values.end(), -1));
+        });
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0) * sizeof(std::int32_t));
+}
+
+template<bool Std>
+static void count(benchmark::State& state)
+{
+    const auto values = random_values(state.range(0));
+    for (auto _ : state)
+    {
+        with_policy(state, [&](auto policy, auto std_policy)
+        {
+            if constexpr (Std)
+                benchmark::DoNotOptimize(std::count(std_policy, values.begin(), values.end(), 42));
+            else
+                benchmark::DoNotOptimize(::count(policy, values.begin(), values.end(), 42));
+        });
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0) * sizeof(std::int32_t));
+}
+
+template<bool Std>
+static void transform(benchmark::State& state)
+{
+    const auto v1 = random_values(state.range(0));
+    const auto v2 = random_values(state.range(0));
+    vector<std::int32_t> result(state.range(0));
+    for (auto _ : state)
+    {
+        with_policy(state, [&](auto policy, auto std_policy)
+        {
+            if constexpr (Std)
+                std::transform(std_policy, v1.begin(), v1.end(), v2.begin(), result.begin(), std::plus<>{});
+            else
+                ::transform(policy, v1.begin(), v1.end(), v2.begin(), result.begin(), std::plus<>{});
+        });
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template<bool Std>
+static void reduce(benchmark::State& state)
+{
+    vector<double> values(state.range(0));
+    std::iota(values.begin(), values.end(), 0.0);
+    for (auto _ : state)
+    {
+        with_policy(state, [&](auto policy, auto std_policy)
+        {
+            if constexpr (Std)
+                benchmark::DoNotOptimize(std::reduce(std_policy, values.begin(), values.end(), 0.0));
+            else
+                benchmark::DoNotOptimize(::reduce(policy, values.begin(), values.end(), 0.0));
+        });
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template<bool Std>
+static void copy(benchmark::State& state)
+{
+    const auto values = random_values(state.range(0));
+    vector<std::int32_t> result(state.range(0));
+    for (auto _ : state)
+    {
+        with_policy(state, [&](auto policy, auto std_policy)
+        {
+            if constexpr (Std)
+                std::copy(std_policy, values.begin(), values.end(), result.begin());
+            else
+                ::copy(policy, values.begin(), values.end(), result.begin());
+        });
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0) * sizeof(std::int32_t));
+}
+
+template<bool Std>
+static void fill(benchmark::State& state)
+{
+    vector<std::int32_t> values(state.range(0));
+    for (auto _ : state)
+    {
+        with_policy(state, [&](auto policy, auto std_policy)
+        {
+            if constexpr (Std)
+                std::fill(std_policy, values.begin(), values.end(), 7);
+            else
+                ::fill(policy, values.begin(), values.end(), 7);
+        });
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0) * sizeof(std::int32_t));
+}
+
+template<bool Std>
+static void sort(benchmark::State& state)
+{
+    const auto values = random_values(state.range(0));
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        auto copy = values;
+        state.ResumeTiming();
+        with_policy(state, [&](auto policy, auto std_policy)
+        {
+            if constexpr (Std)
+                std::sort(std_policy, copy.begin(), copy.end());
+            else
+                ::sort(policy, copy.begin(), copy.end());
+        });
+        benchmark::DoNotOptimize(copy.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template<bool Std>
+static void lexicographical_compare(benchmark::State& state)
+{
+    const auto v1 = random_values(state.range(0));
+    auto v2 = v1;
+    ++v2.back();
+    for (auto _ : state)
+    {
+        with_policy(state, [&](auto policy, auto std_policy)
+        {
+            if constexpr (Std)
+                benchmark::DoNotOptimize(std::lexicographical_compare(std_policy, v1.begin(), v1.end(), v2.begin(), v2.end()));
+            else
+                benchmark::DoNotOptimize(::lexicographical_compare(policy, v1.begin(), v1.end(), v2.begin(), v2.end()));
+        });
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0) * sizeof(std::int32_t));
+}
+
+static void BM_Find(benchmark::State& state) { find<false>(state); }
+static void BM_StdFind(benchmark::State& state) { find<true>(state); }
+static void BM_Count(benchmark::State& state) { count<false>(state); }
+static void BM_StdCount(benchmark::State& state) { count<true>(state); }
+static void BM_Transform(benchmark::State& state) { transform<false>(state); }
+static void BM_StdTransform(benchmark::State& state) { transform<true>(state); }
+static void BM_Reduce(benchmark::State& state) { reduce<false>(state); }
+static void BM_StdReduce(benchmark::State& state) { reduce<true>(state); }
+static void BM_Copy(benchmark::State& state) { copy<false>(state); }
+static void BM_StdCopy(benchmark::State& state) { copy<true>(state); }
+static void BM_Fill(benchmark::State& state) { fill<false>(state); }
+static void BM_StdFill(benchmark::State& state) { fill<true>(state); }
+static void BM_Sort(benchmark::State& state) { sort<false>(state); }
+static void BM_StdSort(benchmark::State& state) { sort<true>(state); }
+static void BM_LexicographicalCompare(benchmark::State& state) { lexicographical_compare<false>(state); }
+static void BM_StdLexicographicalCompare(benchmark::State& state) { lexicographical_compare<true>(state); }
+
+#define ALGORITHM_BENCHMARK(name) BENCHMARK(name)->ArgsProduct({ { 1'000, 100'000, 10'000'000 }, { 0, 1, 2, 3 } })->ArgNames({ "n", "policy" })->Unit(benchmark::kMicrosecond)
+ALGORITHM_BENCHMARK(BM_Find);
+ALGORITHM_BENCHMARK(BM_StdFind);
+ALGORITHM_BENCHMARK(BM_Count);
+ALGORITHM_BENCHMARK(BM_StdCount);
+ALGORITHM_BENCHMARK(BM_Transform);
+ALGORITHM_BENCHMARK(BM_StdTransform);
+ALGORITHM_BENCHMARK(BM_Reduce);
+ALGORITHM_BENCHMARK(BM_StdReduce);
+ALGORITHM_BENCHMARK(BM_Copy);
+ALGORITHM_BENCHMARK(BM_StdCopy);
+ALGORITHM_BENCHMARK(BM_Fill);
+ALGORITHM_BENCHMARK(BM_StdFill);
+ALGORITHM_BENCHMARK(BM_Sort);
+ALGORITHM_BENCHMARK(BM_StdSort);
+ALGORITHM_BENCHMARK(BM_LexicographicalCompare);
+ALGORITHM_BENCHMARK(BM_StdLexicographicalCompare);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,92 @@
+/* Description: the allocators against allocator<T>: short-lived vectors in an inline_arena,
+* random reads over 16 MiB to 1 GiB buffers of normal or huge pages, and the cost of counting with stats_allocator
+*/
+#include "Vector.hpp"
+#include "PageAllocator.hpp"
+
+#include <benchmark/benchmark.h>
+#include <cstdint>
+
+/*A vector of a few elements built and dropped per iteration, like in a hot path*/
+static void BM_ShortLived(benchmark::State& state)
+{
+    const auto n = static_cast<int>(state.range(0));
+    for (auto _ : state)
+    {
+        vector<int> v;
+        for (int i = 0; i < n; ++i)
+            v.push_back(i);
+        benchmark::DoNotOptimize(v.data());
+        benchmark::ClobberMemory();
+    }
+}
+
+static void BM_ShortLivedArena(benchmark::State& state)
+{
+    const auto n = static_cast<int>(state.range(0));
+    for (auto _ : state)
+    {
+        inline_arena<1024> arena;
+        vector<int, arena_allocator<int, 1024>> v{ arena };
+        for (int i = 0; i < n; ++i)
+            v.push_back(i);
+        benchmark::DoNotOptimize(v.data());
+        benchmark::ClobberMemory();
+    }
+}
+
+BENCHMARK(BM_ShortLived)->Arg(4)->Arg(15)->Arg(64)->Arg(200);
+BENCHMARK(BM_ShortLivedArena)->Arg(4)->Arg(15)->Arg(64)->Arg(200);
+
+/*Dependent random reads, each one a TLB miss once the buffer is much bigger than the TLB reach (a few MiB with 4 KiB pages)*/
+template<typename Alloc>
+static void random_reads(benchmark::State& state)
+{
+    const auto n = static_cast<std::size_t>(state.range(0)) << 20 >> 3;
+    vector<std::uint64_t, Alloc> buffer(n, default_init);
+    std::uint64_t x = 1;
+    for (auto& value : buffer)
+    {
+        x ^= x << 13, x ^= x >> 7, x ^= x << 17;
+        value = x;
+    }
+    std::uint64_t index = 0;
+    for (auto _ : state)
+    {
+        for (int i = 0; i < 1 << 16; ++i)
+            index = buffer[index] % n;
+        benchmark::DoNotOptimize(index);
+    }
+    state.SetItemsProcessed(state.iterations() << 16);
+}
+
+static void BM_RandomReads(benchmark::State& state) { random_reads<allocator<std::uint64_t>>(state); }
+static void BM_RandomReadsHugePages(benchmark::State& state) { random_reads<huge_page_allocator<std::uint64_t>>(state); }
+static void BM_RandomReadsNuma(benchmark::State& state) { random_reads<numa_allocator<std::uint64_t>>(state); }
+
+//the argument is the buffer size in MiB
+BENCHMARK(BM_RandomReads)->RangeMultiplier(4)->Range(16, 1024)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_RandomReadsHugePages)->RangeMultiplier(4)->Range(16, 1024)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_RandomReadsNuma)->RangeMultiplier(4)->Range(16, 1024)->Unit(benchmark::kMicrosecond);
+
+template<typename Alloc>
+static void push_back(benchmark::State& state)
+{
+    const auto n = static_cast<int>(state.range(0));
+    for (auto _ : state)
+    {
+        vector<int, Alloc> v;
+        for (int i = 0; i < n; ++i)
+            v.push_back(i);
+        benchmark::DoNotOptimize(v.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+static void BM_PushBack(benchmark::State& state) { push_back<allocator<int>>(state); }
+static void BM_PushBackStats(benchmark::State& state) { push_back<stats_allocator<allocator<int>>>(state); }
+
+BENCHMARK(BM_PushBack)->Range(1 << 10, 1 << 20);
+BENCHMARK(BM_PushBackStats)->Range(1 << 10, 1 << 20);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,117 @@
+/* Description: flat_map against std::map, lookup and iteration of 10^3 to 10^7 random int keys
+*/
+#include "FlatMap.hpp"
+
+#include <benchmark/benchmark.h>
+#include <map>
+#include <random>
+#include <cstdint>
+
+static vector<std::uint32_t> random_keys(std::size_t n, std::uint32_t seed)
+{
+    std::mt19937 rng{ seed };
+    vector<std::uint32_t> keys(n);
+    for (auto& key : keys)
+        key = rng();
+    return keys;
+}
+
+using flat_map_type = flat_map<std::uint32_t, std::uint32_t>;
+using std_map_type = std::map<std::uint32_t, std::uint32_t>;
+
+template<typename Map>
+static Map make_map(vector<std::uint32_t> const& keys)
+{
+    if constexpr (is_same_v<Map, flat_map_type>)
+        return Map{ keys, keys };   //bulk construct, sorted once
+    else
+    {
+        Map map;
+        for (auto key : keys)
+            map.emplace(key, key);
+        return map;
+    }
+}
+
+template<typename Map>
+static void lookup(benchmark::State& state)
+{
+    const auto n = static_cast<std::size_t>(state.range(0));
+    const auto keys = random_keys(n, 1);
+    const auto map = make_map<Map>(keys);
+    auto lookups = random_keys(n, 2);
+    for (std::size_t i = 0; i < n; ++i)
+        lookups[i] = keys[lookups[i] % n];
+    for (auto _ : state)
+    {
+        std::uint64_t sum = 0;
+        for (auto key : lookups)
+            sum += map.find(key)->second;
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template<typename Map>
+static void iterate(benchmark::State& state)
+{
+    const auto map = make_map<Map>(random_keys(state.range(0), 1));
+    for (auto _ : state)
+    {
+        std::uint64_t sum = 0;
+        for (auto const& [key, value] : map)
+            sum += key ^ value;
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * map.size());
+}
+
+template<typename Map>
+static void construct(benchmark::State& state)
+{
+    const auto keys = random_keys(state.range(0), 1);
+    for (auto _ : state)
+    {
+        auto map = make_map<Map>(keys);
+        benchmark::DoNotOptimize(map.size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/*The same lookups with the branchy std::lower_bound over the sorted keys*/
+static void BM_StdLowerBound(benchmark::State& state)
+{
+    const auto n = static_cast<std::size_t>(state.range(0));
+    const auto keys = random_keys(n, 1);
+    const auto map = make_map<flat_map_type>(keys);
+    auto lookups = random_keys(n, 2);
+    for (std::size_t i = 0; i < n; ++i)
+        lookups[i] = keys[lookups[i] % n];
+    auto const& sorted = map.keys();
+    for (auto _ : state)
+    {
+        std::uint64_t sum = 0;
+        for (auto key : lookups)
+            sum += map.values()[std::lower_bound(sorted.begin(), sorted.end(), key) - sorted.begin()];
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+static void BM_FlatLookup(benchmark::State& state) { lookup<flat_map_type>(state); }
+static void BM_StdLookup(benchmark::State& state) { lookup<std_map_type>(state); }
+static void BM_FlatIterate(benchmark::State& state) { iterate<flat_map_type>(state); }
+static void BM_StdIterate(benchmark::State& state) { iterate<std_map_type>(state); }
+static void BM_FlatConstruct(benchmark::State& state) { construct<flat_map_type>(state); }
+static void BM_StdConstruct(benchmark::State& state) { construct<std_map_type>(state); }
+
+#define FLAT_MAP_BENCHMARK(name) BENCHMARK(name)->RangeMultiplier(10)->Range(1'000, 10'000'000)->Unit(benchmark::kMicrosecond)
+FLAT_MAP_BENCHMARK(BM_FlatLookup);
+FLAT_MAP_BENCHMARK(BM_StdLowerBound);
+FLAT_MAP_BENCHMARK(BM_StdLookup);
+FLAT_MAP_BENCHMARK(BM_FlatIterate);
+FLAT_MAP_BENCHMARK(BM_StdIterate);
+FLAT_MAP_BENCHMARK(BM_FlatConstruct);
+FLAT_MAP_BENCHMARK(BM_StdConstruct);
+
+BENCHMARK_MAIN();
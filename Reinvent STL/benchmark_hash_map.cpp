@@ -0,0 +1,99 @@
+/* Description: flat_hash_map against std::unordered_map, insert/find/erase of 10^3 to 10^8 random 64-bit keys
+* 10^8 keys need about 5GB for std::unordered_map, use --benchmark_filter to skip it on smaller machines
+*/
+#include "FlatHashMap.hpp"
+
+#include <benchmark/benchmark.h>
+#include <unordered_map>
+#include <vector>
+#include <random>
+#include <cstdint>
+
+static std::vector<std::uint64_t> random_keys(std::size_t n, std::uint64_t seed)
+{
+    std::mt19937_64 rng{ seed };
+    std::vector<std::uint64_t> keys(n);
+    for (auto& key : keys)
+        key = rng();
+    return keys;
+}
+
+template<typename Map>
+static void insert(benchmark::State& state)
+{
+    const auto keys = random_keys(state.range(0), 1);
+    for (auto _ : state)
+    {
+        Map map;
+        for (auto key : keys)
+            map.emplace(key, key);
+        benchmark::DoNotOptimize(map.size());
+        state.PauseTiming();
+        { Map drop = std::move(map); }
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/*Half of the lookups hit*/
+template<typename Map>
+static void find(benchmark::State& state)
+{
+    const auto n = static_cast<std::size_t>(state.range(0));
+    const auto keys = random_keys(n, 1);
+    auto lookups = random_keys(n, 2);
+    for (std::size_t i = 0; i < n; i += 2)
+        lookups[i] = keys[(i * 7919) % n];
+    Map map;
+    for (auto key : keys)
+        map.emplace(key, key);
+    for (auto _ : state)
+    {
+        std::uint64_t sum = 0;
+        for (auto key : lookups)
+        {
+            if (auto it = map.find(key); it != map.end())
+                sum += it->second;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template<typename Map>
+static void erase(benchmark::State& state)
+{
+    const auto keys = random_keys(state.range(0), 1);
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        Map map;
+        for (auto key : keys)
+            map.emplace(key, key);
+        state.ResumeTiming();
+        for (auto key : keys)
+            map.erase(key);
+        benchmark::DoNotOptimize(map.size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+using flat_map_type = flat_hash_map<std::uint64_t, std::uint64_t>;
+using std_map_type = std::unordered_map<std::uint64_t, std::uint64_t>;
+
+static void BM_FlatInsert(benchmark::State& state) { insert<flat_map_type>(state); }
+static void BM_StdInsert(benchmark::State& state) { insert<std_map_type>(state); }
+static void BM_FlatFind(benchmark::State& state) { find<flat_map_type>(state); }
+static void BM_StdFind(benchmark::State& state) { find<std_map_type>(state); }
+static void BM_FlatErase(benchmark::State& state) { erase<flat_map_type>(state); }
+static void BM_StdErase(benchmark::State& state) { erase<std_map_type>(state); }
+
+#define HASH_MAP_BENCHMARK(name) BENCHMARK(name)->RangeMultiplier(10)->Range(1'000, 100'000'000)->Unit(benchmark::kMillisecond)
+HASH_MAP_BENCHMARK(BM_FlatInsert);
+HASH_MAP_BENCHMARK(BM_StdInsert);
+HASH_MAP_BENCHMARK(BM_FlatFind);
+HASH_MAP_BENCHMARK(BM_StdFind);
+HASH_MAP_BENCHMARK(BM_FlatErase);
+HASH_MAP_BENCHMARK(BM_StdErase);
+
+BENCHMARK_MAIN();
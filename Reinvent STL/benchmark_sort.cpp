@@ -0,0 +1,58 @@
+/* Description: pdqsort, radix_sort and sample_sort against std::sort, on random, sorted, reversed and few unique 32-bit keys, 10^3 to 10^9 of them
+* 10^9 keys need 4GB for the input, another 4GB for the copy sorted by each iteration and 4GB for the buffers, use --benchmark_filter to skip it on smaller machines
+*/
+#include "Sort.hpp"
+#include "Vector.hpp"
+
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <execution>
+#include <random>
+#include <cstdint>
+
+enum distribution { random_keys, sorted_keys, reversed_keys, few_unique_keys };
+
+static vector<std::uint32_t> make_keys(std::size_t n, distribution kind)
+{
+    std::mt19937 rng{ 1 };
+    vector<std::uint32_t> keys(n);
+    for (auto& key : keys)
+        key = kind == few_unique_keys ? rng() % 16 : rng();
+    if (kind == sorted_keys)
+        std::sort(keys.begin(), keys.end());
+    else if (kind == reversed_keys)
+        std::sort(keys.begin(), keys.end(), std::greater<>{});
+    return keys;
+}
+
+template<typename Sort>
+static void sort_keys(benchmark::State& state, Sort sort)
+{
+    const auto keys = make_keys(state.range(0), static_cast<distribution>(state.range(1)));
+    vector<std::uint32_t> copy(keys.size());
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        std::copy(keys.begin(), keys.end(), copy.begin());
+        state.ResumeTiming();
+        sort(copy.begin(), copy.end());
+        benchmark::DoNotOptimize(copy.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_StdSort(benchmark::State& state) { sort_keys(state, [](auto first, auto last) { std::sort(first, last); }); }
+static void BM_StdSortPar(benchmark::State& state) { sort_keys(state, [](auto first, auto last) { std::sort(std::execution::par, first, last); }); }
+static void BM_Pdqsort(benchmark::State& state) { sort_keys(state, [](auto first, auto last) { ::pdqsort(first, last); }); }
+static void BM_RadixSort(benchmark::State& state) { sort_keys(state, [](auto first, auto last) { ::radix_sort(first, last); }); }
+static void BM_SampleSort(benchmark::State& state) { sort_keys(state, [](auto first, auto last) { ::sample_sort(first, last); }); }
+
+#define SORT_BENCHMARK(name) BENCHMARK(name)->ArgsProduct({ benchmark::CreateRange(1'000, 1'000'000'000, 10), { random_keys, sorted_keys, reversed_keys, few_unique_keys } }) \
+    ->ArgNames({ "n", "distribution" })->Unit(benchmark::kMillisecond)
+SORT_BENCHMARK(BM_StdSort);
+SORT_BENCHMARK(BM_StdSortPar);
+SORT_BENCHMARK(BM_Pdqsort);
+SORT_BENCHMARK(BM_RadixSort);
+SORT_BENCHMARK(BM_SampleSort);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,53 @@
+/* A compile-time benchmark of IntegerSequence.hpp: running it does nothing, what is measured is how long it takes to compile.
+ *     cmake --build <build dir> --target IntegerSequenceCompileBenchmark
+ * builds it with -ftime-report on g++, which breaks the time down into template instantiation, constant evaluation and so on.
+ * Pass -DSEQUENCE_SIZE=<n> to change the length, and -DREINVENT_STL_NO_INTEGER_BUILTINS to measure the doubling fallback.
+ *
+ * g++ 12, -fsyntax-only, all the static_asserts below:
+ *
+ *   SEQUENCE_SIZE   recursive version         builtin     doubling
+ *   100             0.67s                     0.13s       0.13s
+ *   418             fails: depth > 900        -           -
+ *   1000            -                         0.50s       0.53s
+ *   2500            -                         1.13s       1.28s
+ *   5000            -                         2.87s       3.05s
+ *   10000           -                         7.05s       7.61s
+ *   20000           -                         19.7s       24.7s
+ *
+ * The smallest -ftemplate-depth that compiles it is 7 with the builtin whatever the size, and 15 / 19 with doubling at 1000 / 10000
+ * elements, while the recursive version needed about 2 levels per element.
+ * The time is still a little superlinear, g++ -ftime-report puts most of it in constant evaluation of the element-wise conversions
+ *
+ * g++ has no instantiation counter, but -fdump-lang-class writes out every class it completes, so
+ *     g++ -std=c++20 -fsyntax-only -fdump-lang-class -DSEQUENCE_SIZE=<n> compile_benchmark_integer_sequence.cpp
+ * and counting the "Class" entries that aren't std:: gives the class template instantiations (function templates aren't listed):
+ *
+ *   SEQUENCE_SIZE   recursive version         builtin     doubling
+ *   100             2373                      66          101
+ *   400             24348                     66          109
+ *   1000            -                         66          109
+ *   10000           -                         66          115
+ *
+ * (the recursive version at 400 with -ftemplate-depth raised). At 10^4 elements it is a constant 66 with the builtin and grows
+ * with log2(N) with doubling, while the recursive version grew with N^2 and doesn't compile anywhere near 10^4
+ */
+#include "IntegerSequence.hpp"
+
+#ifndef SEQUENCE_SIZE
+#define SEQUENCE_SIZE 10000
+#endif
+
+constexpr std::size_t N = SEQUENCE_SIZE;
+using sequence = make_index_sequence<N>;
+
+static_assert(sequence::size() == N);
+static_assert(sequence::reverse::front() == N - 1);
+static_assert(sequence::pop_back_t::back() == N - 2);
+static_assert(sequence::split_second_part_t<N / 2>::front() == N / 2 + 1);
+static_assert(decltype(sequence::filter([](auto i) { return i % 2 == 0; }))::size() == N / 2);
+static_assert(sequence::repeat_t<2>::size() == 2 * N);
+static_assert(std::is_same_v<make_integer_sequence<int, 3, -2>, integer_sequence<int, -2, -1, 0, 1, 2>>);
+
+int main()
+{
+}
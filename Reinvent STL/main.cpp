@@ -568,7 +568,7 @@ namespace Test
         static constexpr auto Trait()
         {
             static_assert(details::is_input_iterator<InputIterator<int>>::value);
-            //static_assert(details::is_input_iterator<int*>::value);
+            static_assert(details::is_input_iterator<int*>::value);
             static_assert(!details::is_input_iterator<NotInputIterator1<int>>::value);
             //static_assert(!details::is_input_iterator<NotInputIterator2<int>>::value);
         }
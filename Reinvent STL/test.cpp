@@ -0,0 +1,487 @@
+/* The runtime tests of the containers, algorithms and allocators, built as ReinventSTLTest and run by ctest.
+ * They use assert(), so NDEBUG is undefined even in a release build
+ */
+#undef NDEBUG
+#include <iostream>
+#include "IteratorTraits.hpp"
+#include "IntegerSequence.hpp"
+#include "SmallVector.hpp"
+#include <cassert>
+#include <string>
+#include <memory>
+
+namespace VectorTest
+{
+    //Not trivially copyable, but fine to be moved by memcpy
+    struct Relocatable
+    {
+        int value;
+        Relocatable(int value) : value{ value } {}
+        Relocatable(Relocatable const& other) : value{ other.value } {}
+        ~Relocatable() {}
+    };
+}
+
+template<>
+struct is_trivially_relocatable<VectorTest::Relocatable> : true_type {};
+
+namespace VectorTest
+{
+    void test()
+    {
+        {
+            vector<int> v;
+            for (int i = 0; i < 1000; ++i)
+                v.push_back(i);
+            assert(v.size() == 1000 && v.back() == 999);
+            for (int i = 0; i < 100; ++i)
+                v.push_back(v[0]);  //the argument refers to an element while growing
+            assert(v.back() == 0);
+            v.insert(v.begin() + 5, 3, v[1]);
+            assert(v[5] == 1 && v[7] == 1 && v[8] == 5);
+            v.erase(v.begin(), v.begin() + 5);
+            assert(v.front() == 1);
+
+            auto copy = v;
+            assert(copy == v);
+            copy.push_back(1);
+            assert(copy != v && v < copy);
+            auto moved = std::move(copy);
+            assert(copy.empty() && moved.size() == v.size() + 1);
+        }
+        {
+            vector<std::string> v{ "a", "b", "c" };
+            v.emplace(v.begin() + 1, "x");
+            assert(v[1] == "x" && v[2] == "b");
+            for (int i = 0; i < 100; ++i)
+                v.push_back(v[0]);
+            assert(v.size() == 104 && v.back() == "a");
+            v.resize(200, "z");
+            assert(v.back() == "z");
+            v.assign({ "p", "q" });
+            assert(v.size() == 2 && v[1] == "q");
+        }
+        {
+            vector<std::unique_ptr<int>> v;
+            for (int i = 0; i < 50; ++i)
+                v.push_back(std::make_unique<int>(i));
+            v.erase(v.begin() + 3);
+            v.insert(v.begin(), std::make_unique<int>(-1));
+            assert(*v[0] == -1 && *v[4] == 4);
+        }
+        {
+            //grows with realloc()
+            vector<Relocatable, malloc_allocator<Relocatable>> v;
+            for (int i = 0; i < 1000; ++i)
+                v.push_back(v.empty() ? Relocatable{ i } : v[0]);
+            assert(v.size() == 1000 && v.back().value == 0);
+            v.shrink_to_fit();
+            assert(v.capacity() == 1000);
+        }
+        {
+            small_vector<std::string, 4> v{ "a", "b" };
+            assert(v.capacity() == 4);
+            for (int i = 0; i < 10; ++i)
+                v.push_back(v[0]);  //spills to the heap
+            assert(v.size() == 12 && v.capacity() > 4);
+            small_vector<std::string, 4> inline_elements{ "x" };
+            inline_elements.swap(v);
+            assert(inline_elements.size() == 12 && v.size() == 1 && v[0] == "x");
+            auto moved = std::move(v);
+            assert(moved[0] == "x" && v.empty());
+            v.clear();
+            v.shrink_to_fit();
+            assert(v.capacity() == 4);
+        }
+    }
+}
+
+#include "FlatHashMap.hpp"
+#include <string_view>
+#include <stdexcept>
+
+namespace FlatHashMapTest
+{
+    struct StringHash
+    {
+        using is_transparent = void;
+        std::size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+    };
+
+    /*Throws once calls_left reaches 0, never if it is negative*/
+    struct ThrowingHash
+    {
+        static inline int calls_left = -1;
+        std::size_t operator()(std::string const& s) const
+        {
+            if (calls_left == 0)
+                throw std::runtime_error{ "hash" };
+            if (calls_left > 0)
+                --calls_left;
+            return std::hash<std::string>{}(s);
+        }
+    };
+
+    void test()
+    {
+        {
+            flat_hash_map<int, int> map;
+            assert(map.find(1) == map.end() && map.begin() == map.end());
+            for (int i = 0; i < 1000; ++i)
+                map[i] = i * 2;
+            assert(map.size() == 1000 && map.at(500) == 1000);
+            for (int i = 0; i < 1000; i += 2)
+                assert(map.erase(i) == 1);
+            assert(map.size() == 500 && !map.contains(2) && map.contains(3));
+
+            int count = 0;
+            for (auto const& [key, value] : map)
+            {
+                assert(key % 2 == 1 && value == key * 2);
+                ++count;
+            }
+            assert(count == 500);
+
+            auto copy = map;
+            assert(copy == map);
+            auto moved = std::move(copy);
+            assert(moved == map && copy.empty());
+        }
+        {
+            //heterogeneous lookup
+            flat_hash_map<std::string, int, StringHash, std::equal_to<>> map{ { "a", 1 }, { "b", 2 } };
+            assert(map.find(std::string_view{ "a" })->second == 1 && map.contains("b") && !map.contains("c"));
+            map.try_emplace("c", 3);
+            map.insert_or_assign("a", 10);
+            assert(map.at("a") == 10 && map.erase("b") == 1 && map.size() == 2);
+        }
+        {
+            flat_hash_map<int, int> map;
+            map.reserve(1000);
+            const auto capacity = map.capacity();
+            for (int i = 0; i < 1000; ++i)
+                map[i] = i;
+            assert(map.capacity() == capacity);
+        }
+        {
+            //the hash throwing in the middle of a rehash leaves every element in place
+            flat_hash_map<std::string, int, ThrowingHash> map;
+            const auto key = [](int i) { return "a key too long for the small string buffer " + std::to_string(i); };
+            for (int i = 0; i < 100; ++i)
+                map[key(i)] = i;
+            ThrowingHash::calls_left = 50;
+            try
+            {
+                map.reserve(10'000);
+                assert(false);
+            }
+            catch (std::runtime_error const&) {}
+            ThrowingHash::calls_left = -1;
+            assert(map.size() == 100);
+            for (int i = 0; i < 100; ++i)
+                assert(map.at(key(i)) == i);
+        }
+    }
+}
+
+#include "FlatMap.hpp"
+
+namespace FlatMapTest
+{
+    void test()
+    {
+        {
+            flat_set<int> set{ 5, 1, 3, 3 };
+            assert(set.size() == 3 && *set.begin() == 1 && set.contains(5) && !set.contains(2));
+            assert(set.insert(2).second && !set.insert(2).second);
+            assert(*set.lower_bound(4) == 5 && set.upper_bound(5) == set.end());
+            set.insert({ 10, 0, 1 });   //bulk insert, sorted once
+            assert(set.size() == 6 && *set.begin() == 0);
+        }
+        {
+            //of the equivalent keys, the first wins, with enough of them that the sort isn't a plain insertion sort
+            auto by_first = [](std::pair<int, int> lhs, std::pair<int, int> rhs) { return lhs.first < rhs.first; };
+            vector<std::pair<int, int>> pairs;
+            for (int i = 0; i < 100; ++i)
+                pairs.push_back({ (i * 7) % 10, i });
+            flat_set<std::pair<int, int>, decltype(by_first)> set(pairs.begin(), pairs.end(), by_first);
+            assert(set.size() == 10);
+            for (auto [key, index] : set)
+                assert(index < 10 && (index * 7) % 10 == key);
+        }
+        {
+            //of the equivalent keys, the first wins
+            flat_map<std::string, int, std::less<>> map{ { "b", 2 }, { "a", 1 }, { "b", 20 }, { "c", 3 } };
+            assert(map.size() == 3 && map.at("b") == 2 && map.begin()->first == "a");
+            assert(map.find(std::string_view{ "c" })->second == 3 && !map.contains("z"));
+            map["d"] = 4;
+            map.insert_or_assign("a", 10);
+            assert(map.at("a") == 10 && map.size() == 4);
+            for (auto it = map.begin(); it != map.end(); ++it)
+                it->second += 1;
+            assert(map["a"] == 11);
+            assert(map.erase("b") == 1 && map.erase(map.begin())->first == "c");
+        }
+        {
+            flat_map<int, int> map{ vector<int>{ 3, 1, 2 }, vector<int>{ 30, 10, 20 } };
+            assert(map.keys() == (vector<int>{ 1, 2, 3 }) && map.values() == (vector<int>{ 10, 20, 30 }));
+        }
+    }
+}
+
+#include "Algorithm.hpp"
+#include <cstdint>
+namespace AlgorithmTest
+{
+    void test()
+    {
+        {
+            //the SIMD kernels at each element size, around the 16-byte blocks
+            vector<std::uint8_t> bytes(37, 1);
+            bytes[20] = 200;
+            assert(::find(execution::unseq, bytes.begin(), bytes.end(), 200) == bytes.begin() + 20);
+            assert(::find(execution::unseq, bytes.begin(), bytes.end(), -56) == bytes.end());    //200 != -56 after promotion
+            assert(::find(execution::unseq, bytes.begin(), bytes.end(), static_cast<signed char>(-56)) == bytes.end());
+            assert(::count(execution::par_unseq, bytes.begin(), bytes.end(), static_cast<signed char>(-56)) == 0);
+            assert(::count(execution::unseq, bytes.begin(), bytes.end(), 1) == 36);
+            vector<std::uint16_t> halves(37, 1);
+            halves[33] = 65535;
+            assert(::find(execution::unseq, halves.begin(), halves.end(), short{ -1 }) == halves.end());   //65535 != -1 after promotion
+            assert(::count(execution::unseq, halves.begin(), halves.end(), short{ -1 }) == 0);
+            assert(::find(execution::unseq, halves.begin(), halves.end(), std::uint16_t{ 65535 }) == halves.begin() + 33);
+            vector<std::uint64_t> words(37, 0xFFFFFFFF);
+            words[33] = ~std::uint64_t{ 0 };
+            assert(::find(execution::unseq, words.begin(), words.end(), ~std::uint64_t{ 0 }) == words.begin() + 33);
+            assert(::count(execution::par_unseq, words.begin(), words.end(), 0xFFFFFFFF) == 36);
+        }
+        {
+            //large enough to be split into chunks
+            vector<long long> values(100'000);
+            for (std::size_t i = 0; i < values.size(); ++i)
+                values[i] = i % 1000;
+            assert(::find(execution::par, values.begin(), values.end(), 999) == values.begin() + 999);
+            assert(::count(execution::par_unseq, values.begin(), values.end(), 7) == 100);
+            assert(::reduce(execution::par_unseq, values.begin(), values.end(), 1LL) == ::reduce(values.begin(), values.end(), 1LL));
+            vector<long long> result(values.size());
+            ::transform(execution::par_unseq, values.begin(), values.end(), values.begin(), result.begin(), [](auto a, auto b) { return a * b; });
+            assert(result[999] == 999 * 999);
+            ::copy(execution::par, values.begin(), values.end(), result.begin());
+            assert(result == values);
+            ::fill(execution::par, result.begin(), result.end(), 3);
+            assert(::count(result.begin(), result.end(), 3) == 100'000);
+            ::sort(execution::par, values.begin(), values.end(), [](auto a, auto b) { return a > b; });
+            assert(values.front() == 999 && values.back() == 0 && std::is_sorted(values.rbegin(), values.rend()));
+            result = values;
+            ++result[90'000];
+            assert(::lexicographical_compare(execution::par, values.begin(), values.end(), result.begin(), result.end()));
+            assert(!::lexicographical_compare(execution::par, result.begin(), result.end(), values.begin(), values.end()));
+        }
+        {
+            //memcmp paths
+            unsigned char a[]{ 1, 200 }, b[]{ 1, 201 };
+            assert(::lexicographical_compare(a, a + 2, b, b + 2) && !::lexicographical_compare(b, b + 2, a, a + 2));
+            assert(::lexicographical_compare(a, a + 1, b, b + 2) && !::lexicographical_compare(a, a + 2, a, a + 2));
+            double zero[]{ 0.0 }, negative_zero[]{ -0.0 };
+            assert(::equal(zero, zero + 1, negative_zero));
+        }
+    }
+}
+
+namespace SortTest
+{
+    void test()
+    {
+        vector<int> random(100'000);
+        unsigned state = 1;
+        for (auto& value : random)
+            value = static_cast<int>(state = state * 1103515245 + 12345) >> 4;
+        auto expected = random;
+        std::sort(expected.begin(), expected.end());
+        {
+            auto values = random;
+            ::pdqsort(values.begin(), values.end());
+            assert(values == expected);
+            ::pdqsort(values.begin(), values.end());   //sorted
+            assert(values == expected);
+            ::pdqsort(values.begin(), values.end(), [](int a, int b) { return a > b; });   //reversed, with a branchy comparison
+            assert(std::is_sorted(values.rbegin(), values.rend()));
+        }
+        {
+            auto values = random;
+            ::radix_sort(values.begin(), values.end());    //negative keys first
+            assert(values == expected);
+            vector<double> doubles{ 2.5, -0.5, 1e300, -1e300, 0.0, 3.0 };
+            ::radix_sort(doubles.begin(), doubles.end());
+            assert(doubles == (vector<double>{ -1e300, -0.5, 0.0, 2.5, 3.0, 1e300 }));
+        }
+        {
+            //stable, by key
+            vector<std::pair<int, int>> pairs;
+            for (int i = 0; i < 1000; ++i)
+                pairs.push_back({ i % 7, i });
+            ::radix_sort(pairs.begin(), pairs.end(), [](auto const& pair) { return pair.first; });
+            assert(std::is_sorted(pairs.begin(), pairs.end()));
+        }
+        {
+            auto values = random;
+            ::sample_sort(values.begin(), values.end());
+            assert(values == expected);
+            for (auto& value : values)
+                value %= 3;     //few unique keys, the equal buckets
+            ::sort(execution::par, values.begin(), values.end());
+            assert(std::is_sorted(values.begin(), values.end()) && values.front() == -2 && values.back() == 2);
+        }
+    }
+}
+
+#include <cmath>
+
+namespace UninitializedMemoryTest
+{
+    void test()
+    {
+        {
+            vector<int> v(1000, default_init);
+            assert(v.size() == 1000);
+            for (int i = 0; i < 1000; ++i)
+                v[i] = i;
+            v.resize(5000, default_init);   //grows, the old elements are kept
+            assert(v.size() == 5000 && v[999] == 999);
+            v.resize(10, default_init);
+            assert(v.size() == 10 && v.back() == 9);
+            vector<std::string> strings(3, default_init);  //not trivial, so still constructed
+            assert(strings.size() == 3 && strings[2].empty());
+        }
+        {
+            //memset: zero bytes or a byte-sized type
+            vector<int> zeros(100, 0);
+            assert(std::count(zeros.begin(), zeros.end(), 0) == 100);
+            vector<char> chars(100, 'x');
+            assert(std::count(chars.begin(), chars.end(), 'x') == 100);
+            vector<double> negative_zeros(100, -0.0);  //not all zero bytes
+            assert(std::signbit(negative_zeros[99]));
+            vector<int*> nulls(10, nullptr);
+            assert(nulls[9] == nullptr);
+            vector<int> values(100, 7);
+            assert(values[0] == 7 && values[99] == 7);
+            auto copy = values; //memcpy
+            assert(copy == values);
+        }
+        {
+            int source[]{ 1, 2, 3, 4 };
+            int destination[4];
+            ::uninitialized_copy(std::make_move_iterator(source), std::make_move_iterator(source + 4), destination);
+            assert(std::equal(source, source + 4, destination));
+            ::uninitialized_relocate(source, source + 3, source + 1);    //memmove, overlapping
+            assert(source[1] == 1 && source[3] == 3);
+        }
+        {
+            std::allocator<std::string> alloc;
+            auto first = alloc.allocate(4);
+            auto second = alloc.allocate(4);
+            ::uninitialized_fill_n(first, 4, std::string(100, 'a'));
+            auto last = ::uninitialized_relocate(first, first + 4, second);  //one by one
+            assert(last == second + 4 && second[3] == std::string(100, 'a'));
+            ::destroy(second, last);
+            alloc.deallocate(second, 4);
+            alloc.deallocate(first, 4);
+        }
+    }
+}
+
+#include "PageAllocator.hpp"
+
+namespace AllocatorTest
+{
+    void test()
+    {
+        {
+            inline_arena<1024> arena;
+            vector<int, arena_allocator<int, 1024>> v{ arena };
+            v.reserve(16);
+            for (int i = 0; i < 64; ++i)
+                v.push_back(i); //grows in place, the only block of the arena
+            assert(arena.used() == 64 * sizeof(int) && v[63] == 63);
+            for (int i = 0; i < 1000; ++i)
+                v.push_back(i); //no more room, from the heap
+            assert(v.size() == 1064 && arena.used() == 0);
+
+            inline_arena<1024> other_arena;
+            vector<int, arena_allocator<int, 1024>> other{ { 1, 2, 3 }, other_arena };
+            other = std::move(v);   //takes the storage and the allocator
+            assert(other.size() == 1064 && (other.get_allocator() == arena_allocator<int, 1024>{ arena }));
+            vector<int, arena_allocator<int, 1024>> copy{ other_arena };
+            copy = other;   //keeps its own arena
+            assert(copy == other && copy.get_allocator() != other.get_allocator());
+            copy.swap(other);
+            assert((copy.get_allocator() == arena_allocator<long, 1024>{ arena }));
+        }
+        {
+            inline_arena<64> full;
+            auto p = full.allocate(64);
+            auto empty = full.allocate(0);  //the end of the buffer, not a heap block
+            full.deallocate(empty, 0);
+            full.deallocate(p, 64);
+            assert(full.used() == 0);
+        }
+        {
+            allocation_stats stats;
+            {
+                using alloc = stats_allocator<allocator<std::string>>;
+                vector<std::string, alloc> v{ alloc{ stats } };
+                for (int i = 0; i < 100; ++i)
+                    v.emplace_back(10, 'a');
+                assert(stats.allocations > 1 && stats.bytes_in_use == v.capacity() * sizeof(std::string));
+                auto copy = v;
+                assert(copy.get_allocator() == v.get_allocator() && stats.peak_bytes_in_use >= 2 * v.size() * sizeof(std::string));
+                vector<std::string, alloc> moved;
+                moved = std::move(v);   //the stateless allocator<T> propagates with the storage
+                assert(moved.get_allocator() == copy.get_allocator());
+            }
+            assert(stats.bytes_in_use == 0 && stats.allocations == stats.deallocations);
+            static_assert(allocator_traits<stats_allocator<malloc_allocator<int>>>::can_reallocate);
+            static_assert(!allocator_traits<stats_allocator<allocator<int>>>::can_reallocate);
+        }
+        {
+            vector<std::uint64_t, huge_page_allocator<std::uint64_t>> v(std::size_t{ 1 } << 20, 1);    //8 MiB
+            assert(reinterpret_cast<std::uintptr_t>(v.data()) % details::huge_page_size == 0);
+            v.resize(10);
+            v.shrink_to_fit();  //back to allocator<T>
+            assert(::count(v.begin(), v.end(), std::uint64_t{ 1 }) == 10);
+
+            vector<int, numa_allocator<int>> local(100'000, 7);
+            vector<int, numa_allocator<int>> on_node_0(numa_allocator<int>{ 0 });
+            on_node_0.assign(local.begin(), local.end());
+            assert(on_node_0 == local && on_node_0.get_allocator().node() == 0);
+        }
+    }
+}
+
+namespace IntegerSequenceTest
+{
+    /*the recursive versions went over the template depth limit at about 420 elements*/
+    using test = make_index_sequence<2000>;
+    static_assert(test::reverse::front() == 1999);
+    static_assert(test::pop_back_t::back() == 1998);
+    static_assert(test::split_second_part_t<999>::front() == 1000);
+    static_assert(decltype(test::filter([](auto i) { return i % 3 == 0; }))::size() == 667);
+    static_assert(test::repeat_t<2>::at(2000) == 0);
+}
+
+namespace IteratorTraitsTest
+{
+    static_assert(details::is_input_iterator<int*>::value);
+    static_assert(!details::is_input_iterator<int>::value);
+}
+
+int main()
+{
+    VectorTest::test();
+    FlatHashMapTest::test();
+    FlatMapTest::test();
+    AlgorithmTest::test();
+    SortTest::test();
+    UninitializedMemoryTest::test();
+    AllocatorTest::test();
+    std::cout << "All tests passed\n";
+}
@@ -9,12 +9,30 @@
 #include <forward_list>
 #include <algorithm>
 #include <iterator>
+#include <memory>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstdlib>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/*Hint the cache to load [p], a no-op if it is already there*/
+inline void prefetch(const void* p)
+{
+#ifdef _MSC_VER
+    _mm_prefetch(static_cast<const char*>(p), _MM_HINT_T0);
+#else
+    __builtin_prefetch(p);
+#endif
+}
 
 class Timer
 {
     std::chrono::steady_clock::time_point prev = std::chrono::steady_clock::now();
 public:
-    ~Timer() { std::cout << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - prev).count() << " microsec.\n\n"; }
+    ~Timer() { std::cout << std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - prev).count() << " microsec.\n\n"; }
 };
 
 int recursion_time;
@@ -108,7 +126,225 @@ void compare()
     }
 }
 
-int main()
+/*******************************Production alternative********************************/
+/* The stack list is fast because its nodes are contiguous, and free because they are never freed one by one.
+*  A pool gives both without the recursion, so the list can be as large as the memory.
+*/
+
+/*Hands out T-sized slots from large contiguous blocks. Freed slots go to a free list, and everything is released at once */
+template<typename T, size_t BlockSize = 64 * 1024>
+class NodePool
+{
+    union Slot
+    {
+        Slot* next_free;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+    static constexpr size_t slots_per_block = BlockSize / sizeof(Slot) ? BlockSize / sizeof(Slot) : 1;
+
+    std::vector<std::unique_ptr<Slot[]>> blocks;
+    Slot* current = nullptr;    //next unused slot of the last block
+    Slot* block_end = nullptr;
+    Slot* free_list = nullptr;
+public:
+    NodePool() = default;
+    NodePool(NodePool const&) = delete;
+    NodePool& operator=(NodePool const&) = delete;
+
+    template<typename... Args>
+    T* create(Args&&... args)
+    {
+        Slot* slot;
+        if (free_list)
+        {
+            slot = free_list;
+            free_list = free_list->next_free;
+        }
+        else
+        {
+            if (current == block_end)
+            {
+                blocks.emplace_back(new Slot[slots_per_block]);
+                current = blocks.back().get();
+                block_end = current + slots_per_block;
+            }
+            slot = current++;
+        }
+        return new (slot->storage) T{ std::forward<Args>(args)... };
+    }
+
+    void destroy(T* object)
+    {
+        object->~T();
+        auto slot = reinterpret_cast<Slot*>(object);
+        slot->next_free = free_list;
+        free_list = slot;
+    }
+
+    /*only for trivially destructible T, the objects are not destroyed */
+    void release()
+    {
+        static_assert(std::is_trivially_destructible_v<T>);
+        blocks.clear();
+        current = block_end = nullptr;
+        free_list = nullptr;
+    }
+
+    size_t bytes() const { return blocks.size() * slots_per_block * sizeof(Slot); }
+};
+
+/*The link lives inside the element, so the list itself never allocates */
+template<typename T>
+struct ListHook
+{
+    T* next = nullptr;
+};
+
+template<typename T>
+class IntrusiveList
+{
+    T* head = nullptr;
+public:
+    void push_front(T& element)
+    {
+        element.next = head;
+        head = &element;
+    }
+
+    T* front() const { return head; }
+
+    template<typename Func>
+    void for_each(Func&& func) const
+    {
+        for (auto cur = head; cur != nullptr; cur = cur->next)
+            func(*cur);
+    }
+
+    /*start loading the node after next while the current one is used, hides part of the latency when nodes are scattered */
+    template<typename Func>
+    void for_each_prefetch(Func&& func) const
+    {
+        for (auto cur = head; cur != nullptr; cur = cur->next)
+        {
+            if (cur->next)
+                prefetch(cur->next->next);
+            func(*cur);
+        }
+    }
+};
+
+template<typename T>
+struct Item : ListHook<Item<T>>
+{
+    T data;
+    Item(T data) : data{ data } {}
+};
+
+/*Several elements per node, a traversal follows one pointer per N elements */
+template<typename T, size_t N = (64 - sizeof(void*) - sizeof(unsigned)) / sizeof(T)>
+class UnrolledList
+{
+    struct Chunk
+    {
+        Chunk* next;
+        unsigned count;
+        T data[N];
+    };
+    NodePool<Chunk> pool;
+    Chunk* head = nullptr;
+public:
+    void push_front(T value)
+    {
+        if (head == nullptr || head->count == N)
+        {
+            auto chunk = pool.create();
+            chunk->next = head;
+            chunk->count = 0;
+            head = chunk;
+        }
+        head->data[head->count++] = value;
+    }
+
+    template<typename Func>
+    void for_each(Func&& func) const
+    {
+        for (auto cur = head; cur != nullptr; cur = cur->next)
+        {
+            if (cur->next)
+                prefetch(cur->next);
+            for (auto i = cur->count; i-- > 0;)    //newest first, same order as a list built by push_front
+                func(cur->data[i]);
+        }
+    }
+
+    size_t bytes() const { return pool.bytes(); }
+};
+
+template<typename Func>
+auto timeIt(Func&& func)
+{
+    auto const start = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+void report(char const* name, long long build, long long traverse, uint64_t sum)
+{
+    std::cout << "  " << name << ": build " << build << " microsec., traverse " << traverse << " microsec. (sum " << sum << ")\n";
+}
+
+template<typename T>
+void compareProduction(size_t count)
+{
+    std::cout << count << " elements:\n";
+    std::vector<T> values(count);
+    std::mt19937 eg{ 42 };
+    std::uniform_int_distribution<T> rd(0, 100);
+    for (auto& value : values)
+        value = rd(eg);
+
+    {
+        std::forward_list<T> l;
+        auto build = timeIt([&] { for (auto value : values) l.push_front(value); });
+        uint64_t sum = 0;
+        auto traverse = timeIt([&] { for (auto value : l) sum += value; });
+        report("std::forward_list          ", build, traverse, sum);
+    }
+    {
+        Node<T>* head = nullptr;
+        auto build = timeIt([&] { for (auto value : values) head = new Node<T>{ value, head }; });
+        uint64_t sum = 0;
+        auto traverse = timeIt([&] { for (auto cur = head; cur; cur = cur->next) sum += cur->data; });
+        report("new per node               ", build, traverse, sum);
+        while (head)
+        {
+            auto next = head->next;
+            delete head;
+            head = next;
+        }
+    }
+    {
+        NodePool<Item<T>> pool;
+        IntrusiveList<Item<T>> l;
+        auto build = timeIt([&] { for (auto value : values) l.push_front(*pool.create(value)); });
+        uint64_t sum = 0;
+        auto traverse = timeIt([&] { l.for_each([&](auto& item) { sum += item.data; }); });
+        report("pooled intrusive           ", build, traverse, sum);
+        sum = 0;
+        traverse = timeIt([&] { l.for_each_prefetch([&](auto& item) { sum += item.data; }); });
+        report("pooled intrusive, prefetch ", build, traverse, sum);
+    }
+    {
+        UnrolledList<T> l;
+        auto build = timeIt([&] { for (auto value : values) l.push_front(value); });
+        uint64_t sum = 0;
+        auto traverse = timeIt([&] { l.for_each([&](T value) { sum += value; }); });
+        report("unrolled, prefetch         ", build, traverse, sum);
+        std::cout << "  unrolled list uses " << static_cast<double>(l.bytes()) / count << " bytes per element\n";
+    }
+}
+
+int main(int argc, char** argv)
 {
     recursion_time = 100000;
     
@@ -117,6 +353,11 @@ int main()
         recursion = 0;
         compare<int>();
     }
+
+    /*10^8 needs about 5 GB for std::forward_list, pass the largest count as an argument */
+    size_t const max_count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10'000'000;
+    for (size_t count = 100'000; count <= max_count; count *= 10)
+        compareProduction<int>(count);
 }
 
 /******************************Release Mode***********************************/
@@ -313,4 +554,40 @@ int main()
 /*Conclusion： As we can see, in the debug mode, averagely using the stack-allocated linked list is a little bit faster than heap-allocated ones.
 * But the difference is more significant in the release mode.
 * Also, std::forward_list is consistenly slower than these two, because of higher overhead.
-*/
\ No newline at end of file
+*/
+
+/******************************Production alternative, Release Mode (-O2), Linux***********************************/
+// 100000 elements:
+//   std::forward_list          : build 1608 microsec., traverse 220 microsec.
+//   new per node               : build 764 microsec., traverse 337 microsec.
+//   pooled intrusive           : build 803 microsec., traverse 218 microsec.
+//   pooled intrusive, prefetch : build 803 microsec., traverse 160 microsec.
+//   unrolled, prefetch         : build 76 microsec., traverse 30 microsec.
+//   unrolled list uses 5.24288 bytes per element
+// 1000000 elements:
+//   std::forward_list          : build 25957 microsec., traverse 5120 microsec.
+//   new per node               : build 7871 microsec., traverse 7169 microsec.
+//   pooled intrusive           : build 12682 microsec., traverse 2213 microsec.
+//   pooled intrusive, prefetch : build 12682 microsec., traverse 2169 microsec.
+//   unrolled, prefetch         : build 1471 microsec., traverse 395 microsec.
+//   unrolled list uses 4.98074 bytes per element
+// 10000000 elements:
+//   std::forward_list          : build 270378 microsec., traverse 56710 microsec.
+//   new per node               : build 87746 microsec., traverse 90878 microsec.
+//   pooled intrusive           : build 143336 microsec., traverse 35766 microsec.
+//   pooled intrusive, prefetch : build 143336 microsec., traverse 41237 microsec.
+//   unrolled, prefetch         : build 20492 microsec., traverse 8421 microsec.
+//   unrolled list uses 4.92831 bytes per element
+// 100000000 elements:
+//   std::forward_list          : build 11836509 microsec., traverse 446261 microsec.
+//   new per node               : build 931181 microsec., traverse 715238 microsec.
+//   pooled intrusive           : build 1278206 microsec., traverse 283140 microsec.
+//   pooled intrusive, prefetch : build 1278206 microsec., traverse 292421 microsec.
+//   unrolled, prefetch         : build 195249 microsec., traverse 70443 microsec.
+//   unrolled list uses 4.92372 bytes per element
+
+/*Conclusion: the pooled list traverses 1.5-2.5x faster than a node per new, because its nodes are packed 16 bytes apart
+* instead of 32 with the malloc header. "new per node" builds faster here only because it reuses the pages freed by std::forward_list,
+* the pool touches fresh ones. Prefetching only helps at 10^5 elements, beyond that the pooled nodes are in order and the hardware prefetcher follows them.
+* The unrolled list is the real win: 13 ints per 64-byte node, about 5 bytes per element instead of 16, and 4-10x faster to build and to traverse.
+*/
@@ -1,7 +1,10 @@
 /**Description: Let's do a template meta programming version of merge sort.
+* Then do it again with a constexpr function, which sorts thousands of elements where the type-level version gives up.
 */
 #include <iostream>
 #include <utility>
+#include <array>
+#include <cstddef>
 
 template<int... Val>    //a integer sequence template, similar to std::integer_sequence
 struct seq{};
@@ -79,8 +82,145 @@ struct sort<seq<ToSort...>>
     using type=typename Merged::type;
 };
 
+/*Sort, but with a constexpr function
+* The type-level sort above instantiates a new divide<> for every element it moves and a new merge<> for every element it outputs,
+* each copying the whole pack, so it is O(N) instantiations deep and about O(N^2 log N) work.
+* Here the sequence is copied into an std::array once, sorted by a plain bottom-up merge sort in a constexpr function,
+* and expanded back into a seq once. Nothing is instantiated per element.
+*/
+template<std::size_t N>
+constexpr std::array<int, N> merge_sort(std::array<int, N> values)
+{
+    std::array<int, N> buffer{};
+    for (std::size_t width = 1; width < N; width *= 2)
+    {
+        for (std::size_t left = 0; left < N; left += 2 * width)
+        {
+            auto const middle = left + width < N ? left + width : N;
+            auto const right = left + 2 * width < N ? left + 2 * width : N;
+            auto i = left, j = middle, k = left;
+            while (i < middle && j < right)
+                buffer[k++] = values[j] < values[i] ? values[j++] : values[i++];    //take from the left on ties, so it's stable
+            while (i < middle)
+                buffer[k++] = values[i++];
+            while (j < right)
+                buffer[k++] = values[j++];
+        }
+        values = buffer;
+    }
+    return values;
+}
+
+/* The array is passed by reference as a template argument, because naming sorted_values<ToSort...>::value once per element
+* costs O(N) per element just to look up the N-argument template-id
+*/
+template<auto const& Values, typename Indices>
+struct to_seq;
+
+template<auto const& Values, std::size_t... I>
+struct to_seq<Values, std::index_sequence<I...>> : std::enable_if<true, seq<Values[I]...>> {};
+
+template<int... ToSort>
+struct sorted_values
+{
+    static constexpr auto value = merge_sort(std::array<int, sizeof...(ToSort)>{ ToSort... });
+};
+
+template<typename ToSort>
+struct constexpr_sort;
+
+template<int... ToSort>
+struct constexpr_sort<seq<ToSort...>> : to_seq<sorted_values<ToSort...>::value, std::make_index_sequence<sizeof...(ToSort)>> {};
+
+/*Lookup table
+* The same idea generates a table: call a constexpr function for every index, at compile time.
+* For example make_lookup_table<256>(popcount) is a 256-entry bit count table without a single hand-written entry.
+*/
+template<std::size_t N, typename Generator>
+constexpr auto make_lookup_table(Generator generator)
+{
+    std::array<decltype(generator(std::size_t{})), N> table{};
+    for (std::size_t i = 0; i < N; ++i)
+        table[i] = generator(i);
+    return table;
+}
+
+constexpr int popcount(std::size_t i)
+{
+    int count = 0;
+    for (; i != 0; i &= i - 1)
+        ++count;
+    return count;
+}
+
+constexpr auto popcount_table = make_lookup_table<256>(popcount);
+static_assert(popcount_table[0] == 0 && popcount_table[0b1011] == 3 && popcount_table[255] == 8);
+
+/*A pseudo-random seq of N elements for the measurements, from a linear congruential generator (Knuth's MMIX constants).
+* Not a lookup table: each element comes from the state left by the previous one
+*/
+template<std::size_t N>
+constexpr auto make_random_values()
+{
+    std::array<int, N> values{};
+    unsigned long long x = 1;
+    for (auto& value : values)
+    {
+        x = 6364136223846793005ULL * x + 1442695040888963407ULL;
+        value = static_cast<int>((x >> 33) % 100000);
+    }
+    return values;
+}
+
+template<std::size_t N>
+constexpr auto random_values = make_random_values<N>();
+
+template<std::size_t N>
+using random_seq = typename to_seq<random_values<N>, std::make_index_sequence<N>>::type;
+
+/*Compile-time measurements (g++ 12, -std=c++17, -fsyntax-only), compile with -DSORT_SIZE=N to sort random_seq<N>
+* with constexpr_sort, and add -DTYPE_LEVEL_SORT to check the type-level sort against it:
+*
+*   SORT_SIZE   sort (type-level)                   constexpr_sort
+*   100         0.50s                               0.33s
+*   300         1.17s                               0.35s
+*   895         7.8s, about the most it handles, merge<> goes over the default -ftemplate-depth of 900 from 900 elements
+*   1000        8.2s with -ftemplate-depth=100000   0.51s
+*   2000        34s with -ftemplate-depth=100000    -
+*   5000        -                                   1.7s
+*   10000       -                                   3.0s
+*   20000       -                                   8.8s, needs -fconstexpr-ops-limit raised over the default 2^25
+*/
+template<int... Val>
+constexpr bool is_sorted(seq<Val...>)
+{
+    std::array<int, sizeof...(Val)> values{ Val... };
+    for (std::size_t i = 1; i < values.size(); ++i)
+    {
+        if (values[i] < values[i - 1])
+            return false;
+    }
+    return true;
+}
+
+#ifdef SORT_SIZE
+using Large = random_seq<SORT_SIZE>;
+#ifdef TYPE_LEVEL_SORT
+static_assert(std::is_same_v<typename sort<Large>::type, typename constexpr_sort<Large>::type>);
+#else
+static_assert(is_sorted(typename constexpr_sort<Large>::type{}));
+#endif
+#endif
+
 int main()
 {
     using ToSort=sort<seq<541,56,23,12,4,789,6>>;
     print_seq(ToSort::type{});
+    static_assert(std::is_same_v<ToSort::type, constexpr_sort<seq<541,56,23,12,4,789,6>>::type>);
+
+    using Random=random_seq<20>;
+    static_assert(std::is_same_v<sort<Random>::type, constexpr_sort<Random>::type>);
+    print_seq(constexpr_sort<Random>::type{});
+
+    std::cout << "popcount(0b1011) from the table: " << popcount_table[0b1011] << '\n';
 }
\ No newline at end of file